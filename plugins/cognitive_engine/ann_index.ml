@@ -0,0 +1,390 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Approximate Nearest-Neighbour Index *)
+
+open Bigarray
+
+(** Binary heap of nodes, highest priority on top *)
+module Heap = struct
+  type t = {
+    mutable prio : float array;
+    mutable node : int array;
+    mutable size : int;
+  }
+
+  let create () = { prio = Array.make 16 0.0; node = Array.make 16 0; size = 0 }
+
+  let is_empty h = h.size = 0
+  let length h = h.size
+  let top_prio h = h.prio.(0)
+  let top_node h = h.node.(0)
+
+  let swap h i j =
+    let p = h.prio.(i) and n = h.node.(i) in
+    h.prio.(i) <- h.prio.(j);
+    h.node.(i) <- h.node.(j);
+    h.prio.(j) <- p;
+    h.node.(j) <- n
+
+  let push h p n =
+    if h.size = Array.length h.prio then begin
+      let grow a fill = Array.append a (Array.make (Array.length a) fill) in
+      h.prio <- grow h.prio 0.0;
+      h.node <- grow h.node 0
+    end;
+    let i = ref h.size in
+    h.prio.(!i) <- p;
+    h.node.(!i) <- n;
+    h.size <- h.size + 1;
+    while !i > 0 && h.prio.((!i - 1) / 2) < h.prio.(!i) do
+      swap h !i ((!i - 1) / 2);
+      i := (!i - 1) / 2
+    done
+
+  let pop h =
+    h.size <- h.size - 1;
+    if h.size > 0 then begin
+      h.prio.(0) <- h.prio.(h.size);
+      h.node.(0) <- h.node.(h.size);
+      let i = ref 0 and settled = ref false in
+      while not !settled do
+        let l = 2 * !i + 1 and r = 2 * !i + 2 in
+        let largest = ref !i in
+        if l < h.size && h.prio.(l) > h.prio.(!largest) then largest := l;
+        if r < h.size && h.prio.(r) > h.prio.(!largest) then largest := r;
+        if !largest = !i then settled := true
+        else begin
+          swap h !i !largest;
+          i := !largest
+        end
+      done
+    end
+end
+
+(** Nodes are never reused: a replaced or removed key leaves a tombstone
+    that keeps routing searches until the graph is rebuilt *)
+type t = {
+  dim : int;
+  m : int;
+  m0 : int;
+  level_mult : float;
+  ef_construction : int;
+  ef_search : int;
+  rng : Random.State.t;
+  mutable vectors : (float, float32_elt, c_layout) Array1.t;
+    (** unit vectors in float32, [dim] per node *)
+  mutable links : int array array array;  (** node -> layer -> neighbours *)
+  mutable node_keys : int array;
+  mutable deleted : bool array;
+  mutable visited : int array;
+  mutable stamp : int;
+  mutable count : int;
+  mutable tombstones : int;
+  mutable entry : int;                    (** -1 when empty *)
+  mutable top_level : int;
+  nodes : (int, int) Hashtbl.t;           (** key -> live node *)
+}
+
+let max_level = 16
+
+let create ?(m=16) ?(ef_construction=100) ?(ef_search=64) ?(seed=42) dim =
+  if dim <= 0 then failwith "Embedding dimension must be positive";
+  if m < 2 then failwith "HNSW needs at least 2 links per node";
+  {
+    dim;
+    m;
+    m0 = 2 * m;
+    level_mult = 1.0 /. log (float_of_int m);
+    ef_construction = max ef_construction m;
+    ef_search = max 1 ef_search;
+    rng = Random.State.make [| seed |];
+    vectors = Array1.create float32 c_layout 0;
+    links = [||];
+    node_keys = [||];
+    deleted = [||];
+    visited = [||];
+    stamp = 0;
+    count = 0;
+    tombstones = 0;
+    entry = -1;
+    top_level = 0;
+    nodes = Hashtbl.create 64;
+  }
+
+let dim t = t.dim
+let length t = Hashtbl.length t.nodes
+let mem t key = Hashtbl.mem t.nodes key
+
+let rec take n = function
+  | x :: rest when n > 0 -> x :: take (n - 1) rest
+  | _ -> []
+
+let similarity a b =
+  let sum = ref 0.0 in
+  for i = 0 to Array.length a - 1 do
+    sum := !sum +. a.(i) *. b.(i)
+  done;
+  !sum
+
+(* Scores against stored rows accumulate in float64 *)
+let row_dot t q node =
+  let base = node * t.dim in
+  let sum = ref 0.0 in
+  for i = 0 to t.dim - 1 do
+    sum := !sum +. q.(i) *. Array1.unsafe_get t.vectors (base + i)
+  done;
+  !sum
+
+let rows_dot t a b =
+  let base_a = a * t.dim and base_b = b * t.dim in
+  let sum = ref 0.0 in
+  for i = 0 to t.dim - 1 do
+    sum := !sum +. Array1.unsafe_get t.vectors (base_a + i) *. Array1.unsafe_get t.vectors (base_b + i)
+  done;
+  !sum
+
+let row t node = Array.init t.dim (fun i -> Array1.get t.vectors (node * t.dim + i))
+
+let normalize t v =
+  if Array.length v <> t.dim then failwith "Embedding dimension mismatch";
+  let norm = sqrt (similarity v v) in
+  if norm > 0.0 then Some (Array.map (fun x -> x /. norm) v) else None
+
+let layer_links t node layer =
+  let layers = t.links.(node) in
+  if layer < Array.length layers then layers.(layer) else [||]
+
+(** Layer search *)
+
+(* Beam search from the entry nodes; returns up to ef nodes, best first *)
+let search_layer t q entries ef layer =
+  t.stamp <- t.stamp + 1;
+  let candidates = Heap.create () in
+  let results = Heap.create () in  (* keyed by negated similarity *)
+  List.iter (fun n ->
+    if t.visited.(n) <> t.stamp then begin
+      t.visited.(n) <- t.stamp;
+      let s = row_dot t q n in
+      Heap.push candidates s n;
+      Heap.push results (-. s) n;
+      if Heap.length results > ef then Heap.pop results
+    end
+  ) entries;
+  let searching = ref true in
+  while !searching && not (Heap.is_empty candidates) do
+    let s = Heap.top_prio candidates and c = Heap.top_node candidates in
+    Heap.pop candidates;
+    if Heap.length results >= ef && s < -. Heap.top_prio results then searching := false
+    else
+      Array.iter (fun e ->
+        if t.visited.(e) <> t.stamp then begin
+          t.visited.(e) <- t.stamp;
+          let se = row_dot t q e in
+          if Heap.length results < ef || se > -. Heap.top_prio results then begin
+            Heap.push candidates se e;
+            Heap.push results (-. se) e;
+            if Heap.length results > ef then Heap.pop results
+          end
+        end
+      ) (layer_links t c layer)
+  done;
+  let found = ref [] in
+  while not (Heap.is_empty results) do
+    found := (-. Heap.top_prio results, Heap.top_node results) :: !found;
+    Heap.pop results
+  done;
+  !found
+
+(* Greedy descent through the layers above [level] *)
+let descend t q level =
+  let ep = ref t.entry in
+  for layer = t.top_level downto level + 1 do
+    match search_layer t q [!ep] 1 layer with
+    | (_, n) :: _ -> ep := n
+    | [] -> ()
+  done;
+  !ep
+
+(** Insertion *)
+
+(* The neighbour heuristic: keep a candidate only if it is closer to the
+   query than to every neighbour kept so far, then top up with the pruned
+   ones. Candidates arrive best first. *)
+let select_neighbours t candidates m =
+  let selected = ref [] and count = ref 0 and pruned = ref [] in
+  List.iter (fun (s, n) ->
+    if !count < m then begin
+      if List.for_all (fun r -> rows_dot t n r < s) !selected then begin
+        selected := n :: !selected;
+        incr count
+      end else
+        pruned := n :: !pruned
+    end
+  ) candidates;
+  let rec fill acc count = function
+    | n :: rest when count < m -> fill (n :: acc) (count + 1) rest
+    | _ -> acc
+  in
+  Array.of_list (fill !selected !count (List.rev !pruned))
+
+let shrink t node links max_links =
+  let scored = Array.to_list (Array.map (fun e -> (rows_dot t node e, e)) links) in
+  select_neighbours t (List.sort (fun (a, _) (b, _) -> compare b a) scored) max_links
+
+let connect t q node level =
+  if t.entry < 0 then begin
+    t.entry <- node;
+    t.top_level <- level
+  end else begin
+    let entries = ref [descend t q level] in
+    for layer = min level t.top_level downto 0 do
+      let found = search_layer t q !entries t.ef_construction layer in
+      let max_links = if layer = 0 then t.m0 else t.m in
+      let chosen = select_neighbours t found t.m in
+      t.links.(node).(layer) <- chosen;
+      Array.iter (fun e ->
+        let grown = Array.append t.links.(e).(layer) [| node |] in
+        t.links.(e).(layer) <-
+          if Array.length grown <= max_links then grown
+          else shrink t e grown max_links
+      ) chosen;
+      entries := List.map snd found
+    done;
+    if level > t.top_level then begin
+      t.entry <- node;
+      t.top_level <- level
+    end
+  end
+
+let random_level t =
+  let u = Random.State.float t.rng 1.0 in
+  if u <= 0.0 then 0
+  else min max_level (int_of_float (-. log u *. t.level_mult))
+
+let reserve t =
+  if t.count = Array.length t.node_keys then begin
+    let capacity = max 16 (2 * t.count) in
+    let grow a fill =
+      let b = Array.make capacity fill in
+      Array.blit a 0 b 0 t.count;
+      b
+    in
+    let vectors = Array1.create float32 c_layout (capacity * t.dim) in
+    Array1.blit (Array1.sub t.vectors 0 (t.count * t.dim)) (Array1.sub vectors 0 (t.count * t.dim));
+    t.vectors <- vectors;
+    t.links <- grow t.links [||];
+    t.node_keys <- grow t.node_keys 0;
+    t.deleted <- grow t.deleted false;
+    t.visited <- grow t.visited 0
+  end
+
+let insert t key u =
+  reserve t;
+  let node = t.count in
+  let level = random_level t in
+  t.count <- node + 1;
+  Array.iteri (fun i x -> Array1.set t.vectors (node * t.dim + i) x) u;
+  t.links.(node) <- Array.make (level + 1) [||];
+  t.node_keys.(node) <- key;
+  t.deleted.(node) <- false;
+  t.visited.(node) <- 0;
+  Hashtbl.replace t.nodes key node;
+  connect t u node level
+
+(* Reinsert the live nodes into a fresh graph *)
+let rebuild t =
+  let live = Hashtbl.fold (fun key node acc -> (node, key) :: acc) t.nodes [] in
+  let live = List.map (fun (node, key) -> (key, row t node)) (List.sort compare live) in
+  Hashtbl.reset t.nodes;
+  t.count <- 0;
+  t.tombstones <- 0;
+  t.entry <- -1;
+  t.top_level <- 0;
+  List.iter (fun (key, u) -> insert t key u) live
+
+let remove t key =
+  match Hashtbl.find_opt t.nodes key with
+  | Some node ->
+    Hashtbl.remove t.nodes key;
+    t.deleted.(node) <- true;
+    t.tombstones <- t.tombstones + 1;
+    if t.tombstones > 64 && t.tombstones > length t then rebuild t
+  | None -> ()
+
+let add t key v =
+  let unit_vector = normalize t v in
+  remove t key;
+  match unit_vector with
+  | Some u -> insert t key u
+  | None -> ()
+
+(** Queries *)
+
+let live_results t found k =
+  take k (List.filter (fun (_, n) -> not t.deleted.(n)) found)
+  |> List.map (fun (s, n) -> (t.node_keys.(n), s))
+
+let exact_scan t q =
+  let found = ref [] in
+  for n = 0 to t.count - 1 do
+    if not t.deleted.(n) then found := (row_dot t q n, n) :: !found
+  done;
+  List.sort (fun (a, _) (b, _) -> compare b a) !found
+
+let search_unit t ef q k =
+  if k <= 0 || t.entry < 0 then []
+  else begin
+    let ef = max k (match ef with Some ef -> ef | None -> t.ef_search) in
+    if t.count <= ef then live_results t (exact_scan t q) k
+    else
+      (* Tombstones take beam slots, so widen the beam by up to ef *)
+      let beam = ef + min t.tombstones ef in
+      live_results t (search_layer t q [descend t q 0] beam 0) k
+  end
+
+let search ?ef t q k =
+  match normalize t q with
+  | Some u -> search_unit t ef u k
+  | None -> []
+
+(* Widen k until the k-th neighbour falls below the threshold *)
+let radius_unit t u threshold =
+  let rec widen k =
+    let found = search_unit t (Some k) u k in
+    let exhausted = List.length found < k in
+    match List.rev found with
+    | (_, s) :: _ when not exhausted && s >= threshold -> widen (2 * k)
+    | _ -> List.filter (fun (_, s) -> s >= threshold) found
+  in
+  widen 16
+
+let search_radius t q threshold =
+  match normalize t q with
+  | Some u -> radius_unit t u threshold
+  | None -> []
+
+let neighbours t key k =
+  match Hashtbl.find_opt t.nodes key with
+  | Some node ->
+    search_unit t None (row t node) (k + 1)
+    |> List.filter (fun (other, _) -> other <> key)
+    |> take k
+  | None -> []
+
+let neighbours_within t key threshold =
+  match Hashtbl.find_opt t.nodes key with
+  | Some node ->
+    radius_unit t (row t node) threshold
+    |> List.filter (fun (other, _) -> other <> key)
+  | None -> []
+
+let knn_graph t k =
+  Hashtbl.fold (fun key _ acc -> key :: acc) t.nodes []
+  |> List.sort compare
+  |> List.map (fun key -> (key, neighbours t key k))
@@ -0,0 +1,51 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Approximate Nearest-Neighbour Index
+
+    A hierarchical navigable small world (HNSW) graph over fixed-dimension
+    embeddings keyed by atom id, ranked by cosine similarity. Insertions
+    are incremental; removals leave a tombstone that still routes searches
+    until enough accumulate to rebuild the graph. Indexes no larger than
+    the search beam are scanned exactly. Vectors are held normalized in
+    one float32 array, 4 bytes per component. *)
+
+type t
+
+(** [create ?m ?ef_construction ?ef_search ?seed dim]. [m] is the number
+    of links per node above layer 0 (twice that on layer 0); the [ef]
+    parameters are the beam widths used while inserting and searching. *)
+val create : ?m:int -> ?ef_construction:int -> ?ef_search:int -> ?seed:int -> int -> t
+
+val dim : t -> int
+
+(** Number of live keys *)
+val length : t -> int
+
+val mem : t -> int -> bool
+
+(** Insert or replace the embedding for a key. Zero vectors are not
+    indexed, since they have no cosine neighbours. *)
+val add : t -> int -> float array -> unit
+
+val remove : t -> int -> unit
+
+(** The [k] most similar keys, best first, with their cosine similarity *)
+val search : ?ef:int -> t -> float array -> int -> (int * float) list
+
+(** Keys whose cosine similarity is at least the threshold, best first *)
+val search_radius : t -> float array -> float -> (int * float) list
+
+(** Neighbours of a stored key, excluding the key itself *)
+val neighbours : t -> int -> int -> (int * float) list
+
+(** Stored keys within the threshold of a stored key, excluding itself *)
+val neighbours_within : t -> int -> float -> (int * float) list
+
+(** The k-nearest-neighbour graph over every live key *)
+val knn_graph : t -> int -> (int * (int * float) list) list
@@ -0,0 +1,160 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Indexed Max-Heap over Atom Ids *)
+
+type t = {
+  mutable slots : int array;      (** heap order: slot -> id *)
+  mutable positions : int array;  (** id -> slot, -1 when absent *)
+  mutable size : int;
+}
+
+let create capacity =
+  let capacity = max 16 capacity in
+  { slots = Array.make capacity 0; positions = Array.make capacity (-1); size = 0 }
+
+let length t = t.size
+
+let mem t id = id >= 0 && id < Array.length t.positions && t.positions.(id) >= 0
+
+let grow a capacity fill =
+  let b = Array.make capacity fill in
+  Array.blit a 0 b 0 (Array.length a);
+  b
+
+let place t slot id =
+  t.slots.(slot) <- id;
+  t.positions.(id) <- slot
+
+let rec sift_up t key slot =
+  if slot > 0 then begin
+    let parent = (slot - 1) / 2 in
+    let id = t.slots.(slot) and above = t.slots.(parent) in
+    if key id > key above then begin
+      place t parent id;
+      place t slot above;
+      sift_up t key parent
+    end
+  end
+
+let rec sift_down t key slot =
+  let l = 2 * slot + 1 and r = 2 * slot + 2 in
+  let largest =
+    if l < t.size && key t.slots.(l) > key t.slots.(slot) then l else slot in
+  let largest =
+    if r < t.size && key t.slots.(r) > key t.slots.(largest) then r else largest in
+  if largest <> slot then begin
+    let id = t.slots.(slot) and below = t.slots.(largest) in
+    place t slot below;
+    place t largest id;
+    sift_down t key largest
+  end
+
+let update t key id =
+  if mem t id then begin
+    let slot = t.positions.(id) in
+    sift_up t key slot;
+    if t.positions.(id) = slot then sift_down t key slot
+  end
+
+let add t key id =
+  if mem t id then update t key id
+  else begin
+    if id >= Array.length t.positions then
+      t.positions <- grow t.positions (max (2 * Array.length t.positions) (id + 1)) (-1);
+    if t.size = Array.length t.slots then
+      t.slots <- grow t.slots (2 * t.size) 0;
+    place t t.size id;
+    t.size <- t.size + 1;
+    sift_up t key (t.size - 1)
+  end
+
+(* Bulk loading: append without sifting, then [rebuild] once *)
+let add_unordered t id =
+  if not (mem t id) then begin
+    if id >= Array.length t.positions then
+      t.positions <- grow t.positions (max (2 * Array.length t.positions) (id + 1)) (-1);
+    if t.size = Array.length t.slots then
+      t.slots <- grow t.slots (2 * t.size) 0;
+    place t t.size id;
+    t.size <- t.size + 1
+  end
+
+let remove t key id =
+  if mem t id then begin
+    let slot = t.positions.(id) in
+    t.positions.(id) <- -1;
+    t.size <- t.size - 1;
+    if slot < t.size then begin
+      let moved = t.slots.(t.size) in
+      place t slot moved;
+      sift_up t key slot;
+      sift_down t key t.positions.(moved)
+    end
+  end
+
+let rebuild t key =
+  for slot = t.size / 2 - 1 downto 0 do
+    sift_down t key slot
+  done
+
+let top t = if t.size > 0 then Some t.slots.(0) else None
+
+(* Best-first walk of the heap tree: the next best id is always a child
+   of one already taken, so a frontier of at most k + 1 slots suffices *)
+let top_k t key k =
+  let k = max 0 (min k t.size) in
+  if k = 0 then []
+  else begin
+    let frontier = Array.make (k + 1) 0 in
+    let count = ref 0 in
+    let score slot = key t.slots.(slot) in
+    let swap i j =
+      let tmp = frontier.(i) in
+      frontier.(i) <- frontier.(j);
+      frontier.(j) <- tmp
+    in
+    let push slot =
+      if slot < t.size then begin
+        let i = ref !count in
+        frontier.(!i) <- slot;
+        incr count;
+        while !i > 0 && score frontier.((!i - 1) / 2) < score frontier.(!i) do
+          swap !i ((!i - 1) / 2);
+          i := (!i - 1) / 2
+        done
+      end
+    in
+    let pop () =
+      let best = frontier.(0) in
+      decr count;
+      frontier.(0) <- frontier.(!count);
+      let i = ref 0 and settled = ref false in
+      while not !settled do
+        let l = 2 * !i + 1 and r = 2 * !i + 2 in
+        let largest = ref !i in
+        if l < !count && score frontier.(l) > score frontier.(!largest) then largest := l;
+        if r < !count && score frontier.(r) > score frontier.(!largest) then largest := r;
+        if !largest = !i then settled := true
+        else begin
+          swap !i !largest;
+          i := !largest
+        end
+      done;
+      best
+    in
+    push 0;
+    let taken = ref [] in
+    for _ = 1 to k do
+      let slot = pop () in
+      taken := t.slots.(slot) :: !taken;
+      push (2 * slot + 1);
+      push (2 * slot + 2)
+    done;
+    List.rev !taken
+  end
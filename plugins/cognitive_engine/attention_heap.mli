@@ -0,0 +1,45 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Indexed Max-Heap over Atom Ids
+
+    Orders atom ids by a key read through a function at each operation,
+    normally a lookup in an attention column, so the heap holds no
+    values of its own. A position index makes membership O(1) and lets a
+    changed key be restored in O(log n). Rescaling every key with the
+    same non-decreasing function keeps the heap valid, so whole-column
+    decay and rent passes need no heap work. *)
+
+type t
+
+val create : int -> t
+
+val length : t -> int
+
+val mem : t -> int -> bool
+
+(** Insert an id, or move it after its key changed *)
+val add : t -> (int -> float) -> int -> unit
+
+(** Move an id after its key changed; absent ids are ignored *)
+val update : t -> (int -> float) -> int -> unit
+
+(** Insert an id without restoring heap order; [rebuild] must run
+    before the next ordered operation *)
+val add_unordered : t -> int -> unit
+
+val remove : t -> (int -> float) -> int -> unit
+
+(** Restore heap order after keys changed arbitrarily, in O(n) *)
+val rebuild : t -> (int -> float) -> unit
+
+(** Id with the largest key *)
+val top : t -> int option
+
+(** The [k] ids with the largest keys, best first, in O(k log k) *)
+val top_k : t -> (int -> float) -> int -> int list
@@ -67,6 +67,7 @@ type attentional_focus = {
   mutable focus_size : int;
   mutable focused_atoms : (Hypergraph.node_id * Hypergraph.link_id) list;
   mutable update_frequency : int;
+  mutable focus_bits : Bytes.t;  (** bit per node id, set for focused nodes *)
 }
 
 (** ECAN system state *)
@@ -75,6 +76,7 @@ type ecan_system = {
   attention_bank : attention_bank;
   config : ecan_config;
   attentional_focus : attentional_focus;
+  spreading : Spreading_matrix.t;  (** node-to-link spreading shares *)
   mutable event_history : attention_event list;
 }
 
@@ -126,61 +128,38 @@ let create_ecan_system atomspace config =
     focus_size = 20;
     focused_atoms = [];
     update_frequency = 10;
+    focus_bits = Bytes.make 128 '\000';
   } in
   {
     atomspace = atomspace;
     attention_bank = bank;
     config = config;
     attentional_focus = focus;
+    spreading = Spreading_matrix.create atomspace;
     event_history = [];
   }
 
+(** Detach the system from its AtomSpace before discarding it *)
+let release_ecan_system system = Spreading_matrix.release system.spreading
+
 (** Core ECAN operations *)
 let stimulate_atom system node_id amount =
-  match Hypergraph.get_node system.atomspace node_id with
-  | None -> ()
-  | Some node ->
-      if allocate_sti system.attention_bank amount then (
-        let new_attention = {
-          node.attention with
-          sti = node.attention.sti +. amount
-        } in
-        Hypergraph.update_node_attention system.atomspace node_id new_attention;
-        system.event_history <- Stimulus (node_id, amount) :: system.event_history
-      )
+  if Hashtbl.mem system.atomspace.nodes node_id
+     && allocate_sti system.attention_bank amount then (
+    Hypergraph.add_node_sti system.atomspace node_id amount;
+    system.event_history <- Stimulus (node_id, amount) :: system.event_history
+  )
 
-let spread_activation system source_id =
-  match Hypergraph.get_node system.atomspace source_id with
-  | None -> ()
-  | Some source ->
-      if source.attention.sti > system.config.spread_threshold then (
-        let spread_amount = source.attention.sti *. 0.1 in
-        let incoming = Hypergraph.get_incoming_links system.atomspace source_id in
-        let outgoing = Hypergraph.get_outgoing_links system.atomspace source_id in
-        let all_links = incoming @ outgoing in
-        
-        if all_links <> [] then (
-          let amount_per_link = spread_amount /. float_of_int (List.length all_links) in
-          List.iter (fun link_id ->
-            match Hypergraph.get_link system.atomspace link_id with
-            | Some link ->
-                let new_attention = {
-                  link.attention with
-                  sti = link.attention.sti +. amount_per_link
-                } in
-                Hypergraph.update_link_attention system.atomspace link_id new_attention
-            | None -> ()
-          ) all_links;
-          
-          (* Reduce source attention *)
-          let new_source_attention = {
-            source.attention with
-            sti = source.attention.sti -. spread_amount
-          } in
-          Hypergraph.update_node_attention system.atomspace source_id new_source_attention;
-          system.event_history <- Spread_activation (source_id, spread_amount) :: system.event_history
-        )
-      )
+(* Each spreading source gives 10% of its STI to its adjacent links *)
+let spread_from system sources =
+  Spreading_matrix.spread system.spreading sources system.config.spread_threshold 0.1
+  |> List.iter (fun (node_id, amount) ->
+    system.event_history <- Spread_activation (node_id, amount) :: system.event_history)
+
+let spread_activation system source_id = spread_from system [source_id]
+
+let spread_focus system =
+  spread_from system (List.map fst system.attentional_focus.focused_atoms)
 
 let apply_decay system =
   let decay_factor = system.config.decay_factor in
@@ -189,53 +168,69 @@ let apply_decay system =
 
 let collect_rent system =
   let rent_rate = system.config.rent_rate in
-  let total_rent_collected = ref 0.0 in
-  
-  (* Collect rent from nodes *)
-  Hashtbl.iter (fun _ (node : Hypergraph.node) ->
-    let rent = node.attention.sti *. rent_rate in
-    let new_attention = {
-      node.attention with
-      sti = max 0.0 (node.attention.sti -. rent)
-    } in
-    Hypergraph.update_node_attention system.atomspace node.id new_attention;
-    total_rent_collected := !total_rent_collected +. rent
-  ) system.atomspace.nodes;
-  
-  (* Collect rent from links *)
-  Hashtbl.iter (fun _ (link : Hypergraph.link) ->
-    let rent = link.attention.sti *. rent_rate in
-    let new_attention = {
-      link.attention with
-      sti = max 0.0 (link.attention.sti -. rent)
-    } in
-    Hypergraph.update_link_attention system.atomspace link.id new_attention;
-    total_rent_collected := !total_rent_collected +. rent
-  ) system.atomspace.links;
-  
-  return_sti system.attention_bank !total_rent_collected;
-  system.event_history <- Rent_collection !total_rent_collected :: system.event_history
+  let total_rent_collected = Hypergraph.collect_attention_rent system.atomspace rent_rate in
+  return_sti system.attention_bank total_rent_collected;
+  system.event_history <- Rent_collection total_rent_collected :: system.event_history
+
+(* Decay and rent as one pass over the columns, recorded as both events *)
+let decay_and_collect_rent system =
+  let decay_factor = system.config.decay_factor in
+  let total_rent_collected =
+    Hypergraph.decay_and_collect_rent system.atomspace decay_factor system.config.rent_rate in
+  return_sti system.attention_bank total_rent_collected;
+  system.event_history <-
+    Rent_collection total_rent_collected :: Decay decay_factor :: system.event_history
+
+(** Attentional focus management *)
+let focus_bit focus node_id =
+  let byte = node_id lsr 3 in
+  byte < Bytes.length focus.focus_bits
+  && Char.code (Bytes.unsafe_get focus.focus_bits byte) land (1 lsl (node_id land 7)) <> 0
+
+let set_focus_bit focus node_id on =
+  let byte = node_id lsr 3 in
+  if byte >= Bytes.length focus.focus_bits then begin
+    let grown = Bytes.make (max (2 * Bytes.length focus.focus_bits) (byte + 1)) '\000' in
+    Bytes.blit focus.focus_bits 0 grown 0 (Bytes.length focus.focus_bits);
+    focus.focus_bits <- grown
+  end;
+  let bits = Char.code (Bytes.get focus.focus_bits byte) in
+  let mask = 1 lsl (node_id land 7) in
+  Bytes.set focus.focus_bits byte
+    (Char.chr (if on then bits lor mask else bits land (lnot mask land 0xff)))
 
 let forget_low_attention_atoms system =
   let threshold = system.config.forgetting_threshold in
   let to_remove = ref [] in
   
-  Hashtbl.iter (fun _ (node : Hypergraph.node) ->
-    if node.attention.sti < threshold && node.attention.lti < threshold then
-      to_remove := node.id :: !to_remove
-  ) system.atomspace.nodes;
+  Hypergraph.iter_node_attention (fun id sti lti ->
+    if sti < threshold && lti < threshold then
+      to_remove := id :: !to_remove
+  ) system.atomspace;
   
-  List.iter (Hypergraph.remove_node system.atomspace) !to_remove
-
-(** Attentional focus management *)
+  List.iter (Hypergraph.remove_node system.atomspace) !to_remove;
+  
+  (* Forgotten nodes leave the focus as well *)
+  let focus = system.attentional_focus in
+  if List.exists (focus_bit focus) !to_remove then begin
+    List.iter (fun id -> if focus_bit focus id then set_focus_bit focus id false) !to_remove;
+    focus.focused_atoms <- List.filter (fun (node_id, _) ->
+      Hashtbl.mem system.atomspace.Hypergraph.nodes node_id) focus.focused_atoms
+  end
+
+(* The focus is read off the AtomSpace's STI ranking, which is kept up to
+   date as STI changes, so only the old and new members are touched *)
 let update_attentional_focus system =
-  let high_attention = Hypergraph.get_high_attention_atoms system.atomspace system.attentional_focus.focus_size in
-  system.attentional_focus.focused_atoms <- high_attention
+  let focus = system.attentional_focus in
+  let high_attention = Hypergraph.get_high_attention_atoms system.atomspace focus.focus_size in
+  List.iter (fun (node_id, _) -> set_focus_bit focus node_id false) focus.focused_atoms;
+  List.iter (fun (node_id, _) -> set_focus_bit focus node_id true) high_attention;
+  focus.focused_atoms <- high_attention
 
 let get_focused_atoms system = system.attentional_focus.focused_atoms
 
 let is_in_focus system node_id =
-  List.exists (fun (nid, _) -> nid = node_id) system.attentional_focus.focused_atoms
+  node_id >= 0 && focus_bit system.attentional_focus node_id
 
 (** Attention-guided processing *)
 let get_attention_guided_tasks system =
@@ -258,12 +253,12 @@ let prioritize_by_attention system node_ids =
 
 (** Economic dynamics *)
 let calculate_importance system node_id =
-  match Hypergraph.get_node system.atomspace node_id with
+  match Hypergraph.get_node_attention system.atomspace node_id with
   | None -> 0.0
-  | Some node ->
+  | Some attention ->
       let incoming_count = float_of_int (List.length (Hypergraph.get_incoming_links system.atomspace node_id)) in
       let outgoing_count = float_of_int (List.length (Hypergraph.get_outgoing_links system.atomspace node_id)) in
-      node.attention.sti +. node.attention.lti +. (incoming_count *. 0.1) +. (outgoing_count *. 0.1)
+      attention.sti +. attention.lti +. (incoming_count *. 0.1) +. (outgoing_count *. 0.1)
 
 let wage_attention system node_id amount =
   match Hypergraph.get_node system.atomspace node_id with
@@ -286,12 +281,10 @@ let attention_competition system node_ids =
 
 (** ECAN cycle - main processing loop *)
 let ecan_cycle system =
-  apply_decay system;
-  collect_rent system;
+  decay_and_collect_rent system;
   
   (* Spread activation for high attention atoms *)
-  let focused = get_focused_atoms system in
-  List.iter (fun (node_id, _) -> spread_activation system node_id) focused;
+  spread_focus system;
   
   update_attentional_focus system;
   forget_low_attention_atoms system;
@@ -308,49 +301,58 @@ let get_attention_statistics system =
   (available_sti, available_lti, num_nodes, num_focused)
 
 let get_most_important_atoms system count =
-  let node_list = ref [] in
-  Hashtbl.iter (fun _ (node : Hypergraph.node) ->
-    let importance = calculate_importance system node.id in
-    node_list := (node.id, importance) :: !node_list
-  ) system.atomspace.nodes;
-  let sorted = List.sort (fun (_, i1) (_, i2) -> compare i2 i1) !node_list in
-  List.map fst (take (min count (List.length sorted)) sorted)
+  let ids = Array.of_list (Hashtbl.fold (fun id _ acc -> id :: acc) system.atomspace.nodes []) in
+  let importance = Array.map (calculate_importance system) ids in
+  List.map (fun i -> ids.(i)) (Hypergraph.top_k_indices importance count)
 
 let get_attention_distribution system =
   let buckets = Array.make 10 0 in
-  Hashtbl.iter (fun _ (node : Hypergraph.node) ->
-    let bucket = min 9 (int_of_float (node.attention.sti /. 10.0)) in
+  Hypergraph.iter_node_attention (fun _ sti _ ->
+    let bucket = max 0 (min 9 (int_of_float (sti /. 10.0))) in
     buckets.(bucket) <- buckets.(bucket) + 1
-  ) system.atomspace.nodes;
+  ) system.atomspace;
   Array.to_list (Array.mapi (fun i count -> (float_of_int (i * 10), count)) buckets)
 
 (** Scheme representation *)
-let attention_event_to_scheme = function
-  | Stimulus (node_id, amount) -> Printf.sprintf "(stimulus %d %.3f)" node_id amount
-  | Decay factor -> Printf.sprintf "(decay %.3f)" factor
-  | Rent_collection amount -> Printf.sprintf "(rent-collection %.3f)" amount
-  | Spread_activation (node_id, amount) -> Printf.sprintf "(spread-activation %d %.3f)" node_id amount
-  | Gradient_update (head_id, gradients) -> 
-      let grad_str = String.concat " " (Array.to_list (Array.map (Printf.sprintf "%.3f") gradients)) in
-      Printf.sprintf "(gradient-update %d (%s))" head_id grad_str
-
-let attention_bank_to_scheme bank =
-  Printf.sprintf "(attention-bank (sti-total %.3f) (sti-available %.3f) (lti-total %.3f) (lti-available %.3f))"
+let add_attention_event_scheme buf = function
+  | Stimulus (node_id, amount) -> Printf.bprintf buf "(stimulus %d %.3f)" node_id amount
+  | Decay factor -> Printf.bprintf buf "(decay %.3f)" factor
+  | Rent_collection amount -> Printf.bprintf buf "(rent-collection %.3f)" amount
+  | Spread_activation (node_id, amount) -> Printf.bprintf buf "(spread-activation %d %.3f)" node_id amount
+  | Gradient_update (head_id, gradients) ->
+      Printf.bprintf buf "(gradient-update %d (" head_id;
+      Array.iteri (fun i g ->
+        if i > 0 then Buffer.add_char buf ' ';
+        Printf.bprintf buf "%.3f" g) gradients;
+      Buffer.add_string buf "))"
+
+let add_attention_bank_scheme buf bank =
+  Printf.bprintf buf "(attention-bank (sti-total %.3f) (sti-available %.3f) (lti-total %.3f) (lti-available %.3f))"
     bank.total_sti bank.available_sti bank.total_lti bank.available_lti
 
-let ecan_config_to_scheme config =
-  Printf.sprintf "(ecan-config (sti-funds %.3f) (lti-funds %.3f) (decay-factor %.3f) (rent-rate %.3f) (spread-threshold %.3f) (forgetting-threshold %.3f))"
+let add_ecan_config_scheme buf config =
+  Printf.bprintf buf "(ecan-config (sti-funds %.3f) (lti-funds %.3f) (decay-factor %.3f) (rent-rate %.3f) (spread-threshold %.3f) (forgetting-threshold %.3f))"
     config.sti_funds config.lti_funds config.decay_factor config.rent_rate config.spread_threshold config.forgetting_threshold
 
-let ecan_system_to_scheme system =
-  let events_str = String.concat " " (List.map attention_event_to_scheme (take 10 system.event_history)) in
-  let focused_str = String.concat " " (List.map (fun (nid, lid) -> Printf.sprintf "(%d %d)" nid lid) system.attentional_focus.focused_atoms) in
-  Printf.sprintf "(ecan-system\n  %s\n  %s\n  (focus-size %d)\n  (focused-atoms (%s))\n  (recent-events (%s)))"
-    (attention_bank_to_scheme system.attention_bank)
-    (ecan_config_to_scheme system.config)
-    system.attentional_focus.focus_size
-    focused_str
-    events_str
+let add_ecan_system_scheme buf system =
+  Buffer.add_string buf "(ecan-system\n  ";
+  add_attention_bank_scheme buf system.attention_bank;
+  Buffer.add_string buf "\n  ";
+  add_ecan_config_scheme buf system.config;
+  Printf.bprintf buf "\n  (focus-size %d)\n  (focused-atoms (" system.attentional_focus.focus_size;
+  List.iteri (fun i (nid, lid) ->
+    if i > 0 then Buffer.add_char buf ' ';
+    Printf.bprintf buf "(%d %d)" nid lid) system.attentional_focus.focused_atoms;
+  Buffer.add_string buf "))\n  (recent-events (";
+  List.iteri (fun i event ->
+    if i > 0 then Buffer.add_char buf ' ';
+    add_attention_event_scheme buf event) (take 10 system.event_history);
+  Buffer.add_string buf "))"
+
+let attention_event_to_scheme event = Hypergraph.scheme_of_buffer add_attention_event_scheme event
+let attention_bank_to_scheme bank = Hypergraph.scheme_of_buffer add_attention_bank_scheme bank
+let ecan_config_to_scheme config = Hypergraph.scheme_of_buffer add_ecan_config_scheme config
+let ecan_system_to_scheme system = Hypergraph.scheme_of_buffer add_ecan_system_scheme system
 
 (** Gradient-based attention optimization implementation *)
 
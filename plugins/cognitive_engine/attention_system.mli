@@ -55,11 +55,14 @@ type ecan_config = {
   forgetting_threshold : float;
 }
 
-(** Attentional focus - high attention atoms *)
+(** Attentional focus - high attention atoms. [focused_atoms] and
+    [focus_bits] are kept in step by [update_attentional_focus] and
+    [forget_low_attention_atoms]. *)
 type attentional_focus = {
   mutable focus_size : int;
   mutable focused_atoms : (Hypergraph.node_id * Hypergraph.link_id) list;
   mutable update_frequency : int;
+  mutable focus_bits : Bytes.t;  (** bit per node id, set for focused nodes *)
 }
 
 (** ECAN system state *)
@@ -68,12 +71,17 @@ type ecan_system = {
   attention_bank : attention_bank;
   config : ecan_config;
   attentional_focus : attentional_focus;
+  spreading : Spreading_matrix.t;  (** node-to-link spreading shares *)
   mutable event_history : attention_event list;
 }
 
 (** Create ECAN system *)
 val create_ecan_system : Hypergraph.atomspace -> ecan_config -> ecan_system
 
+(** Unsubscribe the system's spreading matrix from the AtomSpace; call
+    before dropping a system whose AtomSpace lives on *)
+val release_ecan_system : ecan_system -> unit
+
 (** Default ECAN configuration *)
 val default_ecan_config : ecan_config
 
@@ -95,6 +103,9 @@ val stimulate_atom : ecan_system -> Hypergraph.node_id -> float -> unit
 
 val spread_activation : ecan_system -> Hypergraph.node_id -> unit
 
+(** Spread activation from every focused node in one sparse pass *)
+val spread_focus : ecan_system -> unit
+
 val apply_decay : ecan_system -> unit
 
 val collect_rent : ecan_system -> unit
@@ -106,6 +117,7 @@ val update_attentional_focus : ecan_system -> unit
 
 val get_focused_atoms : ecan_system -> (Hypergraph.node_id * Hypergraph.link_id) list
 
+(** O(1), through the focus bitmap *)
 val is_in_focus : ecan_system -> Hypergraph.node_id -> bool
 
 (** Attention-guided processing *)
@@ -149,7 +161,12 @@ val get_attention_tensor_stats : attention_tensor -> (float * float * float * fl
 
 val get_attention_distribution : ecan_system -> (float * int) list
 
-(** Scheme representation *)
+(** Scheme representation, written into a Buffer or as a string *)
+val add_attention_event_scheme : Buffer.t -> attention_event -> unit
+val add_attention_bank_scheme : Buffer.t -> attention_bank -> unit
+val add_ecan_config_scheme : Buffer.t -> ecan_config -> unit
+val add_ecan_system_scheme : Buffer.t -> ecan_system -> unit
+
 val attention_event_to_scheme : attention_event -> string
 
 val attention_bank_to_scheme : attention_bank -> string
@@ -297,26 +297,19 @@ let add_neural_representation engine node_id representation_data shape =
 
 let get_neural_representation engine node_id =
   let atomspace = engine.atomspace in
-  let tensors = ref [] in
-  Hashtbl.iter (fun _ tensor ->
+  Hypergraph.fold_tensors (fun tensor tensors ->
     match tensor.Hypergraph.associated_node with
-    | Some nid when nid = node_id -> tensors := tensor :: !tensors
-    | _ -> ()
-  ) atomspace.tensors;
-  !tensors
+    | Some nid when nid = node_id -> tensor :: tensors
+    | _ -> tensors
+  ) atomspace []
 
 let compute_concept_similarity engine node_id1 node_id2 =
   let tensors1 = get_neural_representation engine node_id1 in
   let tensors2 = get_neural_representation engine node_id2 in
   match tensors1, tensors2 with
-  | [t1], [t2] when Tensor_backend.validate_shapes t1.shape t2.shape ->
-      let similarity = Hypergraph.tensor_dot_product_op engine.atomspace t1.id t2.id in
-      let norm1 = Hypergraph.tensor_norm_op engine.atomspace t1.id in
-      let norm2 = Hypergraph.tensor_norm_op engine.atomspace t2.id in
-      if norm1 > 0.0 && norm2 > 0.0 then
-        similarity /. (norm1 *. norm2)  (* Cosine similarity *)
-      else
-        0.0
+  | [t1], [t2] when Tensor_backend.Dense.same_shape t1.Hypergraph.data t2.Hypergraph.data ->
+      (* Cosine similarity, with the norms cached on the tensors *)
+      Hypergraph.tensor_cosine_similarity_op engine.atomspace t1.id t2.id
   | _ -> 0.0  (* No compatible representations found *)
 
 let process_with_neural_attention engine input_tensor_ids =
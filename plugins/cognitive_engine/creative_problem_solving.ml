@@ -922,27 +922,19 @@ let neural_guided_concept_generation engine seed_nodes count =
 let tensor_similarity_creative_search engine tensor_ids constraints =
   (* Use tensor operations for similarity-based creative search *)
   let similarity_threshold = 0.7 in
-  let creative_paths = ref [] in
-  
-  List.iteri (fun i tensor_id1 ->
-    List.iteri (fun j tensor_id2 ->
-      if i < j then
-        let similarity = Hypergraph.tensor_cosine_similarity_op engine.atomspace tensor_id1 tensor_id2 in
-        if similarity > similarity_threshold then
-          let path = {
-            nodes = [i; j]; (* Using indices as proxy for node IDs *)
-            links = [];
-            creativity_score = similarity;
-            novelty_score = 1.0 -. similarity; (* More novel if less similar *)
-            feasibility_score = similarity;
-            path_length = 2;
-            exploration_steps = 1;
-          } in
-          creative_paths := path :: !creative_paths
-    ) tensor_ids
-  ) tensor_ids;
-  
-  !creative_paths
+  
+  (* All pairs scored at once from the Gram matrix of unit embeddings *)
+  List.map (fun (i, j, similarity) ->
+    {
+      nodes = [i; j]; (* Using indices as proxy for node IDs *)
+      links = [];
+      creativity_score = similarity;
+      novelty_score = 1.0 -. similarity; (* More novel if less similar *)
+      feasibility_score = similarity;
+      path_length = 2;
+      exploration_steps = 1;
+    }
+  ) (Hypergraph.tensor_cosine_pairs engine.atomspace tensor_ids similarity_threshold)
 
 (** Scheme representation *)
 let creative_solution_to_scheme solution =
@@ -0,0 +1,212 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Quantized Embedding Store *)
+
+open Bigarray
+
+type format =
+  | F32
+  | Q8_0
+  | Q4_0
+
+let format_to_string = function
+  | F32 -> "f32"
+  | Q8_0 -> "q8_0"
+  | Q4_0 -> "q4_0"
+
+(* Codes match emb_format in tensor_kernels.c *)
+let format_code = function
+  | F32 -> 0
+  | Q8_0 -> 1
+  | Q4_0 -> 2
+
+let block_size = 32
+
+let block_bytes = function
+  | F32 -> 4 * block_size
+  | Q8_0 -> 2 + block_size
+  | Q4_0 -> 2 + block_size / 2
+
+let blocks_of dim = (dim + block_size - 1) / block_size
+
+let row_bytes format dim = blocks_of dim * block_bytes format
+
+(* Stored rows are dotted with a Q8_0 query, F32 rows with an F32 one *)
+let query_format = function
+  | F32 -> F32
+  | Q8_0 | Q4_0 -> Q8_0
+
+type buffer = (int, int8_unsigned_elt, c_layout) Array1.t
+
+external encode_stub : int -> Float.Array.t -> buffer -> int -> unit
+  = "caml_embedding_encode" [@@noalloc]
+external decode_stub : int -> buffer -> int -> Float.Array.t -> unit
+  = "caml_embedding_decode" [@@noalloc]
+external dot_stub : int -> buffer -> int -> buffer -> int -> int -> float
+  = "caml_embedding_dot_bytecode" "caml_embedding_dot"
+
+(** Rows [0, length) are live; [row_keys] and [norms] are indexed by row *)
+type t = {
+  format : format;
+  dim : int;
+  row_size : int;
+  mutable table : buffer;
+  mutable norms : float array;
+  mutable row_keys : int array;
+  mutable length : int;
+  rows : (int, int) Hashtbl.t;  (** key -> row *)
+  scratch : Float.Array.t;
+}
+
+type query = {
+  bytes : buffer;
+  query_norm : float;
+}
+
+let new_buffer size =
+  Array1.create int8_unsigned c_layout (max 1 size)
+
+let create ?(format=Q8_0) ?(capacity=64) dim =
+  if dim <= 0 then failwith "Embedding dimension must be positive";
+  let capacity = max 1 capacity in
+  let row_size = row_bytes format dim in
+  {
+    format;
+    dim;
+    row_size;
+    table = new_buffer (capacity * row_size);
+    norms = Array.make capacity 0.0;
+    row_keys = Array.make capacity 0;
+    length = 0;
+    rows = Hashtbl.create capacity;
+    scratch = Float.Array.make dim 0.0;
+  }
+
+let format t = t.format
+let dim t = t.dim
+let length t = t.length
+let mem t key = Hashtbl.mem t.rows key
+let keys t = Array.to_list (Array.sub t.row_keys 0 t.length)
+
+let capacity t = Array.length t.norms
+
+let grow t =
+  let capacity = 2 * capacity t in
+  let table = new_buffer (capacity * t.row_size) in
+  let used = t.length * t.row_size in
+  Array1.blit (Array1.sub t.table 0 used) (Array1.sub table 0 used);
+  t.table <- table;
+  let norms = Array.make capacity 0.0 in
+  Array.blit t.norms 0 norms 0 t.length;
+  t.norms <- norms;
+  let row_keys = Array.make capacity 0 in
+  Array.blit t.row_keys 0 row_keys 0 t.length;
+  t.row_keys <- row_keys
+
+let offset t row = row * t.row_size
+
+let decode_row t row dst = decode_stub (format_code t.format) t.table (offset t row) dst
+
+let vector_norm v = sqrt (Float.Array.fold_left (fun acc x -> acc +. x *. x) 0.0 v)
+
+let floats data = Float.Array.map_from_array Fun.id data
+
+let set t key data =
+  if Array.length data <> t.dim then failwith "Embedding dimension mismatch";
+  let row = match Hashtbl.find_opt t.rows key with
+    | Some row -> row
+    | None ->
+      if t.length = capacity t then grow t;
+      let row = t.length in
+      t.length <- row + 1;
+      t.row_keys.(row) <- key;
+      Hashtbl.replace t.rows key row;
+      row
+  in
+  encode_stub (format_code t.format) (floats data) t.table (offset t row);
+  (* Norm of what was stored, so a row's cosine with itself is 1 *)
+  decode_row t row t.scratch;
+  t.norms.(row) <- vector_norm t.scratch
+
+(* Move the last row into the freed slot *)
+let remove t key =
+  match Hashtbl.find_opt t.rows key with
+  | None -> ()
+  | Some row ->
+    Hashtbl.remove t.rows key;
+    let last = t.length - 1 in
+    if row <> last then begin
+      Array1.blit (Array1.sub t.table (offset t last) t.row_size)
+        (Array1.sub t.table (offset t row) t.row_size);
+      t.norms.(row) <- t.norms.(last);
+      t.row_keys.(row) <- t.row_keys.(last);
+      Hashtbl.replace t.rows t.row_keys.(row) row
+    end;
+    t.length <- last
+
+let get t key =
+  match Hashtbl.find_opt t.rows key with
+  | Some row ->
+    let result = Float.Array.make t.dim 0.0 in
+    decode_row t row result;
+    Some (Float.Array.map_to_array Fun.id result)
+  | None -> None
+
+let norm t key =
+  match Hashtbl.find_opt t.rows key with
+  | Some row -> t.norms.(row)
+  | None -> 0.0
+
+(** Similarity *)
+
+let encode_query t data =
+  if Array.length data <> t.dim then failwith "Embedding dimension mismatch";
+  let format = query_format t.format in
+  let bytes = new_buffer (row_bytes format t.dim) in
+  let data = floats data in
+  encode_stub (format_code format) data bytes 0;
+  { bytes; query_norm = vector_norm data }
+
+let row_dot t q row =
+  dot_stub (format_code t.format) t.table (offset t row) q.bytes 0 (blocks_of t.dim)
+
+let query_dot t q key =
+  match Hashtbl.find_opt t.rows key with
+  | Some row -> row_dot t q row
+  | None -> failwith "Embedding not found"
+
+let query_cosine t q key =
+  match Hashtbl.find_opt t.rows key with
+  | Some row ->
+    let denom = q.query_norm *. t.norms.(row) in
+    if denom > 0.0 then row_dot t q row /. denom else 0.0
+  | None -> 0.0
+
+(* Stored rows are re-encoded as a query through their dequantized values *)
+let stored_query t key =
+  match get t key with
+  | Some data -> Some (encode_query t data)
+  | None -> None
+
+let cosine t key1 key2 =
+  match stored_query t key1 with
+  | Some q when mem t key2 ->
+    let denom = norm t key1 *. norm t key2 in
+    if denom > 0.0 then query_dot t q key2 /. denom else 0.0
+  | _ -> 0.0
+
+let dot t key1 key2 =
+  match stored_query t key1 with
+  | Some q -> query_dot t q key2
+  | None -> failwith "Embedding not found"
+
+(** Memory *)
+
+let memory_bytes t =
+  t.length * (t.row_size + 8)
@@ -0,0 +1,74 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Quantized Embedding Store
+
+    A table of fixed-dimension embeddings keyed by atom id, stored in
+    ggml's block formats: 32 values per block with one fp16 scale.
+    Similarity is computed on the quantized blocks directly; queries are
+    quantized to Q8_0 once per call. *)
+
+(** {1 Formats} *)
+
+type format =
+  | F32    (** 4 bytes per value, exact up to float32 *)
+  | Q8_0   (** 34 bytes per 32 values *)
+  | Q4_0   (** 18 bytes per 32 values *)
+
+val format_to_string : format -> string
+
+(** Bytes one embedding of the given dimension occupies *)
+val row_bytes : format -> int -> int
+
+(** {1 Tables} *)
+
+type t
+
+(** [create ?format ?capacity dim]; [format] defaults to [Q8_0] *)
+val create : ?format:format -> ?capacity:int -> int -> t
+
+val format : t -> format
+val dim : t -> int
+val length : t -> int
+val mem : t -> int -> bool
+val keys : t -> int list
+
+(** Store or replace the embedding for a key *)
+val set : t -> int -> float array -> unit
+
+val remove : t -> int -> unit
+
+(** The dequantized embedding *)
+val get : t -> int -> float array option
+
+(** Norm of the stored (dequantized) embedding, 0.0 if absent *)
+val norm : t -> int -> float
+
+(** {1 Similarity} *)
+
+(** A query vector encoded for this table *)
+type query
+
+val encode_query : t -> float array -> query
+
+(** Dot product of the query with a stored embedding *)
+val query_dot : t -> query -> int -> float
+
+(** Cosine similarity with a stored embedding, 0.0 if absent or zero *)
+val query_cosine : t -> query -> int -> float
+
+(** Cosine similarity of two stored embeddings, 0.0 if either is absent *)
+val cosine : t -> int -> int -> float
+
+val dot : t -> int -> int -> float
+
+(** {1 Memory} *)
+
+(** Resident bytes for the embeddings and their norms, excluding spare
+    capacity and the key index *)
+val memory_bytes : t -> int
@@ -44,8 +44,8 @@
  * ============================================================================
  */
 
-#define GGML_MAX_CONTEXTS 64
-#define GGML_MAX_GRAPHS 64
+/* Freed context arenas kept for reuse by later contexts */
+#define GGML_ARENA_POOL_SIZE 4
 
 /* Backend types */
 typedef enum {
@@ -58,17 +58,19 @@ typedef enum {
 
 /* Context wrapper with metadata */
 typedef struct {
-    void *ctx;              /* ggml_context pointer */
+    void *ctx;              /* ggml_context pointer, NULL once freed */
     size_t mem_size;        /* Allocated memory size */
     int backend;            /* Backend type */
     int n_threads;          /* Number of threads */
-    int ref_count;          /* Reference count */
+    int ref_count;          /* Context block plus its live tensor and graph blocks */
+    unsigned int generation;/* Bumped by reset and free */
 } ggml_ctx_wrapper;
 
 /* Tensor wrapper with metadata */
 typedef struct {
     void *tensor;           /* ggml_tensor pointer */
-    int ctx_id;             /* Parent context ID */
+    ggml_ctx_wrapper *owner;/* Parent context */
+    unsigned int generation;/* Parent generation at creation */
     int is_view;            /* Is this a view of another tensor */
     char name[64];          /* Tensor name for debugging */
 } ggml_tensor_wrapper;
@@ -76,18 +78,39 @@ typedef struct {
 /* Graph wrapper */
 typedef struct {
     void *graph;            /* ggml_cgraph pointer */
-    int ctx_id;             /* Parent context ID */
+    ggml_ctx_wrapper *owner;/* Parent context */
+    unsigned int generation;/* Parent generation at creation */
     int n_nodes;            /* Number of nodes */
 } ggml_graph_wrapper;
 
-/* Global context registry */
-static ggml_ctx_wrapper *g_contexts[GGML_MAX_CONTEXTS] = {0};
-static int g_next_ctx_id = 0;
+/* A tensor or graph is usable while its context has not been reset or
+ * freed since it was created */
+#define Handle_live(w, field) \
+    ((w) != NULL && (w)->field != NULL && (w)->owner->ctx != NULL && \
+     (w)->generation == (w)->owner->generation)
+#define Tensor_live(w) Handle_live(w, tensor)
+#define Graph_live(w) Handle_live(w, graph)
+
+/* Arena pool and live handle counts (guarded by the OCaml runtime lock) */
+typedef struct {
+    void *ctx;
+    size_t mem_size;
+} ggml_arena;
+
+static ggml_arena g_arenas[GGML_ARENA_POOL_SIZE];
+static int g_n_arenas = 0;
+static long g_live_contexts = 0;
+static long g_live_tensors = 0;
+static long g_live_graphs = 0;
+
+static void ggml_ctx_native_finalize(value v);
+static void ggml_tensor_native_finalize(value v);
+static void ggml_graph_native_finalize(value v);
 
 /* Custom block operations */
 static struct custom_operations ggml_ctx_native_ops = {
     "org.opencoq.ggml_ctx_native",
-    custom_finalize_default,
+    ggml_ctx_native_finalize,
     custom_compare_default,
     custom_hash_default,
     custom_serialize_default,
@@ -98,7 +121,7 @@ static struct custom_operations ggml_ctx_native_ops = {
 
 static struct custom_operations ggml_tensor_native_ops = {
     "org.opencoq.ggml_tensor_native",
-    custom_finalize_default,
+    ggml_tensor_native_finalize,
     custom_compare_default,
     custom_hash_default,
     custom_serialize_default,
@@ -109,7 +132,7 @@ static struct custom_operations ggml_tensor_native_ops = {
 
 static struct custom_operations ggml_graph_native_ops = {
     "org.opencoq.ggml_graph_native",
-    custom_finalize_default,
+    ggml_graph_native_finalize,
     custom_compare_default,
     custom_hash_default,
     custom_serialize_default,
@@ -134,6 +157,128 @@ static struct custom_operations ggml_graph_native_ops = {
 #define Ggml_graph(w) ((struct ggml_cgraph *)(w)->graph)
 #endif
 
+/*
+ * ============================================================================
+ * Handle Lifetime and Arena Reuse
+ * ============================================================================
+ *
+ * Tensor and graph blocks hold a reference on their context wrapper, so an
+ * arena stays alive while anything made in it is reachable. Once the last
+ * reference goes (or on an explicit free) the arena is reset and pooled for
+ * the next context of a similar size rather than freed.
+ */
+
+/* Reset an arena and pool it, or free it when the pool is full */
+static void arena_release(void *ctx, size_t mem_size) {
+#ifdef HAVE_GGML
+    if (g_n_arenas < GGML_ARENA_POOL_SIZE) {
+        ggml_reset((struct ggml_context *)ctx);
+        g_arenas[g_n_arenas].ctx = ctx;
+        g_arenas[g_n_arenas].mem_size = mem_size;
+        g_n_arenas++;
+    } else {
+        ggml_free((struct ggml_context *)ctx);
+    }
+#else
+    (void)ctx;
+    (void)mem_size;
+#endif
+}
+
+#ifdef HAVE_GGML
+/* Smallest pooled arena holding [mem_size] bytes without wasting more than
+ * as much again, or NULL */
+static void *arena_acquire(size_t mem_size, size_t *actual) {
+    int best = -1;
+    for (int i = 0; i < g_n_arenas; i++) {
+        size_t size = g_arenas[i].mem_size;
+        if (size >= mem_size && size / 2 <= mem_size &&
+            (best < 0 || size < g_arenas[best].mem_size)) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return NULL;
+    }
+    void *ctx = g_arenas[best].ctx;
+    *actual = g_arenas[best].mem_size;
+    g_arenas[best] = g_arenas[--g_n_arenas];
+    return ctx;
+}
+#endif
+
+/* Give up the context's arena; existing handles become stale */
+static void ctx_detach(ggml_ctx_wrapper *wrapper) {
+    if (wrapper->ctx != NULL) {
+        arena_release(wrapper->ctx, wrapper->mem_size);
+        wrapper->ctx = NULL;
+        wrapper->generation++;
+        g_live_contexts--;
+    }
+}
+
+static void ctx_unref(ggml_ctx_wrapper *wrapper) {
+    if (--wrapper->ref_count <= 0) {
+        ctx_detach(wrapper);
+        free(wrapper);
+    }
+}
+
+static void ggml_ctx_native_finalize(value v) {
+    ggml_ctx_wrapper *wrapper = Ctx_wrapper_val(v);
+    if (wrapper != NULL) {
+        Ctx_wrapper_val(v) = NULL;
+        ctx_unref(wrapper);
+    }
+}
+
+static void ggml_tensor_native_finalize(value v) {
+    ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(v);
+    if (wrapper != NULL) {
+        Tensor_wrapper_val(v) = NULL;
+        ctx_unref(wrapper->owner);
+        free(wrapper);
+        g_live_tensors--;
+    }
+}
+
+static void ggml_graph_native_finalize(value v) {
+    ggml_graph_wrapper *wrapper = Graph_wrapper_val(v);
+    if (wrapper != NULL) {
+        Graph_wrapper_val(v) = NULL;
+        ctx_unref(wrapper->owner);
+        free(wrapper);
+        g_live_graphs--;
+    }
+}
+
+/* (contexts holding an arena, tensor handles, graph handles, pooled arenas) */
+CAMLprim value caml_ggml_native_live_handles(value unit) {
+    CAMLparam1(unit);
+    CAMLlocal1(result);
+    
+    result = caml_alloc_tuple(4);
+    Store_field(result, 0, Val_long(g_live_contexts));
+    Store_field(result, 1, Val_long(g_live_tensors));
+    Store_field(result, 2, Val_long(g_live_graphs));
+    Store_field(result, 3, Val_int(g_n_arenas));
+    
+    CAMLreturn(result);
+}
+
+/* Free every pooled arena */
+CAMLprim value caml_ggml_native_trim_arenas(value unit) {
+    CAMLparam1(unit);
+    
+#ifdef HAVE_GGML
+    while (g_n_arenas > 0) {
+        ggml_free((struct ggml_context *)g_arenas[--g_n_arenas].ctx);
+    }
+#endif
+    
+    CAMLreturn(Val_unit);
+}
+
 /*
  * ============================================================================
  * Backend Detection and Selection
@@ -178,8 +323,16 @@ CAMLprim value caml_ggml_native_backend_name(value unit) {
  * ============================================================================
  * CPU Feature Detection
  * ============================================================================
+ *
+ * These probes are the one CPU-detection path of the plugin; the dense
+ * kernels in tensor_kernels.c dispatch on them too. Without GGML the
+ * AVX2 and FMA probes ask the CPU directly.
  */
 
+#if !defined(HAVE_GGML) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_PROBE(feature) (__builtin_cpu_init(), __builtin_cpu_supports(feature))
+#endif
+
 CAMLprim value caml_ggml_native_cpu_has_avx(value unit) {
     CAMLparam1(unit);
 #ifdef HAVE_GGML
@@ -193,6 +346,8 @@ CAMLprim value caml_ggml_native_cpu_has_avx2(value unit) {
     CAMLparam1(unit);
 #ifdef HAVE_GGML
     CAMLreturn(Val_bool(ggml_cpu_has_avx2()));
+#elif defined(CPU_PROBE)
+    CAMLreturn(Val_bool(CPU_PROBE("avx2")));
 #else
     CAMLreturn(Val_bool(0));
 #endif
@@ -229,6 +384,8 @@ CAMLprim value caml_ggml_native_cpu_has_fma(value unit) {
     CAMLparam1(unit);
 #ifdef HAVE_GGML
     CAMLreturn(Val_bool(ggml_cpu_has_fma()));
+#elif defined(CPU_PROBE)
+    CAMLreturn(Val_bool(CPU_PROBE("fma")));
 #else
     CAMLreturn(Val_bool(0));
 #endif
@@ -348,13 +505,16 @@ CAMLprim value caml_ggml_native_init(value mem_size, value n_threads) {
     size_t size = Long_val(mem_size);
     int threads = Int_val(n_threads);
     
-    struct ggml_init_params params = {
-        .mem_size   = size,
-        .mem_buffer = NULL,
-        .no_alloc   = false,
-    };
-    
-    struct ggml_context *ctx = ggml_init(params);
+    /* Reuse a pooled arena when one fits, else map a new one */
+    struct ggml_context *ctx = (struct ggml_context *)arena_acquire(size, &size);
+    if (ctx == NULL) {
+        struct ggml_init_params params = {
+            .mem_size   = size,
+            .mem_buffer = NULL,
+            .no_alloc   = false,
+        };
+        ctx = ggml_init(params);
+    }
     if (ctx == NULL) {
         caml_failwith("ggml_native_init: failed to initialize context");
     }
@@ -362,7 +522,7 @@ CAMLprim value caml_ggml_native_init(value mem_size, value n_threads) {
     /* Create wrapper */
     ggml_ctx_wrapper *wrapper = (ggml_ctx_wrapper *)malloc(sizeof(ggml_ctx_wrapper));
     if (wrapper == NULL) {
-        ggml_free(ctx);
+        arena_release(ctx, size);
         caml_failwith("ggml_native_init: failed to allocate wrapper");
     }
     
@@ -370,6 +530,7 @@ CAMLprim value caml_ggml_native_init(value mem_size, value n_threads) {
     wrapper->mem_size = size;
     wrapper->n_threads = threads > 0 ? threads : 4;
     wrapper->ref_count = 1;
+    wrapper->generation = 0;
     
 #ifdef GGML_USE_CUDA
     wrapper->backend = BACKEND_CUDA;
@@ -378,31 +539,23 @@ CAMLprim value caml_ggml_native_init(value mem_size, value n_threads) {
 #else
     wrapper->backend = BACKEND_CPU;
 #endif
+    g_live_contexts++;
     
-    /* Register in global table */
-    int ctx_id = g_next_ctx_id++;
-    if (ctx_id < GGML_MAX_CONTEXTS) {
-        g_contexts[ctx_id] = wrapper;
-    }
-    
-    result = caml_alloc_custom(&ggml_ctx_native_ops, sizeof(ggml_ctx_wrapper *), 0, 1);
+    /* Charge the arena to the GC so unreachable contexts are finalized promptly */
+    result = caml_alloc_custom_mem(&ggml_ctx_native_ops, sizeof(ggml_ctx_wrapper *), size);
     Ctx_wrapper_val(result) = wrapper;
     
     CAMLreturn(result);
 }
 
+/* Release the arena now rather than when the context is collected.
+ * Tensors and graphs made in it become invalid. */
 CAMLprim value caml_ggml_native_free(value ctx) {
     CAMLparam1(ctx);
     
     ggml_ctx_wrapper *wrapper = Ctx_wrapper_val(ctx);
-    if (wrapper != NULL && wrapper->ctx != NULL) {
-        wrapper->ref_count--;
-        if (wrapper->ref_count <= 0) {
-            ggml_free(Ggml_ctx(wrapper));
-            wrapper->ctx = NULL;
-            free(wrapper);
-            Ctx_wrapper_val(ctx) = NULL;
-        }
+    if (wrapper != NULL) {
+        ctx_detach(wrapper);
     }
     
     CAMLreturn(Val_unit);
@@ -441,6 +594,22 @@ CAMLprim value caml_ggml_native_set_n_threads(value ctx, value n_threads) {
     CAMLreturn(Val_unit);
 }
 
+/* Release every tensor and graph in the context, keeping its memory pool.
+ * Tensor and graph handles from before the reset must not be used again. */
+CAMLprim value caml_ggml_native_reset(value ctx) {
+    CAMLparam1(ctx);
+    
+    ggml_ctx_wrapper *wrapper = Ctx_wrapper_val(ctx);
+    if (wrapper == NULL || wrapper->ctx == NULL) {
+        caml_failwith("ggml_native_reset: invalid context");
+    }
+    
+    ggml_reset(Ggml_ctx(wrapper));
+    wrapper->generation++;
+    
+    CAMLreturn(Val_unit);
+}
+
 /*
  * ============================================================================
  * Tensor Creation
@@ -461,13 +630,17 @@ static value wrap_tensor(ggml_ctx_wrapper *ctx_wrapper, struct ggml_tensor *tens
     }
     
     wrapper->tensor = tensor;
-    wrapper->ctx_id = 0;  /* TODO: track context ID */
+    wrapper->owner = ctx_wrapper;
+    wrapper->generation = ctx_wrapper->generation;
     wrapper->is_view = 0;
     strncpy(wrapper->name, name ? name : "unnamed", sizeof(wrapper->name) - 1);
     wrapper->name[sizeof(wrapper->name) - 1] = '\0';
     
-    result = caml_alloc_custom(&ggml_tensor_native_ops, sizeof(ggml_tensor_wrapper *), 0, 1);
+    result = caml_alloc_custom_mem(&ggml_tensor_native_ops, sizeof(ggml_tensor_wrapper *),
+                                   sizeof(ggml_tensor_wrapper));
     Tensor_wrapper_val(result) = wrapper;
+    ctx_wrapper->ref_count++;
+    g_live_tensors++;
     
     CAMLreturn(result);
 }
@@ -561,7 +734,7 @@ CAMLprim value caml_ggml_native_set_data(value tensor, value data) {
     CAMLparam2(tensor, data);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_set_data: invalid tensor");
     }
     
@@ -569,6 +742,10 @@ CAMLprim value caml_ggml_native_set_data(value tensor, value data) {
     float *src = (float *)Caml_ba_data_val(data);
     size_t size = ggml_nbytes(t);
     
+    if (t->type != GGML_TYPE_F32 ||
+        (size_t)Caml_ba_array_val(data)->dim[0] * sizeof(float) != size) {
+        caml_failwith("ggml_native_set_data: buffer does not match tensor size");
+    }
     memcpy(t->data, src, size);
     
     CAMLreturn(Val_unit);
@@ -579,7 +756,7 @@ CAMLprim value caml_ggml_native_get_data(value tensor) {
     CAMLlocal1(result);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_get_data: invalid tensor");
     }
     
@@ -596,7 +773,7 @@ CAMLprim value caml_ggml_native_set_f32(value tensor, value index, value val) {
     CAMLparam3(tensor, index, val);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_set_f32: invalid tensor");
     }
     
@@ -609,7 +786,7 @@ CAMLprim value caml_ggml_native_get_f32(value tensor, value index) {
     CAMLparam2(tensor, index);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_get_f32: invalid tensor");
     }
     
@@ -618,11 +795,63 @@ CAMLprim value caml_ggml_native_get_f32(value tensor, value index) {
     CAMLreturn(caml_copy_double(val));
 }
 
+/* Direct float array transfer: one conversion pass, no intermediate Bigarray */
+
+static struct ggml_tensor *f32_tensor(value tensor, const char *fn) {
+    ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
+    if (!Tensor_live(wrapper)) {
+        caml_failwith(fn);
+    }
+    struct ggml_tensor *t = Ggml_tensor(wrapper);
+    if (t->type != GGML_TYPE_F32 || !ggml_is_contiguous(t)) {
+        caml_invalid_argument(fn);
+    }
+    return t;
+}
+
+/* data is a Float.Array.t, whose doubles are unboxed whatever the
+   float array layout */
+CAMLprim value caml_ggml_native_set_floats(value tensor, value data) {
+    CAMLparam2(tensor, data);
+    
+    struct ggml_tensor *t = f32_tensor(tensor, "ggml_native_set_floats");
+    mlsize_t n = Wosize_val(data) / Double_wosize;
+    if ((int64_t)n != ggml_nelements(t)) {
+        caml_invalid_argument("ggml_native_set_floats: size mismatch");
+    }
+    
+    float *dst = (float *)t->data;
+    for (mlsize_t i = 0; i < n; i++) {
+        dst[i] = (float)Double_flat_field(data, i);
+    }
+    
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_ggml_native_get_floats(value tensor) {
+    CAMLparam1(tensor);
+    CAMLlocal1(result);
+    
+    struct ggml_tensor *t = f32_tensor(tensor, "ggml_native_get_floats");
+    mlsize_t n = (mlsize_t)ggml_nelements(t);
+    
+    if (n == 0) {
+        CAMLreturn(caml_alloc(0, 0));
+    }
+    result = caml_alloc(n * Double_wosize, Double_array_tag);
+    const float *src = (const float *)t->data;
+    for (mlsize_t i = 0; i < n; i++) {
+        Store_double_flat_field(result, i, (double)src[i]);
+    }
+    
+    CAMLreturn(result);
+}
+
 CAMLprim value caml_ggml_native_nelements(value tensor) {
     CAMLparam1(tensor);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_nelements: invalid tensor");
     }
     
@@ -633,7 +862,7 @@ CAMLprim value caml_ggml_native_nbytes(value tensor) {
     CAMLparam1(tensor);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_nbytes: invalid tensor");
     }
     
@@ -644,7 +873,7 @@ CAMLprim value caml_ggml_native_n_dims(value tensor) {
     CAMLparam1(tensor);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_n_dims: invalid tensor");
     }
     
@@ -655,7 +884,7 @@ CAMLprim value caml_ggml_native_get_ne(value tensor, value dim) {
     CAMLparam2(tensor, dim);
     
     ggml_tensor_wrapper *wrapper = Tensor_wrapper_val(tensor);
-    if (wrapper == NULL || wrapper->tensor == NULL) {
+    if (!Tensor_live(wrapper)) {
         caml_failwith("ggml_native_get_ne: invalid tensor");
     }
     
@@ -679,7 +908,7 @@ CAMLprim value caml_ggml_native_##name(value ctx, value a, value b) { \
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx); \
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a); \
     ggml_tensor_wrapper *b_wrapper = Tensor_wrapper_val(b); \
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor || !b_wrapper || !b_wrapper->tensor) { \
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper) || !Tensor_live(b_wrapper)) { \
         caml_failwith("ggml_native_" #name ": invalid argument"); \
     } \
     struct ggml_tensor *result = ggml_fn(Ggml_ctx(ctx_wrapper), Ggml_tensor(a_wrapper), Ggml_tensor(b_wrapper)); \
@@ -691,7 +920,7 @@ CAMLprim value caml_ggml_native_##name(value ctx, value a) { \
     CAMLparam2(ctx, a); \
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx); \
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a); \
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor) { \
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper)) { \
         caml_failwith("ggml_native_" #name ": invalid argument"); \
     } \
     struct ggml_tensor *result = ggml_fn(Ggml_ctx(ctx_wrapper), Ggml_tensor(a_wrapper)); \
@@ -720,6 +949,7 @@ DEFINE_UNARY_OP(tanh, ggml_tanh)
 /* Matrix operations */
 DEFINE_BINARY_OP(mul_mat, ggml_mul_mat)
 DEFINE_UNARY_OP(transpose, ggml_transpose)
+DEFINE_UNARY_OP(cont, ggml_cont)
 
 /* Reduction operations */
 DEFINE_UNARY_OP(sum, ggml_sum)
@@ -732,7 +962,7 @@ CAMLprim value caml_ggml_native_scale(value ctx, value a, value s) {
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper)) {
         caml_failwith("ggml_native_scale: invalid argument");
     }
     
@@ -751,7 +981,7 @@ CAMLprim value caml_ggml_native_soft_max(value ctx, value a) {
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper)) {
         caml_failwith("ggml_native_soft_max: invalid argument");
     }
     
@@ -769,7 +999,7 @@ CAMLprim value caml_ggml_native_norm(value ctx, value a, value eps) {
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper)) {
         caml_failwith("ggml_native_norm: invalid argument");
     }
     
@@ -788,7 +1018,7 @@ CAMLprim value caml_ggml_native_rms_norm(value ctx, value a, value eps) {
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_tensor_wrapper *a_wrapper = Tensor_wrapper_val(a);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !a_wrapper || !a_wrapper->tensor) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(a_wrapper)) {
         caml_failwith("ggml_native_rms_norm: invalid argument");
     }
     
@@ -814,7 +1044,7 @@ CAMLprim value caml_ggml_native_build_forward(value ctx, value tensor) {
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_tensor_wrapper *t_wrapper = Tensor_wrapper_val(tensor);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !t_wrapper || !t_wrapper->tensor) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Tensor_live(t_wrapper)) {
         caml_failwith("ggml_native_build_forward: invalid argument");
     }
     
@@ -827,22 +1057,43 @@ CAMLprim value caml_ggml_native_build_forward(value ctx, value tensor) {
     }
     
     g_wrapper->graph = graph;
-    g_wrapper->ctx_id = 0;
+    g_wrapper->owner = ctx_wrapper;
+    g_wrapper->generation = ctx_wrapper->generation;
     g_wrapper->n_nodes = graph->n_nodes;
     
-    result = caml_alloc_custom(&ggml_graph_native_ops, sizeof(ggml_graph_wrapper *), 0, 1);
+    result = caml_alloc_custom_mem(&ggml_graph_native_ops, sizeof(ggml_graph_wrapper *),
+                                   sizeof(ggml_graph_wrapper));
     Graph_wrapper_val(result) = g_wrapper;
+    ctx_wrapper->ref_count++;
+    g_live_graphs++;
     
     CAMLreturn(result);
 }
 
+/* Add another output to a graph, so several results share one compute pass */
+CAMLprim value caml_ggml_native_build_forward_expand(value graph, value tensor) {
+    CAMLparam2(graph, tensor);
+    
+    ggml_graph_wrapper *g_wrapper = Graph_wrapper_val(graph);
+    ggml_tensor_wrapper *t_wrapper = Tensor_wrapper_val(tensor);
+    
+    if (!Graph_live(g_wrapper) || !Tensor_live(t_wrapper)) {
+        caml_failwith("ggml_native_build_forward_expand: invalid argument");
+    }
+    
+    ggml_build_forward_expand(Ggml_graph(g_wrapper), Ggml_tensor(t_wrapper));
+    g_wrapper->n_nodes = Ggml_graph(g_wrapper)->n_nodes;
+    
+    CAMLreturn(Val_unit);
+}
+
 CAMLprim value caml_ggml_native_graph_compute(value ctx, value graph) {
     CAMLparam2(ctx, graph);
     
     ggml_ctx_wrapper *ctx_wrapper = Ctx_wrapper_val(ctx);
     ggml_graph_wrapper *g_wrapper = Graph_wrapper_val(graph);
     
-    if (!ctx_wrapper || !ctx_wrapper->ctx || !g_wrapper || !g_wrapper->graph) {
+    if (!ctx_wrapper || !ctx_wrapper->ctx || !Graph_live(g_wrapper)) {
         caml_failwith("ggml_native_graph_compute: invalid argument");
     }
     
@@ -855,7 +1106,7 @@ CAMLprim value caml_ggml_native_graph_n_nodes(value graph) {
     CAMLparam1(graph);
     
     ggml_graph_wrapper *g_wrapper = Graph_wrapper_val(graph);
-    if (!g_wrapper || !g_wrapper->graph) {
+    if (!Graph_live(g_wrapper)) {
         caml_failwith("ggml_native_graph_n_nodes: invalid graph");
     }
     
@@ -986,6 +1237,7 @@ CAMLprim value caml_ggml_native_##name(value a, value b, value c, value d, value
 STUB_IMPL_1(used_mem)
 STUB_IMPL_1(get_mem_size)
 STUB_IMPL_2(set_n_threads)
+STUB_IMPL_1(reset)
 STUB_IMPL_3(new_tensor_1d)
 STUB_IMPL_4(new_tensor_2d)
 STUB_IMPL_5(new_tensor_3d)
@@ -993,6 +1245,8 @@ STUB_IMPL_2(set_data)
 STUB_IMPL_1(get_data)
 STUB_IMPL_3(set_f32)
 STUB_IMPL_2(get_f32)
+STUB_IMPL_2(set_floats)
+STUB_IMPL_1(get_floats)
 STUB_IMPL_1(nelements)
 STUB_IMPL_1(nbytes)
 STUB_IMPL_1(n_dims)
@@ -1014,6 +1268,7 @@ STUB_IMPL_2(sigmoid)
 STUB_IMPL_2(tanh)
 STUB_IMPL_3(mul_mat)
 STUB_IMPL_2(transpose)
+STUB_IMPL_2(cont)
 STUB_IMPL_2(sum)
 STUB_IMPL_2(mean)
 STUB_IMPL_2(argmax)
@@ -1021,6 +1276,7 @@ STUB_IMPL_2(soft_max)
 STUB_IMPL_3(norm)
 STUB_IMPL_3(rms_norm)
 STUB_IMPL_2(build_forward)
+STUB_IMPL_2(build_forward_expand)
 STUB_IMPL_2(graph_compute)
 STUB_IMPL_1(graph_n_nodes)
 STUB_IMPL_4(quantize_q4_0)
@@ -132,6 +132,20 @@ external free : context -> unit = "caml_ggml_native_free"
 external used_mem : context -> int = "caml_ggml_native_used_mem"
 external get_mem_size : context -> int = "caml_ggml_native_get_mem_size"
 external set_n_threads : context -> int -> unit = "caml_ggml_native_set_n_threads"
+external reset : context -> unit = "caml_ggml_native_reset"
+external trim_arenas : unit -> unit = "caml_ggml_native_trim_arenas"
+external live_handles_raw : unit -> int * int * int * int = "caml_ggml_native_live_handles"
+
+type handle_stats = {
+  live_contexts : int;
+  live_tensors : int;
+  live_graphs : int;
+  pooled_arenas : int;
+}
+
+let handle_stats () =
+  let (live_contexts, live_tensors, live_graphs, pooled_arenas) = live_handles_raw () in
+  { live_contexts; live_tensors; live_graphs; pooled_arenas }
 
 let create_context ?(mem_size=128*1024*1024) ?(n_threads=4) () =
   init mem_size n_threads
@@ -207,21 +221,19 @@ external nelements : tensor -> int = "caml_ggml_native_nelements"
 external nbytes : tensor -> int = "caml_ggml_native_nbytes"
 external n_dims : tensor -> int = "caml_ggml_native_n_dims"
 external get_ne : tensor -> int -> int = "caml_ggml_native_get_ne"
+external set_data_from_floats : tensor -> Float.Array.t -> unit = "caml_ggml_native_set_floats"
+external get_data_as_floats : tensor -> Float.Array.t = "caml_ggml_native_get_floats"
+
+let set_data_from_array tensor data =
+  set_data_from_floats tensor (Float.Array.map_from_array Fun.id data)
+
+let get_data_as_array tensor =
+  Float.Array.map_to_array Fun.id (get_data_as_floats tensor)
 
 let shape tensor =
   let dims = n_dims tensor in
   Array.init dims (fun i -> get_ne tensor i)
 
-let set_data_from_array tensor arr =
-  let n = nelements tensor in
-  let ba = Bigarray.Array1.create Bigarray.float32 Bigarray.c_layout n in
-  Array.iteri (fun i v -> Bigarray.Array1.set ba i v) arr;
-  set_data tensor ba
-
-let get_data_as_array tensor =
-  let ba = get_data tensor in
-  Array.init (Bigarray.Array1.dim ba) (fun i -> Bigarray.Array1.get ba i)
-
 (** {1 Tensor Operations} *)
 
 (** Basic operations *)
@@ -246,6 +258,7 @@ external tanh : context -> tensor -> tensor = "caml_ggml_native_tanh"
 (** Matrix operations *)
 external mul_mat : context -> tensor -> tensor -> tensor = "caml_ggml_native_mul_mat"
 external transpose : context -> tensor -> tensor = "caml_ggml_native_transpose"
+external cont : context -> tensor -> tensor = "caml_ggml_native_cont"
 
 (** Reduction operations *)
 external sum : context -> tensor -> tensor = "caml_ggml_native_sum"
@@ -266,6 +279,7 @@ let rms_layer_norm ctx tensor ?(eps=1e-5) () =
 (** {1 Compute Graph} *)
 
 external build_forward : context -> tensor -> cgraph = "caml_ggml_native_build_forward"
+external build_forward_expand : cgraph -> tensor -> unit = "caml_ggml_native_build_forward_expand"
 external graph_compute : context -> cgraph -> unit = "caml_ggml_native_graph_compute"
 external graph_n_nodes : cgraph -> int = "caml_ggml_native_graph_n_nodes"
 
@@ -94,7 +94,9 @@ val create_context : ?mem_size:int -> ?n_threads:int -> unit -> context
 (** Initialize context (low-level) *)
 val init : int -> int -> context
 
-(** Free context *)
+(** Release the context's memory now instead of when it is collected.
+    Its arena is reset and kept for reuse by a later context of similar
+    size; tensors and graphs made in it become invalid. *)
 val free : context -> unit
 
 (** Get used memory in context *)
@@ -106,6 +108,29 @@ val get_mem_size : context -> int
 (** Set number of threads for computation *)
 val set_n_threads : context -> int -> unit
 
+(** Drop all tensors and graphs, keeping the context's memory for reuse.
+    Handles created before the reset become invalid: using one fails
+    instead of reading reused memory. *)
+val reset : context -> unit
+
+(** Free the arenas kept for reuse by [free] and by collected contexts *)
+val trim_arenas : unit -> unit
+
+(** {1 Handle Lifetime}
+
+    Context, tensor and graph handles are finalized by the GC. A context's
+    arena stays alive while the context or any tensor or graph made in it
+    is reachable, then goes back to the arena pool. *)
+
+type handle_stats = {
+  live_contexts : int;   (** Contexts still holding an arena *)
+  live_tensors : int;
+  live_graphs : int;
+  pooled_arenas : int;
+}
+
+val handle_stats : unit -> handle_stats
+
 (** {1 Data Type Utilities} *)
 
 (** Convert dtype to integer code *)
@@ -160,10 +185,14 @@ val get_ne : tensor -> int -> int
 (** Get tensor shape as array *)
 val shape : tensor -> int array
 
-(** Set data from float array *)
-val set_data_from_array : tensor -> float array -> unit
+(** Set data from a flat float array (F32 tensors; sizes must match) *)
+val set_data_from_floats : tensor -> Float.Array.t -> unit
+
+(** Get data as a flat float array (F32 tensors) *)
+val get_data_as_floats : tensor -> Float.Array.t
 
-(** Get data as float array *)
+(** As [set_data_from_floats] and [get_data_as_floats], through a copy *)
+val set_data_from_array : tensor -> float array -> unit
 val get_data_as_array : tensor -> float array
 
 (** {1 Basic Operations} *)
@@ -192,6 +221,9 @@ val tanh : context -> tensor -> tensor
 val mul_mat : context -> tensor -> tensor -> tensor
 val transpose : context -> tensor -> tensor
 
+(** Contiguous copy of a view, e.g. after [transpose] *)
+val cont : context -> tensor -> tensor
+
 (** {1 Reduction Operations} *)
 
 val sum : context -> tensor -> tensor
@@ -211,6 +243,9 @@ val rms_layer_norm : context -> tensor -> ?eps:float -> unit -> tensor
 (** Build forward compute graph *)
 val build_forward : context -> tensor -> cgraph
 
+(** Add another output to a graph, sharing one compute pass *)
+val build_forward_expand : cgraph -> tensor -> unit
+
 (** Execute compute graph *)
 val graph_compute : context -> cgraph -> unit
 
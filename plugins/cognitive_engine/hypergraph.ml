@@ -60,15 +60,60 @@ type link = {
   truth_value : float * float;
 }
 
+(** Sets of atom ids, for the adjacency indexes *)
+module Id_set = Set.Make (Int)
+
 (** Tensor shapes for neural-symbolic integration *)
 type tensor_shape = int list
 
 (** Tensor for storing distributed representations *)
 type tensor = {
   id : tensor_id;
-  shape : tensor_shape;
-  data : float array;
+  data : Tensor_backend.Dense.t;
   associated_node : node_id option;
+  version : int ref;
+  mutable cached_norm : float;
+  mutable norm_version : int;
+}
+
+(** Tensor whose values are held outside the AtomSpace *)
+type external_tensor = {
+  external_shape : tensor_shape;
+  external_node : node_id option;
+  fetch : unit -> float array;
+  restored : unit -> unit;
+}
+
+(** Link change notifications, delivered synchronously to observers *)
+type link_event =
+  | Link_added of link_id
+  | Link_truth_updated of link_id
+  | Link_removed of link_id  (** Sent while the link is still present *)
+
+(** Handle for removing a link event observer *)
+type link_subscription = int
+
+(** Columnar attention and truth values, indexed directly by atom id *)
+type value_columns = {
+  mutable sti_values : Float.Array.t;
+  mutable lti_values : Float.Array.t;
+  mutable vlti_values : Float.Array.t;
+  mutable strengths : Float.Array.t;
+  mutable confidences : Float.Array.t;
+  sti_ranking : Attention_heap.t;  (** live ids by STI *)
+}
+
+(** How an atom changed since its change log was last cleared *)
+type change =
+  | Values_changed  (** attention or truth values only *)
+  | Added           (** under an id never used before *)
+  | Replaced        (** removed, or restored over an existing id *)
+
+(** Atoms changed since the log was last cleared, for incremental saves *)
+type change_log = {
+  node_changes : (node_id, change) Hashtbl.t;
+  link_changes : (link_id, change) Hashtbl.t;
+  mutable all_values_changed : bool;  (** a whole-column pass ran *)
 }
 
 (** AtomSpace - the main hypergraph store *)
@@ -76,26 +121,233 @@ type atomspace = {
   mutable nodes : (node_id, node) Hashtbl.t;
   mutable links : (link_id, link) Hashtbl.t;
   mutable tensors : (tensor_id, tensor) Hashtbl.t;
+  mutable external_tensors : (tensor_id, external_tensor) Hashtbl.t;
   mutable next_node_id : node_id;
   mutable next_link_id : link_id;
   mutable next_tensor_id : tensor_id;
   mutable node_index : (string, node_id list) Hashtbl.t;
+  mutable incoming_index : (node_id, Id_set.t) Hashtbl.t;
+    (** node -> links whose outgoing set contains it *)
+  mutable outgoing_index : (node_id, Id_set.t) Hashtbl.t;
+    (** node -> links whose outgoing set starts with it *)
+  mutable node_type_index : (node_type, (node_id, unit) Hashtbl.t) Hashtbl.t;
+  mutable link_type_index : (link_type, (link_id, unit) Hashtbl.t) Hashtbl.t;
+  node_values : value_columns;
+  link_values : value_columns;
+  mutable link_observers : (link_subscription * (link_event -> unit)) list;
+  mutable change_log : change_log option;
+}
+
+(** Columnar value storage *)
+
+let create_columns capacity = {
+  sti_values = Float.Array.make capacity 0.0;
+  lti_values = Float.Array.make capacity 0.0;
+  vlti_values = Float.Array.make capacity 0.0;
+  strengths = Float.Array.make capacity 0.0;
+  confidences = Float.Array.make capacity 0.0;
+  sti_ranking = Attention_heap.create capacity;
+}
+
+let columns_capacity cols = Float.Array.length cols.sti_values
+
+let grow_column column capacity =
+  let grown = Float.Array.make capacity 0.0 in
+  Float.Array.blit column 0 grown 0 (Float.Array.length column);
+  grown
+
+let ensure_column_capacity cols id =
+  let capacity = columns_capacity cols in
+  if id >= capacity then begin
+    let new_capacity = max (2 * capacity) (id + 1) in
+    cols.sti_values <- grow_column cols.sti_values new_capacity;
+    cols.lti_values <- grow_column cols.lti_values new_capacity;
+    cols.vlti_values <- grow_column cols.vlti_values new_capacity;
+    cols.strengths <- grow_column cols.strengths new_capacity;
+    cols.confidences <- grow_column cols.confidences new_capacity
+  end
+
+(* The ranking reads STI straight from the column *)
+let sti_key cols = Float.Array.unsafe_get cols.sti_values
+
+let write_attention cols id attention =
+  Float.Array.unsafe_set cols.sti_values id attention.sti;
+  Float.Array.unsafe_set cols.lti_values id attention.lti;
+  Float.Array.unsafe_set cols.vlti_values id attention.vlti;
+  Attention_heap.add cols.sti_ranking (sti_key cols) id
+
+let write_truth cols id (strength, confidence) =
+  Float.Array.unsafe_set cols.strengths id strength;
+  Float.Array.unsafe_set cols.confidences id confidence
+
+let read_attention cols id = {
+  sti = Float.Array.get cols.sti_values id;
+  lti = Float.Array.get cols.lti_values id;
+  vlti = Float.Array.get cols.vlti_values id;
 }
 
-(** Create empty AtomSpace *)
-let create_atomspace () = {
-  nodes = Hashtbl.create 1000;
-  links = Hashtbl.create 1000;
+let read_truth cols id =
+  (Float.Array.get cols.strengths id, Float.Array.get cols.confidences id)
+
+(* Removed atoms leave zeroed slots, so whole-column passes can skip
+   liveness checks *)
+let clear_slot cols id =
+  Float.Array.unsafe_set cols.sti_values id 0.0;
+  Float.Array.unsafe_set cols.lti_values id 0.0;
+  Float.Array.unsafe_set cols.vlti_values id 0.0;
+  write_truth cols id (0.0, 0.0);
+  Attention_heap.remove cols.sti_ranking (sti_key cols) id
+
+(** Create empty AtomSpace, with tables sized for [capacity] atoms *)
+let create_atomspace ?(capacity=1000) () = {
+  nodes = Hashtbl.create capacity;
+  links = Hashtbl.create capacity;
   tensors = Hashtbl.create 100;
+  external_tensors = Hashtbl.create 16;
   next_node_id = 1;
   next_link_id = 1;
   next_tensor_id = 1;
-  node_index = Hashtbl.create 1000;
+  node_index = Hashtbl.create capacity;
+  incoming_index = Hashtbl.create capacity;
+  outgoing_index = Hashtbl.create capacity;
+  node_type_index = Hashtbl.create 8;
+  link_type_index = Hashtbl.create 8;
+  node_values = create_columns (max 1024 (capacity + 1));
+  link_values = create_columns (max 1024 (capacity + 1));
+  link_observers = [];
+  change_log = None;
 }
 
 (** Default attention value *)
 let default_attention = { sti = 0.0; lti = 0.0; vlti = 0.0 }
 
+(** Index maintenance *)
+
+(* Multi-valued index with short per-key lists (names) *)
+let index_add index key id =
+  let existing = try Hashtbl.find index key with Not_found -> [] in
+  Hashtbl.replace index key (id :: existing)
+
+let index_remove index key id =
+  let existing = try Hashtbl.find index key with Not_found -> [] in
+  let filtered = List.filter (fun x -> x <> id) existing in
+  if filtered = [] then
+    Hashtbl.remove index key
+  else
+    Hashtbl.replace index key filtered
+
+(* Type indexes hold very large member sets, so members are kept in a
+   hashtable to make removal O(1) *)
+let type_index_add index key id =
+  let members =
+    try Hashtbl.find index key
+    with Not_found ->
+      let members = Hashtbl.create 64 in
+      Hashtbl.add index key members;
+      members
+  in
+  Hashtbl.replace members id ()
+
+let type_index_remove index key id =
+  try Hashtbl.remove (Hashtbl.find index key) id
+  with Not_found -> ()
+
+let type_index_members index key =
+  try Hashtbl.fold (fun id () acc -> id :: acc) (Hashtbl.find index key) []
+  with Not_found -> []
+
+(* Hub nodes sit in very many links, so adjacency is kept in sets:
+   removing a link is O(log degree) rather than a scan of the list *)
+let adjacency_add index key id =
+  let members = try Hashtbl.find index key with Not_found -> Id_set.empty in
+  Hashtbl.replace index key (Id_set.add id members)
+
+let adjacency_remove index key id =
+  match Hashtbl.find_opt index key with
+  | Some members ->
+    let remaining = Id_set.remove id members in
+    if Id_set.is_empty remaining then
+      Hashtbl.remove index key
+    else
+      Hashtbl.replace index key remaining
+  | None -> ()
+
+let adjacency_members index key =
+  match Hashtbl.find_opt index key with
+  | Some members -> Id_set.elements members
+  | None -> []
+
+(* A node occurring several times in an outgoing set is indexed once *)
+let index_link_adjacency atomspace (link : link) =
+  List.iter (fun node_id -> adjacency_add atomspace.incoming_index node_id link.id)
+    link.outgoing;
+  match link.outgoing with
+  | hd :: _ -> adjacency_add atomspace.outgoing_index hd link.id
+  | [] -> ()
+
+let unindex_link_adjacency atomspace (link : link) =
+  List.iter (fun node_id -> adjacency_remove atomspace.incoming_index node_id link.id)
+    link.outgoing;
+  match link.outgoing with
+  | hd :: _ -> adjacency_remove atomspace.outgoing_index hd link.id
+  | [] -> ()
+
+let next_link_subscription = ref 0
+
+let subscribe_link_events atomspace observer =
+  incr next_link_subscription;
+  let subscription = !next_link_subscription in
+  atomspace.link_observers <- atomspace.link_observers @ [(subscription, observer)];
+  subscription
+
+let unsubscribe_link_events atomspace subscription =
+  atomspace.link_observers <-
+    List.filter (fun (s, _) -> s <> subscription) atomspace.link_observers
+
+let notify_link atomspace event =
+  List.iter (fun (_, observer) -> observer event) atomspace.link_observers
+
+(** Change tracking *)
+
+let track_changes atomspace =
+  match atomspace.change_log with
+  | Some log -> log
+  | None ->
+    let log = {
+      node_changes = Hashtbl.create 64;
+      link_changes = Hashtbl.create 64;
+      all_values_changed = false;
+    } in
+    atomspace.change_log <- Some log;
+    log
+
+let clear_changes log =
+  Hashtbl.reset log.node_changes;
+  Hashtbl.reset log.link_changes;
+  log.all_values_changed <- false
+
+(* A later change never hides an earlier, stronger one *)
+let note_change table id change =
+  match Hashtbl.find_opt table id with
+  | Some Replaced -> ()
+  | Some Added when change = Values_changed -> ()
+  | _ -> Hashtbl.replace table id change
+
+let mark_node atomspace id change =
+  match atomspace.change_log with
+  | Some log -> note_change log.node_changes id change
+  | None -> ()
+
+let mark_link atomspace id change =
+  match atomspace.change_log with
+  | Some log -> note_change log.link_changes id change
+  | None -> ()
+
+let mark_all_values atomspace =
+  match atomspace.change_log with
+  | Some log -> log.all_values_changed <- true
+  | None -> ()
+
 (** Node operations *)
 let add_node atomspace node_type name =
   let id = atomspace.next_node_id in
@@ -107,46 +359,80 @@ let add_node atomspace node_type name =
     truth_value = (1.0, 1.0);
   } in
   Hashtbl.add atomspace.nodes id node;
-  
-  (* Update name index *)
-  let existing = try Hashtbl.find atomspace.node_index name with Not_found -> [] in
-  Hashtbl.replace atomspace.node_index name (id :: existing);
-  
+  ensure_column_capacity atomspace.node_values id;
+  write_attention atomspace.node_values id node.attention;
+  write_truth atomspace.node_values id node.truth_value;
+  index_add atomspace.node_index name id;
+  type_index_add atomspace.node_type_index node_type id;
   atomspace.next_node_id <- id + 1;
+  mark_node atomspace id Added;
   id
 
+(* Records stored in the tables carry identity and structure only; the
+   values are read from the columns when a view is built *)
+let node_view atomspace (node : node) =
+  { node with
+    attention = read_attention atomspace.node_values node.id;
+    truth_value = read_truth atomspace.node_values node.id }
+
+let link_view atomspace (link : link) =
+  { link with
+    attention = read_attention atomspace.link_values link.id;
+    truth_value = read_truth atomspace.link_values link.id }
+
 let get_node atomspace id =
-  try Some (Hashtbl.find atomspace.nodes id)
+  try Some (node_view atomspace (Hashtbl.find atomspace.nodes id))
   with Not_found -> None
 
 let update_node_attention atomspace id attention =
-  try
-    let node = Hashtbl.find atomspace.nodes id in
-    let updated_node = { node with attention = attention } in
-    Hashtbl.replace atomspace.nodes id updated_node
-  with Not_found -> ()
+  if Hashtbl.mem atomspace.nodes id then begin
+    write_attention atomspace.node_values id attention;
+    mark_node atomspace id Values_changed
+  end
 
 let update_node_truth atomspace id truth_value =
-  try
-    let node = Hashtbl.find atomspace.nodes id in
-    let updated_node = { node with truth_value = truth_value } in
-    Hashtbl.replace atomspace.nodes id updated_node
-  with Not_found -> ()
+  if Hashtbl.mem atomspace.nodes id then begin
+    write_truth atomspace.node_values id truth_value;
+    mark_node atomspace id Values_changed
+  end
+
+let get_node_attention atomspace id =
+  if Hashtbl.mem atomspace.nodes id then
+    Some (read_attention atomspace.node_values id)
+  else None
 
+let iter_nodes f atomspace =
+  Hashtbl.iter (fun _ node -> f (node_view atomspace node)) atomspace.nodes
+
+let fold_nodes f atomspace init =
+  Hashtbl.fold (fun _ node acc -> f (node_view atomspace node) acc) atomspace.nodes init
+
+(* Links referring to a removed node are left in place, so its adjacency
+   entries stay valid until those links are removed *)
 let remove_node atomspace id =
   try
     let node = Hashtbl.find atomspace.nodes id in
     Hashtbl.remove atomspace.nodes id;
-    
-    (* Update name index *)
-    let existing = try Hashtbl.find atomspace.node_index node.name with Not_found -> [] in
-    let filtered = List.filter (fun x -> x <> id) existing in
-    if filtered = [] then
-      Hashtbl.remove atomspace.node_index node.name
-    else
-      Hashtbl.replace atomspace.node_index node.name filtered
+    clear_slot atomspace.node_values id;
+    index_remove atomspace.node_index node.name id;
+    type_index_remove atomspace.node_type_index node.node_type id;
+    mark_node atomspace id Replaced
   with Not_found -> ()
 
+(* Bulk loading: atoms keep the ids they were stored under, replacing any
+   atom with the same id, and the id counters move past them *)
+let restore_node atomspace (node : node) =
+  remove_node atomspace node.id;
+  Hashtbl.replace atomspace.nodes node.id node;
+  ensure_column_capacity atomspace.node_values node.id;
+  write_attention atomspace.node_values node.id node.attention;
+  write_truth atomspace.node_values node.id node.truth_value;
+  index_add atomspace.node_index node.name node.id;
+  type_index_add atomspace.node_type_index node.node_type node.id;
+  if node.id >= atomspace.next_node_id then
+    atomspace.next_node_id <- node.id + 1;
+  mark_node atomspace node.id Replaced
+
 (** Link operations *)
 let add_link atomspace link_type outgoing =
   let id = atomspace.next_link_id in
@@ -158,56 +444,210 @@ let add_link atomspace link_type outgoing =
     truth_value = (1.0, 1.0);
   } in
   Hashtbl.add atomspace.links id link;
+  ensure_column_capacity atomspace.link_values id;
+  write_attention atomspace.link_values id link.attention;
+  write_truth atomspace.link_values id link.truth_value;
+  index_link_adjacency atomspace link;
+  type_index_add atomspace.link_type_index link_type id;
   atomspace.next_link_id <- id + 1;
+  mark_link atomspace id Added;
+  notify_link atomspace (Link_added id);
   id
 
 let get_link atomspace id =
-  try Some (Hashtbl.find atomspace.links id)
+  try Some (link_view atomspace (Hashtbl.find atomspace.links id))
   with Not_found -> None
 
 let update_link_attention atomspace id attention =
-  try
-    let link = Hashtbl.find atomspace.links id in
-    let updated_link = { link with attention = attention } in
-    Hashtbl.replace atomspace.links id updated_link
-  with Not_found -> ()
+  if Hashtbl.mem atomspace.links id then begin
+    write_attention atomspace.link_values id attention;
+    mark_link atomspace id Values_changed
+  end
 
 let update_link_truth atomspace id truth_value =
+  if Hashtbl.mem atomspace.links id then begin
+    write_truth atomspace.link_values id truth_value;
+    mark_link atomspace id Values_changed;
+    notify_link atomspace (Link_truth_updated id)
+  end
+
+let get_link_attention atomspace id =
+  if Hashtbl.mem atomspace.links id then
+    Some (read_attention atomspace.link_values id)
+  else None
+
+let iter_links f atomspace =
+  Hashtbl.iter (fun _ link -> f (link_view atomspace link)) atomspace.links
+
+let fold_links f atomspace init =
+  Hashtbl.fold (fun _ link acc -> f (link_view atomspace link) acc) atomspace.links init
+
+let remove_link atomspace id =
   try
     let link = Hashtbl.find atomspace.links id in
-    let updated_link = { link with truth_value = truth_value } in
-    Hashtbl.replace atomspace.links id updated_link
+    notify_link atomspace (Link_removed id);
+    Hashtbl.remove atomspace.links id;
+    clear_slot atomspace.link_values id;
+    unindex_link_adjacency atomspace link;
+    type_index_remove atomspace.link_type_index link.link_type id;
+    mark_link atomspace id Replaced
   with Not_found -> ()
 
-let remove_link atomspace id =
-  Hashtbl.remove atomspace.links id
+let restore_link atomspace (link : link) =
+  remove_link atomspace link.id;
+  Hashtbl.replace atomspace.links link.id link;
+  ensure_column_capacity atomspace.link_values link.id;
+  write_attention atomspace.link_values link.id link.attention;
+  write_truth atomspace.link_values link.id link.truth_value;
+  index_link_adjacency atomspace link;
+  type_index_add atomspace.link_type_index link.link_type link.id;
+  if link.id >= atomspace.next_link_id then
+    atomspace.next_link_id <- link.id + 1;
+  mark_link atomspace link.id Replaced;
+  notify_link atomspace (Link_added link.id)
+
+(* Bulk loading into an empty AtomSpace: columns are sized once, atoms
+   are appended to the STI rankings unordered and each ranking is built
+   in one O(n) pass at the end. No link events are sent. *)
+let restore_bulk atomspace (nodes : node array) (links : link array) =
+  if Hashtbl.length atomspace.nodes > 0 || Hashtbl.length atomspace.links > 0 then
+    failwith "Bulk restore needs an empty AtomSpace";
+  let fill cols id attention truth_value =
+    Float.Array.unsafe_set cols.sti_values id attention.sti;
+    Float.Array.unsafe_set cols.lti_values id attention.lti;
+    Float.Array.unsafe_set cols.vlti_values id attention.vlti;
+    write_truth cols id truth_value;
+    Attention_heap.add_unordered cols.sti_ranking id
+  in
+  let node_cols = atomspace.node_values and link_cols = atomspace.link_values in
+  let max_node = Array.fold_left (fun m (n : node) -> max m n.id) 0 nodes in
+  let max_link = Array.fold_left (fun m (l : link) -> max m l.id) 0 links in
+  ensure_column_capacity node_cols max_node;
+  ensure_column_capacity link_cols max_link;
+  Array.iter (fun (node : node) ->
+    Hashtbl.replace atomspace.nodes node.id node;
+    fill node_cols node.id node.attention node.truth_value;
+    index_add atomspace.node_index node.name node.id;
+    type_index_add atomspace.node_type_index node.node_type node.id;
+    mark_node atomspace node.id Replaced
+  ) nodes;
+  Array.iter (fun (link : link) ->
+    Hashtbl.replace atomspace.links link.id link;
+    fill link_cols link.id link.attention link.truth_value;
+    index_link_adjacency atomspace link;
+    type_index_add atomspace.link_type_index link.link_type link.id;
+    mark_link atomspace link.id Replaced
+  ) links;
+  Attention_heap.rebuild node_cols.sti_ranking (sti_key node_cols);
+  Attention_heap.rebuild link_cols.sti_ranking (sti_key link_cols);
+  atomspace.next_node_id <- max atomspace.next_node_id (max_node + 1);
+  atomspace.next_link_id <- max atomspace.next_link_id (max_link + 1)
 
 (** Tensor operations *)
-let add_tensor atomspace shape data associated_node =
+module Dense = Tensor_backend.Dense
+
+(* A tensor's version counts the writes to its buffer. Views share the
+   counter of the tensor they view, as they share its buffer. *)
+let register_tensor atomspace data associated_node version =
   let id = atomspace.next_tensor_id in
   let tensor = {
     id = id;
-    shape = shape;
     data = data;
     associated_node = associated_node;
+    version = version;
+    cached_norm = 0.0;
+    norm_version = -1;
   } in
   Hashtbl.add atomspace.tensors id tensor;
   atomspace.next_tensor_id <- id + 1;
   id
 
+let add_dense_tensor atomspace data associated_node =
+  register_tensor atomspace data associated_node (ref 0)
+
+let restore_tensor atomspace id data associated_node =
+  Hashtbl.remove atomspace.external_tensors id;
+  Hashtbl.replace atomspace.tensors id
+    { id; data; associated_node; version = ref 0; cached_norm = 0.0; norm_version = -1 };
+  if id >= atomspace.next_tensor_id then
+    atomspace.next_tensor_id <- id + 1
+
+let add_tensor atomspace shape data associated_node =
+  add_dense_tensor atomspace (Dense.of_array (Array.of_list shape) data) associated_node
+
+let tensor_shape_of tensor = Dense.shape tensor.data
+
+let tensor_values tensor = Dense.to_array tensor.data
+
+(* A read of an external tensor gets a fresh copy of its values *)
+let external_copy id ext = {
+  id = id;
+  data = Dense.of_array (Array.of_list ext.external_shape) (ext.fetch ());
+  associated_node = ext.external_node;
+  version = ref 0;
+  cached_norm = 0.0;
+  norm_version = -1;
+}
+
 let get_tensor atomspace id =
-  try Some (Hashtbl.find atomspace.tensors id)
-  with Not_found -> None
+  match Hashtbl.find_opt atomspace.tensors id with
+  | Some _ as tensor -> tensor
+  | None ->
+    match Hashtbl.find_opt atomspace.external_tensors id with
+    | Some ext -> Some (external_copy id ext)
+    | None -> None
+
+let internalize_tensor atomspace id =
+  match Hashtbl.find_opt atomspace.external_tensors id with
+  | Some ext ->
+    Hashtbl.remove atomspace.external_tensors id;
+    Hashtbl.replace atomspace.tensors id (external_copy id ext);
+    ext.restored ()
+  | None -> ()
+
+(* Writes and views need the AtomSpace's own buffer *)
+let get_writable_tensor atomspace id =
+  internalize_tensor atomspace id;
+  Hashtbl.find_opt atomspace.tensors id
+
+let externalize_tensor atomspace id ~fetch ~restored =
+  match Hashtbl.find_opt atomspace.tensors id with
+  | Some tensor ->
+    Hashtbl.remove atomspace.tensors id;
+    Hashtbl.replace atomspace.external_tensors id {
+      external_shape = tensor_shape_of tensor;
+      external_node = tensor.associated_node;
+      fetch;
+      restored;
+    }
+  | None -> ()
+
+let is_external_tensor atomspace id = Hashtbl.mem atomspace.external_tensors id
+
+let fold_tensors f atomspace acc =
+  let acc = Hashtbl.fold (fun _ tensor acc -> f tensor acc) atomspace.tensors acc in
+  Hashtbl.fold (fun id ext acc -> f (external_copy id ext) acc) atomspace.external_tensors acc
+
+let tensor_count atomspace =
+  Hashtbl.length atomspace.tensors + Hashtbl.length atomspace.external_tensors
 
 let update_tensor_data atomspace id data =
-  try
-    let tensor = Hashtbl.find atomspace.tensors id in
-    let updated_tensor = { tensor with data = data } in
-    Hashtbl.replace atomspace.tensors id updated_tensor
-  with Not_found -> ()
+  match get_writable_tensor atomspace id with
+  | Some tensor ->
+    Dense.blit ~src:(Dense.of_array (Dense.dims tensor.data) data) ~dst:tensor.data;
+    incr tensor.version
+  | None -> ()
+
+let tensor_version tensor = !(tensor.version)
+
+let touch_tensor atomspace id =
+  match get_writable_tensor atomspace id with
+  | Some tensor -> incr tensor.version
+  | None -> ()
 
 let remove_tensor atomspace id =
-  Hashtbl.remove atomspace.tensors id
+  Hashtbl.remove atomspace.tensors id;
+  Hashtbl.remove atomspace.external_tensors id
 
 (** Tensor operations with backend support *)
 let tensor_backend = ref Tensor_backend.OCaml_native
@@ -219,209 +659,386 @@ let set_tensor_backend backend =
 
 let get_tensor_backend () = !tensor_backend
 
-let tensor_add_op atomspace id1 id2 =
-  match get_tensor atomspace id1, get_tensor atomspace id2 with
-  | Some t1, Some t2 ->
-      if not (Tensor_backend.validate_shapes t1.shape t2.shape) then
-        failwith "Tensor shapes must match for addition"
-      else
-        let result_data = Tensor_backend.tensor_add !tensor_context t1.shape t1.data t2.data in
-        add_tensor atomspace t1.shape result_data None
-  | _ -> failwith "One or both tensors not found"
+let find_tensor atomspace id =
+  match get_tensor atomspace id with
+  | Some t -> t
+  | None -> failwith "Tensor not found"
 
-let tensor_multiply_op atomspace id1 id2 =
+let find_writable_tensor atomspace id =
+  match get_writable_tensor atomspace id with
+  | Some t -> t
+  | None -> failwith "Tensor not found"
+
+let find_tensor_pair atomspace id1 id2 =
   match get_tensor atomspace id1, get_tensor atomspace id2 with
-  | Some t1, Some t2 ->
-      if not (Tensor_backend.validate_shapes t1.shape t2.shape) then
-        failwith "Tensor shapes must match for element-wise multiplication"
-      else
-        let result_data = Tensor_backend.tensor_multiply !tensor_context t1.shape t1.data t2.data in
-        add_tensor atomspace t1.shape result_data None
+  | Some t1, Some t2 -> (t1, t2)
   | _ -> failwith "One or both tensors not found"
 
+(* One GGML batch: inputs go in from their float32 buffers, the single
+   output comes back as a fresh dense tensor *)
+let ggml_dense inputs f =
+  match Tensor_backend.with_batch !tensor_context (fun b ->
+    Tensor_backend.batch_compute_dense b
+      [f (List.map (Tensor_backend.batch_input_dense b) inputs)]) with
+  | [result] -> result
+  | _ -> assert false
+
+(* On the OCaml backend: copy the first input, then update it in place *)
+let dense_op inputs ~inplace ~batch =
+  match !tensor_backend, inputs with
+  | Tensor_backend.OCaml_native, first :: rest ->
+    let result = Dense.copy first in
+    inplace result rest;
+    result
+  | _ -> ggml_dense inputs batch
+
+let elementwise_op name inplace batch_op atomspace id1 id2 =
+  let (t1, t2) = find_tensor_pair atomspace id1 id2 in
+  if not (Dense.same_shape t1.data t2.data) then
+    failwith ("Tensor shapes must match for " ^ name);
+  let result = dense_op [t1.data; t2.data]
+      ~inplace:(fun r rest -> List.iter (inplace r) rest)
+      ~batch:(function [x; y] -> batch_op x y | _ -> assert false) in
+  add_dense_tensor atomspace result None
+
+let unary_op inplace batch_op atomspace id =
+  let t = find_tensor atomspace id in
+  let result = dense_op [t.data]
+      ~inplace:(fun r _ -> inplace r)
+      ~batch:(function [x] -> batch_op x | _ -> assert false) in
+  add_dense_tensor atomspace result t.associated_node
+
+let tensor_add_op =
+  elementwise_op "addition" Dense.add_inplace Tensor_backend.batch_add
+
+let tensor_multiply_op =
+  elementwise_op "element-wise multiplication" Dense.multiply_inplace Tensor_backend.batch_multiply
+
 let tensor_matmul_op atomspace id1 id2 =
-  match get_tensor atomspace id1, get_tensor atomspace id2 with
-  | Some t1, Some t2 ->
-      let result_data = Tensor_backend.tensor_matmul !tensor_context t1.shape t2.shape t1.data t2.data in
-      (* Calculate result shape for matrix multiplication *)
-      let result_shape = match t1.shape, t2.shape with
-        | [m; _], [_; n] -> [m; n]
-        | _ -> failwith "Matrix multiplication requires 2D tensors"
-      in
-      add_tensor atomspace result_shape result_data None
-  | _ -> failwith "One or both tensors not found"
+  let (t1, t2) = find_tensor_pair atomspace id1 id2 in
+  let result = match !tensor_backend with
+    | Tensor_backend.OCaml_native -> Dense.matmul t1.data t2.data
+    | Tensor_backend.GGML ->
+      (match Dense.dims t1.data, Dense.dims t2.data with
+       | [| _; k |], [| k2; _ |] when k = k2 ->
+         ggml_dense [t1.data; t2.data] (function
+           | [x; y] -> Tensor_backend.batch_matmul x y
+           | _ -> assert false)
+       | _ -> failwith "Invalid shapes for matrix multiplication")
+  in
+  add_dense_tensor atomspace result None
 
 let tensor_scale_op atomspace id scalar =
-  match get_tensor atomspace id with
-  | Some t ->
-      let result_data = Tensor_backend.tensor_scale !tensor_context t.shape scalar t.data in
-      add_tensor atomspace t.shape result_data t.associated_node
-  | None -> failwith "Tensor not found"
+  unary_op (Dense.scale_inplace scalar) (Tensor_backend.batch_scale scalar) atomspace id
 
+(* A strided view on the OCaml backend, no data is moved *)
 let tensor_transpose_op atomspace id =
-  match get_tensor atomspace id with
-  | Some t ->
-      let result_data, result_shape = Tensor_backend.tensor_transpose !tensor_context t.shape t.data in
-      add_tensor atomspace result_shape result_data t.associated_node
-  | None -> failwith "Tensor not found"
+  let t = find_tensor atomspace id in
+  let result = match !tensor_backend with
+    | Tensor_backend.OCaml_native -> Dense.transpose t.data
+    | Tensor_backend.GGML ->
+      ggml_dense [t.data] (function [x] -> Tensor_backend.batch_transpose x | _ -> assert false)
+  in
+  add_dense_tensor atomspace result t.associated_node
 
 let tensor_dot_product_op atomspace id1 id2 =
-  match get_tensor atomspace id1, get_tensor atomspace id2 with
-  | Some t1, Some t2 ->
-      Tensor_backend.tensor_dot_product !tensor_context t1.data t2.data
-  | _ -> failwith "One or both tensors not found"
+  let (t1, t2) = find_tensor_pair atomspace id1 id2 in
+  Dense.dot t1.data t2.data
 
 let tensor_norm_op atomspace id =
-  match get_tensor atomspace id with
-  | Some t -> Tensor_backend.tensor_norm !tensor_context t.data
-  | None -> failwith "Tensor not found"
+  Dense.norm (find_tensor atomspace id).data
 
-let tensor_relu_op atomspace id =
-  match get_tensor atomspace id with
-  | Some t ->
-      let result_data = Tensor_backend.tensor_relu !tensor_context t.shape t.data in
-      add_tensor atomspace t.shape result_data t.associated_node
-  | None -> failwith "Tensor not found"
+let tensor_relu_op = unary_op Dense.relu_inplace Tensor_backend.batch_relu
 
-let tensor_sigmoid_op atomspace id =
-  match get_tensor atomspace id with
-  | Some t ->
-      let result_data = Tensor_backend.tensor_sigmoid !tensor_context t.shape t.data in
-      add_tensor atomspace t.shape result_data t.associated_node
-  | None -> failwith "Tensor not found"
+let tensor_sigmoid_op = unary_op Dense.sigmoid_inplace Tensor_backend.batch_sigmoid
 
+(* Softmax over all elements, on both backends *)
 let tensor_softmax_op atomspace id =
-  match get_tensor atomspace id with
-  | Some t ->
-      let result_data = Tensor_backend.tensor_softmax !tensor_context t.shape t.data in
-      add_tensor atomspace t.shape result_data t.associated_node
-  | None -> failwith "Tensor not found"
+  let t = find_tensor atomspace id in
+  let flat = Dense.reshape (Dense.contiguous t.data) [| Dense.size t.data |] in
+  let result = dense_op [flat]
+      ~inplace:(fun r _ -> Dense.softmax_inplace r)
+      ~batch:(function [x] -> Tensor_backend.batch_softmax x | _ -> assert false) in
+  add_dense_tensor atomspace (Dense.reshape result (Dense.dims t.data)) t.associated_node
+
+let tensor_norm tensor =
+  if tensor.norm_version <> !(tensor.version) then begin
+    tensor.cached_norm <- Dense.norm tensor.data;
+    tensor.norm_version <- !(tensor.version)
+  end;
+  tensor.cached_norm
 
 let tensor_cosine_similarity_op atomspace id1 id2 =
   match get_tensor atomspace id1, get_tensor atomspace id2 with
   | Some t1, Some t2 ->
-      if Tensor_backend.validate_shapes t1.shape t2.shape then
-        let dot_product = Tensor_backend.tensor_dot_product !tensor_context t1.data t2.data in
-        let norm1 = Tensor_backend.tensor_norm !tensor_context t1.data in
-        let norm2 = Tensor_backend.tensor_norm !tensor_context t2.data in
+      if Dense.same_shape t1.data t2.data then
+        let norm1 = tensor_norm t1 in
+        let norm2 = tensor_norm t2 in
         if norm1 > 0.0 && norm2 > 0.0 then
-          dot_product /. (norm1 *. norm2)
+          Dense.dot t1.data t2.data /. (norm1 *. norm2)
         else 0.0
       else 0.0
   | _ -> 0.0
 
+(** Batched similarity *)
+
+(* Candidates as unit rows of one row-major matrix; rows of missing, zero
+   or mismatched tensors stay zero *)
+let unit_rows atomspace dims ids =
+  let d = Array.fold_left ( * ) 1 dims in
+  let rows = Float.Array.make (Array.length ids * d) 0.0 in
+  Array.iteri (fun i id ->
+    match get_tensor atomspace id with
+    | Some t when Dense.dims t.data = dims && tensor_norm t > 0.0 ->
+        let scale = 1.0 /. tensor_norm t in
+        ignore (Dense.fold (fun j x -> Float.Array.set rows j (x *. scale); j + 1) (i * d) t.data)
+    | _ -> ()
+  ) ids;
+  rows
+
+let tensor_cosine_similarities atomspace query_id candidate_ids =
+  let candidates = Array.of_list candidate_ids in
+  match get_tensor atomspace query_id with
+  | Some q when tensor_norm q > 0.0 ->
+      let dims = Dense.dims q.data in
+      let rows = unit_rows atomspace dims candidates in
+      let query = unit_rows atomspace dims [| query_id |] in
+      Float.Array.map_to_array Fun.id
+        (Tensor_kernels.gemv (Array.length candidates) (Dense.size q.data) rows query)
+  | _ -> Array.make (Array.length candidates) 0.0
+
+(* Indices of the k largest scores, best first, through a bounded
+   min-heap: O(n log k) rather than a full sort *)
+let top_k_indices scores k =
+  let k = max 0 (min k (Array.length scores)) in
+  let heap = Array.make k 0 in
+  let size = ref 0 in
+  let swap i j =
+    let tmp = heap.(i) in
+    heap.(i) <- heap.(j);
+    heap.(j) <- tmp
+  in
+  let rec sift_up i =
+    let parent = (i - 1) / 2 in
+    if i > 0 && scores.(heap.(i)) < scores.(heap.(parent)) then begin
+      swap i parent;
+      sift_up parent
+    end
+  in
+  let rec sift_down i =
+    let l = 2 * i + 1 and r = 2 * i + 2 in
+    let smallest = if l < !size && scores.(heap.(l)) < scores.(heap.(i)) then l else i in
+    let smallest = if r < !size && scores.(heap.(r)) < scores.(heap.(smallest)) then r else smallest in
+    if smallest <> i then begin
+      swap i smallest;
+      sift_down smallest
+    end
+  in
+  Array.iteri (fun i s ->
+    if !size < k then begin
+      heap.(!size) <- i;
+      incr size;
+      sift_up (!size - 1)
+    end else if k > 0 && s > scores.(heap.(0)) then begin
+      heap.(0) <- i;
+      sift_down 0
+    end
+  ) scores;
+  List.sort (fun i j -> compare scores.(j) scores.(i)) (Array.to_list heap)
+
+let tensor_cosine_top_k atomspace query_id candidate_ids k =
+  let candidates = Array.of_list candidate_ids in
+  let scores = tensor_cosine_similarities atomspace query_id candidate_ids in
+  List.map (fun i -> (candidates.(i), scores.(i))) (top_k_indices scores k)
+
+let tensor_cosine_pairs atomspace tensor_ids threshold =
+  let ids = Array.of_list tensor_ids in
+  let groups = Hashtbl.create 4 in
+  Array.iteri (fun i id ->
+    match get_tensor atomspace id with
+    | Some t when tensor_norm t > 0.0 ->
+        let dims = Dense.dims t.data in
+        let members = try Hashtbl.find groups dims with Not_found -> [] in
+        Hashtbl.replace groups dims (i :: members)
+    | _ -> ()
+  ) ids;
+  let pairs = Hashtbl.fold (fun dims members acc ->
+    let positions = Array.of_list (List.rev members) in
+    let n = Array.length positions in
+    let d = Array.fold_left ( * ) 1 dims in
+    let rows = unit_rows atomspace dims (Array.map (fun p -> ids.(p)) positions) in
+    let gram = Tensor_kernels.matmul n d n rows (Tensor_kernels.transpose n d rows) in
+    let acc = ref acc in
+    for a = 0 to n - 1 do
+      for b = a + 1 to n - 1 do
+        let similarity = Float.Array.get gram (a * n + b) in
+        if similarity > threshold then
+          acc := (positions.(a), positions.(b), similarity) :: !acc
+      done
+    done;
+    !acc
+  ) groups [] in
+  List.sort compare pairs
+
+let tensor_reshape_view atomspace id shape =
+  let t = find_writable_tensor atomspace id in
+  register_tensor atomspace (Dense.reshape t.data (Array.of_list shape)) t.associated_node t.version
+
+let tensor_slice_view atomspace id ~axis start len =
+  let t = find_writable_tensor atomspace id in
+  register_tensor atomspace (Dense.slice t.data ~axis start len) t.associated_node t.version
+
+(* The target is made writable before the source is read, so adding a
+   tensor to itself sees one buffer *)
+let writable_pair atomspace id1 id2 =
+  let t1 = find_writable_tensor atomspace id1 in
+  (t1, find_tensor atomspace id2)
+
+let tensor_add_inplace atomspace id1 id2 =
+  let (t1, t2) = writable_pair atomspace id1 id2 in
+  Dense.add_inplace t1.data t2.data;
+  incr t1.version
+
+let tensor_multiply_inplace atomspace id1 id2 =
+  let (t1, t2) = writable_pair atomspace id1 id2 in
+  Dense.multiply_inplace t1.data t2.data;
+  incr t1.version
+
+let tensor_scale_inplace atomspace id scalar =
+  let t = find_writable_tensor atomspace id in
+  Dense.scale_inplace scalar t.data;
+  incr t.version
+
+let tensor_relu_inplace atomspace id =
+  let t = find_writable_tensor atomspace id in
+  Dense.relu_inplace t.data;
+  incr t.version
+
+let tensor_sigmoid_inplace atomspace id =
+  let t = find_writable_tensor atomspace id in
+  Dense.sigmoid_inplace t.data;
+  incr t.version
+
+let tensor_softmax_inplace atomspace id =
+  let t = find_writable_tensor atomspace id in
+  Dense.softmax_inplace t.data;
+  incr t.version
+
 (** Query operations *)
 let find_nodes_by_name atomspace name =
   try Hashtbl.find atomspace.node_index name
   with Not_found -> []
 
 let find_nodes_by_type atomspace node_type =
-  let result = ref [] in
-  Hashtbl.iter (fun _ node ->
-    if node.node_type = node_type then
-      result := node.id :: !result
-  ) atomspace.nodes;
-  !result
+  type_index_members atomspace.node_type_index node_type
 
 let find_links_by_type atomspace link_type =
-  let result = ref [] in
-  Hashtbl.iter (fun _ link ->
-    if link.link_type = link_type then
-      result := link.id :: !result
-  ) atomspace.links;
-  !result
+  type_index_members atomspace.link_type_index link_type
 
 let get_incoming_links atomspace node_id =
-  let result = ref [] in
-  Hashtbl.iter (fun _ link ->
-    if List.mem node_id link.outgoing then
-      result := link.id :: !result
-  ) atomspace.links;
-  !result
+  adjacency_members atomspace.incoming_index node_id
 
 let get_outgoing_links atomspace node_id =
-  let result = ref [] in
-  Hashtbl.iter (fun _ link ->
-    match link.outgoing with
-    | [] -> ()
-    | hd :: _ when hd = node_id -> result := link.id :: !result
-    | _ -> ()
-  ) atomspace.links;
-  !result
+  adjacency_members atomspace.outgoing_index node_id
 
 (** Attention allocation primitives (ECAN) *)
+let add_column_sti cols id amount =
+  Float.Array.set cols.sti_values id (Float.Array.get cols.sti_values id +. amount);
+  Attention_heap.update cols.sti_ranking (sti_key cols) id
+
+let add_node_sti atomspace id amount =
+  if Hashtbl.mem atomspace.nodes id then begin
+    add_column_sti atomspace.node_values id amount;
+    mark_node atomspace id Values_changed
+  end
+
+let add_link_sti atomspace id amount =
+  if Hashtbl.mem atomspace.links id then begin
+    add_column_sti atomspace.link_values id amount;
+    mark_link atomspace id Values_changed
+  end
+
+(* Single-source spreading; Spreading_matrix does this for a whole set of
+   sources in one pass *)
 let spread_activation atomspace source_id amount =
-  let incoming = get_incoming_links atomspace source_id in
-  let outgoing = get_outgoing_links atomspace source_id in
-  let all_connected = incoming @ outgoing in
-  
-  if all_connected <> [] then (
-    let spread_amount = amount /. (float_of_int (List.length all_connected)) in
-    List.iter (fun link_id ->
-      match get_link atomspace link_id with
-      | Some link ->
-          let old_attention = link.attention in
-          let new_attention = {
-            sti = old_attention.sti +. spread_amount;
-            lti = old_attention.lti;
-            vlti = old_attention.vlti;
-          } in
-          update_link_attention atomspace link_id new_attention
-      | None -> ()
-    ) all_connected
-  ) else ()
+  let all_connected =
+    get_incoming_links atomspace source_id @ get_outgoing_links atomspace source_id in
+  if all_connected <> [] then begin
+    let spread_amount = amount /. float_of_int (List.length all_connected) in
+    List.iter (fun link_id -> add_link_sti atomspace link_id spread_amount) all_connected
+  end
+
+(* Ids at or past next_node_id / next_link_id have never been written, so
+   whole-column passes stop there rather than at the column capacity *)
+let node_extent atomspace =
+  min atomspace.next_node_id (columns_capacity atomspace.node_values)
+
+let link_extent atomspace =
+  min atomspace.next_link_id (columns_capacity atomspace.link_values)
+
+let decay_columns cols extent decay_factor =
+  for i = 0 to extent - 1 do
+    Float.Array.unsafe_set cols.sti_values i
+      (Float.Array.unsafe_get cols.sti_values i *. decay_factor);
+    Float.Array.unsafe_set cols.lti_values i
+      (Float.Array.unsafe_get cols.lti_values i *. decay_factor)
+  done
+
+(* Scaling by a non-negative factor and charging rent at a rate up to 1
+   are non-decreasing in STI, so they keep the ranking's order; anything
+   else reorders it *)
+let rerank_unless_monotone cols decay_factor rent_rate =
+  if not (decay_factor >= 0.0 && rent_rate <= 1.0) then
+    Attention_heap.rebuild cols.sti_ranking (sti_key cols)
 
 let decay_attention atomspace decay_factor =
-  let decay_node_attention (_ : node_id) (node : node) =
-    let old_attention = node.attention in
-    let new_attention = {
-      sti = old_attention.sti *. decay_factor;
-      lti = old_attention.lti *. decay_factor;
-      vlti = old_attention.vlti;
-    } in
-    update_node_attention atomspace node.id new_attention
-  in
-  Hashtbl.iter decay_node_attention atomspace.nodes;
-  
-  let decay_link_attention (_ : link_id) (link : link) =
-    let old_attention = link.attention in
-    let new_attention = {
-      sti = old_attention.sti *. decay_factor;
-      lti = old_attention.lti *. decay_factor;
-      vlti = old_attention.vlti;
-    } in
-    update_link_attention atomspace link.id new_attention
-  in
-  Hashtbl.iter decay_link_attention atomspace.links
+  mark_all_values atomspace;
+  List.iter (fun (cols, extent) ->
+    decay_columns cols extent decay_factor;
+    rerank_unless_monotone cols decay_factor 0.0
+  ) [(atomspace.node_values, node_extent atomspace);
+     (atomspace.link_values, link_extent atomspace)]
+
+let decay_rent_columns cols extent decay_factor rent_rate =
+  let collected =
+    Tensor_kernels.decay_rent extent cols.sti_values cols.lti_values decay_factor rent_rate in
+  rerank_unless_monotone cols decay_factor rent_rate;
+  collected
+
+let collect_attention_rent atomspace rent_rate =
+  mark_all_values atomspace;
+  decay_rent_columns atomspace.node_values (node_extent atomspace) 1.0 rent_rate
+  +. decay_rent_columns atomspace.link_values (link_extent atomspace) 1.0 rent_rate
+
+let decay_and_collect_rent atomspace decay_factor rent_rate =
+  mark_all_values atomspace;
+  decay_rent_columns atomspace.node_values (node_extent atomspace) decay_factor rent_rate
+  +. decay_rent_columns atomspace.link_values (link_extent atomspace) decay_factor rent_rate
+
+let iter_node_attention f atomspace =
+  let cols = atomspace.node_values in
+  for id = 0 to node_extent atomspace - 1 do
+    if Hashtbl.mem atomspace.nodes id then
+      f id (Float.Array.unsafe_get cols.sti_values id) (Float.Array.unsafe_get cols.lti_values id)
+  done
+
+let top_nodes_by_sti atomspace count =
+  let cols = atomspace.node_values in
+  Attention_heap.top_k cols.sti_ranking (sti_key cols) count
+
+let top_links_by_sti atomspace count =
+  let cols = atomspace.link_values in
+  Attention_heap.top_k cols.sti_ranking (sti_key cols) count
 
+(* Nodes and links are ranked separately and paired rank by rank, so the
+   result is as long as the shorter of the two rankings *)
 let get_high_attention_atoms atomspace count =
-  let node_list = ref [] in
-  let link_list = ref [] in
-  
-  Hashtbl.iter (fun (_ : node_id) (node : node) ->
-    node_list := (node.id, node.attention.sti) :: !node_list
-  ) atomspace.nodes;
-  
-  Hashtbl.iter (fun (_ : link_id) (link : link) ->
-    link_list := (link.id, link.attention.sti) :: !link_list
-  ) atomspace.links;
-  
-  let sorted_nodes = List.sort (fun (_, a) (_, b) -> compare b a) !node_list in
-  let sorted_links = List.sort (fun (_, a) (_, b) -> compare b a) !link_list in
-  
-  let take_n lst n =
-    let rec aux acc lst n =
-      match lst, n with
-      | [], _ | _, 0 -> List.rev acc
-      | (id, _) :: tl, n -> aux (id :: acc) tl (n - 1)
-    in
-    aux [] lst n
+  let rec pair nodes links =
+    match nodes, links with
+    | n :: nodes, l :: links -> (n, l) :: pair nodes links
+    | _ -> []
   in
-  
-  let top_nodes = take_n sorted_nodes (count / 2) in
-  let top_links = take_n sorted_links (count / 2) in
-  
-  List.combine top_nodes top_links
+  pair (top_nodes_by_sti atomspace (count / 2)) (top_links_by_sti atomspace (count / 2))
 
 (** Scheme S-expression conversion *)
 let node_type_to_string = function
@@ -440,50 +1057,306 @@ let link_type_to_string = function
   | Execution -> "Execution"
   | Custom s -> s
 
-let attention_to_scheme attention =
-  Printf.sprintf "(attention (sti %.3f) (lti %.3f) (vlti %.3f))"
-    attention.sti attention.lti attention.vlti
-
-let truth_to_scheme (strength, confidence) =
-  Printf.sprintf "(truth %.3f %.3f)" strength confidence
-
-let node_to_scheme (node : node) =
-  Printf.sprintf "(node (id %d) (type %s) (name \"%s\") %s %s)"
-    node.id
-    (node_type_to_string node.node_type)
-    node.name
-    (attention_to_scheme node.attention)
-    (truth_to_scheme node.truth_value)
-
-let link_to_scheme link =
-  let outgoing_str = String.concat " " (List.map string_of_int link.outgoing) in
-  Printf.sprintf "(link (id %d) (type %s) (outgoing (%s)) %s %s)"
-    link.id
-    (link_type_to_string link.link_type)
-    outgoing_str
-    (attention_to_scheme link.attention)
-    (truth_to_scheme link.truth_value)
-
-let tensor_to_scheme tensor =
-  let shape_str = String.concat " " (List.map string_of_int tensor.shape) in
-  let data_str = String.concat " " (Array.to_list (Array.map string_of_float tensor.data)) in
-  let assoc_str = match tensor.associated_node with
-    | Some id -> Printf.sprintf " (associated %d)" id
-    | None -> ""
+let node_type_of_string = function
+  | "Concept" -> Concept
+  | "Predicate" -> Predicate
+  | "Variable" -> Variable
+  | "Number" -> Number
+  | "LinkType" -> Link_type
+  | "Schema" -> Schema
+  | s -> failwith ("Unknown node type: " ^ s)
+
+let link_type_of_string = function
+  | "Inheritance" -> Inheritance
+  | "Similarity" -> Similarity
+  | "Implication" -> Implication
+  | "Evaluation" -> Evaluation
+  | "Execution" -> Execution
+  | s -> Custom s
+
+(* Scheme output is written into Buffers; large exports go to a channel
+   in chunks instead of being built up as one string *)
+let scheme_chunk = 65536
+
+let output_scheme oc write =
+  let buf = Buffer.create scheme_chunk in
+  let flush () =
+    if Buffer.length buf >= scheme_chunk then begin
+      Buffer.output_buffer oc buf;
+      Buffer.clear buf
+    end
+  in
+  write buf flush;
+  Buffer.output_buffer oc buf
+
+let scheme_of_buffer write x =
+  let buf = Buffer.create 256 in
+  write buf x;
+  Buffer.contents buf
+
+let add_scheme_string buf s =
+  Buffer.add_char buf '"';
+  String.iter (function
+    | '"' | '\\' as c -> Buffer.add_char buf '\\'; Buffer.add_char buf c
+    | c -> Buffer.add_char buf c) s;
+  Buffer.add_char buf '"'
+
+let add_scheme_ints buf ids =
+  List.iteri (fun i id ->
+    if i > 0 then Buffer.add_char buf ' ';
+    Buffer.add_string buf (string_of_int id)) ids
+
+let add_values_scheme buf cols id =
+  Printf.bprintf buf "(attention (sti %.3f) (lti %.3f) (vlti %.3f)) (truth %.3f %.3f)"
+    (Float.Array.get cols.sti_values id) (Float.Array.get cols.lti_values id)
+    (Float.Array.get cols.vlti_values id) (Float.Array.get cols.strengths id)
+    (Float.Array.get cols.confidences id)
+
+let add_record_values_scheme buf attention (strength, confidence) =
+  Printf.bprintf buf "(attention (sti %.3f) (lti %.3f) (vlti %.3f)) (truth %.3f %.3f)"
+    attention.sti attention.lti attention.vlti strength confidence
+
+let add_node_head buf (node : node) =
+  Printf.bprintf buf "(node (id %d) (type %s) (name " node.id (node_type_to_string node.node_type);
+  add_scheme_string buf node.name;
+  Buffer.add_string buf ") "
+
+(* Custom type names may hold any character, so they are quoted like
+   node names; scheme_name reads either form back *)
+let add_link_head buf (link : link) =
+  Printf.bprintf buf "(link (id %d) (type " link.id;
+  (match link.link_type with
+   | Custom s -> add_scheme_string buf s
+   | t -> Buffer.add_string buf (link_type_to_string t));
+  Buffer.add_string buf ") (outgoing (";
+  add_scheme_ints buf link.outgoing;
+  Buffer.add_string buf ")) "
+
+let add_node_scheme buf (node : node) =
+  add_node_head buf node;
+  add_record_values_scheme buf node.attention node.truth_value;
+  Buffer.add_char buf ')'
+
+let add_link_scheme buf (link : link) =
+  add_link_head buf link;
+  add_record_values_scheme buf link.attention link.truth_value;
+  Buffer.add_char buf ')'
+
+let add_tensor_scheme buf tensor =
+  Printf.bprintf buf "(tensor (id %d) (shape (" tensor.id;
+  add_scheme_ints buf (tensor_shape_of tensor);
+  Buffer.add_string buf ")) (data (";
+  let data = Dense.contiguous tensor.data in
+  let flat = Dense.flat data in
+  for i = 0 to Dense.size data - 1 do
+    if i > 0 then Buffer.add_char buf ' ';
+    Buffer.add_string buf (string_of_float (Bigarray.Array1.get flat i))
+  done;
+  Buffer.add_string buf "))";
+  (match tensor.associated_node with
+   | Some id -> Printf.bprintf buf " (associated %d)" id
+   | None -> ());
+  Buffer.add_char buf ')'
+
+let node_to_scheme node = scheme_of_buffer add_node_scheme node
+let link_to_scheme link = scheme_of_buffer add_link_scheme link
+let tensor_to_scheme tensor = scheme_of_buffer add_tensor_scheme tensor
+
+(* Atoms in id order, values read straight from the columns *)
+let write_atomspace_scheme buf flush atomspace =
+  let section name count find next_id write =
+    Printf.bprintf buf "\n  (%s" name;
+    if count = 0 then Buffer.add_string buf "\n    ";
+    for id = 1 to next_id - 1 do
+      match find id with
+      | Some x ->
+        Buffer.add_string buf "\n    ";
+        write id x;
+        flush ()
+      | None -> ()
+    done;
+    Buffer.add_char buf ')'
+  in
+  Buffer.add_string buf "(atomspace";
+  section "nodes" (Hashtbl.length atomspace.nodes) (Hashtbl.find_opt atomspace.nodes)
+    atomspace.next_node_id (fun id node ->
+    add_node_head buf node;
+    add_values_scheme buf atomspace.node_values id;
+    Buffer.add_char buf ')');
+  section "links" (Hashtbl.length atomspace.links) (Hashtbl.find_opt atomspace.links)
+    atomspace.next_link_id (fun id link ->
+    add_link_head buf link;
+    add_values_scheme buf atomspace.link_values id;
+    Buffer.add_char buf ')');
+  section "tensors" (tensor_count atomspace) (get_tensor atomspace)
+    atomspace.next_tensor_id (fun _ tensor ->
+    add_tensor_scheme buf tensor);
+  Buffer.add_char buf ')'
+
+let add_atomspace_scheme buf atomspace = write_atomspace_scheme buf ignore atomspace
+
+let output_atomspace_scheme oc atomspace =
+  output_scheme oc (fun buf flush -> write_atomspace_scheme buf flush atomspace)
+
+let atomspace_to_scheme atomspace = scheme_of_buffer add_atomspace_scheme atomspace
+
+(** Scheme loading *)
+
+type sexp = Atom of string | Quoted of string | Items of sexp list
+
+(* Reads one datum at a time from a character source, so a whole
+   AtomSpace export is never held as a tree *)
+type scheme_reader = {
+  next_char : unit -> char;  (** raises End_of_file *)
+  mutable peeked : char option;
+}
+
+let peek_char r =
+  match r.peeked with
+  | Some c -> c
+  | None -> let c = r.next_char () in r.peeked <- Some c; c
+
+let take_char r =
+  let c = peek_char r in
+  r.peeked <- None;
+  c
+
+let rec skip_blank r =
+  match peek_char r with
+  | ' ' | '\t' | '\n' | '\r' -> ignore (take_char r); skip_blank r
+  | ';' ->
+    while take_char r <> '\n' do () done;
+    skip_blank r
+  | _ -> ()
+
+let rec read_sexp r =
+  skip_blank r;
+  match take_char r with
+  | '(' ->
+    let rec items acc =
+      skip_blank r;
+      if peek_char r = ')' then (ignore (take_char r); Items (List.rev acc))
+      else items (read_sexp r :: acc)
+    in
+    items []
+  | ')' -> failwith "Unexpected ) in Scheme input"
+  | '"' ->
+    let buf = Buffer.create 16 in
+    let rec chars () =
+      match take_char r with
+      | '"' -> Quoted (Buffer.contents buf)
+      | '\\' -> Buffer.add_char buf (take_char r); chars ()
+      | c -> Buffer.add_char buf c; chars ()
+    in
+    chars ()
+  | c ->
+    let buf = Buffer.create 16 in
+    Buffer.add_char buf c;
+    let rec chars () =
+      match peek_char r with
+      | ' ' | '\t' | '\n' | '\r' | '(' | ')' | '"' | ';' -> Atom (Buffer.contents buf)
+      | c -> Buffer.add_char buf (take_char r); chars ()
+      | exception End_of_file -> Atom (Buffer.contents buf)
+    in
+    chars ()
+
+let scheme_field name fields =
+  match List.find_opt (function Items (Atom n :: _) -> n = name | _ -> false) fields with
+  | Some (Items (_ :: args)) -> args
+  | _ -> failwith ("Missing Scheme field: " ^ name)
+
+let scheme_int = function
+  | Atom s -> int_of_string s
+  | _ -> failwith "Expected a Scheme integer"
+
+let scheme_float = function
+  | Atom s -> float_of_string s
+  | _ -> failwith "Expected a Scheme number"
+
+let scheme_name = function
+  | Atom s | Quoted s -> s
+  | Items _ -> failwith "Expected a Scheme name"
+
+let scheme_list = function
+  | [Items items] -> items
+  | _ -> failwith "Expected a Scheme list"
+
+let scheme_values fields =
+  let attention = scheme_field "attention" fields in
+  let value name = scheme_float (List.hd (scheme_field name attention)) in
+  let truth = match scheme_field "truth" fields with
+    | [s; c] -> (scheme_float s, scheme_float c)
+    | _ -> failwith "Malformed Scheme truth value"
   in
-  Printf.sprintf "(tensor (id %d) (shape (%s)) (data (%s))%s)"
-    tensor.id shape_str data_str assoc_str
-
-let atomspace_to_scheme atomspace =
-  let nodes = ref [] in
-  let links = ref [] in
-  let tensors = ref [] in
-  
-  Hashtbl.iter (fun _ node -> nodes := node_to_scheme node :: !nodes) atomspace.nodes;
-  Hashtbl.iter (fun _ link -> links := link_to_scheme link :: !links) atomspace.links;
-  Hashtbl.iter (fun _ tensor -> tensors := tensor_to_scheme tensor :: !tensors) atomspace.tensors;
-  
-  Printf.sprintf "(atomspace\n  (nodes\n    %s)\n  (links\n    %s)\n  (tensors\n    %s))"
-    (String.concat "\n    " !nodes)
-    (String.concat "\n    " !links)  
-    (String.concat "\n    " !tensors)
\ No newline at end of file
+  ({ sti = value "sti"; lti = value "lti"; vlti = value "vlti" }, truth)
+
+let restore_scheme_atom atomspace = function
+  | Items (Atom "node" :: fields) ->
+    let (attention, truth_value) = scheme_values fields in
+    restore_node atomspace {
+      id = scheme_int (List.hd (scheme_field "id" fields));
+      node_type = node_type_of_string (scheme_name (List.hd (scheme_field "type" fields)));
+      name = scheme_name (List.hd (scheme_field "name" fields));
+      attention; truth_value }
+  | Items (Atom "link" :: fields) ->
+    let (attention, truth_value) = scheme_values fields in
+    restore_link atomspace {
+      id = scheme_int (List.hd (scheme_field "id" fields));
+      link_type = link_type_of_string (scheme_name (List.hd (scheme_field "type" fields)));
+      outgoing = List.map scheme_int (scheme_list (scheme_field "outgoing" fields));
+      attention; truth_value }
+  | Items (Atom "tensor" :: fields) ->
+    let shape = List.map scheme_int (scheme_list (scheme_field "shape" fields)) in
+    let data = List.map scheme_float (scheme_list (scheme_field "data" fields)) in
+    let associated = match scheme_field "associated" fields with
+      | [id] -> Some (scheme_int id)
+      | _ -> None
+      | exception Failure _ -> None
+    in
+    restore_tensor atomspace (scheme_int (List.hd (scheme_field "id" fields)))
+      (Dense.of_array (Array.of_list shape) (Array.of_list data)) associated
+  | _ -> failwith "Unknown Scheme atom"
+
+(* The (atomspace (nodes ...) (links ...) (tensors ...)) frame is walked
+   token by token; only one atom at a time is read as a datum *)
+let read_atomspace_scheme r =
+  let expect c =
+    skip_blank r;
+    if take_char r <> c then failwith "Malformed Scheme AtomSpace"
+  in
+  let atomspace = create_atomspace () in
+  expect '(';
+  if read_sexp r <> Atom "atomspace" then failwith "Malformed Scheme AtomSpace";
+  let rec sections () =
+    skip_blank r;
+    if peek_char r = ')' then ignore (take_char r)
+    else begin
+      expect '(';
+      ignore (read_sexp r);
+      let rec atoms () =
+        skip_blank r;
+        if peek_char r = ')' then ignore (take_char r)
+        else begin
+          restore_scheme_atom atomspace (read_sexp r);
+          atoms ()
+        end
+      in
+      atoms ();
+      sections ()
+    end
+  in
+  sections ();
+  atomspace
+
+let input_atomspace_scheme ic =
+  read_atomspace_scheme { next_char = (fun () -> input_char ic); peeked = None }
+
+let atomspace_of_scheme s =
+  let pos = ref 0 in
+  read_atomspace_scheme {
+    next_char = (fun () ->
+      if !pos >= String.length s then raise End_of_file;
+      let c = s.[!pos] in
+      incr pos;
+      c);
+    peeked = None }
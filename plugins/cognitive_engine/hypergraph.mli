@@ -60,30 +60,117 @@ type link = {
   truth_value : float * float;
 }
 
+(** Sets of atom ids, for the adjacency indexes *)
+module Id_set : Set.S with type elt = int
+
 (** Tensor shapes for neural-symbolic integration *)
 type tensor_shape = int list
 
-(** Tensor for storing distributed representations *)
+(** Tensor for storing distributed representations. The data is a
+    float32 [Tensor_backend.Dense.t]; tensors made by the view operations
+    share their source's buffer. *)
 type tensor = {
   id : tensor_id;
-  shape : tensor_shape;
-  data : float array;
+  data : Tensor_backend.Dense.t;
   associated_node : node_id option;
+  version : int ref;
+    (** Counts writes to the buffer; shared with views of the same buffer *)
+  mutable cached_norm : float;
+  mutable norm_version : int;  (** [cached_norm] is valid while this equals [!version] *)
+}
+
+(** A tensor whose values are held outside the AtomSpace, such as a bound
+    embedding kept only in a quantized store; see [externalize_tensor] *)
+type external_tensor = {
+  external_shape : tensor_shape;
+  external_node : node_id option;
+  fetch : unit -> float array;  (** the current values *)
+  restored : unit -> unit;
+    (** called once the tensor is back in [tensors]; the holder's copy
+        no longer answers for it *)
+}
+
+(** Link change notifications, delivered synchronously to observers *)
+type link_event =
+  | Link_added of link_id
+  | Link_truth_updated of link_id
+  | Link_removed of link_id  (** Sent while the link is still present *)
+
+(** Handle for removing a link event observer *)
+type link_subscription
+
+(** Columnar attention and truth values, indexed directly by atom id.
+    Slots of removed atoms are zeroed. [sti_ranking] orders the live ids
+    by STI; code writing [sti_values] directly must update it. *)
+type value_columns = {
+  mutable sti_values : Float.Array.t;
+  mutable lti_values : Float.Array.t;
+  mutable vlti_values : Float.Array.t;
+  mutable strengths : Float.Array.t;
+  mutable confidences : Float.Array.t;
+  sti_ranking : Attention_heap.t;
+}
+
+(** How an atom changed since its change log was last cleared. An atom
+    keeps the strongest change recorded for it. *)
+type change =
+  | Values_changed  (** attention or truth values only *)
+  | Added           (** under an id never used before *)
+  | Replaced        (** removed, or restored over an existing id *)
+
+(** Atoms changed by the operations below since the log was last
+    cleared. [all_values_changed] is set by decay and rent, which
+    rewrite the values of every atom. *)
+type change_log = {
+  node_changes : (node_id, change) Hashtbl.t;
+  link_changes : (link_id, change) Hashtbl.t;
+  mutable all_values_changed : bool;
 }
 
-(** AtomSpace - the main hypergraph store *)
+(** AtomSpace - the main hypergraph store.
+    The [nodes] and [links] tables hold identity and structure; current
+    attention and truth values live in [node_values] and [link_values].
+    Use [get_node], [get_link] or the iterators below to obtain records
+    carrying current values. *)
 type atomspace = {
   mutable nodes : (node_id, node) Hashtbl.t;
   mutable links : (link_id, link) Hashtbl.t;
   mutable tensors : (tensor_id, tensor) Hashtbl.t;
+  mutable external_tensors : (tensor_id, external_tensor) Hashtbl.t;
+    (** tensors whose values live elsewhere; [get_tensor] still finds them *)
   mutable next_node_id : node_id;
   mutable next_link_id : link_id;
   mutable next_tensor_id : tensor_id;
   mutable node_index : (string, node_id list) Hashtbl.t;
+  mutable incoming_index : (node_id, Id_set.t) Hashtbl.t;
+    (** node -> links whose outgoing set contains it *)
+  mutable outgoing_index : (node_id, Id_set.t) Hashtbl.t;
+    (** node -> links whose outgoing set starts with it *)
+  mutable node_type_index : (node_type, (node_id, unit) Hashtbl.t) Hashtbl.t;
+  mutable link_type_index : (link_type, (link_id, unit) Hashtbl.t) Hashtbl.t;
+  node_values : value_columns;
+  link_values : value_columns;
+  mutable link_observers : (link_subscription * (link_event -> unit)) list;
+  mutable change_log : change_log option;  (** set by [track_changes] *)
 }
 
-(** Create empty AtomSpace *)
-val create_atomspace : unit -> atomspace
+(** Create empty AtomSpace, with tables sized for [capacity] atoms *)
+val create_atomspace : ?capacity:int -> unit -> atomspace
+
+(** Register an observer for link additions, truth updates and removals.
+    It is called until the returned handle is unsubscribed. *)
+val subscribe_link_events : atomspace -> (link_event -> unit) -> link_subscription
+
+(** Stop delivering events to an observer; unknown handles are ignored *)
+val unsubscribe_link_events : atomspace -> link_subscription -> unit
+
+(** Start recording changed atoms, or return the log already recording
+    them. An AtomSpace has one log; changes are only recorded once it
+    exists. *)
+val track_changes : atomspace -> change_log
+
+(** Forget the recorded changes, once they are saved *)
+val clear_changes : change_log -> unit
 
 (** Node operations *)
 val add_node : atomspace -> node_type -> string -> node_id
@@ -91,6 +178,9 @@ val get_node : atomspace -> node_id -> node option
 val update_node_attention : atomspace -> node_id -> attention_value -> unit
 val update_node_truth : atomspace -> node_id -> float * float -> unit
 val remove_node : atomspace -> node_id -> unit
+val get_node_attention : atomspace -> node_id -> attention_value option
+val iter_nodes : (node -> unit) -> atomspace -> unit
+val fold_nodes : (node -> 'a -> 'a) -> atomspace -> 'a -> 'a
 
 (** Link operations *)
 val add_link : atomspace -> link_type -> node_id list -> link_id
@@ -98,13 +188,63 @@ val get_link : atomspace -> link_id -> link option
 val update_link_attention : atomspace -> link_id -> attention_value -> unit
 val update_link_truth : atomspace -> link_id -> float * float -> unit
 val remove_link : atomspace -> link_id -> unit
+val get_link_attention : atomspace -> link_id -> attention_value option
+val iter_links : (link -> unit) -> atomspace -> unit
+val fold_links : (link -> 'a -> 'a) -> atomspace -> 'a -> 'a
+
+(** Bulk loading: insert atoms under their stored ids with their values,
+    replacing any atom with the same id *)
+val restore_node : atomspace -> node -> unit
+val restore_link : atomspace -> link -> unit
+
+(** Bulk loading into an empty AtomSpace in one pass per atom kind, the
+    STI rankings built once at the end. No link events are sent. *)
+val restore_bulk : atomspace -> node array -> link array -> unit
 
 (** Tensor operations *)
 val add_tensor : atomspace -> tensor_shape -> float array -> node_id option -> tensor_id
+
+(** Register a dense tensor as it is, without copying *)
+val add_dense_tensor : atomspace -> Tensor_backend.Dense.t -> node_id option -> tensor_id
+
+(** A tensor by id. An external tensor is returned as a fresh copy of its
+    values; writes to that copy are not kept. *)
 val get_tensor : atomspace -> tensor_id -> tensor option
+
+(** Move a tensor's values out of the AtomSpace. Reads go through
+    [fetch]; the first write, view or [internalize_tensor] brings the
+    tensor back and calls [restored]. *)
+val externalize_tensor :
+  atomspace -> tensor_id -> fetch:(unit -> float array) -> restored:(unit -> unit) -> unit
+
+(** Bring an external tensor back into [tensors]; other ids are ignored *)
+val internalize_tensor : atomspace -> tensor_id -> unit
+
+val is_external_tensor : atomspace -> tensor_id -> bool
+
+(** Fold over every tensor, external ones included *)
+val fold_tensors : (tensor -> 'a -> 'a) -> atomspace -> 'a -> 'a
+val tensor_count : atomspace -> int
+
+(** Bulk loading: register a tensor under its stored id *)
+val restore_tensor : atomspace -> tensor_id -> Tensor_backend.Dense.t -> node_id option -> unit
+
+(** Overwrite the tensor's elements in place; the size must match *)
 val update_tensor_data : atomspace -> tensor_id -> float array -> unit
+
+(** Number of writes to the tensor's buffer through this module or
+    [touch_tensor]; caches keyed on it notice every such write *)
+val tensor_version : tensor -> int
+
+(** Record a write made to the tensor's buffer directly *)
+val touch_tensor : atomspace -> tensor_id -> unit
 val remove_tensor : atomspace -> tensor_id -> unit
 
+val tensor_shape_of : tensor -> tensor_shape
+
+(** The elements in row-major order, as a fresh float array *)
+val tensor_values : tensor -> float array
+
 (** Tensor operations with backend support *)
 val set_tensor_backend : Tensor_backend.backend_type -> unit
 val get_tensor_backend : unit -> Tensor_backend.backend_type
@@ -112,6 +252,7 @@ val tensor_add_op : atomspace -> tensor_id -> tensor_id -> tensor_id
 val tensor_multiply_op : atomspace -> tensor_id -> tensor_id -> tensor_id
 val tensor_matmul_op : atomspace -> tensor_id -> tensor_id -> tensor_id
 val tensor_scale_op : atomspace -> tensor_id -> float -> tensor_id
+(** On the OCaml backend the result is a view of the source *)
 val tensor_transpose_op : atomspace -> tensor_id -> tensor_id
 val tensor_dot_product_op : atomspace -> tensor_id -> tensor_id -> float
 val tensor_norm_op : atomspace -> tensor_id -> float
@@ -120,20 +261,106 @@ val tensor_sigmoid_op : atomspace -> tensor_id -> tensor_id
 val tensor_softmax_op : atomspace -> tensor_id -> tensor_id
 val tensor_cosine_similarity_op : atomspace -> tensor_id -> tensor_id -> float
 
+(** Batched similarity. Norms are cached on each tensor until its
+    version changes. Candidates that are missing, zero or of another
+    shape score 0.0. *)
+val tensor_norm : tensor -> float
+
+(** Cosine similarity of one tensor with each candidate, in order, from
+    one matrix-vector product *)
+val tensor_cosine_similarities : atomspace -> tensor_id -> tensor_id list -> float array
+
+(** The [k] candidates most similar to the query, best first *)
+val tensor_cosine_top_k : atomspace -> tensor_id -> tensor_id list -> int -> (tensor_id * float) list
+
+(** Position pairs [(i, j)], [i < j], of tensors whose cosine similarity
+    exceeds the threshold, from one Gram matrix per shape *)
+val tensor_cosine_pairs : atomspace -> tensor_id list -> float -> (int * int * float) list
+
+(** Views: new tensors sharing the source's buffer *)
+val tensor_reshape_view : atomspace -> tensor_id -> tensor_shape -> tensor_id
+val tensor_slice_view : atomspace -> tensor_id -> axis:int -> int -> int -> tensor_id
+
+(** In-place operations on the first tensor; they run in OCaml on every
+    backend and allocate nothing. Views of the same buffer see the change. *)
+val tensor_add_inplace : atomspace -> tensor_id -> tensor_id -> unit
+val tensor_multiply_inplace : atomspace -> tensor_id -> tensor_id -> unit
+val tensor_scale_inplace : atomspace -> tensor_id -> float -> unit
+val tensor_relu_inplace : atomspace -> tensor_id -> unit
+val tensor_sigmoid_inplace : atomspace -> tensor_id -> unit
+val tensor_softmax_inplace : atomspace -> tensor_id -> unit
+
 (** Query operations *)
 val find_nodes_by_name : atomspace -> string -> node_id list
 val find_nodes_by_type : atomspace -> node_type -> node_id list
 val find_links_by_type : atomspace -> link_type -> link_id list
+
+(** Links with the node in their outgoing set, and links headed by it,
+    in increasing id order *)
 val get_incoming_links : atomspace -> node_id -> link_id list
 val get_outgoing_links : atomspace -> node_id -> link_id list
 
-(** Attention allocation primitives (ECAN) *)
+(** Attention allocation primitives (ECAN). Decay and rent are single
+    passes over the value columns, up to the highest id allocated. *)
 val spread_activation : atomspace -> node_id -> float -> unit
 val decay_attention : atomspace -> float -> unit
+val collect_attention_rent : atomspace -> float -> float
+
+(** [decay_attention] followed by [collect_attention_rent] in one pass *)
+val decay_and_collect_rent : atomspace -> float -> float -> float
+
+(** Add to the STI of a live atom in place *)
+val add_node_sti : atomspace -> node_id -> float -> unit
+val add_link_sti : atomspace -> link_id -> float -> unit
+
+(** [f id sti lti] for every live node, read from the columns *)
+val iter_node_attention : (node_id -> float -> float -> unit) -> atomspace -> unit
+
+(** The highest-STI nodes or links, best first, read from the STI
+    ranking in O(count log count) *)
+val top_nodes_by_sti : atomspace -> int -> node_id list
+val top_links_by_sti : atomspace -> int -> link_id list
+
+(** The top [count / 2] nodes paired rank by rank with the top
+    [count / 2] links; as long as the shorter ranking *)
 val get_high_attention_atoms : atomspace -> int -> (node_id * link_id) list
 
+(** Indices of the [k] largest scores, best first, in O(n log k) *)
+val top_k_indices : float array -> int -> int list
+
 (** Scheme S-expression conversion *)
+val node_type_to_string : node_type -> string
+val link_type_to_string : link_type -> string
+val node_type_of_string : string -> node_type
+val link_type_of_string : string -> link_type
+
+(** Streaming export: the [add_*] writers append to a Buffer, and
+    [output_atomspace_scheme] writes an AtomSpace to a channel in chunks
+    of about 64 KB, atoms in id order. The [*_to_scheme] functions wrap
+    them. *)
+val add_node_scheme : Buffer.t -> node -> unit
+val add_link_scheme : Buffer.t -> link -> unit
+val add_tensor_scheme : Buffer.t -> tensor -> unit
+val add_atomspace_scheme : Buffer.t -> atomspace -> unit
+val output_atomspace_scheme : out_channel -> atomspace -> unit
+
+(** [output_scheme oc write] runs [write buf flush] against a chunk
+    buffer; [flush] drains it to [oc] once full and is meant to be
+    called between items *)
+val output_scheme : out_channel -> (Buffer.t -> (unit -> unit) -> unit) -> unit
+
+(** Quoted, with [\"] and [\\] escaped *)
+val add_scheme_string : Buffer.t -> string -> unit
+
+(** Run a Buffer writer and return what it wrote *)
+val scheme_of_buffer : (Buffer.t -> 'a -> unit) -> 'a -> string
+
 val node_to_scheme : node -> string
 val link_to_scheme : link -> string
 val tensor_to_scheme : tensor -> string
-val atomspace_to_scheme : atomspace -> string
\ No newline at end of file
+val atomspace_to_scheme : atomspace -> string
+
+(** Incremental loading of [atomspace_to_scheme] output, one atom datum
+    at a time; values come back at the export's three decimals *)
+val input_atomspace_scheme : in_channel -> atomspace
+val atomspace_of_scheme : string -> atomspace
\ No newline at end of file
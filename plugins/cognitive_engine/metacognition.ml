@@ -523,10 +523,10 @@ let generate_curiosity_goals context =
   
   (* Identify high-attention concepts for deeper exploration *)
   let high_attention_concepts = ref [] in
-  Hashtbl.iter (fun _ node ->
+  Hypergraph.iter_nodes (fun node ->
     if node.Hypergraph.attention.sti > 0.5 then
       high_attention_concepts := node.Hypergraph.name :: !high_attention_concepts
-  ) context.atomspace.nodes;
+  ) context.atomspace;
   
   List.iter (fun concept ->
     if Random.float 1.0 > 0.7 then ( (* 30% chance for curiosity goal *)
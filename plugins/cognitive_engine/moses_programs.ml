@@ -509,41 +509,151 @@ and apply env f args =
     eval (bindings @ env) body
   | _ -> List (f :: args)
 
+(** {1 Compiled Evaluation} *)
+
+(** A program compiled once to closures over an input slot array.
+    Variables are slot indices and operators are dispatched at compile
+    time; results are exactly those of [eval]. *)
+type compiled = {
+  c_arity: int;
+  run: sexpr array -> sexpr;
+}
+
+let p_true = Prim (PBool true)
+let p_false = Prim (PBool false)
+let bool_value b = if b then p_true else p_false
+
+let rec compile_expr variables slot_of expr =
+  match expr with
+  | Atom s ->
+    (match slot_of s with
+     | Some i -> fun slots -> Array.unsafe_get slots i
+     | None -> fun _ -> expr)
+  | Prim _ | Op _ | List [] -> fun _ -> expr
+  | Quoted e -> fun _ -> e
+  | List (Op op :: args) ->
+    compile_op op (List.map (compile_expr variables slot_of) args)
+  | List (Atom "lambda" :: _) -> fun _ -> expr
+  | List _ ->
+    (* Applications bind lambda parameters dynamically; the interpreter
+       handles them *)
+    fun slots -> eval (List.combine variables (Array.to_list slots)) expr
+
+and compile_op op args =
+  let symbolic values = List (Op op :: values) in
+  let arith int_op float_op a b = fun slots ->
+    match a slots, b slots with
+    | Prim (PInt x), Prim (PInt y) -> Prim (PInt (int_op x y))
+    | Prim (PFloat x), Prim (PFloat y) -> Prim (PFloat (float_op x y))
+    | x, y -> symbolic [x; y]
+  in
+  let compare_op int_op float_op a b = fun slots ->
+    match a slots, b slots with
+    | Prim (PInt x), Prim (PInt y) -> bool_value (int_op x y)
+    | Prim (PFloat x), Prim (PFloat y) -> bool_value (float_op x y)
+    | x, y -> symbolic [x; y]
+  in
+  match op, args with
+  | And, [a; b] -> (fun slots ->
+      match a slots, b slots with
+      | Prim (PBool x), Prim (PBool y) -> bool_value (x && y)
+      | x, y -> symbolic [x; y])
+  | Or, [a; b] -> (fun slots ->
+      match a slots, b slots with
+      | Prim (PBool x), Prim (PBool y) -> bool_value (x || y)
+      | x, y -> symbolic [x; y])
+  | Not, [a] -> (fun slots ->
+      match a slots with
+      | Prim (PBool x) -> bool_value (not x)
+      | x -> symbolic [x])
+  | Add, [a; b] -> arith ( + ) ( +. ) a b
+  | Sub, [a; b] -> arith ( - ) ( -. ) a b
+  | Mul, [a; b] -> arith ( * ) ( *. ) a b
+  | Div, [a; b] -> (fun slots ->
+      match a slots, b slots with
+      | Prim (PInt x), Prim (PInt y) when y <> 0 -> Prim (PInt (x / y))
+      | Prim (PFloat x), Prim (PFloat y) when y <> 0.0 -> Prim (PFloat (x /. y))
+      | x, y -> symbolic [x; y])
+  | Neg, [a] -> (fun slots ->
+      match a slots with
+      | Prim (PInt x) -> Prim (PInt (-x))
+      | Prim (PFloat x) -> Prim (PFloat (-.x))
+      | x -> symbolic [x])
+  | Abs, [a] -> (fun slots ->
+      match a slots with
+      | Prim (PInt x) -> Prim (PInt (abs x))
+      | Prim (PFloat x) -> Prim (PFloat (abs_float x))
+      | x -> symbolic [x])
+  | Eq, [a; b] -> fun slots -> bool_value (a slots = b slots)
+  | Lt, [a; b] -> compare_op ( < ) ( < ) a b
+  | Le, [a; b] -> compare_op ( <= ) ( <= ) a b
+  | Gt, [a; b] -> compare_op ( > ) ( > ) a b
+  | Ge, [a; b] -> compare_op ( >= ) ( >= ) a b
+  | If, [cond; then_e; else_e] -> (fun slots ->
+      match cond slots with
+      | Prim (PBool true) -> then_e slots
+      | Prim (PBool false) -> else_e slots
+      | c -> symbolic [c; then_e slots; else_e slots])
+  | _, args -> fun slots -> symbolic (List.map (fun f -> f slots) args)
+
+(** Compile a program once for repeated evaluation *)
+let compile p =
+  let slots = Hashtbl.create 8 in
+  List.iteri (fun i v -> if not (Hashtbl.mem slots v) then Hashtbl.add slots v i) p.variables;
+  { c_arity = p.arity;
+    run = compile_expr p.variables (Hashtbl.find_opt slots) p.expr }
+
+let box_inputs inputs = Array.map (fun x -> Prim (PFloat x)) inputs
+
+let run_slots c slots =
+  if Array.length slots <> c.c_arity then failwith "Input arity mismatch"
+  else c.run slots
+
+(** Evaluate a compiled program on one input vector *)
+let eval_compiled c inputs = run_slots c (box_inputs inputs)
+
+(** Evaluate a compiled program on every input vector *)
+let eval_batch c cases = Array.map (eval_compiled c) cases
+
 (** Evaluate program with inputs *)
-let eval_program p inputs =
-  if List.length inputs <> p.arity then
-    failwith "Input arity mismatch"
-  else
-    let env = List.combine p.variables (List.map (fun x -> Prim (PFloat x)) inputs) in
-    eval env p.expr
+let eval_program p inputs = eval_compiled (compile p) (Array.of_list inputs)
 
 (** Fitness function type *)
 type fitness_fn = program -> float
 
+(* Test cases with their inputs boxed once, for every program scored *)
+let boxed_cases test_cases =
+  Array.of_list (List.map (fun (inputs, expected) ->
+    (box_inputs (Array.of_list inputs), expected)) test_cases)
+
 (** Boolean fitness: percentage of correct outputs *)
-let boolean_fitness test_cases p =
-  let correct = List.fold_left (fun acc (inputs, expected) ->
-    try
-      let result = eval_program p inputs in
-      match result, expected with
-      | Prim (PBool r), b when r = b -> acc + 1
-      | _ -> acc
-    with _ -> acc
-  ) 0 test_cases in
-  float_of_int correct /. float_of_int (List.length test_cases)
+let boolean_fitness test_cases =
+  let cases = boxed_cases test_cases in
+  fun p ->
+    let c = compile p in
+    let correct = Array.fold_left (fun acc (slots, expected) ->
+      try
+        match run_slots c slots with
+        | Prim (PBool r) when r = expected -> acc + 1
+        | _ -> acc
+      with _ -> acc
+    ) 0 cases in
+    float_of_int correct /. float_of_int (Array.length cases)
 
 (** Regression fitness: 1 / (1 + MSE) *)
-let regression_fitness test_cases p =
-  let mse = List.fold_left (fun acc (inputs, expected) ->
-    try
-      let result = eval_program p inputs in
-      match result with
-      | Prim (PFloat r) -> acc +. (r -. expected) ** 2.0
-      | Prim (PInt r) -> acc +. (float_of_int r -. expected) ** 2.0
-      | _ -> acc +. 1000.0  (* Penalty for wrong type *)
-    with _ -> acc +. 1000.0  (* Penalty for error *)
-  ) 0.0 test_cases in
-  1.0 /. (1.0 +. mse /. float_of_int (List.length test_cases))
+let regression_fitness test_cases =
+  let cases = boxed_cases test_cases in
+  fun p ->
+    let c = compile p in
+    let mse = Array.fold_left (fun acc (slots, expected) ->
+      try
+        match run_slots c slots with
+        | Prim (PFloat r) -> acc +. (r -. expected) ** 2.0
+        | Prim (PInt r) -> acc +. (float_of_int r -. expected) ** 2.0
+        | _ -> acc +. 1000.0  (* Penalty for wrong type *)
+      with _ -> acc +. 1000.0  (* Penalty for error *)
+    ) 0.0 cases in
+    1.0 /. (1.0 +. mse /. float_of_int (Array.length cases))
 
 (** Complexity-penalized fitness *)
 let penalized_fitness ?(complexity_weight=0.01) base_fitness p =
@@ -568,9 +678,28 @@ let create_population size depth =
   ) in
   { programs; generation = 0; best_fitness = 0.0; avg_fitness = 0.0 }
 
+(* Each program is scored from its own RNG state, derived from the seed,
+   the generation and its index, so fitness functions that sample give
+   the same scores whatever the worker count *)
+let score_programs ~seed ~generation fitness_fn programs indices =
+  Array.map (fun i ->
+    Random.full_init [| seed; generation; i |];
+    fitness_fn programs.(i)
+  ) indices
+
 (** Evaluate population fitness *)
-let evaluate_population fitness_fn pop =
-  Array.iter (fun p -> p.fitness <- fitness_fn p) pop.programs;
+let evaluate_population ?(workers = 1) ?(seed = 0) fitness_fn pop =
+  let programs = pop.programs in
+  let indices = Array.init (Array.length programs) (fun i -> i) in
+  let state = Random.get_state () in
+  (* Chunks balanced by complexity, one per worker *)
+  let chunks = Parallel_pool.balance workers (fun i -> programs.(i).complexity) indices in
+  let scores = Fun.protect ~finally:(fun () -> Random.set_state state) (fun () ->
+      Parallel_pool.map ~workers
+        (score_programs ~seed ~generation:pop.generation fitness_fn programs) chunks) in
+  Array.iteri (fun c chunk ->
+    Array.iteri (fun j i -> programs.(i).fitness <- scores.(c).(j)) chunk
+  ) chunks;
   let total = Array.fold_left (fun acc p -> acc +. p.fitness) 0.0 pop.programs in
   let best = Array.fold_left (fun acc p -> max acc p.fitness) 0.0 pop.programs in
   { pop with 
@@ -588,7 +717,8 @@ let tournament_select ?(size=3) pop =
   !best
 
 (** Evolve population one generation *)
-let evolve_population ?(mutation_rate=0.1) ?(crossover_rate=0.7) ?(elitism=2) fitness_fn pop =
+let evolve_population ?(mutation_rate=0.1) ?(crossover_rate=0.7) ?(elitism=2)
+    ?workers ?seed fitness_fn pop =
   let n = Array.length pop.programs in
   let new_programs = Array.make n pop.programs.(0) in
   
@@ -624,15 +754,16 @@ let evolve_population ?(mutation_rate=0.1) ?(crossover_rate=0.7) ?(elitism=2) fi
     best_fitness = 0.0;
     avg_fitness = 0.0;
   } in
-  evaluate_population fitness_fn new_pop
+  evaluate_population ?workers ?seed fitness_fn new_pop
 
 (** Run MOSES evolution *)
-let run_moses ?(population_size=100) ?(max_generations=100) ?(target_fitness=0.99) fitness_fn =
+let run_moses ?(population_size=100) ?(max_generations=100) ?(target_fitness=0.99)
+    ?workers ?seed fitness_fn =
   let pop = ref (create_population population_size 4) in
-  pop := evaluate_population fitness_fn !pop;
+  pop := evaluate_population ?workers ?seed fitness_fn !pop;
   
   while !pop.generation < max_generations && !pop.best_fitness < target_fitness do
-    pop := evolve_population fitness_fn !pop;
+    pop := evolve_population ?workers ?seed fitness_fn !pop;
     if !pop.generation mod 10 = 0 then
       Printf.printf "Generation %d: best=%.4f avg=%.4f\n" 
         !pop.generation !pop.best_fitness !pop.avg_fitness
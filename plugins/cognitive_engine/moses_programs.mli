@@ -107,12 +107,28 @@ val eval : env -> sexpr -> sexpr
 (** Evaluate program with float inputs *)
 val eval_program : program -> float list -> sexpr
 
+(** {1 Compiled Evaluation} *)
+
+(** A program compiled to closures over an input slot array, with
+    variables resolved to slots and operators dispatched once. Results
+    match [eval]; lambda applications run through the interpreter. *)
+type compiled
+
+val compile : program -> compiled
+
+(** Evaluate on one input vector *)
+val eval_compiled : compiled -> float array -> sexpr
+
+(** Evaluate on every input vector, in order *)
+val eval_batch : compiled -> float array array -> sexpr array
+
 (** {1 Fitness Evaluation} *)
 
 (** Fitness function type *)
 type fitness_fn = program -> float
 
-(** Boolean fitness: percentage of correct outputs *)
+(** Boolean fitness: percentage of correct outputs. The test cases are
+    prepared once and each program is compiled once per call. *)
 val boolean_fitness : (float list * bool) list -> fitness_fn
 
 (** Regression fitness: 1 / (1 + MSE) *)
@@ -134,8 +150,13 @@ type population = {
 (** Create initial random population *)
 val create_population : int -> int -> population
 
-(** Evaluate population fitness *)
-val evaluate_population : fitness_fn -> population -> population
+(** Evaluate population fitness, in up to [workers] processes (default 1)
+    given chunks of near-equal total complexity. Before each program is
+    scored the global RNG is seeded from [seed], the generation and the
+    program's index, and it is restored afterwards, so results do not
+    depend on the worker count. The fitness function runs in forked
+    workers when [workers > 1] and must not rely on side effects. *)
+val evaluate_population : ?workers:int -> ?seed:int -> fitness_fn -> population -> population
 
 (** Tournament selection *)
 val tournament_select : ?size:int -> population -> program
@@ -145,6 +166,8 @@ val evolve_population :
   ?mutation_rate:float -> 
   ?crossover_rate:float -> 
   ?elitism:int -> 
+  ?workers:int -> 
+  ?seed:int -> 
   fitness_fn -> population -> population
 
 (** Run MOSES evolution *)
@@ -152,6 +175,8 @@ val run_moses :
   ?population_size:int -> 
   ?max_generations:int -> 
   ?target_fitness:float -> 
+  ?workers:int -> 
+  ?seed:int -> 
   fitness_fn -> program
 
 (** {1 Scheme Serialization} *)
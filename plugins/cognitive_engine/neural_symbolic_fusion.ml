@@ -32,6 +32,13 @@ type fusion_context = {
   mutable fusion_history : neural_symbolic_binding list;
   embedding_dimension : int;
   learning_rate : float;
+  embedding_index : Ann_index.t;
+    (** HNSW index over the bound embeddings, keyed by symbolic id *)
+  mutable embedding_store : Embedding_store.t option;
+    (** Quantized bound embeddings, keyed by symbolic id *)
+  released : (int, int) Hashtbl.t;
+    (** Bound tensors external to the AtomSpace, their values held by
+        [embedding_store]: neural id -> symbolic id *)
 }
 
 (** Create fusion context *)
@@ -42,6 +49,9 @@ let create_fusion_context atomspace embedding_dim =
     fusion_history = [];
     embedding_dimension = embedding_dim;
     learning_rate = 0.01;
+    embedding_index = Ann_index.create embedding_dim;
+    embedding_store = None;
+    released = Hashtbl.create 256;
   }
 
 (** Utility functions *)
@@ -53,6 +63,101 @@ let fusion_strategy_to_string = function
   | Attention_Guided -> "attention_guided"  
   | Hierarchical -> "hierarchical"
 
+(** Embedding indexes *)
+
+(* Shape and values of a tensor; released ones are dequantized from the
+   store by the AtomSpace *)
+let tensor_entry ctx neural_id =
+  match Hypergraph.get_tensor ctx.atomspace neural_id with
+  | Some tensor -> Some (Hypergraph.tensor_shape_of tensor, Hypergraph.tensor_values tensor)
+  | None -> None
+
+let tensor_data ctx neural_id =
+  match tensor_entry ctx neural_id with
+  | Some (_, values) -> values
+  | None -> raise Not_found
+
+(* The values of a bound tensor, when it has the context's embedding size *)
+let embedding_values ctx neural_id =
+  match tensor_entry ctx neural_id with
+  | Some (shape, values) when shape = [ctx.embedding_dimension] -> Some values
+  | _ -> None
+
+(* Once quantized, the store holds the only copy of an embedding: the
+   AtomSpace keeps the tensor's id and reads its values from the store.
+   A write through the AtomSpace brings the float tensor back, and the
+   store entry, now stale, is dropped. *)
+let release ctx store symbolic_id neural_id =
+  if Hashtbl.mem ctx.atomspace.tensors neural_id then begin
+    Hypergraph.externalize_tensor ctx.atomspace neural_id
+      ~fetch:(fun () -> Option.get (Embedding_store.get store symbolic_id))
+      ~restored:(fun () ->
+        Hashtbl.remove ctx.released neural_id;
+        Embedding_store.remove store symbolic_id);
+    Hashtbl.replace ctx.released neural_id symbolic_id
+  end
+
+(* A symbol being rebound no longer answers for its old tensor, which
+   goes back to the AtomSpace before the store entry is reused *)
+let unbind ctx symbolic_id =
+  match Hashtbl.find_opt ctx.bindings symbolic_id with
+  | Some old when Hashtbl.find_opt ctx.released old.neural_id = Some symbolic_id ->
+      Hypergraph.internalize_tensor ctx.atomspace old.neural_id
+  | _ -> ()
+
+(* Mirror a binding into the ANN index and the quantized store *)
+let index_binding ctx symbolic_id neural_id =
+  let embedding = embedding_values ctx neural_id in
+  (match embedding with
+   | Some data -> Ann_index.add ctx.embedding_index symbolic_id data
+   | None -> Ann_index.remove ctx.embedding_index symbolic_id);
+  match ctx.embedding_store, embedding with
+  | Some store, Some data ->
+      Embedding_store.set store symbolic_id data;
+      release ctx store symbolic_id neural_id
+  | Some store, None -> Embedding_store.remove store symbolic_id
+  | None, _ -> ()
+
+let use_quantized_embeddings ctx format =
+  if ctx.embedding_store = None then begin
+    let store = Embedding_store.create ~format
+      ~capacity:(Hashtbl.length ctx.bindings) ctx.embedding_dimension in
+    ctx.embedding_store <- Some store;
+    Hashtbl.iter (fun symbolic_id binding ->
+      match embedding_values ctx binding.neural_id with
+      | Some data ->
+          Embedding_store.set store symbolic_id data;
+          release ctx store symbolic_id binding.neural_id
+      | None -> ()
+    ) ctx.bindings
+  end
+
+let use_float_embeddings ctx =
+  if ctx.embedding_store <> None then begin
+    (* Restoring a tensor removes its entry from [released] *)
+    let neural_ids = Hashtbl.fold (fun neural_id _ ids -> neural_id :: ids) ctx.released [] in
+    List.iter (Hypergraph.internalize_tensor ctx.atomspace) neural_ids;
+    Hashtbl.reset ctx.released;
+    ctx.embedding_store <- None
+  end
+
+(* Cosine of two bound symbols, from the store when both are in it *)
+let binding_cosine ctx symbolic_id1 symbolic_id2 neural_id1 neural_id2 =
+  match ctx.embedding_store with
+  | Some store when Embedding_store.mem store symbolic_id1 && Embedding_store.mem store symbolic_id2 ->
+      Embedding_store.cosine store symbolic_id1 symbolic_id2
+  | _ -> Hypergraph.tensor_cosine_similarity_op ctx.atomspace neural_id1 neural_id2
+
+(* A tensor encoded once as a store query, when it fits the store *)
+let store_query ctx neural_id =
+  match ctx.embedding_store with
+  | Some store ->
+      (match tensor_entry ctx neural_id with
+       | Some (shape, values) when shape = [Embedding_store.dim store] ->
+           Some (store, Embedding_store.encode_query store values)
+       | _ -> None)
+  | None -> None
+
 (** Enhanced bidirectional translation *)
 let symbol_to_neural ctx symbolic_id strategy =
   try
@@ -79,6 +184,7 @@ let symbol_to_neural ctx symbolic_id strategy =
         } in
         Hashtbl.add ctx.bindings symbolic_id binding;
         ctx.fusion_history <- binding :: ctx.fusion_history;
+        index_binding ctx symbolic_id neural_id;
         Some neural_id
     | Compositional ->
         (* For compositional, analyze symbolic structure and create appropriate embedding *)
@@ -108,15 +214,18 @@ let symbol_to_neural ctx symbolic_id strategy =
              } in
              Hashtbl.add ctx.bindings symbolic_id binding;
              ctx.fusion_history <- binding :: ctx.fusion_history;
+             index_binding ctx symbolic_id neural_id;
              Some neural_id
          | None -> None)
     | _ -> None  (* Other strategies not implemented yet *)
 
 let neural_to_symbol ctx neural_id =
-  try
-    let tensor = Hashtbl.find ctx.atomspace.tensors neural_id in
-    tensor.associated_node
-  with Not_found -> None
+  match Hashtbl.find_opt ctx.released neural_id with
+  | Some symbolic_id -> Some symbolic_id
+  | None ->
+      match Hypergraph.get_tensor ctx.atomspace neural_id with
+      | Some tensor -> tensor.associated_node
+      | None -> None
 
 let create_neural_symbolic_binding ctx symbolic_id neural_id strategy strength =
   let binding = {
@@ -127,8 +236,10 @@ let create_neural_symbolic_binding ctx symbolic_id neural_id strategy strength =
     created_at = get_current_time ();
     last_updated = get_current_time ();
   } in
+  unbind ctx symbolic_id;
   Hashtbl.replace ctx.bindings symbolic_id binding;
-  ctx.fusion_history <- binding :: ctx.fusion_history
+  ctx.fusion_history <- binding :: ctx.fusion_history;
+  index_binding ctx symbolic_id neural_id
 
 (** Hierarchical fusion operations *)
 let hierarchical_embed ctx root_symbolic_id child_symbolic_ids =
@@ -143,18 +254,15 @@ let hierarchical_embed ctx root_symbolic_id child_symbolic_ids =
       else begin
         (* Combine root and children embeddings using attention mechanism *)
         let combined_data = Array.make ctx.embedding_dimension 0.0 in
-        let root_tensor = Hashtbl.find ctx.atomspace.tensors root_neural_id in
-        
         (* Start with root embedding *)
-        Array.iteri (fun i v -> combined_data.(i) <- v) root_tensor.data;
+        Array.iteri (fun i v -> combined_data.(i) <- v) (tensor_data ctx root_neural_id);
         
         (* Add weighted contributions from children *)
         let weight = 1.0 /. (float_of_int (List.length child_neural_ids + 1)) in
         List.iter (fun child_id ->
-          let child_tensor = Hashtbl.find ctx.atomspace.tensors child_id in
           Array.iteri (fun i v -> 
             combined_data.(i) <- combined_data.(i) +. (weight *. v)
-          ) child_tensor.data
+          ) (tensor_data ctx child_id)
         ) child_neural_ids;
         
         (* Create new tensor for hierarchical embedding *)
@@ -186,10 +294,9 @@ let compositional_reasoning ctx symbolic_ids strategy =
         
         (* Average the embeddings (simple composition) *)
         List.iter (fun neural_id ->
-          let tensor = Hashtbl.find ctx.atomspace.tensors neural_id in
           Array.iteri (fun i v -> 
             result_data.(i) <- result_data.(i) +. v
-          ) tensor.data
+          ) (tensor_data ctx neural_id)
         ) neural_ids;
         
         (* Normalize by count *)
@@ -220,10 +327,9 @@ let adaptive_attention_fusion ctx symbolic_ids neural_ids =
   (* Apply attention to create focused neural representations *)
   List.mapi (fun i neural_id ->
     let weight = attention_weights.(i) in
-    if weight > 0.1 then begin  (* Only include high-attention items *)
-      let attention_tensor_id = Hypergraph.tensor_scale_op ctx.atomspace neural_id weight in
-      attention_tensor_id
-    end else neural_id
+    if weight > 0.1 then  (* Only include high-attention items *)
+      Hypergraph.tensor_scale_op ctx.atomspace neural_id weight
+    else neural_id
   ) neural_ids
 
 (** Gradient-based symbolic learning *)
@@ -231,15 +337,15 @@ let compute_symbolic_gradients ctx symbolic_id target_neural_id =
   (* Compute gradients for updating symbolic representation *)
   match symbol_to_neural ctx symbolic_id Embedding_Based with
   | Some current_neural_id ->
-      let current_tensor = Hashtbl.find ctx.atomspace.tensors current_neural_id in
-      let target_tensor = Hashtbl.find ctx.atomspace.tensors target_neural_id in
+      let current_data = tensor_data ctx current_neural_id in
+      let target_data = tensor_data ctx target_neural_id in
       
       (* Simple gradient: difference between current and target *)
-      let gradients = Array.make (Array.length current_tensor.data) 0.0 in
+      let gradients = Array.make (Array.length current_data) 0.0 in
       Array.iteri (fun i current_val ->
-        let target_val = if i < Array.length target_tensor.data then target_tensor.data.(i) else 0.0 in
+        let target_val = if i < Array.length target_data then target_data.(i) else 0.0 in
         gradients.(i) <- ctx.learning_rate *. (target_val -. current_val)
-      ) current_tensor.data;
+      ) current_data;
       gradients
   | None -> Array.make ctx.embedding_dimension 0.0
 
@@ -247,19 +353,23 @@ let update_symbolic_knowledge ctx symbolic_id gradients =
   (* Update symbolic representation using gradients *)
   match symbol_to_neural ctx symbolic_id Embedding_Based with
   | Some neural_id ->
-      let tensor = Hashtbl.find ctx.atomspace.tensors neural_id in
-      let updated_data = Array.mapi (fun i v -> v +. gradients.(i)) tensor.data in
-      let shape = tensor.shape in
+      let (shape, values) = match tensor_entry ctx neural_id with
+        | Some entry -> entry
+        | None -> raise Not_found
+      in
+      let updated_data = Array.mapi (fun i v -> v +. gradients.(i)) values in
       let new_neural_id = Hypergraph.add_tensor ctx.atomspace shape updated_data (Some symbolic_id) in
       
       (* Update binding *)
       (try
          let binding = Hashtbl.find ctx.bindings symbolic_id in
+         unbind ctx symbolic_id;
          let updated_binding = { binding with 
            neural_id = new_neural_id; 
            last_updated = get_current_time () 
          } in
-         Hashtbl.replace ctx.bindings symbolic_id updated_binding
+         Hashtbl.replace ctx.bindings symbolic_id updated_binding;
+         index_binding ctx symbolic_id new_neural_id
        with Not_found -> ())
   | None -> ()
 
@@ -267,13 +377,24 @@ let neural_guided_inference ctx premise_id conclusions =
   (* Use neural similarity to guide symbolic inference *)
   match symbol_to_neural ctx premise_id Embedding_Based with
   | Some premise_neural_id ->
-      List.map (fun conclusion_id ->
-        match symbol_to_neural ctx conclusion_id Embedding_Based with
-        | Some conclusion_neural_id ->
-            let similarity = Hypergraph.tensor_cosine_similarity_op ctx.atomspace premise_neural_id conclusion_neural_id in
+      (* The premise is encoded once against the quantized store *)
+      let premise_query = store_query ctx premise_neural_id in
+      let bound = List.map (fun conclusion_id ->
+        (conclusion_id, symbol_to_neural ctx conclusion_id Embedding_Based)) conclusions in
+      (* Conclusions outside the store are scored in one batch *)
+      let exact = lazy (Hypergraph.tensor_cosine_similarities ctx.atomspace premise_neural_id
+        (List.map (function (_, Some neural_id) -> neural_id | (_, None) -> -1) bound)) in
+      List.mapi (fun i (conclusion_id, neural_opt) ->
+        match neural_opt with
+        | Some _ ->
+            let similarity = match premise_query with
+              | Some (store, query) when Embedding_store.mem store conclusion_id ->
+                  Embedding_store.query_cosine store query conclusion_id
+              | _ -> (Lazy.force exact).(i)
+            in
             (conclusion_id, similarity)
         | None -> (conclusion_id, 0.0)
-      ) conclusions
+      ) bound
       |> List.sort (fun (_, s1) (_, s2) -> compare s2 s1)  (* Sort by similarity descending *)
   | None -> List.map (fun id -> (id, 0.0)) conclusions
 
@@ -282,7 +403,7 @@ let enhanced_concept_similarity ctx symbolic_id1 symbolic_id2 =
   (* Enhanced similarity that considers both symbolic and neural aspects *)
   match symbol_to_neural ctx symbolic_id1 Embedding_Based, symbol_to_neural ctx symbolic_id2 Embedding_Based with
   | Some neural_id1, Some neural_id2 ->
-      let neural_similarity = Hypergraph.tensor_cosine_similarity_op ctx.atomspace neural_id1 neural_id2 in
+      let neural_similarity = binding_cosine ctx symbolic_id1 symbolic_id2 neural_id1 neural_id2 in
       
       (* Consider symbolic relationship *)
       let symbolic_similarity = 
@@ -297,6 +418,12 @@ let enhanced_concept_similarity ctx symbolic_id1 symbolic_id2 =
       0.8 *. neural_similarity +. 0.2 *. symbolic_similarity
   | _ -> 0.0
 
+let nearest_concepts ctx symbolic_id k =
+  Ann_index.neighbours ctx.embedding_index symbolic_id k
+
+let concepts_within ctx symbolic_id threshold =
+  Ann_index.neighbours_within ctx.embedding_index symbolic_id threshold
+
 let neural_symbolic_composition ctx symbolic_ids strategy =
   (* Compose multiple symbols into new neural representation *)
   compositional_reasoning ctx symbolic_ids strategy
@@ -306,14 +433,21 @@ let cross_modal_attention ctx symbolic_ids neural_ids =
   let num_symbols = List.length symbolic_ids in
   let num_neural = List.length neural_ids in
   let attention_matrix = Array.make (num_symbols * num_neural) 0.0 in
+  (* Each neural tensor is encoded once and scored against quantized rows *)
+  let neural_queries = List.map (store_query ctx) neural_ids in
   
   List.iteri (fun i symbolic_id ->
     match symbol_to_neural ctx symbolic_id Embedding_Based with
     | Some symbolic_neural_id ->
-        List.iteri (fun j neural_id ->
-          let similarity = Hypergraph.tensor_cosine_similarity_op ctx.atomspace symbolic_neural_id neural_id in
+        let exact = lazy (Hypergraph.tensor_cosine_similarities ctx.atomspace symbolic_neural_id neural_ids) in
+        List.iteri (fun j query ->
+          let similarity = match query with
+            | Some (store, query) when Embedding_store.mem store symbolic_id ->
+                Embedding_store.query_cosine store query symbolic_id
+            | _ -> (Lazy.force exact).(j)
+          in
           attention_matrix.(i * num_neural + j) <- similarity
-        ) neural_ids
+        ) neural_queries
     | None -> ()
   ) symbolic_ids;
   
@@ -328,8 +462,7 @@ let neural_guided_tactic_suggestion ctx goal_id =
   (* In a full implementation, this would use learned neural patterns *)
   match symbol_to_neural ctx goal_id Embedding_Based with
   | Some goal_neural_id ->
-      let goal_tensor = Hashtbl.find ctx.atomspace.tensors goal_neural_id in
-      let complexity = Array.fold_left (+.) 0.0 goal_tensor.data in
+      let complexity = Array.fold_left (+.) 0.0 (tensor_data ctx goal_neural_id) in
       if complexity > 2.0 then ["induction"; "destruct"; "apply"]
       else if complexity > 1.0 then ["simpl"; "auto"; "reflexivity"]
       else ["auto"; "reflexivity"]
@@ -367,19 +500,45 @@ let reinforcement_update ctx symbolic_id reward =
   with Not_found -> ()
 
 let discover_neural_patterns ctx neural_ids =
-  (* Discover patterns in neural representations *)
-  let patterns = ref [] in
+  (* Discover patterns in neural representations: pairs of tensors with
+     cosine similarity above 0.7, reported against the earlier tensor.
+     Tensors of one shape share an HNSW index keyed by list position, so
+     each tensor costs one radius query instead of a pass over the list. *)
+  let threshold = 0.7 in
+  let tensors = Array.of_list neural_ids in
+  let indexes = Hashtbl.create 8 in
+  let entries = Array.map (fun neural_id ->
+    match tensor_entry ctx neural_id with
+    | Some (shape, values) ->
+        if Array.length values = 0 then None
+        else begin
+          let index = match Hashtbl.find_opt indexes shape with
+            | Some index -> index
+            | None ->
+                let index = Ann_index.create (Array.length values) in
+                Hashtbl.add indexes shape index;
+                index
+          in
+          Some (index, values)
+        end
+    | None -> None
+  ) tensors in
+  Array.iteri (fun position entry ->
+    match entry with
+    | Some (index, values) -> Ann_index.add index position values
+    | None -> ()
+  ) entries;
   
-  (* Simple pattern discovery: find clusters of similar tensors *)
-  for i = 0 to List.length neural_ids - 1 do
-    for j = i + 1 to List.length neural_ids - 1 do
-      let id1 = List.nth neural_ids i in
-      let id2 = List.nth neural_ids j in
-      let similarity = Hypergraph.tensor_cosine_similarity_op ctx.atomspace id1 id2 in
-      if similarity > 0.7 then
-        patterns := (id1, similarity) :: !patterns
-    done
-  done;
+  let patterns = ref [] in
+  Array.iteri (fun i entry ->
+    match entry with
+    | Some (index, _) ->
+        List.iter (fun (j, similarity) ->
+          if j > i && similarity > threshold then
+            patterns := (tensors.(i), similarity) :: !patterns
+        ) (Ann_index.neighbours_within index i threshold)
+    | None -> ()
+  ) entries;
   
   !patterns
 
@@ -441,6 +600,9 @@ let get_fusion_statistics ctx =
     ("average_strength", avg_strength);
     ("embedding_dimension", float_of_int ctx.embedding_dimension);
     ("learning_rate", ctx.learning_rate);
+    ("quantized_embedding_bytes", match ctx.embedding_store with
+      | Some store -> float_of_int (Embedding_store.memory_bytes store)
+      | None -> 0.0);
   ]
 
 (** Integration with gradient-based attention optimization *)
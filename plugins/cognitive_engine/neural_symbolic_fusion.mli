@@ -32,11 +32,29 @@ type fusion_context = {
   mutable fusion_history : neural_symbolic_binding list;
   embedding_dimension : int;
   learning_rate : float;
+  embedding_index : Ann_index.t;
+    (** HNSW index over the bound embeddings, keyed by symbolic id *)
+  mutable embedding_store : Embedding_store.t option;
+    (** Quantized bound embeddings, keyed by symbolic id *)
+  released : (int, int) Hashtbl.t;
+    (** Bound tensors external to the AtomSpace, their values held by
+        [embedding_store]: neural id -> symbolic id *)
 }
 
 (** Create fusion context *)
 val create_fusion_context : Hypergraph.atomspace -> int -> fusion_context
 
+(** Move bound embeddings into a quantized store, existing bindings and
+    every later one. The store becomes their only copy: the AtomSpace
+    keeps their tensor ids as external tensors, so lookups, tensor
+    operations and saves see the dequantized values. A write to one of
+    them, or rebinding its symbol, turns it back into a float tensor. *)
+val use_quantized_embeddings : fusion_context -> Embedding_store.format -> unit
+
+(** Put the stored embeddings back into the AtomSpace as float tensors
+    under their ids and drop the store *)
+val use_float_embeddings : fusion_context -> unit
+
 (** Enhanced bidirectional translation *)
 val symbol_to_neural : fusion_context -> int -> fusion_strategy -> int option
 val neural_to_symbol : fusion_context -> int -> int option
@@ -57,6 +75,10 @@ val enhanced_concept_similarity : fusion_context -> int -> int -> float
 val neural_symbolic_composition : fusion_context -> int list -> fusion_strategy -> int
 val cross_modal_attention : fusion_context -> int list -> int list -> float array
 
+(** Approximate nearest bound symbols by embedding cosine, best first *)
+val nearest_concepts : fusion_context -> int -> int -> (int * float) list
+val concepts_within : fusion_context -> int -> float -> (int * float) list
+
 (** Proof-theoretic integration *)
 val neural_guided_tactic_suggestion : fusion_context -> int -> string list
 val symbolic_constraint_neural_search : fusion_context -> int list -> int list -> int list
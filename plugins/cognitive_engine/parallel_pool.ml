@@ -0,0 +1,103 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Process Pool Implementation
+
+    Work is distributed to forked children, which inherit the parent's
+    heap copy-on-write and marshal their results back through a pipe.
+    This gives true multi-core execution for read-only work (rule
+    matching, fitness evaluation) without requiring the AtomSpace to be
+    thread-safe.
+*)
+
+let default_workers = 4
+
+let chunk n items =
+  let len = Array.length items in
+  let n = max 1 (min n len) in
+  Array.init n (fun i ->
+    let start = i * len / n in
+    let stop = (i + 1) * len / n in
+    Array.sub items start (stop - start))
+
+(* Longest first onto the lightest chunk; each chunk keeps input order *)
+let balance n weight items =
+  let len = Array.length items in
+  let n = max 1 (min n len) in
+  let order = Array.init len (fun i -> i) in
+  let weights = Array.map weight items in
+  Array.stable_sort (fun i j -> compare weights.(j) weights.(i)) order;
+  let loads = Array.make n 0 in
+  let owner = Array.make len 0 in
+  Array.iter (fun i ->
+    let lightest = ref 0 in
+    for c = 1 to n - 1 do
+      if loads.(c) < loads.(!lightest) then lightest := c
+    done;
+    owner.(i) <- !lightest;
+    loads.(!lightest) <- loads.(!lightest) + max 1 weights.(i)
+  ) order;
+  let chunks = Array.make n [] in
+  for i = len - 1 downto 0 do
+    chunks.(owner.(i)) <- items.(i) :: chunks.(owner.(i))
+  done;
+  Array.map Array.of_list chunks
+
+type 'b outcome =
+  | Done of 'b
+  | Failed of string
+
+let can_fork = Sys.os_type = "Unix"
+
+(** Fork one child computing [f item]; returns its pid and result pipe *)
+let spawn f item =
+  let (read_fd, write_fd) = Unix.pipe () in
+  match Unix.fork () with
+  | 0 ->
+    Unix.close read_fd;
+    let outcome =
+      try Done (f item)
+      with e -> Failed (Printexc.to_string e)
+    in
+    let oc = Unix.out_channel_of_descr write_fd in
+    (try
+       Marshal.to_channel oc outcome [];
+       close_out oc
+     with _ -> ());
+    (* Skip at_exit handlers, which would flush buffers inherited from
+       the parent a second time *)
+    Unix._exit 0
+  | pid ->
+    Unix.close write_fd;
+    (pid, read_fd)
+
+(* Read one child's outcome and reap it; never raises, so a failing
+   worker cannot leave its siblings unreaped *)
+let collect (pid, read_fd) =
+  let ic = Unix.in_channel_of_descr read_fd in
+  let outcome =
+    try (Marshal.from_channel ic : 'b outcome)
+    with End_of_file | Failure _ -> Failed "worker exited without a result"
+  in
+  close_in_noerr ic;
+  (try ignore (Unix.waitpid [] pid) with Unix.Unix_error _ -> ());
+  outcome
+
+let map ~workers f items =
+  if workers <= 1 || Array.length items <= 1 || not can_fork then
+    Array.map f items
+  else begin
+    let chunks = chunk workers items in
+    flush_all ();
+    let children = Array.map (spawn (Array.map f)) chunks in
+    (* Wait for every worker before reporting the first failure *)
+    let outcomes = Array.map collect children in
+    Array.concat (Array.to_list (Array.map (function
+      | Done result -> result
+      | Failed msg -> failwith ("Parallel_pool worker failed: " ^ msg)) outcomes))
+  end
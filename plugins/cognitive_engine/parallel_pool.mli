@@ -0,0 +1,33 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Process Pool - fork-based parallel map for pure work items *)
+
+(** Default number of workers *)
+val default_workers : int
+
+(** Whether [map] can fork workers on this platform; when false it
+    always runs sequentially *)
+val can_fork : bool
+
+(** Split an array into at most [n] contiguous chunks of near-equal size *)
+val chunk : int -> 'a array -> 'a array array
+
+(** [balance n weight items] splits [items] into at most [n] chunks of
+    near-equal total [weight], for work whose cost varies per item.
+    Items keep their relative order within a chunk. *)
+val balance : int -> ('a -> int) -> 'a array -> 'a array array
+
+(** [map ~workers f items] applies [f] to every item in forked worker
+    processes and returns the results in order. Each worker receives the
+    parent's heap copy-on-write, so [f] may read shared state freely but
+    its side effects are not visible to the parent. Results are
+    marshalled back and must not contain closures. Runs sequentially
+    when [workers <= 1], when there is a single item, or on platforms
+    without [fork]. A failing worker raises [Failure] in the parent. *)
+val map : workers:int -> ('a -> 'b) -> 'a array -> 'b array
@@ -43,7 +43,7 @@ type serialized_node = {
   sn_confidence: float;
   sn_sti: float;
   sn_lti: float;
-  sn_vlti: bool;
+  sn_vlti: float;
 }
 
 (** Serialized link *)
@@ -55,7 +55,7 @@ type serialized_link = {
   sl_confidence: float;
   sl_sti: float;
   sl_lti: float;
-  sl_vlti: bool;
+  sl_vlti: float;
 }
 
 (** Serialized atomspace *)
@@ -89,14 +89,14 @@ module JSON = struct
 
   (** Serialize node to JSON *)
   let node_to_json n =
-    Printf.sprintf "{\"id\":%d,\"type\":\"%s\",\"name\":\"%s\",\"strength\":%.6f,\"confidence\":%.6f,\"sti\":%.6f,\"lti\":%.6f,\"vlti\":%b}"
+    Printf.sprintf "{\"id\":%d,\"type\":\"%s\",\"name\":\"%s\",\"strength\":%.6f,\"confidence\":%.6f,\"sti\":%.6f,\"lti\":%.6f,\"vlti\":%.6f}"
       n.sn_id (escape_string n.sn_node_type) (escape_string n.sn_name)
       n.sn_strength n.sn_confidence n.sn_sti n.sn_lti n.sn_vlti
 
   (** Serialize link to JSON *)
   let link_to_json l =
     let outgoing_str = String.concat "," (List.map string_of_int l.sl_outgoing) in
-    Printf.sprintf "{\"id\":%d,\"type\":\"%s\",\"outgoing\":[%s],\"strength\":%.6f,\"confidence\":%.6f,\"sti\":%.6f,\"lti\":%.6f,\"vlti\":%b}"
+    Printf.sprintf "{\"id\":%d,\"type\":\"%s\",\"outgoing\":[%s],\"strength\":%.6f,\"confidence\":%.6f,\"sti\":%.6f,\"lti\":%.6f,\"vlti\":%.6f}"
       l.sl_id (escape_string l.sl_link_type) outgoing_str
       l.sl_strength l.sl_confidence l.sl_sti l.sl_lti l.sl_vlti
 
@@ -196,7 +196,7 @@ module Binary = struct
     write_float64 buf n.sn_confidence;
     write_float64 buf n.sn_sti;
     write_float64 buf n.sn_lti;
-    Buffer.add_char buf (if n.sn_vlti then '\001' else '\000')
+    write_float64 buf n.sn_vlti
 
   (** Serialize link to binary *)
   let write_link buf l =
@@ -208,7 +208,7 @@ module Binary = struct
     write_float64 buf l.sl_confidence;
     write_float64 buf l.sl_sti;
     write_float64 buf l.sl_lti;
-    Buffer.add_char buf (if l.sl_vlti then '\001' else '\000')
+    write_float64 buf l.sl_vlti
 
   (** Serialize atomspace to binary *)
   let atomspace_to_binary as_ =
@@ -242,10 +242,49 @@ module Binary = struct
   let read_string s offset =
     let len = read_int32 s offset in
     (String.sub s (offset + 4) len, offset + 4 + len)
+
+  (** Write int64 (atom ids) to buffer *)
+  let write_int64 buf i =
+    for k = 0 to 7 do
+      Buffer.add_char buf (Char.chr ((i lsr (k * 8)) land 0xFF))
+    done
+
+  (** Read int64 from string at offset *)
+  let read_int64 s offset =
+    let v = ref 0 in
+    for k = 7 downto 0 do
+      v := (!v lsl 8) lor Char.code s.[offset + k]
+    done;
+    !v
+
+  let crc_table = lazy (Array.init 256 (fun n ->
+    let c = ref n in
+    for _ = 0 to 7 do
+      c := if !c land 1 <> 0 then 0xEDB88320 lxor (!c lsr 1) else !c lsr 1
+    done;
+    !c))
+
+  (** CRC-32 (IEEE) of [len] bytes of [s] from [offset] *)
+  let crc32 s offset len =
+    let table = Lazy.force crc_table in
+    let c = ref 0xFFFFFFFF in
+    for i = offset to offset + len - 1 do
+      c := table.((!c lxor Char.code (String.unsafe_get s i)) land 0xFF) lxor (!c lsr 8)
+    done;
+    !c lxor 0xFFFFFFFF
 end
 
 (** {1 Write-Ahead Log} *)
 
+(** Log file of length-prefixed binary records, each
+    [payload length (u32) | CRC-32 of payload (u32) | payload], the
+    payload being the sequence number (u64), an operation tag and the
+    operation's full node or link data. Records are written through a
+    descriptor kept open: one at a time and fsynced under [Sync_always],
+    a group at a time under [Sync_interval], each group fsynced once the
+    interval has passed. Checkpoints truncate the file, so it
+    only holds what the last save does not. Reading stops at the first
+    short or corrupt record: the tail of a write cut off by a crash. *)
 module WAL = struct
   type operation =
     | AddNode of serialized_node
@@ -256,74 +295,271 @@ module WAL = struct
     | DeleteLink of int
     | Checkpoint
 
+  type sync_policy =
+    | Sync_always              (** write and fsync every record *)
+    | Sync_interval of float   (** write groups, or sooner once this many
+                                   seconds have passed, and fsync then *)
+    | Sync_never               (** write every record, leave write-back to the OS *)
+
   type wal = {
     mutable operations: operation list;
     mutable sequence: int;
     path: string option;
+    group_size: int;
+    sync_policy: sync_policy;
+    pending: Buffer.t;               (** encoded records not yet written *)
+    mutable pending_records: int;
+    mutable last_sync: float;
+    mutable fd: Unix.file_descr option;
   }
 
-  let create ?path () = {
+  let header_size = 8
+
+  let create ?path ?(group_size=64) ?(sync=Sync_interval 1.0) () = {
     operations = [];
     sequence = 0;
     path;
+    group_size = max 1 group_size;
+    sync_policy = sync;
+    pending = Buffer.create 4096;
+    pending_records = 0;
+    last_sync = Unix.gettimeofday ();
+    fd = None;
   }
 
+  (** {2 Record encoding} *)
+
+  let write_values buf strength confidence sti lti vlti =
+    List.iter (Binary.write_float64 buf) [strength; confidence; sti; lti; vlti]
+
+  let write_node buf n =
+    Binary.write_int64 buf n.sn_id;
+    Binary.write_string buf n.sn_node_type;
+    Binary.write_string buf n.sn_name;
+    write_values buf n.sn_strength n.sn_confidence n.sn_sti n.sn_lti n.sn_vlti
+
+  let write_link buf l =
+    Binary.write_int64 buf l.sl_id;
+    Binary.write_string buf l.sl_link_type;
+    Binary.write_int32 buf (List.length l.sl_outgoing);
+    List.iter (Binary.write_int64 buf) l.sl_outgoing;
+    write_values buf l.sl_strength l.sl_confidence l.sl_sti l.sl_lti l.sl_vlti
+
+  let encode_payload buf sequence op =
+    Binary.write_int64 buf sequence;
+    match op with
+    | AddNode n -> Buffer.add_char buf 'N'; write_node buf n
+    | UpdateNode n -> Buffer.add_char buf 'n'; write_node buf n
+    | DeleteNode id -> Buffer.add_char buf 'D'; Binary.write_int64 buf id
+    | AddLink l -> Buffer.add_char buf 'L'; write_link buf l
+    | UpdateLink l -> Buffer.add_char buf 'l'; write_link buf l
+    | DeleteLink id -> Buffer.add_char buf 'E'; Binary.write_int64 buf id
+    | Checkpoint -> Buffer.add_char buf 'C'
+
+  let read_values s pos =
+    let f i = Binary.read_float64 s (pos + 8 * i) in
+    (f 0, f 1, f 2, f 3, f 4)
+
+  let read_node s pos =
+    let id = Binary.read_int64 s pos in
+    let (node_type, p) = Binary.read_string s (pos + 8) in
+    let (name, p) = Binary.read_string s p in
+    let (strength, confidence, sti, lti, vlti) = read_values s p in
+    { sn_id = id; sn_node_type = node_type; sn_name = name;
+      sn_strength = strength; sn_confidence = confidence;
+      sn_sti = sti; sn_lti = lti; sn_vlti = vlti }
+
+  let read_link s pos =
+    let id = Binary.read_int64 s pos in
+    let (link_type, p) = Binary.read_string s (pos + 8) in
+    let arity = Binary.read_int32 s p in
+    let outgoing = List.init arity (fun i -> Binary.read_int64 s (p + 4 + 8 * i)) in
+    let (strength, confidence, sti, lti, vlti) = read_values s (p + 4 + 8 * arity) in
+    { sl_id = id; sl_link_type = link_type; sl_outgoing = outgoing;
+      sl_strength = strength; sl_confidence = confidence;
+      sl_sti = sti; sl_lti = lti; sl_vlti = vlti }
+
+  let decode_payload s =
+    match s.[8] with
+    | 'N' -> AddNode (read_node s 9)
+    | 'n' -> UpdateNode (read_node s 9)
+    | 'D' -> DeleteNode (Binary.read_int64 s 9)
+    | 'L' -> AddLink (read_link s 9)
+    | 'l' -> UpdateLink (read_link s 9)
+    | 'E' -> DeleteLink (Binary.read_int64 s 9)
+    | 'C' -> Checkpoint
+    | _ -> failwith "Unknown WAL record"
+
+  (** {2 Group commit} *)
+
+  let descriptor wal path =
+    match wal.fd with
+    | Some fd -> fd
+    | None ->
+      let fd = Unix.openfile path [Unix.O_WRONLY; Unix.O_CREAT; Unix.O_APPEND] 0o644 in
+      wal.fd <- Some fd;
+      fd
+
+  (** Write the buffered group; [force] fsyncs whatever the policy *)
+  let commit ?(force=false) wal =
+    match wal.path with
+    | Some path when wal.pending_records > 0 || force ->
+      let fd = descriptor wal path in
+      let data = Buffer.to_bytes wal.pending in
+      ignore (Unix.write fd data 0 (Bytes.length data));
+      Buffer.clear wal.pending;
+      wal.pending_records <- 0;
+      let now = Unix.gettimeofday () in
+      let due = match wal.sync_policy with
+        | Sync_always -> true
+        | Sync_interval seconds -> now -. wal.last_sync >= seconds
+        | Sync_never -> false
+      in
+      if force || due then begin
+        Unix.fsync fd;
+        wal.last_sync <- now
+      end
+    | _ -> ()
+
+  let flush wal = commit ~force:true wal
+
+  let add_record buf sequence op =
+    let payload = Buffer.create 64 in
+    encode_payload payload sequence op;
+    let bytes = Buffer.contents payload in
+    Binary.write_int32 buf (String.length bytes);
+    Binary.write_int32 buf (Binary.crc32 bytes 0 (String.length bytes));
+    Buffer.add_string buf bytes
+
+  (* Only the interval policy holds records back; an acknowledged append
+     is otherwise already written *)
+  let commit_due wal =
+    match wal.sync_policy with
+    | Sync_always | Sync_never -> true
+    | Sync_interval seconds ->
+      wal.pending_records >= wal.group_size
+      || Unix.gettimeofday () -. wal.last_sync >= seconds
+
   let append wal op =
     wal.operations <- op :: wal.operations;
     wal.sequence <- wal.sequence + 1;
-    (* Optionally write to disk *)
+    match wal.path with
+    | Some _ ->
+      add_record wal.pending wal.sequence op;
+      wal.pending_records <- wal.pending_records + 1;
+      if commit_due wal then commit wal
+    | None -> ()
+
+  let sequence wal = wal.sequence
+  let operations wal = wal.operations
+  let pending_records wal = wal.pending_records
+
+  (** Drop the log; everything it held is in the snapshot just saved *)
+  let truncate wal =
+    Buffer.clear wal.pending;
+    wal.pending_records <- 0;
     match wal.path with
     | Some path ->
-      let oc = open_out_gen [Open_append; Open_creat] 0o644 path in
-      let op_str = match op with
-        | AddNode n -> Printf.sprintf "AN:%d:%s:%s\n" n.sn_id n.sn_node_type n.sn_name
-        | UpdateNode n -> Printf.sprintf "UN:%d\n" n.sn_id
-        | DeleteNode id -> Printf.sprintf "DN:%d\n" id
-        | AddLink l -> Printf.sprintf "AL:%d:%s\n" l.sl_id l.sl_link_type
-        | UpdateLink l -> Printf.sprintf "UL:%d\n" l.sl_id
-        | DeleteLink id -> Printf.sprintf "DL:%d\n" id
-        | Checkpoint -> "CP\n"
-      in
-      output_string oc op_str;
-      close_out oc
+      (match wal.fd with
+       | Some fd -> Unix.ftruncate fd 0
+       | None -> if Sys.file_exists path then Unix.truncate path 0)
     | None -> ()
 
-  let checkpoint wal =
-    append wal Checkpoint;
+  (** Mark everything logged so far as saved, leaving the file alone *)
+  let reset wal =
+    wal.sequence <- wal.sequence + 1;
     wal.operations <- [Checkpoint]
 
+  let checkpoint wal =
+    flush wal;
+    truncate wal;
+    (match wal.fd with Some fd -> Unix.fsync fd | None -> ());
+    reset wal
+
+  let close wal =
+    if wal.fd <> None || wal.pending_records > 0 then flush wal;
+    match wal.fd with
+    | Some fd ->
+      Unix.close fd;
+      wal.fd <- None
+    | None -> ()
+
   let clear wal =
     wal.operations <- [];
+    Buffer.clear wal.pending;
+    wal.pending_records <- 0;
+    (match wal.fd with
+     | Some fd -> Unix.close fd; wal.fd <- None
+     | None -> ());
     match wal.path with
-    | Some path -> 
+    | Some path ->
       (try Sys.remove path with _ -> ())
     | None -> ()
-end
-
-(** {1 Persistence Store} *)
 
-type store = {
-  backend: backend_type;
-  mutable wal: WAL.wal;
-  mutable dirty: bool;
-  mutable last_save: float;
-  auto_save_interval: float;  (** Seconds between auto-saves *)
-}
+  (** {2 Replay} *)
+
+  (** Operations in the log file at [path], oldest first *)
+  let read_file path =
+    if not (Sys.file_exists path) then []
+    else begin
+      let ic = open_in_bin path in
+      let size = in_channel_length ic in
+      let rec loop acc =
+        let pos = pos_in ic in
+        if pos + header_size > size then acc
+        else begin
+          let header = really_input_string ic header_size in
+          let len = Binary.read_int32 header 0 in
+          if len < 9 || pos + header_size + len > size then acc
+          else begin
+            let payload = really_input_string ic len in
+            if Binary.crc32 payload 0 len <> Binary.read_int32 header 4 then acc
+            else match decode_payload payload with
+              | op -> loop (op :: acc)
+              | exception _ -> acc
+          end
+        end
+      in
+      let ops = loop [] in
+      close_in ic;
+      List.rev ops
+    end
 
-(** Create a new store *)
-let create_store ?(auto_save_interval=60.0) backend =
-  let wal_path = match backend with
-    | RocksDB path | SQLite path -> Some (path ^ ".wal")
-    | FileJSON path | FileBinary path -> Some (path ^ ".wal")
-    | InMemory -> None
-  in
-  {
-    backend;
-    wal = WAL.create ?path:wal_path ();
-    dirty = false;
-    last_save = Unix.gettimeofday ();
-    auto_save_interval;
-  }
+  (** Logged operations not covered by the last checkpoint, oldest first *)
+  let replay wal =
+    match wal.path with
+    | Some path -> List.filter (fun op -> op <> Checkpoint) (read_file path)
+    | None -> []
+
+  (** Make the log hold exactly [ops], e.g. after replaying them onto a
+      freshly loaded base that does not contain them. The new log is
+      written beside the old one and renamed over it, so a crash leaves
+      one or the other whole. *)
+  let restore wal ops =
+    Buffer.clear wal.pending;
+    wal.pending_records <- 0;
+    reset wal;
+    let records = Buffer.create 4096 in
+    List.iter (fun op ->
+      wal.sequence <- wal.sequence + 1;
+      wal.operations <- op :: wal.operations;
+      add_record records wal.sequence op
+    ) ops;
+    match wal.path with
+    | Some path ->
+      (match wal.fd with
+       | Some fd -> Unix.close fd; wal.fd <- None
+       | None -> ());
+      let tmp = path ^ ".tmp" in
+      let fd = Unix.openfile tmp [Unix.O_WRONLY; Unix.O_CREAT; Unix.O_TRUNC] 0o644 in
+      Fun.protect ~finally:(fun () -> Unix.close fd) (fun () ->
+        let data = Buffer.to_bytes records in
+        ignore (Unix.write fd data 0 (Bytes.length data));
+        Unix.fsync fd);
+      Unix.rename tmp path;
+      wal.last_sync <- Unix.gettimeofday ()
+    | None -> ()
+end
 
 (** {1 AtomSpace Conversion} *)
 
@@ -333,8 +569,8 @@ let serialize_node (node : Hypergraph.node) : serialized_node =
     sn_id = node.id;
     sn_node_type = Hypergraph.node_type_to_string node.node_type;
     sn_name = node.name;
-    sn_strength = node.strength;
-    sn_confidence = node.confidence;
+    sn_strength = fst node.truth_value;
+    sn_confidence = snd node.truth_value;
     sn_sti = node.attention.sti;
     sn_lti = node.attention.lti;
     sn_vlti = node.attention.vlti;
@@ -346,8 +582,8 @@ let serialize_link (link : Hypergraph.link) : serialized_link =
     sl_id = link.id;
     sl_link_type = Hypergraph.link_type_to_string link.link_type;
     sl_outgoing = link.outgoing;
-    sl_strength = link.strength;
-    sl_confidence = link.confidence;
+    sl_strength = fst link.truth_value;
+    sl_confidence = snd link.truth_value;
     sl_sti = link.attention.sti;
     sl_lti = link.attention.lti;
     sl_vlti = link.attention.vlti;
@@ -355,16 +591,14 @@ let serialize_link (link : Hypergraph.link) : serialized_link =
 
 (** Serialize entire atomspace *)
 let serialize_atomspace atomspace =
-  let nodes = Hypergraph.get_all_nodes atomspace |> List.map (fun id ->
-    match Hypergraph.get_node atomspace id with
-    | Some n -> serialize_node n
-    | None -> failwith "Node not found"
-  ) in
-  let links = Hypergraph.get_all_links atomspace |> List.map (fun id ->
-    match Hypergraph.get_link atomspace id with
-    | Some l -> serialize_link l
-    | None -> failwith "Link not found"
-  ) in
+  let nodes =
+    Hypergraph.fold_nodes (fun n acc -> serialize_node n :: acc) atomspace []
+    |> List.sort (fun a b -> compare a.sn_id b.sn_id)
+  in
+  let links =
+    Hypergraph.fold_links (fun l acc -> serialize_link l :: acc) atomspace []
+    |> List.sort (fun a b -> compare a.sl_id b.sl_id)
+  in
   {
     version = "1.0";
     timestamp = Unix.gettimeofday ();
@@ -378,6 +612,749 @@ let serialize_atomspace atomspace =
     ];
   }
 
+(** {1 RocksDB Store} *)
+
+(** Incremental RocksDB layout. Ids are stored as fixed-width big-endian
+    integers so keys sort numerically:
+
+    - [Nodes]:       node id           -> type, name
+    - [Links]:       link id           -> type, varint arity, varint outgoing ids
+    - [Incoming]:    node id ^ link id -> empty (one key per membership)
+    - [Attention]:   kind ^ atom id    -> sti, lti, vlti as float64
+    - [TruthValues]: kind ^ atom id    -> strength, confidence as float64
+
+    [kind] is ['n'] or ['l'], as node and link ids overlap. Saving
+    writes only the atoms in the AtomSpace's change log, so its cost
+    follows the number of changes rather than the AtomSpace size. *)
+module RocksStore = struct
+  module R = Rocksdb_native
+
+  let id_key id =
+    let b = Bytes.create 8 in
+    Bytes.set_int64_be b 0 (Int64.of_int id);
+    Bytes.unsafe_to_string b
+
+  let id_of_key s offset =
+    Int64.to_int (Bytes.get_int64_be (Bytes.unsafe_of_string s) offset)
+
+  let atom_key kind id =
+    let b = Bytes.create 9 in
+    Bytes.set b 0 kind;
+    Bytes.set_int64_be b 1 (Int64.of_int id);
+    Bytes.unsafe_to_string b
+
+  let incoming_key node_id link_id =
+    let b = Bytes.create 16 in
+    Bytes.set_int64_be b 0 (Int64.of_int node_id);
+    Bytes.set_int64_be b 8 (Int64.of_int link_id);
+    Bytes.unsafe_to_string b
+
+  (** Unsigned LEB128 *)
+  let rec add_varint buf n =
+    if n < 0x80 then Buffer.add_char buf (Char.chr n)
+    else begin
+      Buffer.add_char buf (Char.chr (n land 0x7F lor 0x80));
+      add_varint buf (n lsr 7)
+    end
+
+  let read_varint s offset =
+    let rec go pos shift acc =
+      let b = Char.code s.[pos] in
+      let acc = acc lor ((b land 0x7F) lsl shift) in
+      if b < 0x80 then (acc, pos + 1) else go (pos + 1) (shift + 7) acc
+    in
+    go offset 0 0
+
+  (* Built-in type names take one byte; custom link types are spelled out *)
+  let type_names = [|
+    "Concept"; "Predicate"; "Variable"; "Number"; "LinkType"; "Schema";
+    "Inheritance"; "Similarity"; "Implication"; "Evaluation"; "Execution";
+  |]
+
+  let custom_type_tag = '\255'
+
+  let add_type buf name =
+    let rec find i =
+      if i = Array.length type_names then begin
+        Buffer.add_char buf custom_type_tag;
+        add_varint buf (String.length name);
+        Buffer.add_string buf name
+      end else if type_names.(i) = name then
+        Buffer.add_char buf (Char.chr i)
+      else
+        find (i + 1)
+    in
+    find 0
+
+  let read_type s offset =
+    if s.[offset] = custom_type_tag then
+      let (len, pos) = read_varint s (offset + 1) in
+      (String.sub s pos len, pos + len)
+    else
+      (type_names.(Char.code s.[offset]), offset + 1)
+
+  (** Node value: type and name *)
+  let encode_node n =
+    let buf = Buffer.create (String.length n.sn_name + 2) in
+    add_type buf n.sn_node_type;
+    Buffer.add_string buf n.sn_name;
+    Buffer.contents buf
+
+  let decode_node s =
+    let (node_type, pos) = read_type s 0 in
+    (node_type, String.sub s pos (String.length s - pos))
+
+  (** Link value: type and outgoing set *)
+  let encode_link l =
+    let buf = Buffer.create 16 in
+    add_type buf l.sl_link_type;
+    add_varint buf (List.length l.sl_outgoing);
+    List.iter (add_varint buf) l.sl_outgoing;
+    Buffer.contents buf
+
+  let decode_link s =
+    let (link_type, pos) = read_type s 0 in
+    let (arity, pos) = read_varint s pos in
+    let rec read_ids k pos acc =
+      if k = 0 then List.rev acc
+      else
+        let (id, pos) = read_varint s pos in
+        read_ids (k - 1) pos (id :: acc)
+    in
+    (link_type, read_ids arity pos [])
+
+  let encode_floats values =
+    let b = Bytes.create (8 * Array.length values) in
+    Array.iteri (fun i f -> Bytes.set_int64_le b (8 * i) (Int64.bits_of_float f)) values;
+    Bytes.unsafe_to_string b
+
+  let decode_float s i =
+    Int64.float_of_bits (Bytes.get_int64_le (Bytes.unsafe_of_string s) (8 * i))
+
+  let put_values db batch kind id sti lti vlti strength confidence =
+    let key = atom_key kind id in
+    R.batch_put_cf db batch R.Attention key (encode_floats [| sti; lti; vlti |]);
+    R.batch_put_cf db batch R.TruthValues key (encode_floats [| strength; confidence |])
+
+  let delete_values db batch kind id =
+    let key = atom_key kind id in
+    R.batch_delete_cf db batch R.Attention key;
+    R.batch_delete_cf db batch R.TruthValues key
+
+  let put_node db batch n =
+    R.batch_put_cf db batch R.Nodes (id_key n.sn_id) (encode_node n);
+    put_values db batch 'n' n.sn_id n.sn_sti n.sn_lti n.sn_vlti n.sn_strength n.sn_confidence
+
+  let put_link db batch l =
+    R.batch_put_cf db batch R.Links (id_key l.sl_id) (encode_link l);
+    List.iter (fun node_id ->
+      R.batch_put_cf db batch R.Incoming (incoming_key node_id l.sl_id) ""
+    ) (List.sort_uniq compare l.sl_outgoing);
+    put_values db batch 'l' l.sl_id l.sl_sti l.sl_lti l.sl_vlti l.sl_strength l.sl_confidence
+
+  let delete_node db batch id =
+    R.batch_delete_cf db batch R.Nodes (id_key id);
+    delete_values db batch 'n' id
+
+  let delete_link db batch id outgoing =
+    R.batch_delete_cf db batch R.Links (id_key id);
+    List.iter (fun node_id ->
+      R.batch_delete_cf db batch R.Incoming (incoming_key node_id id)
+    ) (List.sort_uniq compare outgoing);
+    delete_values db batch 'l' id
+
+  (** Outgoing set of a stored link *)
+  let stored_outgoing db id =
+    match R.get ~cf:R.Links db (id_key id) with
+    | Some v -> snd (decode_link v)
+    | None -> []
+
+  (** Entries per batch when writing a whole AtomSpace *)
+  let batch_limit = 100_000
+
+  (** Write a whole serialized AtomSpace and drop stored atoms it no
+      longer contains. Used once per session, before the WAL takes over. *)
+  let write_atomspace db (as_ : serialized_atomspace) =
+    let live_nodes = Hashtbl.create (as_.node_count + 1) in
+    let live_links = Hashtbl.create (as_.link_count + 1) in
+    List.iter (fun n -> Hashtbl.replace live_nodes n.sn_id ()) as_.nodes;
+    List.iter (fun l -> Hashtbl.replace live_links l.sl_id ()) as_.links;
+    let stale_nodes = R.iter_fold ~cf:R.Nodes db ~init:[] ~f:(fun acc key _ ->
+      let id = id_of_key key 0 in
+      if Hashtbl.mem live_nodes id then acc else id :: acc) in
+    let stale_links = R.iter_fold ~cf:R.Links db ~init:[] ~f:(fun acc key value ->
+      let id = id_of_key key 0 in
+      if Hashtbl.mem live_links id then acc else (id, snd (decode_link value)) :: acc) in
+    let batch = R.batch_create () in
+    let write_if_full () =
+      if R.batch_count batch >= batch_limit then begin
+        R.batch_write db batch;
+        R.batch_clear batch
+      end
+    in
+    try
+      List.iter (fun id -> delete_node db batch id; write_if_full ()) stale_nodes;
+      List.iter (fun (id, outgoing) -> delete_link db batch id outgoing; write_if_full ()) stale_links;
+      List.iter (fun n -> put_node db batch n; write_if_full ()) as_.nodes;
+      List.iter (fun l -> put_link db batch l; write_if_full ()) as_.links;
+      R.batch_write db batch;
+      R.batch_destroy batch
+    with e ->
+      R.batch_destroy batch;
+      raise e
+
+  (** {2 Incremental Saves} *)
+
+  (** Write the atoms in [changes] as write batches: changed atoms are
+      rewritten from [atomspace] and atoms it no longer holds are
+      deleted. Values alone are rewritten for atoms whose records did
+      not change, and for every atom after a whole-column pass. The log
+      is cleared once everything is written. Returns the number of batch
+      entries written. *)
+  let write_changes db atomspace (changes : Hypergraph.change_log) =
+    let batch = R.batch_create () in
+    let count = ref 0 in
+    let write_if_full () =
+      if R.batch_count batch >= batch_limit then begin
+        count := !count + R.batch_count batch;
+        R.batch_write db batch;
+        R.batch_clear batch
+      end
+    in
+    let node_values n =
+      put_values db batch 'n' n.sn_id n.sn_sti n.sn_lti n.sn_vlti n.sn_strength n.sn_confidence in
+    let link_values l =
+      put_values db batch 'l' l.sl_id l.sl_sti l.sl_lti l.sl_vlti l.sl_strength l.sl_confidence in
+    let write_node id change =
+      (match Hypergraph.get_node atomspace id, change with
+       | Some node, Hypergraph.Values_changed -> node_values (serialize_node node)
+       | Some node, _ -> put_node db batch (serialize_node node)
+       | None, _ -> delete_node db batch id);
+      write_if_full ()
+    in
+    let write_link id change =
+      (match Hypergraph.get_link atomspace id, change with
+       | Some link, Hypergraph.Values_changed -> link_values (serialize_link link)
+       | Some link, Hypergraph.Added -> put_link db batch (serialize_link link)
+       | Some link, Hypergraph.Replaced ->
+         (* The stored link may have another outgoing set *)
+         delete_link db batch id (stored_outgoing db id);
+         put_link db batch (serialize_link link)
+       | None, _ -> delete_link db batch id (stored_outgoing db id));
+      write_if_full ()
+    in
+    try
+      Hashtbl.iter write_node changes.Hypergraph.node_changes;
+      Hashtbl.iter write_link changes.Hypergraph.link_changes;
+      if changes.Hypergraph.all_values_changed then begin
+        Hypergraph.iter_nodes (fun node ->
+          if not (Hashtbl.mem changes.Hypergraph.node_changes node.Hypergraph.id) then begin
+            node_values (serialize_node node);
+            write_if_full ()
+          end) atomspace;
+        Hypergraph.iter_links (fun link ->
+          if not (Hashtbl.mem changes.Hypergraph.link_changes link.Hypergraph.id) then begin
+            link_values (serialize_link link);
+            write_if_full ()
+          end) atomspace
+      end;
+      count := !count + R.batch_count batch;
+      R.batch_write db batch;
+      R.batch_destroy batch;
+      Hypergraph.clear_changes changes;
+      !count
+    with e ->
+      R.batch_destroy batch;
+      raise e
+
+  (** {2 Parallel Loading}
+
+      A load reads one snapshot, splits each column family into id
+      ranges and scans the ranges on a pool of threads. The scans spend
+      their time in RocksDB with the runtime lock released, so the reads
+      overlap; the AtomSpace itself is built on the calling thread. *)
+
+  (** Largest id keyed in [cf], or -1 when it is empty *)
+  let max_stored_id db snapshot cf =
+    let iter = R.iter_create_range ~cf ~snapshot db in
+    R.iter_seek_to_last iter;
+    let id = if R.iter_valid iter then id_of_key (R.iter_key iter) 0 else -1 in
+    R.iter_destroy iter;
+    id
+
+  (** Split ids [0, max_id] into at most [parts] half-open ranges *)
+  let id_ranges max_id parts =
+    if max_id < 0 then []
+    else
+      let total = max_id + 1 in
+      let parts = max 1 (min parts total) in
+      List.init parts (fun i -> (i * total / parts, (i + 1) * total / parts))
+
+  (** Run [tasks] on up to [threads] threads, re-raising the first failure *)
+  let run_parallel threads tasks =
+    let queue = Queue.create () in
+    List.iter (fun task -> Queue.add task queue) tasks;
+    let lock = Mutex.create () in
+    let failure = ref None in
+    let next_task () =
+      Mutex.lock lock;
+      let task = if Queue.is_empty queue then None else Some (Queue.pop queue) in
+      Mutex.unlock lock;
+      task
+    in
+    let rec worker () =
+      match next_task () with
+      | None -> ()
+      | Some task ->
+        (try task () with e ->
+           Mutex.lock lock;
+           (match !failure with None -> failure := Some e | Some _ -> ());
+           Mutex.unlock lock);
+        worker ()
+    in
+    let workers =
+      List.init (max 1 (min threads (Queue.length queue))) (fun _ -> Thread.create worker ())
+    in
+    List.iter Thread.join workers;
+    match !failure with
+    | Some e -> raise e
+    | None -> ()
+
+  (** Values of one atom kind by id, five floats per id: attention,
+      then truth. Atoms without stored values read as defaults. *)
+  let value_slots max_id =
+    let values = Float.Array.make (5 * (max_id + 1)) 0.0 in
+    for id = 0 to max_id do
+      Float.Array.set values (5 * id + 3) 1.0;
+      Float.Array.set values (5 * id + 4) 1.0
+    done;
+    values
+
+  let set_values values id first v count =
+    for i = 0 to count - 1 do
+      Float.Array.set values (5 * id + first + i) (decode_float v i)
+    done
+
+  let attention_at values id =
+    { Hypergraph.sti = Float.Array.get values (5 * id);
+      lti = Float.Array.get values (5 * id + 1);
+      vlti = Float.Array.get values (5 * id + 2) }
+
+  let truth_at values id =
+    (Float.Array.get values (5 * id + 3), Float.Array.get values (5 * id + 4))
+
+  (** Read a consistent AtomSpace, scanning with [threads] threads. The
+      value scans fill flat slots by id; the atom scans then decode
+      straight into the records handed to [Hypergraph.restore_bulk]. *)
+  let read_atomspace ?(threads=4) db =
+    R.with_snapshot db (fun snapshot ->
+      let max_node = max_stored_id db snapshot R.Nodes in
+      let max_link = max_stored_id db snapshot R.Links in
+      let node_ranges = id_ranges max_node threads in
+      let link_ranges = id_ranges max_link threads in
+      let node_values = value_slots max_node in
+      let link_values = value_slots max_link in
+      let scan cf lower upper f =
+        R.scan_range ~cf ~snapshot ~lower ~upper db ~init:() ~f:(fun () key value -> f key value) in
+      let value_scans cf first count =
+        let fill kind values (lo, hi) () =
+          scan cf (atom_key kind lo) (atom_key kind hi) (fun key value ->
+            set_values values (id_of_key key 1) first value count) in
+        List.map (fill 'n' node_values) node_ranges
+        @ List.map (fill 'l' link_values) link_ranges
+      in
+      run_parallel threads (value_scans R.Attention 0 3 @ value_scans R.TruthValues 3 2);
+      (* Each range decodes into its own part; the parts keep id order *)
+      let atom_scans cf ranges decode =
+        let parts = Array.make (List.length ranges) [||] in
+        let tasks = List.mapi (fun i (lo, hi) () ->
+          parts.(i) <- Array.of_list (List.rev (
+            R.scan_range ~cf ~snapshot ~lower:(id_key lo) ~upper:(id_key hi) db ~init:[]
+              ~f:(fun acc key value -> decode (id_of_key key 0) value :: acc)))) ranges in
+        (tasks, fun () -> Array.concat (Array.to_list parts))
+      in
+      let (node_tasks, nodes) = atom_scans R.Nodes node_ranges (fun id value ->
+        let (node_type, name) = decode_node value in
+        { Hypergraph.id;
+          node_type = Hypergraph.node_type_of_string node_type;
+          name;
+          attention = attention_at node_values id;
+          truth_value = truth_at node_values id }) in
+      let (link_tasks, links) = atom_scans R.Links link_ranges (fun id value ->
+        let (link_type, outgoing) = decode_link value in
+        { Hypergraph.id;
+          link_type = Hypergraph.link_type_of_string link_type;
+          outgoing;
+          attention = attention_at link_values id;
+          truth_value = truth_at link_values id }) in
+      run_parallel threads (node_tasks @ link_tasks);
+      let nodes = nodes () and links = links () in
+      let atomspace =
+        Hypergraph.create_atomspace ~capacity:(max (Array.length nodes) (Array.length links)) () in
+      Hypergraph.restore_bulk atomspace nodes links;
+      atomspace)
+end
+
+(** {1 Persistence Store} *)
+
+type store = {
+  backend: backend_type;
+  mutable wal: WAL.wal;
+  mutable dirty: bool;
+  mutable last_save: float;
+  auto_save_interval: float;  (** Seconds between auto-saves *)
+  mutable rocks: Rocksdb_native.db option;  (** Opened on first RocksDB save *)
+  mutable rocks_changes: Hypergraph.change_log option;
+    (** Changes to the AtomSpace the database last matched *)
+}
+
+(** Create a new store *)
+let create_store ?(auto_save_interval=60.0) ?wal_group_size ?wal_sync backend =
+  let wal_path = match backend with
+    | RocksDB path | SQLite path -> Some (path ^ ".wal")
+    | FileJSON path | FileBinary path -> Some (path ^ ".wal")
+    | InMemory -> None
+  in
+  {
+    backend;
+    wal = WAL.create ?path:wal_path ?group_size:wal_group_size ?sync:wal_sync ();
+    dirty = false;
+    last_save = Unix.gettimeofday ();
+    auto_save_interval;
+    rocks = None;
+    rocks_changes = None;
+  }
+
+(** Current WAL sequence number *)
+let wal_sequence store = store.wal.WAL.sequence
+
+(** Make buffered WAL records durable now *)
+let flush_wal store = WAL.flush store.wal
+
+(** Flush and close the WAL, and release the store's database handle *)
+let close_store store =
+  WAL.close store.wal;
+  match store.rocks with
+  | Some db ->
+    Rocksdb_native.close db;
+    store.rocks <- None;
+    store.rocks_changes <- None
+  | None -> ()
+
+(** {1 Columnar Snapshots} *)
+
+(** Binary format version 2: a header, then sections of fixed-width
+    arrays in native byte order, each 8-byte aligned so it can be mapped
+    as a typed Bigarray. Names and type names share one interned string
+    table; link outgoing sets are CSR rows; values are five float
+    columns per atom kind. Saving and loading map the file instead of
+    going through one large string.
+
+    Header: ["OCAS"], version (u32), timestamp (f64), section count
+    (u32), padding (u32), then per section its tag (4 bytes), padding
+    (u32), offset (u64) and element count (u64). *)
+module Columnar = struct
+  open Bigarray
+
+  let version = 2
+
+  (* Element size of every section, in bytes *)
+  let sections = [
+    ("STRO", 8);  (* string offsets into STRB, count + 1 *)
+    ("STRB", 1);  (* string bytes *)
+    ("NIDS", 8);  (* node ids, ascending *)
+    ("NTYP", 4);  (* node type, as a string index *)
+    ("NNAM", 4);  (* node name, as a string index *)
+    ("NVAL", 8);  (* sti, lti, vlti, strength, confidence columns *)
+    ("LIDS", 8);  (* link ids, ascending *)
+    ("LTYP", 4);  (* link type, as a string index *)
+    ("LOFF", 8);  (* CSR row offsets into LOUT, count + 1 *)
+    ("LOUT", 8);  (* outgoing node ids *)
+    ("LVAL", 8);  (* value columns as for nodes *)
+    ("TMET", 8);  (* per tensor: id, associated node or -1, rank *)
+    ("TDIM", 8);  (* dimensions of every tensor in turn *)
+    ("TDAT", 4);  (* float32 elements of every tensor in turn *)
+  ]
+
+  let align n = (n + 7) land (lnot 7)
+
+  let header_size = align (24 + 24 * List.length sections)
+
+  (* Offsets for the given element counts, and the file size *)
+  let layout counts =
+    let (size, placed) = List.fold_left2 (fun (offset, acc) (tag, width) count ->
+        (align (offset + width * count), (tag, (offset, count)) :: acc)
+      ) (header_size, []) sections counts in
+    (List.rev placed, size)
+
+  let map fd kind shared (offset, count) =
+    if count = 0 then Array1.create kind c_layout 0
+    else array1_of_genarray
+        (Unix.map_file fd ~pos:(Int64.of_int offset) kind c_layout shared [| count |])
+
+  (* Write zeros up to [size] so every block is allocated before the file
+     is mapped: a full disk then fails here with ENOSPC rather than with a
+     SIGBUS on a store through the mapping, as a sparse file would *)
+  let preallocate fd size =
+    let zeros = Bytes.make (min size (1 lsl 20)) '\000' in
+    let rec fill pos =
+      if pos < size then
+        fill (pos + Unix.write fd zeros 0 (min (Bytes.length zeros) (size - pos)))
+    in
+    fill 0
+
+  let sorted_ids table =
+    let ids = Array.make (Hashtbl.length table) 0 in
+    let i = ref 0 in
+    Hashtbl.iter (fun id _ -> ids.(!i) <- id; incr i) table;
+    Array.sort compare ids;
+    ids
+
+  (** Write [atomspace] to [path] through a temporary file renamed into
+      place once synced *)
+  let write path (atomspace : Hypergraph.atomspace) =
+    let node_ids = sorted_ids atomspace.nodes in
+    let link_ids = sorted_ids atomspace.links in
+    (* External tensors, such as quantized embeddings, are written as floats *)
+    let tensors =
+      Hypergraph.fold_tensors (fun t acc -> t :: acc) atomspace []
+      |> List.sort (fun (a : Hypergraph.tensor) (b : Hypergraph.tensor) -> compare a.id b.id)
+      |> Array.of_list
+      |> Array.map (fun (t : Hypergraph.tensor) -> (t, Tensor_backend.Dense.contiguous t.data)) in
+    (* Interned strings *)
+    let strings = Hashtbl.create 1024 in
+    let table = ref [] and table_bytes = ref 0 in
+    let intern s =
+      match Hashtbl.find_opt strings s with
+      | Some i -> i
+      | None ->
+        let i = Hashtbl.length strings in
+        Hashtbl.add strings s i;
+        table := s :: !table;
+        table_bytes := !table_bytes + String.length s;
+        i
+    in
+    let node_of id = Hashtbl.find atomspace.nodes id in
+    let link_of id = Hashtbl.find atomspace.links id in
+    let node_types = Array.map (fun id ->
+        intern (Hypergraph.node_type_to_string (node_of id).node_type)) node_ids in
+    let node_names = Array.map (fun id -> intern (node_of id).name) node_ids in
+    let link_types = Array.map (fun id ->
+        intern (Hypergraph.link_type_to_string (link_of id).link_type)) link_ids in
+    let strings = Array.of_list (List.rev !table) in
+    let arity = Array.fold_left (fun n id -> n + List.length (link_of id).outgoing) 0 link_ids in
+    let ranks = Array.fold_left (fun n (_, d) ->
+        n + Array.length (Tensor_backend.Dense.dims d)) 0 tensors in
+    let elements = Array.fold_left (fun n (_, d) -> n + Tensor_backend.Dense.size d) 0 tensors in
+    let n = Array.length node_ids and l = Array.length link_ids in
+    let t = Array.length tensors in
+    let (placed, size) = layout [
+        Array.length strings + 1; !table_bytes; n; n; n; 5 * n;
+        l; l; l + 1; arity; 5 * l; 3 * t; ranks; elements ] in
+    let section tag = List.assoc tag placed in
+    let tmp = path ^ ".tmp" in
+    let fd = Unix.openfile tmp [Unix.O_RDWR; Unix.O_CREAT; Unix.O_TRUNC] 0o644 in
+    let written = ref false in
+    let cleanup () =
+      Unix.close fd;
+      if not !written then (try Sys.remove tmp with Sys_error _ -> ())
+    in
+    Fun.protect ~finally:cleanup (fun () ->
+      preallocate fd size;
+      (* Header *)
+      let header = Buffer.create header_size in
+      Buffer.add_string header Binary.magic;
+      Binary.write_int32 header version;
+      Binary.write_float64 header (Unix.gettimeofday ());
+      Binary.write_int32 header (List.length sections);
+      Binary.write_int32 header 0;
+      List.iter (fun (tag, (offset, count)) ->
+        Buffer.add_string header tag;
+        Binary.write_int32 header 0;
+        Binary.write_int64 header offset;
+        Binary.write_int64 header count
+      ) placed;
+      let bytes = map fd char true (0, Buffer.length header) in
+      String.iteri (fun i c -> Array1.unsafe_set bytes i c) (Buffer.contents header);
+      (* Strings *)
+      let offsets = map fd int64 true (section "STRO") in
+      let data = map fd char true (section "STRB") in
+      let pos = ref 0 in
+      Array.iteri (fun i s ->
+        Array1.unsafe_set offsets i (Int64.of_int !pos);
+        String.iteri (fun k c -> Array1.unsafe_set data (!pos + k) c) s;
+        pos := !pos + String.length s
+      ) strings;
+      Array1.unsafe_set offsets (Array.length strings) (Int64.of_int !pos);
+      let write_ids tag ids =
+        let a = map fd int64 true (section tag) in
+        Array.iteri (fun i id -> Array1.unsafe_set a i (Int64.of_int id)) ids
+      in
+      let write_indices tag indices =
+        let a = map fd int32 true (section tag) in
+        Array.iteri (fun i s -> Array1.unsafe_set a i (Int32.of_int s)) indices
+      in
+      let write_values tag ids (cols : Hypergraph.value_columns) =
+        let a = map fd float64 true (section tag) in
+        let count = Array.length ids in
+        List.iteri (fun c column ->
+          Array.iteri (fun i id ->
+            Array1.unsafe_set a (c * count + i) (Float.Array.get column id)) ids
+        ) [cols.sti_values; cols.lti_values; cols.vlti_values; cols.strengths; cols.confidences]
+      in
+      write_ids "NIDS" node_ids;
+      write_indices "NTYP" node_types;
+      write_indices "NNAM" node_names;
+      write_values "NVAL" node_ids atomspace.node_values;
+      write_ids "LIDS" link_ids;
+      write_indices "LTYP" link_types;
+      let row_offsets = map fd int64 true (section "LOFF") in
+      let outgoing = map fd int64 true (section "LOUT") in
+      let pos = ref 0 in
+      Array.iteri (fun i id ->
+        Array1.unsafe_set row_offsets i (Int64.of_int !pos);
+        List.iter (fun node_id ->
+          Array1.unsafe_set outgoing !pos (Int64.of_int node_id);
+          incr pos
+        ) (link_of id).outgoing
+      ) link_ids;
+      Array1.unsafe_set row_offsets l (Int64.of_int !pos);
+      write_values "LVAL" link_ids atomspace.link_values;
+      (* Tensors *)
+      let meta = map fd int64 true (section "TMET") in
+      let dims = map fd int64 true (section "TDIM") in
+      let elems = map fd float32 true (section "TDAT") in
+      let dim_pos = ref 0 and elem_pos = ref 0 in
+      Array.iteri (fun i ((tensor : Hypergraph.tensor), dense) ->
+        let shape = Tensor_backend.Dense.dims dense in
+        let assoc = match tensor.associated_node with Some id -> id | None -> -1 in
+        Array1.unsafe_set meta (3 * i) (Int64.of_int tensor.id);
+        Array1.unsafe_set meta (3 * i + 1) (Int64.of_int assoc);
+        Array1.unsafe_set meta (3 * i + 2) (Int64.of_int (Array.length shape));
+        Array.iteri (fun k d -> Array1.unsafe_set dims (!dim_pos + k) (Int64.of_int d)) shape;
+        dim_pos := !dim_pos + Array.length shape;
+        let size = Tensor_backend.Dense.size dense in
+        Array1.blit (Tensor_backend.Dense.flat dense) (Array1.sub elems !elem_pos size);
+        elem_pos := !elem_pos + size
+      ) tensors;
+      Unix.fsync fd;
+      written := true);
+    Sys.rename tmp path
+
+  (* CSR offsets: [rows + 1] of them, starting at 0, never decreasing and
+     ending within the [limit] elements they index *)
+  let valid_offsets offsets rows limit =
+    let rec ascending i =
+      i > rows || (Array1.get offsets i >= Array1.get offsets (i - 1) && ascending (i + 1))
+    in
+    Array1.dim offsets = rows + 1 && Array1.get offsets 0 = 0L && ascending 1
+    && Int64.to_int (Array1.get offsets rows) <= limit
+
+  (* Atom ids are written in ascending order *)
+  let valid_ids ids =
+    let rec ascending i =
+      i >= Array1.dim ids || (Array1.get ids i > Array1.get ids (i - 1) && ascending (i + 1))
+    in
+    Array1.dim ids = 0 || (Array1.get ids 0 >= 0L && ascending 1)
+
+  (** Load a version 2 file. Fixed-width sections are read straight from
+      the mapping; tensors keep pointing into it, copy-on-write. Every
+      offset and index is checked against the section it points into. *)
+  let read path =
+    let fd = Unix.openfile path [Unix.O_RDONLY] 0 in
+    Fun.protect ~finally:(fun () -> Unix.close fd) (fun () ->
+      let invalid () = failwith "Invalid binary format" in
+      let check ok = if not ok then invalid () in
+      let size = (Unix.fstat fd).Unix.st_size in
+      check (size >= header_size);
+      let bytes = map fd char false (0, header_size) in
+      let header = String.init header_size (Array1.get bytes) in
+      check (String.sub header 0 4 = Binary.magic && Binary.read_int32 header 4 = version
+             && Binary.read_int32 header 16 = List.length sections);
+      let placed = List.mapi (fun i (tag, width) ->
+          let entry = 24 + 24 * i in
+          let offset = Binary.read_int64 header (entry + 8) in
+          let count = Binary.read_int64 header (entry + 16) in
+          check (String.sub header entry 4 = tag && offset >= header_size && count >= 0
+                 && count <= (size - offset) / width);
+          (tag, (offset, count))
+        ) sections in
+      let section kind tag = map fd kind false (List.assoc tag placed) in
+      let offsets = section int64 "STRO" and data = section char "STRB" in
+      check (Array1.dim offsets > 0);
+      let string_count = Array1.dim offsets - 1 in
+      check (valid_offsets offsets string_count (Array1.dim data));
+      let strings = Array.init string_count (fun i ->
+          let first = Int64.to_int (Array1.get offsets i) in
+          let last = Int64.to_int (Array1.get offsets (i + 1)) in
+          String.init (last - first) (fun k -> Array1.get data (first + k))) in
+      let string_at i =
+        check (i >= 0 && i < string_count);
+        strings.(i)
+      in
+      let memo of_string =
+        let cache = Hashtbl.create 16 in
+        fun i -> match Hashtbl.find_opt cache i with
+          | Some v -> v
+          | None -> let v = of_string (string_at i) in Hashtbl.add cache i v; v
+      in
+      let node_type = memo Hypergraph.node_type_of_string in
+      let link_type = memo Hypergraph.link_type_of_string in
+      let values tag count =
+        let a = section float64 tag in
+        check (Array1.dim a = 5 * count);
+        fun i ->
+          let v c = Array1.get a (c * count + i) in
+          ({ Hypergraph.sti = v 0; lti = v 1; vlti = v 2 }, (v 3, v 4))
+      in
+      let node_ids = section int64 "NIDS" in
+      let node_types = section int32 "NTYP" and node_names = section int32 "NNAM" in
+      let n = Array1.dim node_ids in
+      check (valid_ids node_ids && Array1.dim node_types = n && Array1.dim node_names = n);
+      let node_values = values "NVAL" n in
+      let nodes = Array.init n (fun i ->
+          let (attention, truth_value) = node_values i in
+          { Hypergraph.id = Int64.to_int (Array1.get node_ids i);
+            node_type = node_type (Int32.to_int (Array1.get node_types i));
+            name = string_at (Int32.to_int (Array1.get node_names i));
+            attention; truth_value }) in
+      let link_ids = section int64 "LIDS" and link_types = section int32 "LTYP" in
+      let row_offsets = section int64 "LOFF" and outgoing = section int64 "LOUT" in
+      let l = Array1.dim link_ids in
+      check (valid_ids link_ids && Array1.dim link_types = l);
+      check (valid_offsets row_offsets l (Array1.dim outgoing));
+      let link_values = values "LVAL" l in
+      let links = Array.init l (fun i ->
+          let first = Int64.to_int (Array1.get row_offsets i) in
+          let last = Int64.to_int (Array1.get row_offsets (i + 1)) in
+          let (attention, truth_value) = link_values i in
+          { Hypergraph.id = Int64.to_int (Array1.get link_ids i);
+            link_type = link_type (Int32.to_int (Array1.get link_types i));
+            outgoing = List.init (last - first) (fun k ->
+                Int64.to_int (Array1.get outgoing (first + k)));
+            attention; truth_value }) in
+      let atomspace = Hypergraph.create_atomspace ~capacity:(max n l) () in
+      Hypergraph.restore_bulk atomspace nodes links;
+      let meta = section int64 "TMET" and dims = section int64 "TDIM" in
+      let elems = section float32 "TDAT" in
+      check (Array1.dim meta mod 3 = 0);
+      let dim_pos = ref 0 and elem_pos = ref 0 in
+      for i = 0 to Array1.dim meta / 3 - 1 do
+        let field k = Int64.to_int (Array1.get meta (3 * i + k)) in
+        check (field 2 >= 0 && field 2 <= Array1.dim dims - !dim_pos);
+        let shape = Array.init (field 2) (fun k -> Int64.to_int (Array1.get dims (!dim_pos + k))) in
+        check (Array.for_all (fun d -> d >= 0) shape);
+        let size = Array.fold_left ( * ) 1 shape in
+        check (size >= 0 && size <= Array1.dim elems - !elem_pos);
+        let data = Tensor_backend.Dense.of_buffer shape (Array1.sub elems !elem_pos size) in
+        Hypergraph.restore_tensor atomspace (field 0) data
+          (if field 1 < 0 then None else Some (field 1));
+        dim_pos := !dim_pos + field 2;
+        elem_pos := !elem_pos + size
+      done;
+      atomspace)
+end
+
 (** {1 Save Operations} *)
 
 (** Save to JSON file *)
@@ -388,13 +1365,31 @@ let save_json path atomspace =
   output_string oc json;
   close_out oc
 
-(** Save to binary file *)
-let save_binary path atomspace =
-  let serialized = serialize_atomspace atomspace in
-  let binary = Binary.atomspace_to_binary serialized in
-  let oc = open_out_bin path in
-  output_string oc binary;
-  close_out oc
+(** Save to binary file, in the columnar format *)
+let save_binary path atomspace = Columnar.write path atomspace
+
+(** Open the store's database on first use *)
+let rocks_db store path =
+  match store.rocks with
+  | Some db -> db
+  | None ->
+    let db = Rocksdb_native.open_db path in
+    store.rocks <- Some db;
+    db
+
+(** Save to RocksDB. The first save of an AtomSpace in a session writes
+    all of it and starts tracking its changes; later saves write only
+    the atoms changed since. *)
+let save_rocksdb store path atomspace =
+  let db = rocks_db store path in
+  match store.rocks_changes, atomspace.Hypergraph.change_log with
+  | Some changes, Some log when changes == log ->
+    ignore (RocksStore.write_changes db atomspace changes)
+  | _ ->
+    let changes = Hypergraph.track_changes atomspace in
+    RocksStore.write_atomspace db (serialize_atomspace atomspace);
+    Hypergraph.clear_changes changes;
+    store.rocks_changes <- Some changes
 
 (** Save atomspace using store backend *)
 let save store atomspace =
@@ -403,8 +1398,11 @@ let save store atomspace =
   | FileJSON path -> save_json path atomspace
   | FileBinary path -> save_binary path atomspace
   | RocksDB path ->
-    (* RocksDB would use native bindings - for now use JSON fallback *)
-    save_json (path ^ "/atomspace.json") atomspace
+    if Rocksdb_native.is_native_available () then
+      save_rocksdb store path atomspace
+    else
+      (* Without native bindings fall back to JSON *)
+      save_json (path ^ "/atomspace.json") atomspace
   | SQLite path ->
     (* SQLite would use native bindings - for now use JSON fallback *)
     save_json (path ^ ".json") atomspace
@@ -423,45 +1421,127 @@ let load_json path =
   close_in ic;
   
   (* Parse JSON - simplified parser *)
-  let atomspace = Hypergraph.create () in
+  let atomspace = Hypergraph.create_atomspace () in
   
   (* This is a simplified parser - production would use a proper JSON library *)
   (* For now, return empty atomspace if parsing fails *)
   atomspace
 
-(** Load from binary file *)
+(* Version 1 files: one record after another *)
+let load_binary_records s =
+  let n = String.length s in
+  if n < 24 then failwith "Invalid binary format";
+  
+  let node_count = Binary.read_int32 s 16 in
+  let link_count = Binary.read_int32 s 20 in
+  let atomspace =
+    Hypergraph.create_atomspace ~capacity:(max node_count link_count) () in
+  let read_values pos =
+    let f i = Binary.read_float64 s (pos + 8 * i) in
+    ((f 0, f 1), { Hypergraph.sti = f 2; lti = f 3; vlti = f 4 }, pos + 40)
+  in
+  let pos = ref 24 in
+  for _ = 1 to node_count do
+    let id = Binary.read_int32 s !pos in
+    let (node_type, p) = Binary.read_string s (!pos + 4) in
+    let (name, p) = Binary.read_string s p in
+    let (truth_value, attention, p) = read_values p in
+    Hypergraph.restore_node atomspace {
+      Hypergraph.id; node_type = Hypergraph.node_type_of_string node_type;
+      name; attention; truth_value };
+    pos := p
+  done;
+  for _ = 1 to link_count do
+    let id = Binary.read_int32 s !pos in
+    let (link_type, p) = Binary.read_string s (!pos + 4) in
+    let arity = Binary.read_int32 s p in
+    let outgoing = List.init arity (fun i -> Binary.read_int32 s (p + 4 + 4 * i)) in
+    let (truth_value, attention, p) = read_values (p + 4 + 4 * arity) in
+    Hypergraph.restore_link atomspace {
+      Hypergraph.id; link_type = Hypergraph.link_type_of_string link_type;
+      outgoing; attention; truth_value };
+    pos := p
+  done;
+  atomspace
+
+(** Load from binary file, columnar or in the older record format *)
 let load_binary path =
   let ic = open_in_bin path in
   let n = in_channel_length ic in
-  let s = really_input_string ic n in
-  close_in ic;
-  
-  (* Verify magic number *)
-  if String.sub s 0 4 <> Binary.magic then
-    failwith "Invalid binary format";
-  
-  let atomspace = Hypergraph.create () in
-  (* Parse binary data and populate atomspace *)
+  let head = really_input_string ic (min n 8) in
+  if n < 8 || String.sub head 0 4 <> Binary.magic then begin
+    close_in ic;
+    failwith "Invalid binary format"
+  end;
+  if Binary.read_int32 head 4 = Columnar.version then begin
+    close_in ic;
+    Columnar.read path
+  end else begin
+    let s = head ^ really_input_string ic (n - 8) in
+    close_in ic;
+    load_binary_records s
+  end
+
+(** Load from RocksDB with [threads] parallel range scans. The database
+    then matches the AtomSpace, so later saves write only what changes.
+    The log file is left alone: it may hold operations still to replay. *)
+let load_rocksdb ?threads store path =
+  let db = rocks_db store path in
+  let atomspace = RocksStore.read_atomspace ?threads db in
+  store.rocks_changes <- Some (Hypergraph.track_changes atomspace);
+  WAL.reset store.wal;
   atomspace
 
-(** Load atomspace using store backend *)
-let load store =
+(** Apply a logged operation on top of a loaded AtomSpace *)
+let apply_logged atomspace = function
+  | WAL.AddNode n | WAL.UpdateNode n ->
+    Hypergraph.restore_node atomspace {
+      Hypergraph.id = n.sn_id;
+      node_type = Hypergraph.node_type_of_string n.sn_node_type;
+      name = n.sn_name;
+      attention = { Hypergraph.sti = n.sn_sti; lti = n.sn_lti; vlti = n.sn_vlti };
+      truth_value = (n.sn_strength, n.sn_confidence) }
+  | WAL.DeleteNode id -> Hypergraph.remove_node atomspace id
+  | WAL.AddLink l | WAL.UpdateLink l ->
+    Hypergraph.restore_link atomspace {
+      Hypergraph.id = l.sl_id;
+      link_type = Hypergraph.link_type_of_string l.sl_link_type;
+      outgoing = l.sl_outgoing;
+      attention = { Hypergraph.sti = l.sl_sti; lti = l.sl_lti; vlti = l.sl_vlti };
+      truth_value = (l.sl_strength, l.sl_confidence) }
+  | WAL.DeleteLink id -> Hypergraph.remove_link atomspace id
+  | WAL.Checkpoint -> ()
+
+let load_base store =
   match store.backend with
-  | InMemory -> Hypergraph.create ()
+  | InMemory -> Hypergraph.create_atomspace ()
   | FileJSON path -> 
     if Sys.file_exists path then load_json path
-    else Hypergraph.create ()
+    else Hypergraph.create_atomspace ()
   | FileBinary path ->
     if Sys.file_exists path then load_binary path
-    else Hypergraph.create ()
+    else Hypergraph.create_atomspace ()
   | RocksDB path ->
     let json_path = path ^ "/atomspace.json" in
-    if Sys.file_exists json_path then load_json json_path
-    else Hypergraph.create ()
+    if Rocksdb_native.is_native_available () then load_rocksdb store path
+    else if Sys.file_exists json_path then load_json json_path
+    else Hypergraph.create_atomspace ()
   | SQLite path ->
     let json_path = path ^ ".json" in
     if Sys.file_exists json_path then load_json json_path
-    else Hypergraph.create ()
+    else Hypergraph.create_atomspace ()
+
+(** Load atomspace using store backend, then replay the operations the
+    WAL logged after the last save. They stay logged and pending until
+    the next save; the log is only rewritten once they are applied. *)
+let load store =
+  let logged = WAL.replay store.wal in
+  let atomspace = load_base store in
+  if logged <> [] then begin
+    List.iter (apply_logged atomspace) logged;
+    WAL.restore store.wal logged
+  end;
+  atomspace
 
 (** {1 Incremental Operations} *)
 
@@ -17,20 +17,209 @@ type backend_type =
   | RocksDB of string
   | SQLite of string
 
+(** {1 Serialization Formats} *)
+
+(** Serialized node *)
+type serialized_node = {
+  sn_id: int;
+  sn_node_type: string;
+  sn_name: string;
+  sn_strength: float;
+  sn_confidence: float;
+  sn_sti: float;
+  sn_lti: float;
+  sn_vlti: float;
+}
+
+(** Serialized link *)
+type serialized_link = {
+  sl_id: int;
+  sl_link_type: string;
+  sl_outgoing: int list;
+  sl_strength: float;
+  sl_confidence: float;
+  sl_sti: float;
+  sl_lti: float;
+  sl_vlti: float;
+}
+
+(** Serialized atomspace *)
+type serialized_atomspace = {
+  version: string;
+  timestamp: float;
+  node_count: int;
+  link_count: int;
+  nodes: serialized_node list;
+  links: serialized_link list;
+  metadata: (string * string) list;
+}
+
+module JSON : sig
+  val escape_string : string -> string
+  val node_to_json : serialized_node -> string
+  val link_to_json : serialized_link -> string
+  val atomspace_to_json : serialized_atomspace -> string
+end
+
+module Binary : sig
+  val magic : string
+  val write_int32 : Buffer.t -> int -> unit
+  val write_float64 : Buffer.t -> float -> unit
+  val write_string : Buffer.t -> string -> unit
+  val read_int32 : string -> int -> int
+  val read_float64 : string -> int -> float
+  val read_string : string -> int -> string * int
+  val write_int64 : Buffer.t -> int -> unit
+  val read_int64 : string -> int -> int
+
+  (** CRC-32 (IEEE) of [len] bytes of [s] from [offset] *)
+  val crc32 : string -> int -> int -> int
+  val atomspace_to_binary : serialized_atomspace -> string
+end
+
+(** {1 Write-Ahead Log} *)
+
+(** Binary log of CRC-checked records, written a group at a time and
+    truncated at each checkpoint *)
+module WAL : sig
+  type operation =
+    | AddNode of serialized_node
+    | UpdateNode of serialized_node
+    | DeleteNode of int
+    | AddLink of serialized_link
+    | UpdateLink of serialized_link
+    | DeleteLink of int
+    | Checkpoint
+
+  (** When a written group is fsynced *)
+  type sync_policy =
+    | Sync_always
+    | Sync_interval of float
+    | Sync_never
+
+  type wal
+
+  (** Under [Sync_always] every append is written and fsynced before it
+      returns, and under [Sync_never] written. Under [Sync_interval] (the
+      default, every second) records are written every [group_size]
+      appends (default 64), or at the first append once the interval
+      has passed since the last fsync. *)
+  val create : ?path:string -> ?group_size:int -> ?sync:sync_policy -> unit -> wal
+  val append : wal -> operation -> unit
+
+  val sequence : wal -> int
+
+  (** Operations held in memory since the last reset, newest first *)
+  val operations : wal -> operation list
+
+  (** Records appended but not yet written *)
+  val pending_records : wal -> int
+
+  (** Write buffered records and fsync *)
+  val flush : wal -> unit
+
+  (** Forget the operations held in memory, as if saved, without
+      touching the log file *)
+  val reset : wal -> unit
+
+  (** Truncate the log once its operations are saved elsewhere, after
+      writing any buffered records *)
+  val checkpoint : wal -> unit
+  val close : wal -> unit
+  val clear : wal -> unit
+
+  (** Operations in a log file, oldest first, up to the first torn or
+      corrupt record *)
+  val read_file : string -> operation list
+
+  (** Operations of the log to replay after loading, oldest first *)
+  val replay : wal -> operation list
+
+  (** Rewrite the log to hold exactly these operations, atomically
+      through a temporary file and a rename *)
+  val restore : wal -> operation list -> unit
+end
+
+(** {1 RocksDB Store} *)
+
+(** Compact binary encoding of atoms into the {!Rocksdb_native} column
+    families, and incremental saves as write batches *)
+module RocksStore : sig
+  (** Fixed-width big-endian id, sorting numerically *)
+  val id_key : int -> string
+  val id_of_key : string -> int -> int
+
+  (** Key into [Attention] / [TruthValues]: ['n'] or ['l'] then the id *)
+  val atom_key : char -> int -> string
+
+  (** Key into [Incoming]: node id then link id *)
+  val incoming_key : int -> int -> string
+
+  val encode_node : serialized_node -> string
+
+  (** Node type and name *)
+  val decode_node : string -> string * string
+
+  val encode_link : serialized_link -> string
+
+  (** Link type and outgoing set *)
+  val decode_link : string -> string * int list
+
+  val encode_floats : float array -> string
+  val decode_float : string -> int -> float
+
+  (** Write a whole AtomSpace, removing stored atoms it lacks *)
+  val write_atomspace : Rocksdb_native.db -> serialized_atomspace -> unit
+
+  (** [write_changes db atomspace log] writes the atoms [log] records
+      as changed, from [atomspace], deleting those it no longer holds,
+      then clears [log]. Returns the number of batch entries written. *)
+  val write_changes : Rocksdb_native.db -> Hypergraph.atomspace -> Hypergraph.change_log -> int
+
+  (** Split ids [0, max_id] into at most [parts] half-open ranges *)
+  val id_ranges : int -> int -> (int * int) list
+
+  (** Read a snapshot-consistent AtomSpace, scanning id ranges of every
+      column family on [threads] threads (default 4) *)
+  val read_atomspace : ?threads:int -> Rocksdb_native.db -> Hypergraph.atomspace
+end
+
 (** {1 Store Management} *)
 
 (** Abstract store type *)
 type store
 
 (** Create a new persistence store *)
-val create_store : ?auto_save_interval:float -> backend_type -> store
+val create_store :
+  ?auto_save_interval:float -> ?wal_group_size:int -> ?wal_sync:WAL.sync_policy ->
+  backend_type -> store
 
-(** Save atomspace to store *)
+(** Current WAL sequence number *)
+val wal_sequence : store -> int
+
+(** Make buffered WAL records durable now *)
+val flush_wal : store -> unit
+
+(** Flush and close the WAL, and release the store's database handle *)
+val close_store : store -> unit
+
+(** Serialize a whole atomspace, atoms in id order *)
+val serialize_atomspace : Hypergraph.atomspace -> serialized_atomspace
+
+(** Save atomspace to store. With native RocksDB the first save of a
+    session writes everything; later saves of the same AtomSpace write
+    only the atoms its change log records. *)
 val save : store -> Hypergraph.atomspace -> unit
 
-(** Load atomspace from store *)
+(** Load atomspace from store, then replay operations the WAL logged
+    after the last save. With native RocksDB the base load is
+    [load_rocksdb] with the default thread count. *)
 val load : store -> Hypergraph.atomspace
 
+(** Load from the store's RocksDB database at [path] using [threads]
+    parallel range scans *)
+val load_rocksdb : ?threads:int -> store -> string -> Hypergraph.atomspace
+
 (** {1 Incremental Operations} *)
 
 (** Record node addition *)
@@ -73,13 +262,18 @@ val restore_snapshot : snapshot -> Hypergraph.atomspace
 (** Save to JSON file *)
 val save_json : string -> Hypergraph.atomspace -> unit
 
-(** Save to binary file *)
+(** Save to binary file in the columnar format: fixed-width sections for
+    ids, interned names and types, CSR outgoing sets, value columns and
+    tensors, written through a mapping of a temporary file that is
+    synced and renamed into place *)
 val save_binary : string -> Hypergraph.atomspace -> unit
 
 (** Load from JSON file *)
 val load_json : string -> Hypergraph.atomspace
 
-(** Load from binary file *)
+(** Load from binary file. Columnar files are mapped and their indexes
+    built in bulk, and tensors stay copy-on-write views of the mapping;
+    files in the older record format are parsed as before. *)
 val load_binary : string -> Hypergraph.atomspace
 
 (** {1 Statistics} *)
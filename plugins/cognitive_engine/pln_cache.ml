@@ -12,8 +12,8 @@
     optimizing repeated queries and supporting incremental updates.
     
     Features:
-    - LRU cache with configurable size
-    - Cache invalidation on truth value updates
+    - LRU cache with configurable size (O(1) lookup, insert and evict)
+    - Cache invalidation on truth value updates via an atom -> keys index
     - Dependency tracking for inference chains
     - Statistics and monitoring
 *)
@@ -38,8 +38,8 @@ type cache_key =
 type cache_entry = {
   result: (int * truth_value) option;  (** Inference result *)
   timestamp: float;                     (** When cached *)
-  access_count: int;                    (** Number of accesses *)
-  last_access: float;                   (** Last access time *)
+  mutable access_count: int;            (** Number of accesses *)
+  mutable last_access: float;           (** Last access time *)
   dependencies: int list;               (** Atom IDs this depends on *)
 }
 
@@ -63,16 +63,19 @@ let create_stats () = {
 
 (** {1 LRU Cache Implementation} *)
 
-module CacheKeyMap = Map.Make(struct
-  type t = cache_key
-  let compare = compare
-end)
-
-module IntSet = Set.Make(Int)
+(** Intrusive LRU list cell, linked from most to least recently used *)
+type lru_node = {
+  key: cache_key;
+  entry: cache_entry;
+  mutable prev: lru_node option;  (** More recently used neighbour *)
+  mutable next: lru_node option;  (** Less recently used neighbour *)
+}
 
 type cache = {
-  mutable entries: cache_entry CacheKeyMap.t;
-  mutable dependency_index: cache_key list IntSet.t;  (** atom_id -> keys that depend on it *)
+  entries: (cache_key, lru_node) Hashtbl.t;
+  dependency_index: (int, (cache_key, unit) Hashtbl.t) Hashtbl.t;  (** atom_id -> keys that depend on it *)
+  mutable most_recent: lru_node option;
+  mutable least_recent: lru_node option;
   max_size: int;
   ttl: float;  (** Time-to-live in seconds *)
   stats: cache_stats;
@@ -80,8 +83,10 @@ type cache = {
 
 (** Create a new cache *)
 let create ?(max_size=10000) ?(ttl=300.0) () = {
-  entries = CacheKeyMap.empty;
-  dependency_index = IntSet.empty;
+  entries = Hashtbl.create (min max_size 65536);
+  dependency_index = Hashtbl.create 1024;
+  most_recent = None;
+  least_recent = None;
   max_size;
   ttl;
   stats = create_stats ();
@@ -118,51 +123,96 @@ let key_dependencies = function
 let is_expired cache entry =
   now () -. entry.timestamp > cache.ttl
 
-(** Evict least recently used entries *)
-let evict_lru cache =
-  if CacheKeyMap.cardinal cache.entries <= cache.max_size then ()
-  else begin
-    (* Find entries to evict (oldest 10%) *)
-    let entries_list = CacheKeyMap.bindings cache.entries in
-    let sorted = List.sort (fun (_, e1) (_, e2) -> 
-      compare e1.last_access e2.last_access
-    ) entries_list in
-    let to_evict = List.length sorted / 10 + 1 in
-    let evict_keys = List.map fst (List.filteri (fun i _ -> i < to_evict) sorted) in
-    
-    List.iter (fun key ->
-      cache.entries <- CacheKeyMap.remove key cache.entries;
-      cache.stats.evictions <- cache.stats.evictions + 1
-    ) evict_keys
-  end
+(** Detach a cell from the LRU list *)
+let unlink cache node =
+  (match node.prev with
+   | Some prev -> prev.next <- node.next
+   | None -> cache.most_recent <- node.next);
+  (match node.next with
+   | Some next -> next.prev <- node.prev
+   | None -> cache.least_recent <- node.prev);
+  node.prev <- None;
+  node.next <- None
+
+(** Insert a cell at the most recently used end *)
+let push_front cache node =
+  node.next <- cache.most_recent;
+  (match cache.most_recent with
+   | Some head -> head.prev <- Some node
+   | None -> cache.least_recent <- Some node);
+  cache.most_recent <- Some node
+
+let index_dependencies cache key dependencies =
+  List.iter (fun atom_id ->
+    let keys =
+      try Hashtbl.find cache.dependency_index atom_id
+      with Not_found ->
+        let keys = Hashtbl.create 8 in
+        Hashtbl.add cache.dependency_index atom_id keys;
+        keys
+    in
+    Hashtbl.replace keys key ()
+  ) dependencies
+
+let unindex_dependencies cache key dependencies =
+  List.iter (fun atom_id ->
+    match Hashtbl.find_opt cache.dependency_index atom_id with
+    | Some keys ->
+      Hashtbl.remove keys key;
+      if Hashtbl.length keys = 0 then
+        Hashtbl.remove cache.dependency_index atom_id
+    | None -> ()
+  ) dependencies
+
+(** Remove a cell from the table, the LRU list and the dependency index *)
+let remove_node cache node =
+  Hashtbl.remove cache.entries node.key;
+  unlink cache node;
+  unindex_dependencies cache node.key node.entry.dependencies
+
+(** Evict least recently used entries until there is room for one more *)
+let rec evict_lru cache =
+  if Hashtbl.length cache.entries >= cache.max_size then
+    match cache.least_recent with
+    | Some node ->
+      remove_node cache node;
+      cache.stats.evictions <- cache.stats.evictions + 1;
+      evict_lru cache
+    | None -> ()
 
 (** Add entry to cache *)
 let add cache key result dependencies =
+  (match Hashtbl.find_opt cache.entries key with
+   | Some existing -> remove_node cache existing
+   | None -> ());
   evict_lru cache;
+  let timestamp = now () in
   let entry = {
     result;
-    timestamp = now ();
+    timestamp;
     access_count = 0;
-    last_access = now ();
+    last_access = timestamp;
     dependencies;
   } in
-  cache.entries <- CacheKeyMap.add key entry cache.entries
+  let node = { key; entry; prev = None; next = None } in
+  Hashtbl.replace cache.entries key node;
+  push_front cache node;
+  index_dependencies cache key dependencies
 
 (** Lookup entry in cache *)
 let lookup cache key =
   cache.stats.total_queries <- cache.stats.total_queries + 1;
-  match CacheKeyMap.find_opt key cache.entries with
-  | Some entry when not (is_expired cache entry) ->
+  match Hashtbl.find_opt cache.entries key with
+  | Some node when not (is_expired cache node.entry) ->
     cache.stats.hits <- cache.stats.hits + 1;
-    let updated_entry = { entry with
-      access_count = entry.access_count + 1;
-      last_access = now ();
-    } in
-    cache.entries <- CacheKeyMap.add key updated_entry cache.entries;
-    Some entry.result
-  | Some _ ->
+    node.entry.access_count <- node.entry.access_count + 1;
+    node.entry.last_access <- now ();
+    unlink cache node;
+    push_front cache node;
+    Some node.entry.result
+  | Some node ->
     (* Expired - remove and miss *)
-    cache.entries <- CacheKeyMap.remove key cache.entries;
+    remove_node cache node;
     cache.stats.misses <- cache.stats.misses + 1;
     None
   | None ->
@@ -171,20 +221,25 @@ let lookup cache key =
 
 (** Invalidate entries depending on an atom *)
 let invalidate cache atom_id =
-  let keys_to_remove = CacheKeyMap.fold (fun key entry acc ->
-    if List.mem atom_id entry.dependencies then key :: acc
-    else acc
-  ) cache.entries [] in
-  
-  List.iter (fun key ->
-    cache.entries <- CacheKeyMap.remove key cache.entries;
-    cache.stats.invalidations <- cache.stats.invalidations + 1
-  ) keys_to_remove
+  match Hashtbl.find_opt cache.dependency_index atom_id with
+  | None -> ()
+  | Some keys ->
+    let keys_to_remove = Hashtbl.fold (fun key () acc -> key :: acc) keys [] in
+    List.iter (fun key ->
+      match Hashtbl.find_opt cache.entries key with
+      | Some node ->
+        remove_node cache node;
+        cache.stats.invalidations <- cache.stats.invalidations + 1
+      | None -> ()
+    ) keys_to_remove
 
 (** Invalidate all entries *)
 let invalidate_all cache =
-  let count = CacheKeyMap.cardinal cache.entries in
-  cache.entries <- CacheKeyMap.empty;
+  let count = Hashtbl.length cache.entries in
+  Hashtbl.reset cache.entries;
+  Hashtbl.reset cache.dependency_index;
+  cache.most_recent <- None;
+  cache.least_recent <- None;
   cache.stats.invalidations <- cache.stats.invalidations + count
 
 (** {1 Cached PLN Operations} *)
@@ -295,7 +350,7 @@ let hit_rate cache =
   else float_of_int cache.stats.hits /. float_of_int cache.stats.total_queries
 
 (** Get cache size *)
-let size cache = CacheKeyMap.cardinal cache.entries
+let size cache = Hashtbl.length cache.entries
 
 (** Get memory estimate (rough) *)
 let memory_estimate cache =
@@ -310,14 +365,161 @@ let reset_stats cache =
   cache.stats.invalidations <- 0;
   cache.stats.total_queries <- 0
 
+(** {1 Sharded Concurrent Cache} *)
+
+(** Keys are hashed to independently locked shards, each an ordinary
+    cache with its own LRU list and statistics. Compute functions run
+    outside the shard lock, so concurrent workers only contend on the
+    lookup and insert themselves. *)
+module Sharded = struct
+  type t = {
+    shards: cache array;
+    locks: Mutex.t array;
+  }
+
+  let create ?(shards=16) ?(max_size=10000) ?(ttl=300.0) () =
+    let shards = max 1 shards in
+    let shard_size = max 1 ((max_size + shards - 1) / shards) in
+    {
+      shards = Array.init shards (fun _ -> create ~max_size:shard_size ~ttl ());
+      locks = Array.init shards (fun _ -> Mutex.create ());
+    }
+
+  let with_lock lock f =
+    Mutex.lock lock;
+    match f () with
+    | result -> Mutex.unlock lock; result
+    | exception e -> Mutex.unlock lock; raise e
+
+  let shard_index t key =
+    Hashtbl.hash key mod Array.length t.shards
+
+  (** Lookup under the shard lock; on a miss compute unlocked, then insert *)
+  let cached t key dependencies compute =
+    let i = shard_index t key in
+    let shard = t.shards.(i) and lock = t.locks.(i) in
+    match with_lock lock (fun () -> lookup shard key) with
+    | Some result -> result
+    | None ->
+      let result = compute () in
+      with_lock lock (fun () -> add shard key result dependencies);
+      result
+
+  let cached_truth t key dependencies compute =
+    let i = shard_index t key in
+    let shard = t.shards.(i) and lock = t.locks.(i) in
+    match with_lock lock (fun () -> lookup shard key) with
+    | Some (Some (_, tv)) -> tv
+    | _ ->
+      let result = compute () in
+      with_lock lock (fun () -> add shard key (Some (0, result)) dependencies);
+      result
+
+  let cached_deduction t atomspace premise1_id premise2_id compute_fn =
+    cached t (DeductionKey (premise1_id, premise2_id)) [premise1_id; premise2_id]
+      (fun () -> compute_fn atomspace premise1_id premise2_id)
+
+  let cached_induction t atomspace premise1_id premise2_id compute_fn =
+    cached t (InductionKey (premise1_id, premise2_id)) [premise1_id; premise2_id]
+      (fun () -> compute_fn atomspace premise1_id premise2_id)
+
+  let cached_abduction t atomspace premise1_id premise2_id compute_fn =
+    cached t (AbductionKey (premise1_id, premise2_id)) [premise1_id; premise2_id]
+      (fun () -> compute_fn atomspace premise1_id premise2_id)
+
+  let cached_revision t atomspace link_id1 link_id2 compute_fn =
+    cached t (RevisionKey (link_id1, link_id2)) [link_id1; link_id2]
+      (fun () -> compute_fn atomspace link_id1 link_id2)
+
+  let cached_modus_ponens t atomspace node_id impl_link_id compute_fn =
+    cached t (ModusPonensKey (node_id, impl_link_id)) [node_id; impl_link_id]
+      (fun () -> compute_fn atomspace node_id impl_link_id)
+
+  let cached_conjunction t atomspace node1_id node2_id compute_fn =
+    cached_truth t (ConjunctionKey (node1_id, node2_id)) [node1_id; node2_id]
+      (fun () -> compute_fn atomspace node1_id node2_id)
+
+  let cached_disjunction t atomspace node1_id node2_id compute_fn =
+    cached_truth t (DisjunctionKey (node1_id, node2_id)) [node1_id; node2_id]
+      (fun () -> compute_fn atomspace node1_id node2_id)
+
+  let cached_negation t atomspace node_id compute_fn =
+    cached_truth t (NegationKey node_id) [node_id]
+      (fun () -> compute_fn atomspace node_id)
+
+  let cached_chain t atomspace link_ids compute_fn =
+    let key = ChainKey link_ids in
+    let i = shard_index t key in
+    let shard = t.shards.(i) and lock = t.locks.(i) in
+    match with_lock lock (fun () -> lookup shard key) with
+    | Some result ->
+      (match result with Some (_, tv) -> [{ Pln_integration.rule_name = "cached"; premises = link_ids; conclusion = 0; truth_value = tv }] | None -> [])
+    | None ->
+      let result = compute_fn atomspace link_ids in
+      let final_tv = match result with
+        | [] -> None
+        | steps -> Some (0, (List.hd (List.rev steps)).Pln_integration.truth_value)
+      in
+      with_lock lock (fun () -> add shard key final_tv link_ids);
+      result
+
+  (** Dependent keys may live in any shard *)
+  let invalidate t atom_id =
+    Array.iteri (fun i shard ->
+      with_lock t.locks.(i) (fun () -> invalidate shard atom_id)
+    ) t.shards
+
+  let invalidate_all t =
+    Array.iteri (fun i shard ->
+      with_lock t.locks.(i) (fun () -> invalidate_all shard)
+    ) t.shards
+
+  (** Snapshot of the per-shard statistics, summed *)
+  let get_stats t =
+    let total = create_stats () in
+    Array.iteri (fun i shard ->
+      with_lock t.locks.(i) (fun () ->
+        let s = get_stats shard in
+        total.hits <- total.hits + s.hits;
+        total.misses <- total.misses + s.misses;
+        total.evictions <- total.evictions + s.evictions;
+        total.invalidations <- total.invalidations + s.invalidations;
+        total.total_queries <- total.total_queries + s.total_queries)
+    ) t.shards;
+    total
+
+  let hit_rate t =
+    let stats = get_stats t in
+    if stats.total_queries = 0 then 0.0
+    else float_of_int stats.hits /. float_of_int stats.total_queries
+
+  let size t =
+    let total = ref 0 in
+    Array.iteri (fun i shard ->
+      total := !total + with_lock t.locks.(i) (fun () -> size shard)
+    ) t.shards;
+    !total
+
+  let num_shards t = Array.length t.shards
+
+  let reset_stats t =
+    Array.iteri (fun i shard ->
+      with_lock t.locks.(i) (fun () -> reset_stats shard)
+    ) t.shards
+end
+
 (** {1 Persistence} *)
 
-(** Serialize cache to string *)
+(** Serialize cache to string, most recently used entries first *)
 let serialize cache =
-  let entries = CacheKeyMap.bindings cache.entries in
-  let entry_strs = List.map (fun (key, entry) ->
+  let rec collect acc = function
+    | Some node -> collect (node :: acc) node.next
+    | None -> List.rev acc
+  in
+  let entry_strs = List.map (fun node ->
+    let entry = node.entry in
     Printf.sprintf "(%s %f %d %f [%s] %s)"
-      (key_to_string key)
+      (key_to_string node.key)
       entry.timestamp
       entry.access_count
       entry.last_access
@@ -325,7 +527,7 @@ let serialize cache =
       (match entry.result with
        | Some (id, tv) -> Printf.sprintf "(result %d %.6f %.6f)" id tv.strength tv.confidence
        | None -> "(none)")
-  ) entries in
+  ) (collect [] cache.most_recent) in
   Printf.sprintf "(pln-cache (size %d) (max-size %d) (ttl %.1f)\n  %s)"
     (size cache) cache.max_size cache.ttl
     (String.concat "\n  " entry_strs)
@@ -339,8 +541,13 @@ let stats_to_string stats =
 
 (** {1 Scheme Serialization} *)
 
-let stats_to_scheme stats =
-  Printf.sprintf "(pln-cache-stats (hits %d) (misses %d) (evictions %d) (invalidations %d) (total-queries %d) (hit-rate %.4f))"
+let add_stats_scheme buf stats =
+  Printf.bprintf buf "(pln-cache-stats (hits %d) (misses %d) (evictions %d) (invalidations %d) (total-queries %d) (hit-rate %.4f))"
     stats.hits stats.misses stats.evictions stats.invalidations stats.total_queries
     (if stats.total_queries = 0 then 0.0 
      else float_of_int stats.hits /. float_of_int stats.total_queries)
+
+let stats_to_scheme stats =
+  let buf = Buffer.create 160 in
+  add_stats_scheme buf stats;
+  Buffer.contents buf
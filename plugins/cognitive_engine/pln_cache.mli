@@ -120,6 +120,78 @@ val memory_estimate : cache -> int
 (** Reset statistics *)
 val reset_stats : cache -> unit
 
+(** {1 Sharded Concurrent Cache} *)
+
+(** Thread-safe cache for concurrent reasoning workers (systhreads or
+    domains). Keys are hashed to [shards] independently locked caches;
+    [max_size] is split evenly between them. *)
+module Sharded : sig
+  type t
+
+  val create : ?shards:int -> ?max_size:int -> ?ttl:float -> unit -> t
+
+  val cached_deduction :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> (int * truth_value) option) ->
+    (int * truth_value) option
+
+  val cached_induction :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> (int * truth_value) option) ->
+    (int * truth_value) option
+
+  val cached_abduction :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> (int * truth_value) option) ->
+    (int * truth_value) option
+
+  val cached_revision :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> (int * truth_value) option) ->
+    (int * truth_value) option
+
+  val cached_modus_ponens :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> (int * truth_value) option) ->
+    (int * truth_value) option
+
+  val cached_conjunction :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> truth_value) ->
+    truth_value
+
+  val cached_disjunction :
+    t -> 'a -> int -> int ->
+    ('a -> int -> int -> truth_value) ->
+    truth_value
+
+  val cached_negation :
+    t -> 'a -> int ->
+    ('a -> int -> truth_value) ->
+    truth_value
+
+  val cached_chain :
+    t -> 'a -> int list ->
+    ('a -> int list -> Pln_integration.inference_step list) ->
+    Pln_integration.inference_step list
+
+  (** Invalidate entries depending on an atom, in every shard *)
+  val invalidate : t -> int -> unit
+
+  val invalidate_all : t -> unit
+
+  (** Statistics summed over all shards (a fresh snapshot) *)
+  val get_stats : t -> cache_stats
+
+  val hit_rate : t -> float
+
+  val size : t -> int
+
+  val num_shards : t -> int
+
+  val reset_stats : t -> unit
+end
+
 (** {1 Serialization} *)
 
 (** Serialize cache to string *)
@@ -129,6 +201,7 @@ val serialize : cache -> string
 val stats_to_string : cache_stats -> string
 
 (** Statistics to Scheme *)
+val add_stats_scheme : Buffer.t -> cache_stats -> unit
 val stats_to_scheme : cache_stats -> string
 
 (** Key to string *)
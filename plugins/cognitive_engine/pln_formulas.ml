@@ -142,14 +142,22 @@ let revision tv1 tv2 =
   let n2 = tv2.count in
   let n_new = n1 +. n2 in
   
-  let strength =
-    if n_new > 0.0 then
-      (tv1.strength *. n1 +. tv2.strength *. n2) /. n_new
-    else
-      (tv1.strength +. tv2.strength) /. 2.0
-  in
-  
-  make_tv_from_count strength n_new
+  if n_new = infinity then
+    (* Certain evidence (confidence 1) outweighs any finite count *)
+    let strength =
+      if n1 = n2 then (tv1.strength +. tv2.strength) /. 2.0
+      else if n1 = infinity then tv1.strength
+      else tv2.strength
+    in
+    make_tv strength 1.0
+  else
+    let strength =
+      if n_new > 0.0 then
+        (tv1.strength *. n1 +. tv2.strength *. n2) /. n_new
+      else
+        (tv1.strength +. tv2.strength) /. 2.0
+    in
+    make_tv_from_count strength n_new
 
 (** ================================================================== *)
 (** Second-Order PLN Formulas (Similarity, Inheritance) *)
@@ -244,8 +244,8 @@ let store_pln_tensor_in_atomspace atomspace pln_tensor =
 let load_pln_tensor_from_atomspace atomspace tensor_id logic_types probability_states =
   match Hypergraph.get_tensor atomspace tensor_id with
   | Some tensor ->
-    let [l_dim; p_dim] = tensor.shape in
-    let tensor_data = flat_array_to_pln_tensor_data tensor.data l_dim p_dim in
+    let [l_dim; p_dim] = Hypergraph.tensor_shape_of tensor in
+    let tensor_data = flat_array_to_pln_tensor_data (Hypergraph.tensor_values tensor) l_dim p_dim in
     Some {
       logic_types = logic_types;
       probability_states = probability_states;
@@ -414,16 +414,43 @@ let calculate_confidence result =
   let (_, conf) = result.truth_value in
   conf *. (1.0 /. (1.0 +. float_of_int (List.length result.premises_used)))
 
+(** Conclusion a rule would derive, computed without touching the AtomSpace *)
+type derivation = {
+  derived_rule : pln_rule;
+  derived_type : Hypergraph.link_type;
+  derived_outgoing : Hypergraph.node_id list;
+  derived_truth : float * float;
+  derived_from : Hypergraph.link_id list;
+}
+
+(** Deduction: A -> B, B -> C implies A -> C *)
+let derive_deduction atomspace premises =
+  match premises with
+  | [p1; p2] ->
+      (match Hypergraph.get_link atomspace p1, Hypergraph.get_link atomspace p2 with
+       | Some { Hypergraph.link_type = Hypergraph.Implication; outgoing = [a; b]; truth_value = (s1, c1); _ },
+         Some { Hypergraph.link_type = Hypergraph.Implication; outgoing = [b'; c]; truth_value = (s2, c2); _ }
+         when b = b' && a <> c ->
+           let tv = Pln_formulas.deduction_simple
+                      (Pln_formulas.make_tv s1 c1) (Pln_formulas.make_tv s2 c2) in
+           Some {
+             derived_rule = Deduction_rule;
+             derived_type = Hypergraph.Implication;
+             derived_outgoing = [a; c];
+             derived_truth = (tv.Pln_formulas.strength, tv.Pln_formulas.confidence);
+             derived_from = premises;
+           }
+       | _ -> None)
+  | _ -> None
+
 (** PLN rule application stubs *)
 let apply_deduction_rule atomspace premises =
-  (* Stub: A -> B, B -> C implies A -> C *)
-  match premises with
-  | [p1; p2] -> 
-      (* In real implementation, would check if premises form valid deduction *)
-      let target_nodes = [1; 2] in (* Placeholder *)
-      let new_link_id = Hypergraph.add_link atomspace Hypergraph.Implication target_nodes in
+  match derive_deduction atomspace premises with
+  | Some d ->
+      let new_link_id = Hypergraph.add_link atomspace d.derived_type d.derived_outgoing in
+      Hypergraph.update_link_truth atomspace new_link_id d.derived_truth;
       Some new_link_id
-  | _ -> None
+  | None -> None
 
 let apply_induction_rule atomspace premises =
   (* Stub: Multiple instances of A -> B implies general rule *)
@@ -453,11 +480,16 @@ let apply_pln_rule engine rule context =
   
   match result_link with
   | Some link_id ->
+      (* The truth value the rule wrote on its conclusion *)
+      let truth_value = match Hypergraph.get_link engine.atomspace link_id with
+        | Some link -> link.Hypergraph.truth_value
+        | None -> (0.0, 0.0)
+      in
       let result = {
         conclusion_link = link_id;
         applied_rule = rule;
-        truth_value = (0.8, 0.7); (* Placeholder values *)
-        confidence = 0.75;
+        truth_value;
+        confidence = snd truth_value;
         premises_used = context.premises;
       } in
       engine.inference_count <- engine.inference_count + 1;
@@ -491,6 +523,312 @@ let forward_chaining engine max_steps =
   done;
   !results
 
+(** Pure counterpart of [apply_pln_rule], safe to run in parallel workers.
+    Only rules that join real premises derive anything; the stubbed
+    rules' placeholder conclusions are never committed this way. *)
+let derive_conclusion atomspace rule premises =
+  match rule with
+  | Deduction_rule -> derive_deduction atomspace premises
+  | _ -> None
+
+(** Premise combinations to try for [rule] given one new link. Deduction
+    joins the link with its neighbours through the adjacency indexes;
+    the other rules derive nothing from premises yet. *)
+let premise_combinations atomspace rule link_id =
+  match rule with
+  | Deduction_rule ->
+      (match Hypergraph.get_link atomspace link_id with
+       | Some { Hypergraph.outgoing = [a; b]; _ } ->
+           let is_implication id =
+             match Hypergraph.get_link atomspace id with
+             | Some { Hypergraph.link_type = Hypergraph.Implication; outgoing = [_; _]; _ } -> true
+             | _ -> false
+           in
+           (* link_id as A -> B followed by B -> C *)
+           let forward = List.filter is_implication (Hypergraph.get_outgoing_links atomspace b) in
+           (* X -> A followed by link_id as A -> B *)
+           let backward = List.filter (fun id ->
+             is_implication id &&
+             (match Hypergraph.get_link atomspace id with
+              | Some { Hypergraph.outgoing = [_; a']; _ } -> a' = a
+              | _ -> false)
+           ) (Hypergraph.get_incoming_links atomspace a) in
+           List.map (fun id -> [link_id; id]) forward @
+           List.map (fun id -> [id; link_id]) backward
+       | _ -> [])
+  | _ -> []
+
+(** Parallel semi-naive forward chaining.
+    Each step only joins implication links that are new since the
+    previous step. The delta links are partitioned across [workers]
+    processes, balanced by their number of join partners; each worker
+    joins its links and matches rules without mutating the AtomSpace,
+    and returns only conclusions not already present. These are
+    deduplicated across workers and committed sequentially. *)
+let parallel_forward_chaining ?(workers = Parallel_pool.default_workers) engine max_steps =
+  let atomspace = engine.atomspace in
+  let known = Hashtbl.create 1024 in
+  Hashtbl.iter (fun _ (link : Hypergraph.link) ->
+    Hashtbl.replace known (link.link_type, link.outgoing) ()
+  ) atomspace.Hypergraph.links;
+  
+  let results = ref [] in
+  let delta = ref (Hypergraph.find_links_by_type atomspace Hypergraph.Implication) in
+  let steps = ref 0 in
+  
+  (* Join cost of a delta link: the partners deduction scans for it *)
+  let partners link_id =
+    match Hypergraph.get_link atomspace link_id with
+    | Some { Hypergraph.outgoing = [a; b]; _ } ->
+        List.length (Hypergraph.get_outgoing_links atomspace b)
+        + List.length (Hypergraph.get_incoming_links atomspace a)
+    | _ -> 0
+  in
+  
+  while !steps < max_steps && !delta <> [] do
+    let join_chunk links =
+      let seen = Hashtbl.create 64 in
+      Array.fold_left (fun acc link_id ->
+        List.fold_left (fun acc rule ->
+          List.fold_left (fun acc premises ->
+            match derive_conclusion atomspace rule premises with
+            | Some d ->
+                let key = (d.derived_type, d.derived_outgoing) in
+                if Hashtbl.mem seen key || Hashtbl.mem known key then acc
+                else begin
+                  Hashtbl.add seen key ();
+                  d :: acc
+                end
+            | None -> acc
+          ) acc (premise_combinations atomspace rule link_id)
+        ) acc engine.pln_rules
+      ) [] links
+    in
+    let derived = Parallel_pool.map ~workers join_chunk
+                    (Parallel_pool.balance workers partners (Array.of_list !delta)) in
+    
+    let next_delta = ref [] in
+    Array.iter (List.iter (fun d ->
+      let key = (d.derived_type, d.derived_outgoing) in
+      if not (Hashtbl.mem known key) then begin
+        Hashtbl.add known key ();
+        let link_id = Hypergraph.add_link atomspace d.derived_type d.derived_outgoing in
+        Hypergraph.update_link_truth atomspace link_id d.derived_truth;
+        let result = {
+          conclusion_link = link_id;
+          applied_rule = d.derived_rule;
+          truth_value = d.derived_truth;
+          confidence = snd d.derived_truth;
+          premises_used = d.derived_from;
+        } in
+        engine.inference_count <- engine.inference_count + 1;
+        Hashtbl.replace engine.inference_cache d.derived_from result;
+        results := result :: !results;
+        if d.derived_type = Hypergraph.Implication then
+          next_delta := link_id :: !next_delta
+      end
+    )) derived;
+    
+    delta := !next_delta;
+    incr steps
+  done;
+  !results
+
+(** Delta-driven inference agenda.
+    The agenda subscribes to AtomSpace link events and keeps, per cycle,
+    only the implication links added or re-weighted since the previous
+    cycle. Deduction's partial matches are held in two alpha memories
+    (implications by source and by target node), so joining a changed
+    link costs its number of partners rather than the size of the
+    knowledge base. A conclusion reached from several premise sets keeps
+    each set's truth value and holds their PLN revision. *)
+type inference_agenda = {
+  agenda_engine : reasoning_engine;
+  pending : (Hypergraph.link_id, unit) Hashtbl.t;
+  implications_from : (Hypergraph.node_id, Hypergraph.link_id list) Hashtbl.t;
+  implications_to : (Hypergraph.node_id, Hypergraph.link_id list) Hashtbl.t;
+  conclusions : (Hypergraph.link_type * Hypergraph.node_id list, Hypergraph.link_id) Hashtbl.t;
+  derived_links : (Hypergraph.link_id, unit) Hashtbl.t;
+  support : (Hypergraph.link_type * Hypergraph.node_id list,
+             (Hypergraph.link_id list, float * float) Hashtbl.t) Hashtbl.t;
+  mutable agenda_cycles : int;
+  mutable subscription : Hypergraph.link_subscription option;
+}
+
+let alpha_add memory key link_id =
+  let existing = try Hashtbl.find memory key with Not_found -> [] in
+  Hashtbl.replace memory key (link_id :: existing)
+
+let alpha_remove memory key link_id =
+  let existing = try Hashtbl.find memory key with Not_found -> [] in
+  match List.filter (fun id -> id <> link_id) existing with
+  | [] -> Hashtbl.remove memory key
+  | remaining -> Hashtbl.replace memory key remaining
+
+let agenda_link_added agenda link_id =
+  match Hypergraph.get_link agenda.agenda_engine.atomspace link_id with
+  | Some link ->
+      Hashtbl.replace agenda.conclusions (link.link_type, link.outgoing) link_id;
+      (match link.link_type, link.outgoing with
+       | Hypergraph.Implication, [a; b] ->
+           alpha_add agenda.implications_from a link_id;
+           alpha_add agenda.implications_to b link_id;
+           Hashtbl.replace agenda.pending link_id ()
+       | _ -> ())
+  | None -> ()
+
+let agenda_link_removed agenda link_id =
+  match Hypergraph.get_link agenda.agenda_engine.atomspace link_id with
+  | Some link ->
+      Hashtbl.remove agenda.conclusions (link.link_type, link.outgoing);
+      if Hashtbl.mem agenda.derived_links link_id then
+        Hashtbl.remove agenda.support (link.link_type, link.outgoing);
+      Hashtbl.remove agenda.derived_links link_id;
+      Hashtbl.remove agenda.pending link_id;
+      (match link.link_type, link.outgoing with
+       | Hypergraph.Implication, [a; b] ->
+           alpha_remove agenda.implications_from a link_id;
+           alpha_remove agenda.implications_to b link_id
+       | _ -> ())
+  | None -> ()
+
+let create_inference_agenda engine =
+  let agenda = {
+    agenda_engine = engine;
+    pending = Hashtbl.create 1024;
+    implications_from = Hashtbl.create 1024;
+    implications_to = Hashtbl.create 1024;
+    conclusions = Hashtbl.create 1024;
+    derived_links = Hashtbl.create 1024;
+    support = Hashtbl.create 1024;
+    agenda_cycles = 0;
+    subscription = None;
+  } in
+  (* The whole existing knowledge base is the first delta *)
+  Hashtbl.iter (fun link_id _ -> agenda_link_added agenda link_id)
+    engine.atomspace.Hypergraph.links;
+  agenda.subscription <- Some (Hypergraph.subscribe_link_events engine.atomspace (function
+    | Hypergraph.Link_added link_id -> agenda_link_added agenda link_id
+    | Hypergraph.Link_truth_updated link_id ->
+        (match Hypergraph.get_link engine.atomspace link_id with
+         | Some { Hypergraph.link_type = Hypergraph.Implication; outgoing = [_; _]; _ } ->
+             Hashtbl.replace agenda.pending link_id ()
+         | _ -> ())
+    | Hypergraph.Link_removed link_id -> agenda_link_removed agenda link_id));
+  agenda
+
+let release_inference_agenda agenda =
+  match agenda.subscription with
+  | Some subscription ->
+      Hypergraph.unsubscribe_link_events agenda.agenda_engine.atomspace subscription;
+      agenda.subscription <- None;
+      Hashtbl.reset agenda.pending
+  | None -> ()
+
+(** Premise combinations for a changed link, joined through the alpha memories *)
+let agenda_premises agenda rule link_id =
+  match rule with
+  | Deduction_rule ->
+      (match Hypergraph.get_link agenda.agenda_engine.atomspace link_id with
+       | Some { Hypergraph.outgoing = [a; b]; _ } ->
+           let forward = try Hashtbl.find agenda.implications_from b with Not_found -> [] in
+           let backward = try Hashtbl.find agenda.implications_to a with Not_found -> [] in
+           List.map (fun id -> [link_id; id]) forward @
+           List.map (fun id -> [id; link_id]) backward
+       | _ -> [])
+  | _ -> []
+
+let truth_changed (s1, c1) (s2, c2) =
+  abs_float (s1 -. s2) > 1e-6 || abs_float (c1 -. c2) > 1e-6
+
+(** Record one premise set's derivation of a conclusion and return the
+    revision of every set still supporting it. Sets whose premises have
+    been removed from the AtomSpace no longer count. *)
+let revise_support agenda d =
+  let atomspace = agenda.agenda_engine.atomspace in
+  let key = (d.derived_type, d.derived_outgoing) in
+  let table = match Hashtbl.find_opt agenda.support key with
+    | Some table -> table
+    | None ->
+        let table = Hashtbl.create 4 in
+        Hashtbl.replace agenda.support key table;
+        table
+  in
+  Hashtbl.replace table d.derived_from d.derived_truth;
+  let stale = Hashtbl.fold (fun premises _ acc ->
+    if List.for_all (fun id -> Hypergraph.get_link atomspace id <> None) premises
+    then acc else premises :: acc) table [] in
+  List.iter (Hashtbl.remove table) stale;
+  let evidence = Hashtbl.fold (fun _ (s, c) acc ->
+    Pln_formulas.make_tv s c :: acc) table [] in
+  match evidence with
+  | [] -> d.derived_truth
+  | tv :: rest ->
+      let revised = List.fold_left Pln_formulas.revision tv rest in
+      (revised.Pln_formulas.strength, revised.Pln_formulas.confidence)
+
+(** Process the current delta once. New conclusions are added to the
+    AtomSpace; conclusions previously derived by the agenda are updated
+    when their premises changed. Either kind of change feeds the next
+    cycle through the link event subscription. *)
+let run_agenda_cycle agenda =
+  let engine = agenda.agenda_engine in
+  let atomspace = engine.atomspace in
+  let delta = Hashtbl.fold (fun link_id () acc -> link_id :: acc) agenda.pending [] in
+  Hashtbl.reset agenda.pending;
+  let results = ref [] in
+  let record d tv link_id =
+    let result = {
+      conclusion_link = link_id;
+      applied_rule = d.derived_rule;
+      truth_value = tv;
+      confidence = snd tv;
+      premises_used = d.derived_from;
+    } in
+    engine.inference_count <- engine.inference_count + 1;
+    Hashtbl.replace engine.inference_cache d.derived_from result;
+    results := result :: !results
+  in
+  List.iter (fun link_id ->
+    List.iter (fun rule ->
+      List.iter (fun premises ->
+        match derive_conclusion atomspace rule premises with
+        | None -> ()
+        | Some d ->
+            let key = (d.derived_type, d.derived_outgoing) in
+            (match Hashtbl.find_opt agenda.conclusions key with
+             | None ->
+                 let tv = revise_support agenda d in
+                 let new_link = Hypergraph.add_link atomspace d.derived_type d.derived_outgoing in
+                 Hashtbl.replace agenda.derived_links new_link ();
+                 Hypergraph.update_link_truth atomspace new_link tv;
+                 record d tv new_link
+             | Some existing when Hashtbl.mem agenda.derived_links existing ->
+                 let tv = revise_support agenda d in
+                 (match Hypergraph.get_link atomspace existing with
+                  | Some link when truth_changed link.truth_value tv ->
+                      Hypergraph.update_link_truth atomspace existing tv;
+                      record d tv existing
+                  | _ -> ())
+             | Some _ -> ())
+      ) (agenda_premises agenda rule link_id)
+    ) engine.pln_rules
+  ) delta;
+  agenda.agenda_cycles <- agenda.agenda_cycles + 1;
+  List.rev !results
+
+(** Run cycles until the delta is empty or [max_cycles] is reached *)
+let run_agenda agenda max_cycles =
+  let rec loop cycle acc =
+    if cycle >= max_cycles || Hashtbl.length agenda.pending = 0 then
+      List.concat (List.rev acc)
+    else
+      loop (cycle + 1) (run_agenda_cycle agenda :: acc)
+  in
+  loop 0 []
+
+let agenda_pending_count agenda = Hashtbl.length agenda.pending
+
 let backward_chaining engine target_link =
   (* Stub: Work backwards from target to find supporting premises *)
   let context = {
@@ -948,31 +1286,53 @@ let pln_rule_to_string = function
   | Temporal_rule -> "temporal"
   | Causal_rule -> "causal"
 
-let pln_rule_to_scheme rule =
-  Printf.sprintf "(rule %s)" (pln_rule_to_string rule)
+let add_pln_rule_scheme buf rule =
+  Printf.bprintf buf "(rule %s)" (pln_rule_to_string rule)
 
-let inference_result_to_scheme result =
-  let premises_str = String.concat " " (List.map string_of_int result.premises_used) in
+let add_inference_result_scheme buf result =
   let (strength, confidence) = result.truth_value in
-  Printf.sprintf "(inference-result (conclusion %d) (rule %s) (truth %.3f %.3f) (confidence %.3f) (premises (%s)))"
+  Printf.bprintf buf "(inference-result (conclusion %d) (rule %s) (truth %.3f %.3f) (confidence %.3f) (premises ("
     result.conclusion_link
     (pln_rule_to_string result.applied_rule)
     strength confidence
-    result.confidence
-    premises_str
+    result.confidence;
+  List.iteri (fun i id ->
+    if i > 0 then Buffer.add_char buf ' ';
+    Buffer.add_string buf (string_of_int id)) result.premises_used;
+  Buffer.add_string buf ")))"
+
+let add_moses_candidate_scheme buf candidate =
+  Buffer.add_string buf "(moses-candidate (program ";
+  Hypergraph.add_scheme_string buf candidate.program;
+  Printf.bprintf buf ") (fitness %.3f) (complexity %d) (generation %d))"
+    candidate.fitness candidate.complexity candidate.generation
+
+let write_reasoning_engine_scheme buf flush engine =
+  Printf.bprintf buf "(reasoning-engine\n  (inference-count %d)\n  (pln-rules (%s))\n  (moses-population ("
+    engine.inference_count
+    (String.concat " " (List.map pln_rule_to_string engine.pln_rules));
+  List.iteri (fun i candidate ->
+    if i > 0 then Buffer.add_char buf ' ';
+    add_moses_candidate_scheme buf candidate;
+    flush ()
+  ) engine.moses_population;
+  Printf.bprintf buf "))\n  (cache-size %d))" (Hashtbl.length engine.inference_cache)
+
+let add_reasoning_engine_scheme buf engine = write_reasoning_engine_scheme buf ignore engine
+
+let output_reasoning_engine_scheme oc engine =
+  Hypergraph.output_scheme oc (fun buf flush -> write_reasoning_engine_scheme buf flush engine)
+
+let pln_rule_to_scheme rule = Hypergraph.scheme_of_buffer add_pln_rule_scheme rule
+
+let inference_result_to_scheme result =
+  Hypergraph.scheme_of_buffer add_inference_result_scheme result
 
 let moses_candidate_to_scheme candidate =
-  Printf.sprintf "(moses-candidate (program \"%s\") (fitness %.3f) (complexity %d) (generation %d))"
-    candidate.program candidate.fitness candidate.complexity candidate.generation
+  Hypergraph.scheme_of_buffer add_moses_candidate_scheme candidate
 
 let reasoning_engine_to_scheme engine =
-  let rules_str = String.concat " " (List.map pln_rule_to_string engine.pln_rules) in
-  let population_str = String.concat " " (List.map moses_candidate_to_scheme engine.moses_population) in
-  Printf.sprintf "(reasoning-engine\n  (inference-count %d)\n  (pln-rules (%s))\n  (moses-population (%s))\n  (cache-size %d))"
-    engine.inference_count
-    rules_str
-    population_str
-    (Hashtbl.length engine.inference_cache)
+  Hypergraph.scheme_of_buffer add_reasoning_engine_scheme engine
 
 (** Temporal Logic Operations Implementation *)
 
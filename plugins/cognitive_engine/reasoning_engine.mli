@@ -218,6 +218,30 @@ val apply_pln_rule : reasoning_engine -> pln_rule -> inference_context -> infere
 
 val forward_chaining : reasoning_engine -> int -> inference_result list
 
+(** Parallel semi-naive forward chaining: only links derived in the
+    previous step are re-joined, the joins are partitioned across
+    [workers] processes (default [Parallel_pool.default_workers]), and
+    duplicate conclusions are dropped *)
+val parallel_forward_chaining : ?workers:int -> reasoning_engine -> int -> inference_result list
+
+(** Delta-driven inference agenda fed by AtomSpace link events *)
+type inference_agenda
+
+(** Create an agenda; the existing implication links form its first delta.
+    The agenda observes the AtomSpace until it is released. *)
+val create_inference_agenda : reasoning_engine -> inference_agenda
+
+(** Unsubscribe the agenda from its AtomSpace and drop pending changes *)
+val release_inference_agenda : inference_agenda -> unit
+
+(** Process the links added or changed since the previous cycle *)
+val run_agenda_cycle : inference_agenda -> inference_result list
+
+(** Run cycles until no changes are pending or the cycle limit is hit *)
+val run_agenda : inference_agenda -> int -> inference_result list
+
+val agenda_pending_count : inference_agenda -> int
+
 val backward_chaining : reasoning_engine -> Hypergraph.link_id -> inference_result list
 
 val find_applicable_rules : reasoning_engine -> Hypergraph.link_id list -> (pln_rule * inference_context) list
@@ -295,7 +319,18 @@ val create_reasoning_tasks : reasoning_engine -> Hypergraph.node_id list -> Task
 
 val execute_reasoning_task : reasoning_engine -> Task_system.cognitive_task -> unit
 
-(** Scheme representation *)
+(** Scheme representation, into a Buffer, to a channel in chunks, or as
+    a string *)
+val add_pln_rule_scheme : Buffer.t -> pln_rule -> unit
+
+val add_inference_result_scheme : Buffer.t -> inference_result -> unit
+
+val add_moses_candidate_scheme : Buffer.t -> moses_candidate -> unit
+
+val add_reasoning_engine_scheme : Buffer.t -> reasoning_engine -> unit
+
+val output_reasoning_engine_scheme : out_channel -> reasoning_engine -> unit
+
 val pln_rule_to_scheme : pln_rule -> string
 
 val inference_result_to_scheme : inference_result -> string
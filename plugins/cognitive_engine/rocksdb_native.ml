@@ -17,6 +17,7 @@
     - Snapshots for consistent reads
     - Compression support (LZ4, Snappy, Zstd)
     - Iterator support for range scans
+    - Zero-copy Bigarray value paths and multi-get
 *)
 
 (** {1 Types} *)
@@ -51,6 +52,9 @@ type iterator
 (** Opaque snapshot handle *)
 type snapshot
 
+(** Caller-owned byte buffer for zero-copy reads and writes *)
+type buffer = (char, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
 (** {1 Backend Detection} *)
 
 external backend_available : unit -> bool = "caml_rocksdb_backend_available"
@@ -138,6 +142,14 @@ external batch_clear : batch -> unit = "caml_rocksdb_batch_clear"
 external batch_count : batch -> int = "caml_rocksdb_batch_count"
 external batch_write : db -> batch -> unit = "caml_rocksdb_batch_write"
 external batch_destroy : batch -> unit = "caml_rocksdb_batch_destroy"
+external batch_put_cf_raw : db -> batch -> int -> string -> string -> unit = "caml_rocksdb_batch_put_cf"
+external batch_delete_cf_raw : db -> batch -> int -> string -> unit = "caml_rocksdb_batch_delete_cf"
+
+let batch_put_cf db batch cf key value =
+  batch_put_cf_raw db batch (cf_to_int cf) key value
+
+let batch_delete_cf db batch cf key =
+  batch_delete_cf_raw db batch (cf_to_int cf) key
 
 let with_batch db f =
   let batch = batch_create () in
@@ -212,6 +224,34 @@ let iter_range ?(cf=Default) db ~start_key ~end_key =
   iter_destroy iter;
   result
 
+(** {1 Zero-Copy Operations}
+
+    Values move between RocksDB and caller-owned Bigarrays without
+    allocating OCaml strings. Reads return the full value length, or -1
+    when the key is absent; only the prefix that fits is copied. *)
+
+external put_bigarray_raw : db -> int -> string -> buffer -> unit = "caml_rocksdb_put_bigarray"
+external get_into_raw : db -> int -> string -> buffer -> int = "caml_rocksdb_get_into"
+external batch_put_bigarray_raw : db -> batch -> int -> string -> buffer -> unit = "caml_rocksdb_batch_put_bigarray"
+external iter_key_into : iterator -> buffer -> int = "caml_rocksdb_iter_key_into"
+external iter_value_into : iterator -> buffer -> int = "caml_rocksdb_iter_value_into"
+external multi_get_into_raw : db -> int -> string array -> buffer -> int array = "caml_rocksdb_multi_get_into"
+
+let create_buffer size =
+  Bigarray.Array1.create Bigarray.char Bigarray.c_layout size
+
+let put_bigarray ?(cf=Default) db key value =
+  put_bigarray_raw db (cf_to_int cf) key value
+
+let get_into ?(cf=Default) db key buf =
+  get_into_raw db (cf_to_int cf) key buf
+
+let batch_put_bigarray db batch cf key value =
+  batch_put_bigarray_raw db batch (cf_to_int cf) key value
+
+let multi_get_into ?(cf=Default) db keys buf =
+  multi_get_into_raw db (cf_to_int cf) keys buf
+
 (** {1 Snapshot Operations} *)
 
 external snapshot_create : db -> snapshot = "caml_rocksdb_snapshot_create"
@@ -227,6 +267,58 @@ let with_snapshot db f =
     snapshot_release snap;
     raise e
 
+(** {1 Range Scans}
+
+    Range iterators read between two keys ([lower] inclusive, [upper]
+    exclusive; an empty bound is open), optionally pinned to a snapshot.
+    [iter_read_batch] copies entries into a buffer with the runtime lock
+    released, framed as [key length: u32 LE][value length: u32 LE][key][value],
+    so several threads can scan disjoint ranges at once. *)
+
+external iter_create_range_raw : db -> int -> snapshot option -> string -> string -> iterator
+  = "caml_rocksdb_iter_create_range"
+external iter_read_batch : iterator -> buffer -> int = "caml_rocksdb_iter_read_batch"
+
+let iter_create_range ?(cf=Default) ?snapshot ?(lower="") ?(upper="") db =
+  iter_create_range_raw db (cf_to_int cf) snapshot lower upper
+
+let buffer_u32 buf off =
+  Char.code buf.{off}
+  lor (Char.code buf.{off + 1} lsl 8)
+  lor (Char.code buf.{off + 2} lsl 16)
+  lor (Char.code buf.{off + 3} lsl 24)
+
+let buffer_string buf off len =
+  Bytes.unsafe_to_string (Bytes.init len (fun i -> buf.{off + i}))
+
+let scan_range ?(cf=Default) ?snapshot ?lower ?upper ?(buffer_size=1 lsl 20) db ~init ~f =
+  let iter = iter_create_range ~cf ?snapshot ?lower ?upper db in
+  let rec loop buf acc =
+    match iter_read_batch iter buf with
+    | 0 -> acc
+    | n ->
+        let acc = ref acc and off = ref 0 in
+        for _ = 1 to n do
+          let klen = buffer_u32 buf !off and vlen = buffer_u32 buf (!off + 4) in
+          let key = buffer_string buf (!off + 8) klen in
+          let value = buffer_string buf (!off + 8 + klen) vlen in
+          acc := f !acc key value;
+          off := !off + 8 + klen + vlen
+        done;
+        loop buf !acc
+    | exception Invalid_argument _ ->
+        (* A single entry outgrew the buffer *)
+        loop (create_buffer (2 * Bigarray.Array1.dim buf)) acc
+  in
+  try
+    iter_seek_to_first iter;
+    let result = loop (create_buffer (max 64 buffer_size)) init in
+    iter_destroy iter;
+    result
+  with e ->
+    iter_destroy iter;
+    raise e
+
 (** {1 Statistics and Utilities} *)
 
 external get_property : db -> string -> string option = "caml_rocksdb_get_property"
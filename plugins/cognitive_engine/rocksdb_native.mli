@@ -40,6 +40,9 @@ type iterator
 (** Opaque snapshot handle *)
 type snapshot
 
+(** Caller-owned byte buffer for zero-copy reads and writes *)
+type buffer = (char, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
 (** {1 Backend Detection} *)
 
 (** Check if native RocksDB is available *)
@@ -56,7 +59,10 @@ val cf_name : column_family -> string
 (** Open a database *)
 val open_db : ?create_if_missing:bool -> ?compression:compression -> string -> db
 
-(** Close a database *)
+(** Close a database. Calls already running on other threads finish
+    first; later calls fail as on a closed database. Live iterators and
+    snapshots keep reading the old state, and the files stay open until
+    the last of them is destroyed or released. *)
 val close : db -> unit
 
 (** Check if database is open *)
@@ -90,6 +96,12 @@ val batch_put : batch -> string -> string -> unit
 (** Add a delete operation to batch *)
 val batch_delete : batch -> string -> unit
 
+(** Add a put operation into a column family of [db] to batch *)
+val batch_put_cf : db -> batch -> column_family -> string -> string -> unit
+
+(** Add a delete operation on a column family of [db] to batch *)
+val batch_delete_cf : db -> batch -> column_family -> string -> unit
+
 (** Clear all operations from batch *)
 val batch_clear : batch -> unit
 
@@ -134,7 +146,8 @@ val iter_key : iterator -> string
 (** Get current value *)
 val iter_value : iterator -> string
 
-(** Destroy iterator *)
+(** Destroy iterator, after any seek or read_batch still running on
+    another thread returns *)
 val iter_destroy : iterator -> unit
 
 (** Fold over all key-value pairs *)
@@ -152,6 +165,32 @@ val iter_pairs : ?cf:column_family -> db -> (string * string) list
 (** Get key-value pairs in range *)
 val iter_range : ?cf:column_family -> db -> start_key:string -> end_key:string -> (string * string) list
 
+(** {1 Zero-Copy Operations} *)
+
+(** Allocate a buffer of [size] bytes *)
+val create_buffer : int -> buffer
+
+(** Put a value held in a buffer; use [Bigarray.Array1.sub] to pass a slice *)
+val put_bigarray : ?cf:column_family -> db -> string -> buffer -> unit
+
+(** Read a value into a buffer through a pinned slice. Returns the full
+    value length (only the prefix that fits is copied), or -1 if absent. *)
+val get_into : ?cf:column_family -> db -> string -> buffer -> int
+
+(** Add a put of a buffered value to batch *)
+val batch_put_bigarray : db -> batch -> column_family -> string -> buffer -> unit
+
+(** Copy the current key into a buffer, returning its full length *)
+val iter_key_into : iterator -> buffer -> int
+
+(** Copy the current value into a buffer, returning its full length *)
+val iter_value_into : iterator -> buffer -> int
+
+(** Fetch several keys in one call. Values are packed back to back into
+    the buffer; the result holds each value's length, or -1 if absent.
+    Raises [Invalid_argument] if the values do not fit. *)
+val multi_get_into : ?cf:column_family -> db -> string array -> buffer -> int array
+
 (** {1 Snapshot Operations} *)
 
 (** Create a snapshot *)
@@ -163,6 +202,24 @@ val snapshot_release : snapshot -> unit
 (** Execute function with snapshot, auto-release *)
 val with_snapshot : db -> (snapshot -> 'a) -> 'a
 
+(** {1 Range Scans} *)
+
+(** Create an iterator over keys in \[lower, upper), reading from
+    [snapshot] if given. Omitted bounds are open. *)
+val iter_create_range :
+  ?cf:column_family -> ?snapshot:snapshot -> ?lower:string -> ?upper:string -> db -> iterator
+
+(** Copy entries from the current position into a buffer, advancing past
+    them, without holding the runtime lock. Returns the entry count (0 once
+    exhausted). Raises [Invalid_argument] if the next entry does not fit. *)
+val iter_read_batch : iterator -> buffer -> int
+
+(** Fold over a key range in buffered batches. Safe to run from several
+    threads on disjoint ranges; the RocksDB reads overlap. *)
+val scan_range :
+  ?cf:column_family -> ?snapshot:snapshot -> ?lower:string -> ?upper:string ->
+  ?buffer_size:int -> db -> init:'a -> f:('a -> string -> string -> 'a) -> 'a
+
 (** {1 Statistics and Utilities} *)
 
 (** Get a database property *)
@@ -19,6 +19,8 @@
  * - Compression (LZ4, Snappy, Zstd)
  * - Write-ahead logging
  * - Bloom filters for fast lookups
+ * - Zero-copy Bigarray value paths and multi-get
+ * - Blocking calls run without the OCaml runtime lock
  * 
  * Build with: -DHAVE_ROCKSDB -lrocksdb
  */
@@ -29,10 +31,13 @@
 #include <caml/custom.h>
 #include <caml/fail.h>
 #include <caml/callback.h>
+#include <caml/bigarray.h>
+#include <caml/threads.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #ifdef HAVE_ROCKSDB
 #include <rocksdb/c.h>
@@ -56,6 +61,13 @@
 
 #define MAX_COLUMN_FAMILIES 16
 
+/* Calls in flight on a handle with the runtime lock released */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+    int users;
+} handle_guard;
+
 /* Database wrapper */
 typedef struct {
     void *db;                           /* rocksdb_t pointer */
@@ -66,6 +78,8 @@ typedef struct {
     int n_cf;                           /* Number of column families */
     char *path;                         /* Database path */
     int is_open;                        /* Is database open */
+    int refs;                           /* OCaml handle + live iterators and snapshots */
+    handle_guard guard;                 /* Blocking calls in flight */
 } rocksdb_wrapper;
 
 /* Batch wrapper */
@@ -78,6 +92,11 @@ typedef struct {
 typedef struct {
     void *iter;                         /* rocksdb_iterator_t pointer */
     int cf_index;                       /* Column family index */
+    void *read_options;                 /* Own read options (snapshot/range), or NULL */
+    char *lower;                        /* Bound keys; must outlive the iterator */
+    char *upper;
+    rocksdb_wrapper *db_wrapper;        /* Parent database, kept open while live */
+    handle_guard guard;                 /* Blocking calls in flight */
 } rocksdb_iter_wrapper;
 
 /* Snapshot wrapper */
@@ -142,8 +161,169 @@ static struct custom_operations rocksdb_snapshot_ops = {
 #define Iter_val(v) (*((rocksdb_iter_wrapper **) Data_custom_val(v)))
 #define Snapshot_val(v) (*((rocksdb_snapshot_wrapper **) Data_custom_val(v)))
 
+/* Bigarray buffers: (char, int8_unsigned_elt, c_layout) Array1.t */
+#define Buffer_data(v) ((char *) Caml_ba_data_val(v))
+#define Buffer_size(v) ((size_t) Caml_ba_array_val(v)->dim[0])
+
 #ifdef HAVE_ROCKSDB
 
+/*
+ * ============================================================================
+ * Runtime Lock Helpers
+ * ============================================================================
+ *
+ * Calls that may block on I/O (reads, writes, flushes, compactions, seeks)
+ * release the OCaml runtime lock so other threads keep running. OCaml
+ * strings can move while the lock is released, so keys and values are
+ * copied out first; Bigarray data lives outside the heap and is used in
+ * place (the CAMLparam root keeps it alive).
+ */
+
+#define INLINE_KEY_SIZE 64
+
+/* Copy of an OCaml string; short keys avoid the heap */
+typedef struct {
+    char inline_buf[INLINE_KEY_SIZE];
+    char *data;
+    size_t len;
+} string_copy;
+
+/* Returns 0 when the copy cannot be allocated. It does not raise, so a
+ * caller holding other copies can free them first. */
+static int string_copy_init(string_copy *copy, value s) {
+    copy->len = caml_string_length(s);
+    if (copy->len <= INLINE_KEY_SIZE) {
+        copy->data = copy->inline_buf;
+    } else {
+        copy->data = (char *)malloc(copy->len);
+        if (copy->data == NULL) {
+            return 0;
+        }
+    }
+    memcpy(copy->data, String_val(s), copy->len);
+    return 1;
+}
+
+static void string_copy_free(string_copy *copy) {
+    if (copy->data != copy->inline_buf) {
+        free(copy->data);
+    }
+}
+
+static void string_copy_key(string_copy *copy, value s) {
+    if (!string_copy_init(copy, s)) {
+        caml_raise_out_of_memory();
+    }
+}
+
+/*
+ * Closing a handle while another thread is inside a call that released
+ * the runtime lock would free memory that call still uses. Such calls
+ * enter the handle's guard while holding the lock; close and destroy
+ * first detach the handle from its OCaml value, so no new call can
+ * start, then wait for the guard to drain before freeing anything.
+ *
+ * Iterators and snapshots keep using the database after the call that
+ * created them returns, so each one holds a reference on its database
+ * wrapper. Close drops the reference of the OCaml handle; the database
+ * itself is closed when the last reference goes. The references are only
+ * touched with the runtime lock held.
+ */
+
+static void guard_init(handle_guard *guard) {
+    pthread_mutex_init(&guard->lock, NULL);
+    pthread_cond_init(&guard->idle, NULL);
+    guard->users = 0;
+}
+
+static void guard_enter(handle_guard *guard) {
+    pthread_mutex_lock(&guard->lock);
+    guard->users++;
+    pthread_mutex_unlock(&guard->lock);
+}
+
+static void guard_leave(handle_guard *guard) {
+    pthread_mutex_lock(&guard->lock);
+    if (--guard->users == 0) {
+        pthread_cond_broadcast(&guard->idle);
+    }
+    pthread_mutex_unlock(&guard->lock);
+}
+
+/* Wait, without the runtime lock, until no call is in flight */
+static void guard_drain(handle_guard *guard) {
+    caml_release_runtime_system();
+    pthread_mutex_lock(&guard->lock);
+    while (guard->users > 0) {
+        pthread_cond_wait(&guard->idle, &guard->lock);
+    }
+    pthread_mutex_unlock(&guard->lock);
+    caml_acquire_runtime_system();
+    pthread_cond_destroy(&guard->idle);
+    pthread_mutex_destroy(&guard->lock);
+}
+
+/* Release the runtime lock around a blocking call on [wrapper] */
+static void db_release(rocksdb_wrapper *wrapper) {
+    guard_enter(&wrapper->guard);
+    caml_release_runtime_system();
+}
+
+static void db_acquire(rocksdb_wrapper *wrapper) {
+    caml_acquire_runtime_system();
+    guard_leave(&wrapper->guard);
+}
+
+static void db_ref(rocksdb_wrapper *wrapper) {
+    wrapper->refs++;
+}
+
+static void db_unref(rocksdb_wrapper *wrapper) {
+    if (--wrapper->refs > 0) {
+        return;
+    }
+    
+    /* Close column family handles */
+    for (int i = 0; i < wrapper->n_cf; i++) {
+        if (wrapper->cf_handles[i] != NULL) {
+            rocksdb_column_family_handle_destroy(wrapper->cf_handles[i]);
+        }
+    }
+    
+    rocksdb_close(wrapper->db);
+    rocksdb_options_destroy(wrapper->options);
+    rocksdb_writeoptions_destroy(wrapper->write_options);
+    rocksdb_readoptions_destroy(wrapper->read_options);
+    
+    free(wrapper->path);
+    free(wrapper);
+}
+
+static void iter_release(rocksdb_iter_wrapper *wrapper) {
+    guard_enter(&wrapper->guard);
+    caml_release_runtime_system();
+}
+
+static void iter_acquire(rocksdb_iter_wrapper *wrapper) {
+    caml_acquire_runtime_system();
+    guard_leave(&wrapper->guard);
+}
+
+static rocksdb_column_family_handle_t *cf_handle(rocksdb_wrapper *wrapper, int cf_idx) {
+    if (cf_idx > 0 && cf_idx < wrapper->n_cf) {
+        return wrapper->cf_handles[cf_idx];
+    }
+    return NULL;
+}
+
+/* Raise a Failure for a RocksDB error string, freeing it */
+static void raise_rocksdb_error(const char *op, char *err) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s failed: %s", op, err);
+    free(err);
+    caml_failwith(msg);
+}
+
 /*
  * ============================================================================
  * Database Management
@@ -240,6 +420,8 @@ CAMLprim value caml_rocksdb_open(value path, value create_if_missing, value comp
     wrapper->n_cf = n_cf;
     wrapper->path = strdup(db_path);
     wrapper->is_open = 1;
+    wrapper->refs = 1;
+    guard_init(&wrapper->guard);
     
     for (int i = 0; i < n_cf; i++) {
         wrapper->cf_handles[i] = cf_handles[i];
@@ -256,22 +438,12 @@ CAMLprim value caml_rocksdb_close(value db) {
     
     rocksdb_wrapper *wrapper = Rocksdb_val(db);
     if (wrapper != NULL && wrapper->is_open) {
-        /* Close column family handles */
-        for (int i = 0; i < wrapper->n_cf; i++) {
-            if (wrapper->cf_handles[i] != NULL) {
-                rocksdb_column_family_handle_destroy(wrapper->cf_handles[i]);
-            }
-        }
-        
-        rocksdb_close(wrapper->db);
-        rocksdb_options_destroy(wrapper->options);
-        rocksdb_writeoptions_destroy(wrapper->write_options);
-        rocksdb_readoptions_destroy(wrapper->read_options);
-        
-        free(wrapper->path);
+        /* Detach so no new call starts, then let in-flight calls finish */
         wrapper->is_open = 0;
-        free(wrapper);
         Rocksdb_val(db) = NULL;
+        guard_drain(&wrapper->guard);
+        /* Live iterators and snapshots defer the real close */
+        db_unref(wrapper);
     }
     
     CAMLreturn(Val_unit);
@@ -299,32 +471,28 @@ CAMLprim value caml_rocksdb_put(value db, value cf_index, value key, value val)
     }
     
     char *err = NULL;
-    int cf_idx = Int_val(cf_index);
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    string_copy k, v;
+    string_copy_key(&k, key);
+    if (!string_copy_init(&v, val)) {
+        string_copy_free(&k);
+        caml_raise_out_of_memory();
+    }
     
-    if (cf_idx > 0 && cf_idx < wrapper->n_cf && wrapper->cf_handles[cf_idx] != NULL) {
-        rocksdb_put_cf(
-            wrapper->db,
-            wrapper->write_options,
-            wrapper->cf_handles[cf_idx],
-            String_val(key), caml_string_length(key),
-            String_val(val), caml_string_length(val),
-            &err
-        );
+    db_release(wrapper);
+    if (cf != NULL) {
+        rocksdb_put_cf(wrapper->db, wrapper->write_options, cf,
+                       k.data, k.len, v.data, v.len, &err);
     } else {
-        rocksdb_put(
-            wrapper->db,
-            wrapper->write_options,
-            String_val(key), caml_string_length(key),
-            String_val(val), caml_string_length(val),
-            &err
-        );
+        rocksdb_put(wrapper->db, wrapper->write_options,
+                    k.data, k.len, v.data, v.len, &err);
     }
+    db_acquire(wrapper);
     
+    string_copy_free(&k);
+    string_copy_free(&v);
     if (err != NULL) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "rocksdb_put failed: %s", err);
-        free(err);
-        caml_failwith(msg);
+        raise_rocksdb_error("rocksdb_put", err);
     }
     
     CAMLreturn(Val_unit);
@@ -341,33 +509,24 @@ CAMLprim value caml_rocksdb_get(value db, value cf_index, value key) {
     
     char *err = NULL;
     size_t val_len;
-    int cf_idx = Int_val(cf_index);
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
     char *val;
+    string_copy k;
+    string_copy_key(&k, key);
     
-    if (cf_idx > 0 && cf_idx < wrapper->n_cf && wrapper->cf_handles[cf_idx] != NULL) {
-        val = rocksdb_get_cf(
-            wrapper->db,
-            wrapper->read_options,
-            wrapper->cf_handles[cf_idx],
-            String_val(key), caml_string_length(key),
-            &val_len,
-            &err
-        );
+    db_release(wrapper);
+    if (cf != NULL) {
+        val = rocksdb_get_cf(wrapper->db, wrapper->read_options, cf,
+                             k.data, k.len, &val_len, &err);
     } else {
-        val = rocksdb_get(
-            wrapper->db,
-            wrapper->read_options,
-            String_val(key), caml_string_length(key),
-            &val_len,
-            &err
-        );
+        val = rocksdb_get(wrapper->db, wrapper->read_options,
+                          k.data, k.len, &val_len, &err);
     }
+    db_acquire(wrapper);
     
+    string_copy_free(&k);
     if (err != NULL) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "rocksdb_get failed: %s", err);
-        free(err);
-        caml_failwith(msg);
+        raise_rocksdb_error("rocksdb_get", err);
     }
     
     if (val == NULL) {
@@ -395,30 +554,21 @@ CAMLprim value caml_rocksdb_delete(value db, value cf_index, value key) {
     }
     
     char *err = NULL;
-    int cf_idx = Int_val(cf_index);
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    string_copy k;
+    string_copy_key(&k, key);
     
-    if (cf_idx > 0 && cf_idx < wrapper->n_cf && wrapper->cf_handles[cf_idx] != NULL) {
-        rocksdb_delete_cf(
-            wrapper->db,
-            wrapper->write_options,
-            wrapper->cf_handles[cf_idx],
-            String_val(key), caml_string_length(key),
-            &err
-        );
+    db_release(wrapper);
+    if (cf != NULL) {
+        rocksdb_delete_cf(wrapper->db, wrapper->write_options, cf, k.data, k.len, &err);
     } else {
-        rocksdb_delete(
-            wrapper->db,
-            wrapper->write_options,
-            String_val(key), caml_string_length(key),
-            &err
-        );
+        rocksdb_delete(wrapper->db, wrapper->write_options, k.data, k.len, &err);
     }
+    db_acquire(wrapper);
     
+    string_copy_free(&k);
     if (err != NULL) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "rocksdb_delete failed: %s", err);
-        free(err);
-        caml_failwith(msg);
+        raise_rocksdb_error("rocksdb_delete", err);
     }
     
     CAMLreturn(Val_unit);
@@ -433,36 +583,28 @@ CAMLprim value caml_rocksdb_exists(value db, value cf_index, value key) {
     }
     
     char *err = NULL;
-    size_t val_len;
-    int cf_idx = Int_val(cf_index);
-    char *val;
-    
-    if (cf_idx > 0 && cf_idx < wrapper->n_cf && wrapper->cf_handles[cf_idx] != NULL) {
-        val = rocksdb_get_cf(
-            wrapper->db,
-            wrapper->read_options,
-            wrapper->cf_handles[cf_idx],
-            String_val(key), caml_string_length(key),
-            &val_len,
-            &err
-        );
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    rocksdb_pinnableslice_t *slice;
+    string_copy k;
+    string_copy_key(&k, key);
+    
+    /* A pinned lookup avoids copying a value nobody reads */
+    db_release(wrapper);
+    if (cf != NULL) {
+        slice = rocksdb_get_pinned_cf(wrapper->db, wrapper->read_options, cf, k.data, k.len, &err);
     } else {
-        val = rocksdb_get(
-            wrapper->db,
-            wrapper->read_options,
-            String_val(key), caml_string_length(key),
-            &val_len,
-            &err
-        );
+        slice = rocksdb_get_pinned(wrapper->db, wrapper->read_options, k.data, k.len, &err);
     }
+    db_acquire(wrapper);
     
+    string_copy_free(&k);
     if (err != NULL) {
         free(err);
         CAMLreturn(Val_bool(0));
     }
     
-    int exists = (val != NULL);
-    if (val != NULL) free(val);
+    int exists = (slice != NULL);
+    if (slice != NULL) rocksdb_pinnableslice_destroy(slice);
     
     CAMLreturn(Val_bool(exists));
 }
@@ -526,6 +668,72 @@ CAMLprim value caml_rocksdb_batch_delete(value batch, value key) {
     CAMLreturn(Val_unit);
 }
 
+/* Column family handles belong to the database, so the CF-aware batch
+ * operations take the database the batch will be written to. */
+CAMLprim value caml_rocksdb_batch_put_cf(value db, value batch, value cf_index, value key, value val) {
+    CAMLparam5(db, batch, cf_index, key, val);
+    
+    rocksdb_wrapper *db_wrapper = Rocksdb_val(db);
+    rocksdb_batch_wrapper *wrapper = Batch_val(batch);
+    if (db_wrapper == NULL || !db_wrapper->is_open) {
+        caml_failwith("rocksdb_batch_put_cf: database not open");
+    }
+    if (wrapper == NULL || wrapper->batch == NULL) {
+        caml_failwith("rocksdb_batch_put_cf: invalid batch");
+    }
+    
+    int cf_idx = Int_val(cf_index);
+    
+    if (cf_idx > 0 && cf_idx < db_wrapper->n_cf && db_wrapper->cf_handles[cf_idx] != NULL) {
+        rocksdb_writebatch_put_cf(
+            wrapper->batch,
+            db_wrapper->cf_handles[cf_idx],
+            String_val(key), caml_string_length(key),
+            String_val(val), caml_string_length(val)
+        );
+    } else {
+        rocksdb_writebatch_put(
+            wrapper->batch,
+            String_val(key), caml_string_length(key),
+            String_val(val), caml_string_length(val)
+        );
+    }
+    wrapper->n_ops++;
+    
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_batch_delete_cf(value db, value batch, value cf_index, value key) {
+    CAMLparam4(db, batch, cf_index, key);
+    
+    rocksdb_wrapper *db_wrapper = Rocksdb_val(db);
+    rocksdb_batch_wrapper *wrapper = Batch_val(batch);
+    if (db_wrapper == NULL || !db_wrapper->is_open) {
+        caml_failwith("rocksdb_batch_delete_cf: database not open");
+    }
+    if (wrapper == NULL || wrapper->batch == NULL) {
+        caml_failwith("rocksdb_batch_delete_cf: invalid batch");
+    }
+    
+    int cf_idx = Int_val(cf_index);
+    
+    if (cf_idx > 0 && cf_idx < db_wrapper->n_cf && db_wrapper->cf_handles[cf_idx] != NULL) {
+        rocksdb_writebatch_delete_cf(
+            wrapper->batch,
+            db_wrapper->cf_handles[cf_idx],
+            String_val(key), caml_string_length(key)
+        );
+    } else {
+        rocksdb_writebatch_delete(
+            wrapper->batch,
+            String_val(key), caml_string_length(key)
+        );
+    }
+    wrapper->n_ops++;
+    
+    CAMLreturn(Val_unit);
+}
+
 CAMLprim value caml_rocksdb_batch_clear(value batch) {
     CAMLparam1(batch);
     
@@ -564,14 +772,14 @@ CAMLprim value caml_rocksdb_batch_write(value db, value batch) {
         caml_failwith("rocksdb_batch_write: invalid batch");
     }
     
+    /* The batch lives in C memory, so it needs no copy */
     char *err = NULL;
+    db_release(db_wrapper);
     rocksdb_write(db_wrapper->db, db_wrapper->write_options, batch_wrapper->batch, &err);
+    db_acquire(db_wrapper);
     
     if (err != NULL) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "rocksdb_batch_write failed: %s", err);
-        free(err);
-        caml_failwith(msg);
+        raise_rocksdb_error("rocksdb_batch_write", err);
     }
     
     CAMLreturn(Val_unit);
@@ -624,6 +832,12 @@ CAMLprim value caml_rocksdb_iter_create(value db, value cf_index) {
     
     iter_wrapper->iter = iter;
     iter_wrapper->cf_index = cf_idx;
+    iter_wrapper->read_options = NULL;
+    iter_wrapper->lower = NULL;
+    iter_wrapper->upper = NULL;
+    iter_wrapper->db_wrapper = wrapper;
+    db_ref(wrapper);
+    guard_init(&iter_wrapper->guard);
     
     result = caml_alloc_custom(&rocksdb_iter_ops, sizeof(rocksdb_iter_wrapper *), 0, 1);
     Iter_val(result) = iter_wrapper;
@@ -639,7 +853,9 @@ CAMLprim value caml_rocksdb_iter_seek_to_first(value iter) {
         caml_failwith("rocksdb_iter_seek_to_first: invalid iterator");
     }
     
+    iter_release(wrapper);
     rocksdb_iter_seek_to_first(wrapper->iter);
+    iter_acquire(wrapper);
     
     CAMLreturn(Val_unit);
 }
@@ -652,7 +868,9 @@ CAMLprim value caml_rocksdb_iter_seek_to_last(value iter) {
         caml_failwith("rocksdb_iter_seek_to_last: invalid iterator");
     }
     
+    iter_release(wrapper);
     rocksdb_iter_seek_to_last(wrapper->iter);
+    iter_acquire(wrapper);
     
     CAMLreturn(Val_unit);
 }
@@ -665,7 +883,12 @@ CAMLprim value caml_rocksdb_iter_seek(value iter, value key) {
         caml_failwith("rocksdb_iter_seek: invalid iterator");
     }
     
-    rocksdb_iter_seek(wrapper->iter, String_val(key), caml_string_length(key));
+    string_copy k;
+    string_copy_key(&k, key);
+    iter_release(wrapper);
+    rocksdb_iter_seek(wrapper->iter, k.data, k.len);
+    iter_acquire(wrapper);
+    string_copy_free(&k);
     
     CAMLreturn(Val_unit);
 }
@@ -748,11 +971,19 @@ CAMLprim value caml_rocksdb_iter_destroy(value iter) {
     
     rocksdb_iter_wrapper *wrapper = Iter_val(iter);
     if (wrapper != NULL) {
+        Iter_val(iter) = NULL;
+        guard_drain(&wrapper->guard);
+        
         if (wrapper->iter != NULL) {
             rocksdb_iter_destroy(wrapper->iter);
         }
+        if (wrapper->read_options != NULL) {
+            rocksdb_readoptions_destroy(wrapper->read_options);
+        }
+        free(wrapper->lower);
+        free(wrapper->upper);
+        db_unref(wrapper->db_wrapper);
         free(wrapper);
-        Iter_val(iter) = NULL;
     }
     
     CAMLreturn(Val_unit);
@@ -783,6 +1014,7 @@ CAMLprim value caml_rocksdb_snapshot_create(value db) {
     
     snap_wrapper->snapshot = (void *)snapshot;
     snap_wrapper->db_wrapper = wrapper;
+    db_ref(wrapper);
     
     result = caml_alloc_custom(&rocksdb_snapshot_ops, sizeof(rocksdb_snapshot_wrapper *), 0, 1);
     Snapshot_val(result) = snap_wrapper;
@@ -797,6 +1029,7 @@ CAMLprim value caml_rocksdb_snapshot_release(value snapshot) {
     if (wrapper != NULL && wrapper->snapshot != NULL && wrapper->db_wrapper != NULL) {
         rocksdb_release_snapshot(wrapper->db_wrapper->db, wrapper->snapshot);
         wrapper->snapshot = NULL;
+        db_unref(wrapper->db_wrapper);
         free(wrapper);
         Snapshot_val(snapshot) = NULL;
     }
@@ -842,13 +1075,15 @@ CAMLprim value caml_rocksdb_compact_range(value db, value cf_index) {
         caml_failwith("rocksdb_compact_range: database not open");
     }
     
-    int cf_idx = Int_val(cf_index);
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
     
-    if (cf_idx > 0 && cf_idx < wrapper->n_cf && wrapper->cf_handles[cf_idx] != NULL) {
-        rocksdb_compact_range_cf(wrapper->db, wrapper->cf_handles[cf_idx], NULL, 0, NULL, 0);
+    db_release(wrapper);
+    if (cf != NULL) {
+        rocksdb_compact_range_cf(wrapper->db, cf, NULL, 0, NULL, 0);
     } else {
         rocksdb_compact_range(wrapper->db, NULL, 0, NULL, 0);
     }
+    db_acquire(wrapper);
     
     CAMLreturn(Val_unit);
 }
@@ -865,19 +1100,408 @@ CAMLprim value caml_rocksdb_flush(value db) {
     rocksdb_flushoptions_t *flush_options = rocksdb_flushoptions_create();
     rocksdb_flushoptions_set_wait(flush_options, 1);
     
+    db_release(wrapper);
     rocksdb_flush(wrapper->db, flush_options, &err);
+    db_acquire(wrapper);
     rocksdb_flushoptions_destroy(flush_options);
     
     if (err != NULL) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "rocksdb_flush failed: %s", err);
-        free(err);
-        caml_failwith(msg);
+        raise_rocksdb_error("rocksdb_flush", err);
+    }
+    
+    CAMLreturn(Val_unit);
+}
+
+/*
+ * ============================================================================
+ * Zero-Copy Bigarray Operations
+ * ============================================================================
+ *
+ * Values are read from and written to caller-owned Bigarrays, so hot
+ * attention and truth-value traffic allocates nothing on the OCaml heap.
+ * Reads return the full value length (-1 when absent); only the prefix
+ * that fits is copied, letting callers retry with a larger buffer.
+ */
+
+CAMLprim value caml_rocksdb_put_bigarray(value db, value cf_index, value key, value buf) {
+    CAMLparam4(db, cf_index, key, buf);
+    
+    rocksdb_wrapper *wrapper = Rocksdb_val(db);
+    if (wrapper == NULL || !wrapper->is_open) {
+        caml_failwith("rocksdb_put_bigarray: database not open");
+    }
+    
+    char *err = NULL;
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    char *data = Buffer_data(buf);
+    size_t size = Buffer_size(buf);
+    string_copy k;
+    string_copy_key(&k, key);
+    
+    db_release(wrapper);
+    if (cf != NULL) {
+        rocksdb_put_cf(wrapper->db, wrapper->write_options, cf,
+                       k.data, k.len, data, size, &err);
+    } else {
+        rocksdb_put(wrapper->db, wrapper->write_options,
+                    k.data, k.len, data, size, &err);
+    }
+    db_acquire(wrapper);
+    
+    string_copy_free(&k);
+    if (err != NULL) {
+        raise_rocksdb_error("rocksdb_put_bigarray", err);
+    }
+    
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_get_into(value db, value cf_index, value key, value buf) {
+    CAMLparam4(db, cf_index, key, buf);
+    
+    rocksdb_wrapper *wrapper = Rocksdb_val(db);
+    if (wrapper == NULL || !wrapper->is_open) {
+        caml_failwith("rocksdb_get_into: database not open");
+    }
+    
+    char *err = NULL;
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    char *data = Buffer_data(buf);
+    size_t size = Buffer_size(buf);
+    rocksdb_pinnableslice_t *slice;
+    long result = -1;
+    string_copy k;
+    string_copy_key(&k, key);
+    
+    /* Pinned reads hand back block-cache memory without an extra malloc */
+    db_release(wrapper);
+    if (cf != NULL) {
+        slice = rocksdb_get_pinned_cf(wrapper->db, wrapper->read_options, cf, k.data, k.len, &err);
+    } else {
+        slice = rocksdb_get_pinned(wrapper->db, wrapper->read_options, k.data, k.len, &err);
+    }
+    if (slice != NULL) {
+        size_t val_len;
+        const char *val = rocksdb_pinnableslice_value(slice, &val_len);
+        memcpy(data, val, val_len < size ? val_len : size);
+        rocksdb_pinnableslice_destroy(slice);
+        result = (long)val_len;
+    }
+    db_acquire(wrapper);
+    
+    string_copy_free(&k);
+    if (err != NULL) {
+        raise_rocksdb_error("rocksdb_get_into", err);
+    }
+    
+    CAMLreturn(Val_long(result));
+}
+
+CAMLprim value caml_rocksdb_batch_put_bigarray(value db, value batch, value cf_index, value key, value buf) {
+    CAMLparam5(db, batch, cf_index, key, buf);
+    
+    rocksdb_wrapper *db_wrapper = Rocksdb_val(db);
+    rocksdb_batch_wrapper *wrapper = Batch_val(batch);
+    if (db_wrapper == NULL || !db_wrapper->is_open) {
+        caml_failwith("rocksdb_batch_put_bigarray: database not open");
+    }
+    if (wrapper == NULL || wrapper->batch == NULL) {
+        caml_failwith("rocksdb_batch_put_bigarray: invalid batch");
     }
     
+    /* The write batch copies the value into its own representation */
+    rocksdb_column_family_handle_t *cf = cf_handle(db_wrapper, Int_val(cf_index));
+    
+    if (cf != NULL) {
+        rocksdb_writebatch_put_cf(wrapper->batch, cf,
+                                  String_val(key), caml_string_length(key),
+                                  Buffer_data(buf), Buffer_size(buf));
+    } else {
+        rocksdb_writebatch_put(wrapper->batch,
+                               String_val(key), caml_string_length(key),
+                               Buffer_data(buf), Buffer_size(buf));
+    }
+    wrapper->n_ops++;
+    
     CAMLreturn(Val_unit);
 }
 
+CAMLprim value caml_rocksdb_iter_key_into(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    
+    rocksdb_iter_wrapper *wrapper = Iter_val(iter);
+    if (wrapper == NULL || wrapper->iter == NULL) {
+        caml_failwith("rocksdb_iter_key_into: invalid iterator");
+    }
+    
+    size_t key_len;
+    const char *key = rocksdb_iter_key(wrapper->iter, &key_len);
+    size_t n = key_len < Buffer_size(buf) ? key_len : Buffer_size(buf);
+    memcpy(Buffer_data(buf), key, n);
+    
+    CAMLreturn(Val_long(key_len));
+}
+
+CAMLprim value caml_rocksdb_iter_value_into(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    
+    rocksdb_iter_wrapper *wrapper = Iter_val(iter);
+    if (wrapper == NULL || wrapper->iter == NULL) {
+        caml_failwith("rocksdb_iter_value_into: invalid iterator");
+    }
+    
+    size_t val_len;
+    const char *val = rocksdb_iter_value(wrapper->iter, &val_len);
+    size_t n = val_len < Buffer_size(buf) ? val_len : Buffer_size(buf);
+    memcpy(Buffer_data(buf), val, n);
+    
+    CAMLreturn(Val_long(val_len));
+}
+
+/* Fetch a batch of keys in one call. Values are packed back to back into
+ * [buf]; the result array holds each value's length, or -1 when absent. */
+CAMLprim value caml_rocksdb_multi_get_into(value db, value cf_index, value keys, value buf) {
+    CAMLparam4(db, cf_index, keys, buf);
+    CAMLlocal1(result);
+    
+    rocksdb_wrapper *wrapper = Rocksdb_val(db);
+    if (wrapper == NULL || !wrapper->is_open) {
+        caml_failwith("rocksdb_multi_get_into: database not open");
+    }
+    
+    size_t n_keys = Wosize_val(keys);
+    if (n_keys == 0) {
+        CAMLreturn(caml_alloc_tuple(0));
+    }
+    
+    /* Keys are copied into one block so they survive releasing the lock */
+    size_t total_key_len = 0;
+    for (size_t i = 0; i < n_keys; i++) {
+        total_key_len += caml_string_length(Field(keys, i));
+    }
+    
+    char *key_block = (char *)malloc(total_key_len > 0 ? total_key_len : 1);
+    const char **key_ptrs = (const char **)malloc(n_keys * sizeof(char *));
+    size_t *key_lens = (size_t *)malloc(n_keys * sizeof(size_t));
+    char **vals = (char **)malloc(n_keys * sizeof(char *));
+    size_t *val_lens = (size_t *)malloc(n_keys * sizeof(size_t));
+    char **errs = (char **)malloc(n_keys * sizeof(char *));
+    rocksdb_column_family_handle_t **cfs =
+        (rocksdb_column_family_handle_t **)malloc(n_keys * sizeof(rocksdb_column_family_handle_t *));
+    
+    if (key_block == NULL || key_ptrs == NULL || key_lens == NULL || vals == NULL ||
+        val_lens == NULL || errs == NULL || cfs == NULL) {
+        free(key_block); free(key_ptrs); free(key_lens); free(vals);
+        free(val_lens); free(errs); free(cfs);
+        caml_failwith("rocksdb_multi_get_into: failed to allocate key arrays");
+    }
+    
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, Int_val(cf_index));
+    size_t key_offset = 0;
+    for (size_t i = 0; i < n_keys; i++) {
+        value k = Field(keys, i);
+        key_lens[i] = caml_string_length(k);
+        memcpy(key_block + key_offset, String_val(k), key_lens[i]);
+        key_ptrs[i] = key_block + key_offset;
+        key_offset += key_lens[i];
+        cfs[i] = cf;
+    }
+    
+    char *data = Buffer_data(buf);
+    size_t capacity = Buffer_size(buf);
+    size_t offset = 0;
+    int overflow = 0;
+    char *first_err = NULL;
+    
+    db_release(wrapper);
+    if (cf != NULL) {
+        rocksdb_multi_get_cf(wrapper->db, wrapper->read_options,
+                             (const rocksdb_column_family_handle_t *const *)cfs,
+                             n_keys, key_ptrs, key_lens, vals, val_lens, errs);
+    } else {
+        rocksdb_multi_get(wrapper->db, wrapper->read_options,
+                          n_keys, key_ptrs, key_lens, vals, val_lens, errs);
+    }
+    
+    /* Pack values and record lengths (-1 when absent) in val_lens */
+    for (size_t i = 0; i < n_keys; i++) {
+        if (errs[i] != NULL) {
+            if (first_err == NULL) first_err = errs[i];
+            else free(errs[i]);
+            val_lens[i] = (size_t)-1;
+        } else if (vals[i] == NULL) {
+            val_lens[i] = (size_t)-1;
+        } else {
+            if (offset + val_lens[i] <= capacity) {
+                memcpy(data + offset, vals[i], val_lens[i]);
+            } else {
+                overflow = 1;
+            }
+            offset += val_lens[i];
+        }
+        if (vals[i] != NULL) free(vals[i]);
+    }
+    db_acquire(wrapper);
+    
+    result = caml_alloc_tuple(n_keys);
+    for (size_t i = 0; i < n_keys; i++) {
+        Store_field(result, i, Val_long((long)val_lens[i]));
+    }
+    
+    free(key_block); free(key_ptrs); free(key_lens); free(vals);
+    free(val_lens); free(errs); free(cfs);
+    
+    if (first_err != NULL) {
+        raise_rocksdb_error("rocksdb_multi_get_into", first_err);
+    }
+    if (overflow) {
+        caml_invalid_argument("rocksdb_multi_get_into: buffer too small");
+    }
+    
+    CAMLreturn(result);
+}
+
+/*
+ * ============================================================================
+ * Range Scans
+ * ============================================================================
+ *
+ * Range iterators read a consistent snapshot between two keys, so a
+ * column family can be split into ranges and scanned by several threads.
+ * read_batch then copies many entries per call, with the runtime lock
+ * released, into a caller buffer framed as
+ *   [key length: u32 LE][value length: u32 LE][key][value] ...
+ */
+
+/* Sets *failed instead of raising, so the caller can free what it holds */
+static char *copy_bound(value bound, size_t *len, int *failed) {
+    *len = caml_string_length(bound);
+    if (*len == 0) return NULL;
+    char *copy = (char *)malloc(*len);
+    if (copy == NULL) {
+        *failed = 1;
+        return NULL;
+    }
+    memcpy(copy, String_val(bound), *len);
+    return copy;
+}
+
+CAMLprim value caml_rocksdb_iter_create_range(value db, value cf_index, value snapshot,
+                                              value lower, value upper) {
+    CAMLparam5(db, cf_index, snapshot, lower, upper);
+    CAMLlocal1(result);
+    
+    rocksdb_wrapper *wrapper = Rocksdb_val(db);
+    if (wrapper == NULL || !wrapper->is_open) {
+        caml_failwith("rocksdb_iter_create_range: database not open");
+    }
+    
+    rocksdb_iter_wrapper *iter_wrapper = (rocksdb_iter_wrapper *)malloc(sizeof(rocksdb_iter_wrapper));
+    if (iter_wrapper == NULL) {
+        caml_failwith("rocksdb_iter_create_range: failed to allocate wrapper");
+    }
+    
+    size_t lower_len, upper_len;
+    rocksdb_readoptions_t *read_options = rocksdb_readoptions_create();
+    /* Bulk scans should not evict the working set from the block cache */
+    rocksdb_readoptions_set_fill_cache(read_options, 0);
+    
+    if (Is_block(snapshot)) {
+        rocksdb_snapshot_wrapper *snap = Snapshot_val(Field(snapshot, 0));
+        if (snap == NULL || snap->snapshot == NULL) {
+            rocksdb_readoptions_destroy(read_options);
+            free(iter_wrapper);
+            caml_failwith("rocksdb_iter_create_range: snapshot released");
+        }
+        rocksdb_readoptions_set_snapshot(read_options, snap->snapshot);
+    }
+    
+    int failed = 0;
+    iter_wrapper->lower = copy_bound(lower, &lower_len, &failed);
+    iter_wrapper->upper = copy_bound(upper, &upper_len, &failed);
+    if (failed) {
+        free(iter_wrapper->lower);
+        free(iter_wrapper->upper);
+        rocksdb_readoptions_destroy(read_options);
+        free(iter_wrapper);
+        caml_raise_out_of_memory();
+    }
+    if (iter_wrapper->lower != NULL) {
+        rocksdb_readoptions_set_iterate_lower_bound(read_options, iter_wrapper->lower, lower_len);
+    }
+    if (iter_wrapper->upper != NULL) {
+        rocksdb_readoptions_set_iterate_upper_bound(read_options, iter_wrapper->upper, upper_len);
+    }
+    
+    int cf_idx = Int_val(cf_index);
+    rocksdb_column_family_handle_t *cf = cf_handle(wrapper, cf_idx);
+    if (cf != NULL) {
+        iter_wrapper->iter = rocksdb_create_iterator_cf(wrapper->db, read_options, cf);
+    } else {
+        iter_wrapper->iter = rocksdb_create_iterator(wrapper->db, read_options);
+    }
+    iter_wrapper->cf_index = cf_idx;
+    iter_wrapper->read_options = read_options;
+    iter_wrapper->db_wrapper = wrapper;
+    db_ref(wrapper);
+    guard_init(&iter_wrapper->guard);
+    
+    result = caml_alloc_custom(&rocksdb_iter_ops, sizeof(rocksdb_iter_wrapper *), 0, 1);
+    Iter_val(result) = iter_wrapper;
+    
+    CAMLreturn(result);
+}
+
+static void put_u32_le(char *p, uint32_t x) {
+    p[0] = (char)(x & 0xFF);
+    p[1] = (char)((x >> 8) & 0xFF);
+    p[2] = (char)((x >> 16) & 0xFF);
+    p[3] = (char)((x >> 24) & 0xFF);
+}
+
+/* Copy entries from the current position until the buffer is full or the
+ * iterator is exhausted, advancing past them. Returns the entry count. */
+CAMLprim value caml_rocksdb_iter_read_batch(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    
+    rocksdb_iter_wrapper *wrapper = Iter_val(iter);
+    if (wrapper == NULL || wrapper->iter == NULL) {
+        caml_failwith("rocksdb_iter_read_batch: invalid iterator");
+    }
+    
+    char *data = Buffer_data(buf);
+    size_t capacity = Buffer_size(buf);
+    size_t offset = 0;
+    long count = 0;
+    int too_small = 0;
+    
+    iter_release(wrapper);
+    while (rocksdb_iter_valid(wrapper->iter)) {
+        size_t key_len, val_len;
+        const char *key = rocksdb_iter_key(wrapper->iter, &key_len);
+        const char *val = rocksdb_iter_value(wrapper->iter, &val_len);
+        size_t need = 8 + key_len + val_len;
+        if (offset + need > capacity) {
+            too_small = (count == 0);
+            break;
+        }
+        put_u32_le(data + offset, (uint32_t)key_len);
+        put_u32_le(data + offset + 4, (uint32_t)val_len);
+        memcpy(data + offset + 8, key, key_len);
+        memcpy(data + offset + 8 + key_len, val, val_len);
+        offset += need;
+        count++;
+        rocksdb_iter_next(wrapper->iter);
+    }
+    iter_acquire(wrapper);
+    
+    if (too_small) {
+        caml_invalid_argument("rocksdb_iter_read_batch: entry larger than buffer");
+    }
+    
+    CAMLreturn(Val_long(count));
+}
+
 CAMLprim value caml_rocksdb_backend_available(value unit) {
     CAMLparam1(unit);
     CAMLreturn(Val_bool(1));
@@ -954,6 +1578,18 @@ CAMLprim value caml_rocksdb_batch_delete(value batch, value key) {
     CAMLreturn(Val_unit);
 }
 
+CAMLprim value caml_rocksdb_batch_put_cf(value db, value batch, value cf_index, value key, value val) {
+    CAMLparam5(db, batch, cf_index, key, val);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_batch_delete_cf(value db, value batch, value cf_index, value key) {
+    CAMLparam4(db, batch, cf_index, key);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
 CAMLprim value caml_rocksdb_batch_clear(value batch) {
     CAMLparam1(batch);
     rocksdb_not_available();
@@ -1062,6 +1698,55 @@ CAMLprim value caml_rocksdb_flush(value db) {
     CAMLreturn(Val_unit);
 }
 
+CAMLprim value caml_rocksdb_put_bigarray(value db, value cf_index, value key, value buf) {
+    CAMLparam4(db, cf_index, key, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_get_into(value db, value cf_index, value key, value buf) {
+    CAMLparam4(db, cf_index, key, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_batch_put_bigarray(value db, value batch, value cf_index, value key, value buf) {
+    CAMLparam5(db, batch, cf_index, key, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_iter_key_into(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_iter_value_into(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_multi_get_into(value db, value cf_index, value keys, value buf) {
+    CAMLparam4(db, cf_index, keys, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_iter_create_range(value db, value cf_index, value snapshot,
+                                              value lower, value upper) {
+    CAMLparam5(db, cf_index, snapshot, lower, upper);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_rocksdb_iter_read_batch(value iter, value buf) {
+    CAMLparam2(iter, buf);
+    rocksdb_not_available();
+    CAMLreturn(Val_unit);
+}
+
 CAMLprim value caml_rocksdb_backend_available(value unit) {
     CAMLparam1(unit);
     CAMLreturn(Val_bool(0));
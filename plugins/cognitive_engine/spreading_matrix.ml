@@ -0,0 +1,185 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Sparse Spreading-Activation Matrix *)
+
+open Hypergraph
+
+(** A row is a slice of an id array and a share array *)
+type row = {
+  ids : int array;
+  shares : float array;
+  first : int;
+  count : int;
+}
+
+type t = {
+  atomspace : atomspace;
+  workers : int;
+  parallel_threshold : int;
+  mutable rows : int;
+  mutable row_start : int array;  (** node id -> first entry, [rows + 1] long *)
+  mutable columns : int array;    (** link ids *)
+  mutable weights : float array;  (** shares, parallel to [columns] *)
+  changed : (node_id, row) Hashtbl.t;  (** rows recomputed since the last rebuild *)
+  stale : (node_id, unit) Hashtbl.t;   (** rows to recompute on next use *)
+  mutable subscription : link_subscription option;
+}
+
+let empty_row = { ids = [||]; shares = [||]; first = 0; count = 0 }
+
+(* Rebuild once this many rows have changed, or an eighth of them *)
+let compaction_floor = 1024
+
+(* Shares reproduce spreading over [incoming @ outgoing]: a link found in
+   both lists gets two shares *)
+let compute_row atomspace node_id =
+  let adjacent = get_incoming_links atomspace node_id @ get_outgoing_links atomspace node_id in
+  match List.sort compare adjacent with
+  | [] -> empty_row
+  | sorted ->
+    let share = 1.0 /. float_of_int (List.length sorted) in
+    let rec group acc = function
+      | id :: rest ->
+        (match acc with
+         | (last, w) :: acc' when last = id -> group ((id, w +. share) :: acc') rest
+         | _ -> group ((id, share) :: acc) rest)
+      | [] -> List.rev acc
+    in
+    let entries = Array.of_list (group [] sorted) in
+    { ids = Array.map fst entries;
+      shares = Array.map snd entries;
+      first = 0;
+      count = Array.length entries }
+
+let compact t =
+  let rows = t.atomspace.next_node_id in
+  let computed = Array.init rows (fun id ->
+    if Hashtbl.mem t.atomspace.nodes id then compute_row t.atomspace id else empty_row) in
+  let row_start = Array.make (rows + 1) 0 in
+  Array.iteri (fun id r -> row_start.(id + 1) <- row_start.(id) + r.count) computed;
+  let columns = Array.make row_start.(rows) 0 in
+  let weights = Array.make row_start.(rows) 0.0 in
+  Array.iteri (fun id r ->
+    Array.blit r.ids 0 columns row_start.(id) r.count;
+    Array.blit r.shares 0 weights row_start.(id) r.count
+  ) computed;
+  t.rows <- rows;
+  t.row_start <- row_start;
+  t.columns <- columns;
+  t.weights <- weights;
+  Hashtbl.reset t.changed;
+  Hashtbl.reset t.stale
+
+(* Link_added arrives after the link is indexed and Link_removed before
+   it is unindexed; either way its nodes' rows are recomputed lazily *)
+let mark_link t link_id =
+  match Hashtbl.find_opt t.atomspace.links link_id with
+  | Some link -> List.iter (fun node_id -> Hashtbl.replace t.stale node_id ()) link.outgoing
+  | None -> ()
+
+let create ?(workers = Parallel_pool.default_workers) ?(parallel_threshold = 1 lsl 18) atomspace =
+  let t = {
+    atomspace;
+    workers;
+    parallel_threshold;
+    rows = 0;
+    row_start = [| 0 |];
+    columns = [||];
+    weights = [||];
+    changed = Hashtbl.create 64;
+    stale = Hashtbl.create 64;
+    subscription = None;
+  } in
+  compact t;
+  t.subscription <- Some (subscribe_link_events atomspace (function
+    | Link_added link_id | Link_removed link_id -> mark_link t link_id
+    | Link_truth_updated _ -> ()));
+  t
+
+let release t =
+  match t.subscription with
+  | Some subscription ->
+    unsubscribe_link_events t.atomspace subscription;
+    t.subscription <- None
+  | None -> ()
+
+let nonzeros t = Array.length t.columns
+
+let pending_rows t = Hashtbl.length t.changed + Hashtbl.length t.stale
+
+let find_row t node_id =
+  if Hashtbl.mem t.stale node_id then begin
+    Hashtbl.remove t.stale node_id;
+    Hashtbl.replace t.changed node_id (compute_row t.atomspace node_id)
+  end;
+  match Hashtbl.find_opt t.changed node_id with
+  | Some r -> r
+  | None ->
+    if node_id >= 0 && node_id < t.rows then
+      let first = t.row_start.(node_id) in
+      { ids = t.columns; shares = t.weights; first; count = t.row_start.(node_id + 1) - first }
+    else empty_row
+
+let row t node_id =
+  let r = find_row t node_id in
+  List.init r.count (fun j -> (r.ids.(r.first + j), r.shares.(r.first + j)))
+
+(** Spreading *)
+
+(* Sum the contributions of a block of sources per link, so a worker
+   sends back one entry per distinct link *)
+let block_deltas block =
+  let sums = Hashtbl.create 256 in
+  Array.iter (fun (_, amount, r) ->
+    for j = r.first to r.first + r.count - 1 do
+      let id = r.ids.(j) in
+      let delta = amount *. r.shares.(j) in
+      match Hashtbl.find_opt sums id with
+      | Some sum -> Hashtbl.replace sums id (sum +. delta)
+      | None -> Hashtbl.add sums id delta
+    done
+  ) block;
+  let ids = Array.make (Hashtbl.length sums) 0 in
+  let amounts = Array.make (Hashtbl.length sums) 0.0 in
+  let i = ref 0 in
+  Hashtbl.iter (fun id sum ->
+    ids.(!i) <- id;
+    amounts.(!i) <- sum;
+    incr i
+  ) sums;
+  (ids, amounts)
+
+let spread t sources threshold fraction =
+  if pending_rows t > max compaction_floor (t.rows / 8) then compact t;
+  let node_sti = t.atomspace.node_values.sti_values in
+  let seen = Hashtbl.create 64 in
+  let active = List.filter_map (fun id ->
+    if Hashtbl.mem seen id || not (Hashtbl.mem t.atomspace.nodes id) then None
+    else begin
+      Hashtbl.add seen id ();
+      let sti = Float.Array.get node_sti id in
+      if sti > threshold then
+        let r = find_row t id in
+        if r.count > 0 then Some (id, sti *. fraction, r) else None
+      else None
+    end
+  ) sources |> Array.of_list in
+  let entries = Array.fold_left (fun n (_, _, r) -> n + r.count) 0 active in
+  let add id delta = add_link_sti t.atomspace id delta in
+  if t.workers > 1 && Array.length active > 1 && entries >= t.parallel_threshold then
+    Parallel_pool.map ~workers:t.workers block_deltas (Parallel_pool.chunk t.workers active)
+    |> Array.iter (fun (ids, amounts) -> Array.iteri (fun i id -> add id amounts.(i)) ids)
+  else
+    Array.iter (fun (_, amount, r) ->
+      for j = r.first to r.first + r.count - 1 do
+        add r.ids.(j) (amount *. r.shares.(j))
+      done
+    ) active;
+  Array.iter (fun (id, amount, _) -> add_node_sti t.atomspace id (-. amount)) active;
+  Array.to_list (Array.map (fun (id, amount, _) -> (id, amount)) active)
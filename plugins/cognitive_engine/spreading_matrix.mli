@@ -0,0 +1,48 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Sparse Spreading-Activation Matrix
+
+    The node-to-link incidence of an AtomSpace in compressed sparse row
+    form. Row [n] lists the links adjacent to node [n] (incoming, plus
+    outgoing links that start at it) with the share of [n]'s spread
+    each receives, so one spreading step for a set of sources is a
+    sparse matrix-vector product into the link STI column.
+
+    The matrix follows the AtomSpace through its link events: rows of
+    nodes touched by a link change are recomputed on next use and kept
+    beside the CSR arrays, which are rebuilt once such rows pile up. *)
+
+type t
+
+(** Build the matrix and subscribe it to the AtomSpace's link events.
+    Spreading runs in up to [workers] processes once the selected rows
+    hold at least [parallel_threshold] entries. *)
+val create : ?workers:int -> ?parallel_threshold:int -> Hypergraph.atomspace -> t
+
+(** Unsubscribe from the AtomSpace; the matrix stops following link
+    changes and should be dropped *)
+val release : t -> unit
+
+(** Adjacent links of a node and their shares, which sum to 1.0 *)
+val row : t -> Hypergraph.node_id -> (Hypergraph.link_id * float) list
+
+(** [spread t sources threshold fraction] moves [fraction] of the STI of
+    every live source above [threshold] onto its adjacent links, split by
+    the row shares; sources without links keep their STI. Returns the
+    amount each spreading source gave, in source order. *)
+val spread : t -> Hypergraph.node_id list -> float -> float -> (Hypergraph.node_id * float) list
+
+(** Rebuild the CSR arrays from the AtomSpace *)
+val compact : t -> unit
+
+(** Entries in the CSR arrays *)
+val nonzeros : t -> int
+
+(** Rows changed since the last rebuild *)
+val pending_rows : t -> int
@@ -272,32 +272,44 @@ let task_type_to_string = function
   | Memory_consolidation -> "memory-consolidation"
   | Meta_cognition -> "meta-cognition"
 
-let task_to_scheme task =
-  let deps_str = String.concat " " (List.map string_of_int task.dependencies) in
-  let start_str = match task.start_time with
-    | Some t -> Printf.sprintf " (start-time %.3f)" t
-    | None -> ""
-  in
-  let end_str = match task.end_time with
-    | Some t -> Printf.sprintf " (end-time %.3f)" t
-    | None -> ""
-  in
-  Printf.sprintf "(task (id %d) (type %s) (priority %s) (status %s) (description \"%s\") (dependencies (%s)) (created %.3f)%s%s)"
+let add_task_scheme buf task =
+  Printf.bprintf buf "(task (id %d) (type %s) (priority %s) (status %s) (description "
     task.id
     (task_type_to_string task.task_type)
     (priority_to_string task.priority)
-    (status_to_string task.status)
-    task.description
-    deps_str
-    task.created_time
-    start_str
-    end_str
-
-let task_queue_to_scheme queue =
-  let tasks = ref [] in
-  Hashtbl.iter (fun _ task -> tasks := task_to_scheme task :: !tasks) queue.tasks;
+    (status_to_string task.status);
+  Hypergraph.add_scheme_string buf task.description;
+  Buffer.add_string buf ") (dependencies (";
+  List.iteri (fun i dep ->
+    if i > 0 then Buffer.add_char buf ' ';
+    Buffer.add_string buf (string_of_int dep)) task.dependencies;
+  Printf.bprintf buf ")) (created %.3f)" task.created_time;
+  (match task.start_time with
+   | Some t -> Printf.bprintf buf " (start-time %.3f)" t
+   | None -> ());
+  (match task.end_time with
+   | Some t -> Printf.bprintf buf " (end-time %.3f)" t
+   | None -> ());
+  Buffer.add_char buf ')'
+
+let write_task_queue_scheme buf flush queue =
   let (pending, running, completed, failed) = get_task_statistics queue in
-  Printf.sprintf "(task-queue\n  (max-concurrent %d)\n  (statistics (pending %d) (running %d) (completed %d) (failed %d))\n  (tasks\n    %s))"
+  Printf.bprintf buf "(task-queue\n  (max-concurrent %d)\n  (statistics (pending %d) (running %d) (completed %d) (failed %d))\n  (tasks"
     queue.max_concurrent
-    pending running completed failed
-    (String.concat "\n    " !tasks)
\ No newline at end of file
+    pending running completed failed;
+  if Hashtbl.length queue.tasks = 0 then Buffer.add_string buf "\n    ";
+  Hashtbl.iter (fun _ task ->
+    Buffer.add_string buf "\n    ";
+    add_task_scheme buf task;
+    flush ()
+  ) queue.tasks;
+  Buffer.add_string buf "))"
+
+let add_task_queue_scheme buf queue = write_task_queue_scheme buf ignore queue
+
+let output_task_queue_scheme oc queue =
+  Hypergraph.output_scheme oc (fun buf flush -> write_task_queue_scheme buf flush queue)
+
+let task_to_scheme task = Hypergraph.scheme_of_buffer add_task_scheme task
+
+let task_queue_to_scheme queue = Hypergraph.scheme_of_buffer add_task_queue_scheme queue
\ No newline at end of file
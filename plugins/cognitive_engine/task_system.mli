@@ -95,7 +95,14 @@ val get_task_statistics : task_queue -> (int * int * int * int) (** pending, run
 
 val get_average_execution_time : task_queue -> task_type -> float option
 
-(** Scheme representation *)
+(** Scheme representation. The queue can also be streamed to a channel
+    in chunks instead of being built as one string. *)
+val add_task_scheme : Buffer.t -> cognitive_task -> unit
+
+val add_task_queue_scheme : Buffer.t -> task_queue -> unit
+
+val output_task_queue_scheme : out_channel -> task_queue -> unit
+
 val task_to_scheme : cognitive_task -> string
 
 val task_queue_to_scheme : task_queue -> string
\ No newline at end of file
@@ -21,6 +21,7 @@ type tensor_context = {
   backend : backend_type;
   mutable device : string;
   mutable precision : [`Float32 | `Float16];
+  mutable n_threads : int;
 }
 
 (** Create tensor context *)
@@ -28,6 +29,7 @@ let create_context backend = {
   backend = backend;
   device = "cpu";
   precision = `Float32;
+  n_threads = 4;
 }
 
 (** Utility functions *)
@@ -64,32 +66,20 @@ module OCaml_backend = struct
   let scale shape scalar data =
     Array.map (fun x -> x *. scalar) data
 
+  (* Tensor_kernels works on flat float arrays *)
+  let floats = Float.Array.map_from_array Fun.id
+  let of_floats = Float.Array.map_to_array Fun.id
+
   let transpose shape data =
     match shape with
-    | [rows; cols] ->
-        let result = Array.make (rows * cols) 0.0 in
-        for i = 0 to rows - 1 do
-          for j = 0 to cols - 1 do
-            result.(j * rows + i) <- data.(i * cols + j)
-          done
-        done;
-        (result, [cols; rows])
+    | [rows; cols] -> (of_floats (Tensor_kernels.transpose rows cols (floats data)), [cols; rows])
     | _ -> failwith "Transpose only supported for 2D tensors currently"
 
+  (* Cache-blocked SIMD GEMM, see Tensor_kernels *)
   let matmul shape1 shape2 data1 data2 =
     match shape1, shape2 with
     | [m; k], [k2; n] when k = k2 ->
-        let result = Array.make (m * n) 0.0 in
-        for i = 0 to m - 1 do
-          for j = 0 to n - 1 do
-            let sum = ref 0.0 in
-            for l = 0 to k - 1 do
-              sum := !sum +. data1.(i * k + l) *. data2.(l * n + j)
-            done;
-            result.(i * n + j) <- !sum
-          done
-        done;
-        result
+      of_floats (Tensor_kernels.matmul m k n (floats data1) (floats data2))
     | _ -> failwith "Invalid shapes for matrix multiplication"
 
   let reshape old_shape new_shape data =
@@ -127,61 +117,573 @@ module OCaml_backend = struct
 
 end
 
-(** GGML backend interface - Currently stubbed for future implementation *)
+(** Strided float32 tensors over a Bigarray buffer. Views (reshape,
+    transpose, slice) share the buffer of the tensor they come from, and
+    the [_inplace] operations write through to every view of it. *)
+module Dense = struct
+  open Bigarray
+
+  type buffer = (float, float32_elt, c_layout) Array1.t
+
+  type t = {
+    buffer : buffer;
+    dims : int array;
+    strides : int array;  (** In elements *)
+    offset : int;
+  }
+
+  let size_of dims = Array.fold_left ( * ) 1 dims
+
+  let row_major_strides dims =
+    let n = Array.length dims in
+    let strides = Array.make n 1 in
+    for i = n - 2 downto 0 do
+      strides.(i) <- strides.(i + 1) * dims.(i + 1)
+    done;
+    strides
+
+  let check_dims dims =
+    if Array.exists (fun d -> d < 0) dims then
+      failwith "Tensor dimensions must be non-negative"
+
+  let of_buffer dims buffer =
+    check_dims dims;
+    if Array1.dim buffer <> size_of dims then
+      failwith "Tensor data does not match its shape";
+    { buffer; dims = Array.copy dims; strides = row_major_strides dims; offset = 0 }
+
+  let create dims =
+    check_dims dims;
+    let buffer = Array1.create float32 c_layout (size_of dims) in
+    Array1.fill buffer 0.0;
+    of_buffer dims buffer
+
+  let of_array dims data =
+    check_dims dims;
+    if Array.length data <> size_of dims then
+      failwith "Tensor data does not match its shape";
+    let buffer = Array1.create float32 c_layout (Array.length data) in
+    Array.iteri (fun i x -> Array1.unsafe_set buffer i x) data;
+    of_buffer dims buffer
+
+  let dims t = Array.copy t.dims
+  let shape t = Array.to_list t.dims
+  let size t = size_of t.dims
+
+  let is_contiguous t =
+    let expected = ref 1 in
+    let ok = ref true in
+    for i = Array.length t.dims - 1 downto 0 do
+      if t.dims.(i) <> 1 && t.strides.(i) <> !expected then ok := false;
+      expected := !expected * t.dims.(i)
+    done;
+    !ok
+
+  (** Buffer offsets in row-major element order *)
+  let iter_offsets t f =
+    let total = size t in
+    if total > 0 then
+      if is_contiguous t then
+        for k = 0 to total - 1 do f k (t.offset + k) done
+      else begin
+        let n = Array.length t.dims in
+        let index = Array.make n 0 in
+        let off = ref t.offset in
+        for k = 0 to total - 1 do
+          f k !off;
+          let d = ref (n - 1) in
+          let carry = ref true in
+          while !carry && !d >= 0 do
+            let axis = !d in
+            index.(axis) <- index.(axis) + 1;
+            off := !off + t.strides.(axis);
+            if index.(axis) < t.dims.(axis) then carry := false
+            else begin
+              off := !off - t.strides.(axis) * t.dims.(axis);
+              index.(axis) <- 0;
+              decr d
+            end
+          done
+        done
+      end
+
+  let offset_of t index =
+    if Array.length index <> Array.length t.dims then
+      failwith "Tensor index has the wrong number of dimensions";
+    let off = ref t.offset in
+    Array.iteri (fun i x ->
+      if x < 0 || x >= t.dims.(i) then invalid_arg "Tensor index out of bounds";
+      off := !off + x * t.strides.(i)) index;
+    !off
+
+  let get t index = Array1.unsafe_get t.buffer (offset_of t index)
+  let set t index x = Array1.unsafe_set t.buffer (offset_of t index) x
+
+  let to_array t =
+    let result = Array.make (size t) 0.0 in
+    iter_offsets t (fun k off -> result.(k) <- Array1.unsafe_get t.buffer off);
+    result
+
+  (* Double-precision copy for Tensor_kernels *)
+  let to_floats t =
+    let result = Float.Array.make (size t) 0.0 in
+    iter_offsets t (fun k off -> Float.Array.unsafe_set result k (Array1.unsafe_get t.buffer off));
+    result
+
+  (** The elements as one buffer slice, without copying *)
+  let flat t =
+    if not (is_contiguous t) then failwith "Tensor view is not contiguous";
+    Array1.sub t.buffer t.offset (size t)
+
+  let copy t =
+    let result = create t.dims in
+    if is_contiguous t then Array1.blit (flat t) result.buffer
+    else iter_offsets t (fun k off -> Array1.unsafe_set result.buffer k (Array1.unsafe_get t.buffer off));
+    result
+
+  let contiguous t = if is_contiguous t then t else copy t
+
+  (** {2 Views} *)
+
+  let reshape t dims =
+    check_dims dims;
+    if size_of dims <> size t then
+      failwith "Cannot reshape: total number of elements must remain the same";
+    if not (is_contiguous t) then failwith "Cannot reshape a non-contiguous view";
+    { t with dims = Array.copy dims; strides = row_major_strides dims }
+
+  let transpose t =
+    match t.dims, t.strides with
+    | [| rows; cols |], [| s0; s1 |] -> { t with dims = [| cols; rows |]; strides = [| s1; s0 |] }
+    | _ -> failwith "Transpose only supported for 2D tensors currently"
+
+  (** [len] entries of [axis] starting at [start] *)
+  let slice t ~axis start len =
+    if axis < 0 || axis >= Array.length t.dims then failwith "Slice axis out of range";
+    if start < 0 || len < 0 || start + len > t.dims.(axis) then
+      failwith "Slice out of bounds";
+    let dims = Array.copy t.dims in
+    dims.(axis) <- len;
+    { t with dims; offset = t.offset + start * t.strides.(axis) }
+
+  (** {2 In-place operations} *)
+
+  let same_shape a b = a.dims = b.dims
+
+  let fill t x =
+    if is_contiguous t then Array1.fill (flat t) x
+    else iter_offsets t (fun _ off -> Array1.unsafe_set t.buffer off x)
+
+  let map_inplace f t =
+    iter_offsets t (fun _ off -> Array1.unsafe_set t.buffer off (f (Array1.unsafe_get t.buffer off)))
+
+  let binary_inplace name f dst src =
+    if not (same_shape dst src) then failwith ("Tensor shapes must match for " ^ name);
+    if is_contiguous dst && is_contiguous src then begin
+      let d = dst.buffer and s = src.buffer in
+      for k = 0 to size dst - 1 do
+        let i = dst.offset + k in
+        Array1.unsafe_set d i (f (Array1.unsafe_get d i) (Array1.unsafe_get s (src.offset + k)))
+      done
+    end else begin
+      let values = to_array src in
+      iter_offsets dst (fun k off ->
+        Array1.unsafe_set dst.buffer off (f (Array1.unsafe_get dst.buffer off) values.(k)))
+    end
+
+  let blit ~src ~dst = binary_inplace "copy" (fun _ y -> y) dst src
+  let add_inplace dst src = binary_inplace "addition" ( +. ) dst src
+  let multiply_inplace dst src = binary_inplace "element-wise multiplication" ( *. ) dst src
+  let scale_inplace scalar t = map_inplace (fun x -> x *. scalar) t
+  let relu_inplace t = map_inplace (fun x -> if x > 0.0 then x else 0.0) t
+  let sigmoid_inplace t = map_inplace (fun x -> 1.0 /. (1.0 +. exp (-.x))) t
+
+  let fold f init t =
+    let acc = ref init in
+    iter_offsets t (fun _ off -> acc := f !acc (Array1.unsafe_get t.buffer off));
+    !acc
+
+  (** Softmax over all elements, as in [OCaml_backend] *)
+  let softmax_inplace t =
+    let max_val = fold max neg_infinity t in
+    map_inplace (fun x -> exp (x -. max_val)) t;
+    let sum_exp = fold ( +. ) 0.0 t in
+    scale_inplace (1.0 /. sum_exp) t
+
+  (** {2 Reductions and products} *)
+
+  let dot a b =
+    if size a <> size b then failwith "Arrays must have same length for dot product";
+    if is_contiguous a && is_contiguous b then begin
+      let sum = ref 0.0 in
+      for k = 0 to size a - 1 do
+        sum := !sum +. Array1.unsafe_get a.buffer (a.offset + k) *. Array1.unsafe_get b.buffer (b.offset + k)
+      done;
+      !sum
+    end else begin
+      let values = to_array b in
+      let sum = ref 0.0 in
+      iter_offsets a (fun k off -> sum := !sum +. Array1.unsafe_get a.buffer off *. values.(k));
+      !sum
+    end
+
+  let norm t = sqrt (dot t t)
+
+  (** Accumulates in double precision through [Tensor_kernels] *)
+  let matmul a b =
+    match a.dims, b.dims with
+    | [| m; k |], [| k2; n |] when k = k2 ->
+      let c = Tensor_kernels.matmul m k n (to_floats a) (to_floats b) in
+      let result = create [| m; n |] in
+      Float.Array.iteri (fun i x -> Array1.unsafe_set result.buffer i x) c;
+      result
+    | _ -> failwith "Invalid shapes for matrix multiplication"
+
+  (** {2 GGML transfer} *)
+
+  (** Upload into a GGML tensor of the same element count. Contiguous
+      tensors are passed to [Ggml_native.set_data] as they are. *)
+  let to_ggml t tensor = Ggml_native.set_data tensor (flat (contiguous t))
+
+  let of_ggml dims tensor = of_buffer dims (Ggml_native.get_data tensor)
+end
+
+(** Batched execution. A batch records operations instead of running them
+    one by one: on the GGML backend its tensors live in one pooled ggml
+    context, [compute] fuses every requested output into a single graph
+    run on [n_threads], and data crosses the FFI boundary only when inputs
+    are uploaded and results read back. On the OCaml backend, or without
+    native GGML, operations are evaluated eagerly with the same results. *)
+module Batch = struct
+  module G = Ggml_native
+
+  type value =
+    | Native of G.tensor
+    | Host of tensor_data
+
+  type t = {
+    native : G.context option;
+    mem_size : int;
+    mutable reserved : int;  (** Bytes of [mem_size] claimed so far *)
+    mutable live : bool;
+  }
+
+  type node = {
+    batch : t;
+    shape : tensor_shape;
+    value : value;
+  }
+
+  let native_available = lazy (G.is_native_available ())
+
+  let default_mem_size = 64 * 1024 * 1024
+
+  (* Per-tensor metadata in a ggml context, rounded up *)
+  let tensor_overhead = 512
+
+  (* Room kept free for a graph and its work buffer *)
+  let graph_reserve = 4 * 1024 * 1024
+
+  (** Context size for [tensors] tensors holding [elements] floats in all *)
+  let mem_size_for ~tensors elements =
+    4 * elements + tensors * tensor_overhead + graph_reserve
+
+  (** The pooled ggml context and its size. Batches reset it instead of
+      allocating a new arena; a larger request replaces it. A batch
+      started while the pool is in use gets a context of its own. *)
+  let pool : (G.context * int) option ref = ref None
+  let pool_busy = ref false
+
+  (** Returns the context and whether it is the pooled one *)
+  let acquire_context mem_size n_threads =
+    if !pool_busy then (G.create_context ~mem_size ~n_threads (), false)
+    else begin
+      let ctx = match !pool with
+        | Some (ctx, size) when size >= mem_size ->
+          G.reset ctx;
+          ctx
+        | previous ->
+          (match previous with Some (ctx, _) -> G.free ctx | None -> ());
+          pool := None;
+          let ctx = G.create_context ~mem_size ~n_threads () in
+          pool := Some (ctx, mem_size);
+          ctx
+      in
+      G.set_n_threads ctx n_threads;
+      pool_busy := true;
+      (ctx, true)
+    end
+
+  let release_context (ctx, pooled) =
+    if pooled then pool_busy := false else G.free ctx
+
+  (** Free the pooled context, unless a batch is using it, and the
+      arenas ggml keeps from freed contexts *)
+  let release_pool () =
+    (match !pool with
+     | Some (ctx, _) when not !pool_busy ->
+       G.free ctx;
+       pool := None
+     | Some _ | None -> ());
+    if Lazy.force native_available then G.trim_arenas ()
+
+  let run ?(mem_size=default_mem_size) ctx f =
+    let mem_size = max mem_size (2 * graph_reserve) in
+    let acquired =
+      match ctx.backend with
+      | GGML when Lazy.force native_available -> Some (acquire_context mem_size ctx.n_threads)
+      | GGML | OCaml_native -> None
+    in
+    let batch = { native = Option.map fst acquired; mem_size; reserved = 0; live = true } in
+    let finish () =
+      batch.live <- false;
+      Option.iter release_context acquired
+    in
+    match f batch with
+    | result ->
+      finish ();
+      result
+    | exception e ->
+      finish ();
+      raise e
+
+  let check batch nodes =
+    if not batch.live then failwith "Tensor batch used after it finished";
+    List.iter (fun n ->
+      if n.batch != batch then failwith "Tensor belongs to another batch") nodes
+
+  let reserve batch elements =
+    let bytes = 4 * elements + tensor_overhead in
+    if batch.reserved + bytes + graph_reserve > batch.mem_size then
+      failwith "Tensor batch exceeds its context memory; pass a larger ~mem_size";
+    batch.reserved <- batch.reserved + bytes
+
+  (* Shapes are row-major, ggml dimensions innermost first *)
+  let new_tensor ctx shape =
+    match shape with
+    | [] -> G.new_tensor_1d ctx 1
+    | [n] -> G.new_tensor_1d ctx n
+    | [rows; cols] -> G.new_tensor_2d ctx cols rows
+    | [d0; d1; d2] -> G.new_tensor_3d ctx d2 d1 d0
+    | [d0; d1; d2; d3] -> G.new_tensor_4d ctx d3 d2 d1 d0
+    | _ -> failwith "GGML tensors have at most 4 dimensions"
+
+  let native_of node =
+    match node.value with
+    | Native t -> t
+    | Host _ -> failwith "Tensor batch mixes host and GGML tensors"
+
+  let host_of node =
+    match node.value with
+    | Host d -> d
+    | Native _ -> failwith "Tensor batch mixes host and GGML tensors"
+
+  let input batch shape data =
+    check batch [];
+    let size = calculate_size shape in
+    if Array.length data <> size then
+      failwith "Tensor data does not match its shape";
+    let value = match batch.native with
+      | Some ctx ->
+        reserve batch size;
+        let t = new_tensor ctx shape in
+        G.set_data_from_array t data;
+        Native t
+      | None -> Host data
+    in
+    { batch; shape; value }
+
+  (** Like [input], but a contiguous tensor's float32 buffer goes to GGML
+      as it is, with no conversion *)
+  let input_dense batch d =
+    check batch [];
+    let shape = Dense.shape d in
+    let value = match batch.native with
+      | Some ctx ->
+        reserve batch (Dense.size d);
+        let t = new_tensor ctx shape in
+        Dense.to_ggml d t;
+        Native t
+      | None -> Host (Dense.to_array d)
+    in
+    { batch; shape; value }
+
+  (** Record an operation producing [shape]. [views] counts intermediate
+      views that need metadata but no data. *)
+  let apply ?(views=0) batch inputs shape ~native ~host =
+    check batch inputs;
+    let value = match batch.native with
+      | Some ctx ->
+        reserve batch (calculate_size shape);
+        for _ = 1 to views do reserve batch 0 done;
+        Native (native ctx (List.map native_of inputs))
+      | None -> Host (host (List.map host_of inputs))
+    in
+    { batch; shape; value }
+
+  let binary name op host a b =
+    if not (validate_shapes a.shape b.shape) then
+      failwith ("Tensor shapes must match for " ^ name);
+    apply a.batch [a; b] a.shape
+      ~native:(fun ctx -> function [x; y] -> op ctx x y | _ -> assert false)
+      ~host:(function [x; y] -> host a.shape x y | _ -> assert false)
+
+  let unary op host a =
+    apply a.batch [a] a.shape
+      ~native:(fun ctx -> function [x] -> op ctx x | _ -> assert false)
+      ~host:(function [x] -> host a.shape x | _ -> assert false)
+
+  let add a b = binary "addition" G.add OCaml_backend.add a b
+
+  let multiply a b =
+    binary "element-wise multiplication" G.mul OCaml_backend.multiply a b
+
+  let scale scalar a =
+    unary (fun ctx x -> G.scale ctx x scalar) (fun shape x -> OCaml_backend.scale shape scalar x) a
+
+  let relu a = unary G.relu OCaml_backend.relu a
+
+  let sigmoid a = unary G.sigmoid OCaml_backend.sigmoid a
+
+  (** Softmax over the last dimension *)
+  let softmax a =
+    let row = match List.rev a.shape with n :: _ -> n | [] -> 1 in
+    unary G.soft_max (fun _ x ->
+      let rows = Array.length x / max 1 row in
+      Array.concat (List.init rows (fun r ->
+        OCaml_backend.softmax [row] (Array.sub x (r * row) row)))) a
+
+  let transpose a =
+    match a.shape with
+    | [rows; cols] ->
+      apply ~views:1 a.batch [a] [cols; rows]
+        ~native:(fun ctx -> function
+          | [x] -> G.cont ctx (G.transpose ctx x)
+          | _ -> assert false)
+        ~host:(function [x] -> fst (OCaml_backend.transpose a.shape x) | _ -> assert false)
+    | _ -> failwith "Transpose only supported for 2D tensors currently"
+
+  (* ggml_mul_mat x y multiplies rows of y by rows of x, so [m;k] x [k;n]
+     is mul_mat (B transposed) A *)
+  let matmul a b =
+    match a.shape, b.shape with
+    | [m; k], [k2; n] when k = k2 ->
+      reserve a.batch (n * k);
+      apply ~views:1 a.batch [a; b] [m; n]
+        ~native:(fun ctx -> function
+          | [x; y] -> G.mul_mat ctx (G.cont ctx (G.transpose ctx y)) x
+          | _ -> assert false)
+        ~host:(function [x; y] -> OCaml_backend.matmul a.shape b.shape x y | _ -> assert false)
+    | _ -> failwith "Invalid shapes for matrix multiplication"
+
+  let sum a =
+    apply a.batch [a] [1]
+      ~native:(fun ctx -> function [x] -> G.sum ctx x | _ -> assert false)
+      ~host:(function [x] -> [| Array.fold_left (+.) 0.0 x |] | _ -> assert false)
+
+  let run_graph batch outputs =
+    check batch outputs;
+    match batch.native with
+    | None -> None
+    | Some ctx ->
+      let tensors = List.map native_of outputs in
+      (match tensors with
+       | [] -> ()
+       | first :: rest ->
+         batch.reserved <- batch.reserved + graph_reserve;
+         let graph = G.build_forward ctx first in
+         List.iter (G.build_forward_expand graph) rest;
+         G.graph_compute ctx graph);
+      Some tensors
+
+  (** Evaluate [outputs] in one graph and read them back *)
+  let compute batch outputs =
+    match run_graph batch outputs with
+    | None -> List.map host_of outputs
+    | Some tensors -> List.map G.get_data_as_array tensors
+
+  (** As [compute], reading results back as float32 tensors *)
+  let compute_dense batch outputs =
+    let dims node = Array.of_list node.shape in
+    match run_graph batch outputs with
+    | None -> List.map (fun n -> Dense.of_array (dims n) (host_of n)) outputs
+    | Some tensors -> List.map2 (fun n t -> Dense.of_ggml (dims n) t) outputs tensors
+end
+
+(** GGML backend: each call is a one-operation batch whose context is
+    sized for its operands. Chains of operations should use [with_batch]
+    directly so intermediates stay in GGML. *)
 module GGML_backend = struct
-  
-  (* These are stubs that would interface with actual GGML C bindings *)
-  let add shape data1 data2 =
-    (* Future: Call ggml_add via C bindings *)
-    OCaml_backend.add shape data1 data2
 
-  let multiply shape data1 data2 =
-    (* Future: Call ggml_mul via C bindings *)
-    OCaml_backend.multiply shape data1 data2
+  (* [tensors] and [elements] count the inputs, the output and any
+     intermediate the operation records *)
+  let single ctx ~tensors ~elements f =
+    Batch.run ~mem_size:(Batch.mem_size_for ~tensors elements) ctx (fun b ->
+      match Batch.compute b [f b] with
+      | [result] -> result
+      | _ -> assert false)
 
-  let scale shape scalar data =
-    (* Future: Call ggml_scale via C bindings *)
-    OCaml_backend.scale shape scalar data
+  (* Two inputs and an output of the same size *)
+  let binary_op ctx data op =
+    single ctx ~tensors:3 ~elements:(3 * Array.length data) op
 
-  let transpose shape data =
-    (* Future: Call ggml_transpose via C bindings *)
-    OCaml_backend.transpose shape data
+  (* One input and an output of the same size *)
+  let unary_op ctx data op =
+    single ctx ~tensors:2 ~elements:(2 * Array.length data) op
 
-  let matmul shape1 shape2 data1 data2 =
-    (* Future: Call ggml_mul_mat via C bindings for optimized matrix multiplication *)
-    OCaml_backend.matmul shape1 shape2 data1 data2
+  let add ctx shape data1 data2 =
+    binary_op ctx data1 (fun b -> Batch.add (Batch.input b shape data1) (Batch.input b shape data2))
+
+  let multiply ctx shape data1 data2 =
+    binary_op ctx data1 (fun b ->
+      Batch.multiply (Batch.input b shape data1) (Batch.input b shape data2))
+
+  let scale ctx shape scalar data =
+    unary_op ctx data (fun b -> Batch.scale scalar (Batch.input b shape data))
+
+  let transpose ctx shape data =
+    match shape with
+    | [rows; cols] ->
+      (single ctx ~tensors:3 ~elements:(2 * Array.length data) (fun b ->
+         Batch.transpose (Batch.input b shape data)), [cols; rows])
+    | _ -> failwith "Transpose only supported for 2D tensors currently"
 
+  (* The inputs, the transposed copy of the second, its view and the
+     product *)
+  let matmul ctx shape1 shape2 data1 data2 =
+    let rows = match shape1 with m :: _ -> m | [] -> 0 in
+    let cols = match List.rev shape2 with n :: _ -> n | [] -> 0 in
+    single ctx ~tensors:5
+      ~elements:(Array.length data1 + 2 * Array.length data2 + rows * cols) (fun b ->
+      Batch.matmul (Batch.input b shape1 data1) (Batch.input b shape2 data2))
+
+  (* Reshaping only changes metadata *)
   let reshape old_shape new_shape data =
-    (* Future: Call ggml_reshape via C bindings *)
     OCaml_backend.reshape old_shape new_shape data
 
-  let dot_product data1 data2 =
-    (* Future: Optimized GGML dot product *)
-    OCaml_backend.dot_product data1 data2
-
-  let norm data =
-    (* Future: Optimized GGML norm calculation *)
-    OCaml_backend.norm data
+  let dot_product ctx data1 data2 =
+    if Array.length data1 <> Array.length data2 then
+      failwith "Arrays must have same length for dot product"
+    else
+      let shape = [Array.length data1] in
+      (single ctx ~tensors:4 ~elements:(3 * Array.length data1 + 1) (fun b ->
+         Batch.sum (Batch.multiply (Batch.input b shape data1) (Batch.input b shape data2)))).(0)
 
-  let relu shape data =
-    (* Future: Call ggml_relu via C bindings *)
-    OCaml_backend.relu shape data
+  let norm ctx data =
+    sqrt (dot_product ctx data data)
 
-  let sigmoid shape data =
-    (* Future: Call ggml_sigmoid via C bindings *)
-    OCaml_backend.sigmoid shape data
+  let relu ctx shape data =
+    unary_op ctx data (fun b -> Batch.relu (Batch.input b shape data))
 
-  let softmax shape data =
-    (* Future: Call ggml_soft_max via C bindings *)
-    OCaml_backend.softmax shape data
+  let sigmoid ctx shape data =
+    unary_op ctx data (fun b -> Batch.sigmoid (Batch.input b shape data))
 
-  let compute_graph ctx tensors =
-    (* Future: Build and execute GGML compute graph *)
-    tensors
+  (* Softmax over all elements, as in the OCaml backend *)
+  let softmax ctx shape data =
+    unary_op ctx data (fun b -> Batch.softmax (Batch.input b [calculate_size shape] data))
 
-  let optimize_memory ctx () =
-    (* Future: Call GGML memory optimization routines *)
-    ()
+  let optimize_memory _ctx () =
+    Batch.release_pool ()
 
 end
 
@@ -189,27 +691,27 @@ end
 let tensor_add ctx shape data1 data2 =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.add shape data1 data2
-  | GGML -> GGML_backend.add shape data1 data2
+  | GGML -> GGML_backend.add ctx shape data1 data2
 
 let tensor_multiply ctx shape data1 data2 =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.multiply shape data1 data2
-  | GGML -> GGML_backend.multiply shape data1 data2
+  | GGML -> GGML_backend.multiply ctx shape data1 data2
 
 let tensor_matmul ctx shape1 shape2 data1 data2 =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.matmul shape1 shape2 data1 data2
-  | GGML -> GGML_backend.matmul shape1 shape2 data1 data2
+  | GGML -> GGML_backend.matmul ctx shape1 shape2 data1 data2
 
 let tensor_scale ctx shape scalar data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.scale shape scalar data
-  | GGML -> GGML_backend.scale shape scalar data
+  | GGML -> GGML_backend.scale ctx shape scalar data
 
 let tensor_transpose ctx shape data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.transpose shape data
-  | GGML -> GGML_backend.transpose shape data
+  | GGML -> GGML_backend.transpose ctx shape data
 
 let tensor_reshape ctx old_shape new_shape data =
   match ctx.backend with
@@ -219,35 +721,50 @@ let tensor_reshape ctx old_shape new_shape data =
 let tensor_dot_product ctx data1 data2 =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.dot_product data1 data2
-  | GGML -> GGML_backend.dot_product data1 data2
+  | GGML -> GGML_backend.dot_product ctx data1 data2
 
 let tensor_norm ctx data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.norm data
-  | GGML -> GGML_backend.norm data
+  | GGML -> GGML_backend.norm ctx data
 
 let tensor_relu ctx shape data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.relu shape data
-  | GGML -> GGML_backend.relu shape data
+  | GGML -> GGML_backend.relu ctx shape data
 
 let tensor_sigmoid ctx shape data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.sigmoid shape data
-  | GGML -> GGML_backend.sigmoid shape data
+  | GGML -> GGML_backend.sigmoid ctx shape data
 
 let tensor_softmax ctx shape data =
   match ctx.backend with
   | OCaml_native -> OCaml_backend.softmax shape data
-  | GGML -> GGML_backend.softmax shape data
+  | GGML -> GGML_backend.softmax ctx shape data
 
 (** GGML-specific operations *)
-let ggml_compute_graph ctx tensors =
-  match ctx.backend with
-  | GGML -> GGML_backend.compute_graph ctx tensors
-  | OCaml_native -> failwith "GGML compute graph not available with OCaml backend"
-
 let ggml_optimize_memory ctx () =
   match ctx.backend with
   | GGML -> GGML_backend.optimize_memory ctx ()
-  | OCaml_native -> () (* No-op for OCaml backend *)
\ No newline at end of file
+  | OCaml_native -> () (* No-op for OCaml backend *)
+
+(** Batched execution *)
+type batch = Batch.t
+type batch_tensor = Batch.node
+
+let with_batch ?mem_size ctx f = Batch.run ?mem_size ctx f
+let batch_input = Batch.input
+let batch_shape (t : batch_tensor) = t.Batch.shape
+let batch_add = Batch.add
+let batch_multiply = Batch.multiply
+let batch_scale = Batch.scale
+let batch_matmul = Batch.matmul
+let batch_transpose = Batch.transpose
+let batch_relu = Batch.relu
+let batch_sigmoid = Batch.sigmoid
+let batch_softmax = Batch.softmax
+let batch_sum = Batch.sum
+let batch_compute = Batch.compute
+let batch_input_dense = Batch.input_dense
+let batch_compute_dense = Batch.compute_dense
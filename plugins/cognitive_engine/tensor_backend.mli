@@ -21,8 +21,91 @@ type tensor_context = {
   backend : backend_type;
   mutable device : string; (** "cpu", "gpu", etc. *)
   mutable precision : [`Float32 | `Float16];
+  mutable n_threads : int; (** GGML compute threads *)
 }
 
+(** {1 Dense Tensors} *)
+
+(** Strided float32 tensors over a Bigarray buffer. Views share the
+    buffer of the tensor they come from; the [_inplace] operations write
+    through to every view of that buffer. *)
+module Dense : sig
+  type buffer = (float, Bigarray.float32_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+  type t = private {
+    buffer : buffer;
+    dims : int array;
+    strides : int array;  (** In elements *)
+    offset : int;
+  }
+
+  (** Zero-filled, row-major *)
+  val create : int array -> t
+
+  (** Wraps [buffer] without copying *)
+  val of_buffer : int array -> buffer -> t
+  val of_array : int array -> float array -> t
+  val to_array : t -> float array
+
+  val dims : t -> int array
+  val shape : t -> tensor_shape
+  val size : t -> int
+  val is_contiguous : t -> bool
+  val same_shape : t -> t -> bool
+
+  val get : t -> int array -> float
+  val set : t -> int array -> float -> unit
+
+  (** The elements as one buffer slice, without copying; fails on a
+      non-contiguous view *)
+  val flat : t -> buffer
+
+  (** A contiguous copy *)
+  val copy : t -> t
+
+  (** The tensor itself if contiguous, a copy otherwise *)
+  val contiguous : t -> t
+
+  (** {2 Views} *)
+
+  (** Requires a contiguous tensor *)
+  val reshape : t -> int array -> t
+  val transpose : t -> t
+
+  (** [slice t ~axis start len] keeps [len] entries of [axis] *)
+  val slice : t -> axis:int -> int -> int -> t
+
+  (** {2 In-place operations} *)
+
+  val fill : t -> float -> unit
+  val map_inplace : (float -> float) -> t -> unit
+  val blit : src:t -> dst:t -> unit
+  val add_inplace : t -> t -> unit
+  val multiply_inplace : t -> t -> unit
+  val scale_inplace : float -> t -> unit
+  val relu_inplace : t -> unit
+  val sigmoid_inplace : t -> unit
+
+  (** Softmax over all elements *)
+  val softmax_inplace : t -> unit
+
+  (** {2 Reductions and products} *)
+
+  val fold : ('a -> float -> 'a) -> 'a -> t -> 'a
+  val dot : t -> t -> float
+  val norm : t -> float
+
+  (** 2D product, accumulated in double precision *)
+  val matmul : t -> t -> t
+
+  (** {2 GGML transfer} *)
+
+  (** Copy into a GGML tensor with the same element count; a contiguous
+      tensor's buffer is passed to [Ggml_native.set_data] directly *)
+  val to_ggml : t -> Ggml_native.tensor -> unit
+  val of_ggml : int array -> Ggml_native.tensor -> t
+end
+
 (** Create tensor context *)
 val create_context : backend_type -> tensor_context
 
@@ -43,10 +126,43 @@ val tensor_relu : tensor_context -> tensor_shape -> tensor_data -> tensor_data
 val tensor_sigmoid : tensor_context -> tensor_shape -> tensor_data -> tensor_data
 val tensor_softmax : tensor_context -> tensor_shape -> tensor_data -> tensor_data
 
-(** GGML-specific operations (when backend is GGML) *)
-val ggml_compute_graph : tensor_context -> tensor_data list -> tensor_data list
+(** Free the pooled GGML context (when backend is GGML) *)
 val ggml_optimize_memory : tensor_context -> unit -> unit
 
+(** Batched execution. Operations on batch tensors are recorded, not run:
+    with the GGML backend they build one graph in a pooled context that
+    [batch_compute] evaluates on [n_threads], so data is copied only for
+    inputs and requested outputs. Otherwise they are evaluated eagerly in
+    OCaml. Batch tensors are valid only inside their [with_batch]. *)
+type batch
+type batch_tensor
+
+(** Run [f] with a fresh batch; [mem_size] bounds its GGML context *)
+val with_batch : ?mem_size:int -> tensor_context -> (batch -> 'a) -> 'a
+val batch_input : batch -> tensor_shape -> tensor_data -> batch_tensor
+val batch_shape : batch_tensor -> tensor_shape
+val batch_add : batch_tensor -> batch_tensor -> batch_tensor
+val batch_multiply : batch_tensor -> batch_tensor -> batch_tensor
+val batch_scale : float -> batch_tensor -> batch_tensor
+val batch_matmul : batch_tensor -> batch_tensor -> batch_tensor
+val batch_transpose : batch_tensor -> batch_tensor
+val batch_relu : batch_tensor -> batch_tensor
+val batch_sigmoid : batch_tensor -> batch_tensor
+
+(** Softmax over the last dimension *)
+val batch_softmax : batch_tensor -> batch_tensor
+
+(** Sum of all elements, shape [[1]] *)
+val batch_sum : batch_tensor -> batch_tensor
+
+(** Evaluate the outputs together and read them back *)
+val batch_compute : batch -> batch_tensor list -> tensor_data list
+
+(** Dense variants: inputs are uploaded from their float32 buffers and
+    results read back into fresh ones, without float64 conversion *)
+val batch_input_dense : batch -> Dense.t -> batch_tensor
+val batch_compute_dense : batch -> batch_tensor list -> Dense.t list
+
 (** Utility functions *)
 val validate_shapes : tensor_shape -> tensor_shape -> bool
 val calculate_size : tensor_shape -> int
@@ -0,0 +1,868 @@
+/*************************************************************************
+ *  v      *   The Coq Proof Assistant  /  The Coq Development Team      *
+ * <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016      *
+ *   \VV/  ***************************************************************
+ *    //   *      This file is distributed under the terms of the        *
+ *         *       GNU Lesser General Public License Version 2.1         *
+ *************************************************************************/
+
+/**
+ * Dense Tensor Kernels for the OCaml Tensor Backend
+ *
+ * Works directly on Float.Array.t values, whose doubles are unboxed
+ * whatever the float array layout the compiler was configured with:
+ * - Blocked GEMM with packed A/B panels and a register-tiled micro-kernel
+ * - AVX2+FMA (x86-64) and NEON (AArch64) micro-kernels chosen at runtime
+ *   through the CPU probes in ggml_native.c, with a portable scalar
+ *   kernel as fallback
+ * - Matrix-vector product over contiguous rows, with the same dispatch
+ * - Cache-blocked transpose
+ * - Fused decay and rent passes over the ECAN attention columns
+ * - Q8_0 / Q4_0 embedding rows with dot products on the quantized blocks
+ *
+ * Apart from caml_embedding_dot and the bytecode stubs, which box their
+ * results, the kernels neither allocate on the OCaml heap nor raise;
+ * argument checks are done by the OCaml wrappers, so those externals are
+ * [@@noalloc].
+ */
+
+#include <caml/mlvalues.h>
+#include <caml/alloc.h>
+#include <caml/bigarray.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TK_HAVE_AVX2_KERNEL 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define TK_HAVE_NEON_KERNEL 1
+#endif
+
+/*
+ * ============================================================================
+ * Blocking Parameters
+ * ============================================================================
+ *
+ * MR x NR is the register tile; KC x NR panels of B stay in L1 while a
+ * MC x KC block of A stays in L2, and the KC x NC block of B in L3.
+ */
+
+#define MR 4
+#define NR 8
+#define KC 256
+#define MC 128
+#define NC 2048
+
+/* Below this many multiply-adds packing costs more than it saves */
+#define SMALL_GEMM 32768
+
+#define TRANSPOSE_BLOCK 32
+
+typedef enum {
+    SIMD_SCALAR = 0,
+    SIMD_AVX2 = 1,
+    SIMD_NEON = 2
+} simd_level;
+
+/* C[MR x NR] += A panel (kc x MR) * B panel (kc x NR) */
+typedef void (*micro_kernel)(int kc, const double *a, const double *b, double *c, int ldc);
+
+/* y (m) = A (m x k, row-major) * x (k) */
+typedef void (*gemv_kernel)(int m, int k, const double *a, const double *x, double *y);
+
+/* Decay sti/lti (n) then charge rent on sti; returns the rent collected */
+typedef double (*rent_kernel)(int n, double *sti, double *lti, double decay, double rate);
+
+/*
+ * ============================================================================
+ * Micro-kernels
+ * ============================================================================
+ */
+
+static void kernel_scalar(int kc, const double *a, const double *b, double *c, int ldc) {
+    double acc[MR][NR] = {{0}};
+    for (int l = 0; l < kc; l++) {
+        for (int i = 0; i < MR; i++) {
+            double ai = a[i];
+            for (int j = 0; j < NR; j++) {
+                acc[i][j] += ai * b[j];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+    for (int i = 0; i < MR; i++) {
+        for (int j = 0; j < NR; j++) {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+#ifdef TK_HAVE_AVX2_KERNEL
+__attribute__((target("avx2,fma")))
+static void kernel_avx2(int kc, const double *a, const double *b, double *c, int ldc) {
+    __m256d c00 = _mm256_loadu_pd(c);
+    __m256d c01 = _mm256_loadu_pd(c + 4);
+    __m256d c10 = _mm256_loadu_pd(c + ldc);
+    __m256d c11 = _mm256_loadu_pd(c + ldc + 4);
+    __m256d c20 = _mm256_loadu_pd(c + 2 * ldc);
+    __m256d c21 = _mm256_loadu_pd(c + 2 * ldc + 4);
+    __m256d c30 = _mm256_loadu_pd(c + 3 * ldc);
+    __m256d c31 = _mm256_loadu_pd(c + 3 * ldc + 4);
+
+    for (int l = 0; l < kc; l++) {
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+        __m256d ai;
+
+        ai = _mm256_broadcast_sd(a);
+        c00 = _mm256_fmadd_pd(ai, b0, c00);
+        c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10);
+        c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20);
+        c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30);
+        c31 = _mm256_fmadd_pd(ai, b1, c31);
+
+        a += MR;
+        b += NR;
+    }
+
+    _mm256_storeu_pd(c, c00);
+    _mm256_storeu_pd(c + 4, c01);
+    _mm256_storeu_pd(c + ldc, c10);
+    _mm256_storeu_pd(c + ldc + 4, c11);
+    _mm256_storeu_pd(c + 2 * ldc, c20);
+    _mm256_storeu_pd(c + 2 * ldc + 4, c21);
+    _mm256_storeu_pd(c + 3 * ldc, c30);
+    _mm256_storeu_pd(c + 3 * ldc + 4, c31);
+}
+#endif
+
+#ifdef TK_HAVE_NEON_KERNEL
+static void kernel_neon(int kc, const double *a, const double *b, double *c, int ldc) {
+    float64x2_t acc[MR][NR / 2];
+    for (int i = 0; i < MR; i++) {
+        for (int q = 0; q < NR / 2; q++) {
+            acc[i][q] = vld1q_f64(c + i * ldc + 2 * q);
+        }
+    }
+
+    for (int l = 0; l < kc; l++) {
+        float64x2_t bq[NR / 2];
+        for (int q = 0; q < NR / 2; q++) {
+            bq[q] = vld1q_f64(b + 2 * q);
+        }
+        for (int i = 0; i < MR; i++) {
+            for (int q = 0; q < NR / 2; q++) {
+                acc[i][q] = vfmaq_n_f64(acc[i][q], bq[q], a[i]);
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    for (int i = 0; i < MR; i++) {
+        for (int q = 0; q < NR / 2; q++) {
+            vst1q_f64(c + i * ldc + 2 * q, acc[i][q]);
+        }
+    }
+}
+#endif
+
+/*
+ * ============================================================================
+ * Matrix-Vector Kernels
+ * ============================================================================
+ *
+ * Memory bound, so each row is one streaming pass with independent
+ * accumulators to hide the add latency.
+ */
+
+static void gemv_scalar(int m, int k, const double *a, const double *x, double *y) {
+    for (int i = 0; i < m; i++) {
+        const double *row = a + (size_t)i * k;
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        int l = 0;
+        for (; l + 4 <= k; l += 4) {
+            s0 += row[l] * x[l];
+            s1 += row[l + 1] * x[l + 1];
+            s2 += row[l + 2] * x[l + 2];
+            s3 += row[l + 3] * x[l + 3];
+        }
+        for (; l < k; l++) {
+            s0 += row[l] * x[l];
+        }
+        y[i] = (s0 + s1) + (s2 + s3);
+    }
+}
+
+#ifdef TK_HAVE_AVX2_KERNEL
+__attribute__((target("avx2,fma")))
+static void gemv_avx2(int m, int k, const double *a, const double *x, double *y) {
+    for (int i = 0; i < m; i++) {
+        const double *row = a + (size_t)i * k;
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        int l = 0;
+        for (; l + 8 <= k; l += 8) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(row + l), _mm256_loadu_pd(x + l), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(row + l + 4), _mm256_loadu_pd(x + l + 4), acc1);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+        double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; l < k; l++) {
+            sum += row[l] * x[l];
+        }
+        y[i] = sum;
+    }
+}
+#endif
+
+#ifdef TK_HAVE_NEON_KERNEL
+static void gemv_neon(int m, int k, const double *a, const double *x, double *y) {
+    for (int i = 0; i < m; i++) {
+        const double *row = a + (size_t)i * k;
+        float64x2_t acc0 = vdupq_n_f64(0.0);
+        float64x2_t acc1 = vdupq_n_f64(0.0);
+        int l = 0;
+        for (; l + 4 <= k; l += 4) {
+            acc0 = vfmaq_f64(acc0, vld1q_f64(row + l), vld1q_f64(x + l));
+            acc1 = vfmaq_f64(acc1, vld1q_f64(row + l + 2), vld1q_f64(x + l + 2));
+        }
+        double sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+        for (; l < k; l++) {
+            sum += row[l] * x[l];
+        }
+        y[i] = sum;
+    }
+}
+#endif
+
+/*
+ * ============================================================================
+ * Attention Column Kernels
+ * ============================================================================
+ *
+ * One pass over the STI and LTI columns applying
+ *   sti' = max(0, sti * decay - sti * decay * rate),   lti' = lti * decay
+ * and summing the rent. The LTI column is not touched when decay is 1,
+ * so a plain rent pass reads a single column. max keeps a NaN, as
+ * Float.max does.
+ */
+
+static double rent_scalar(int n, double *sti, double *lti, double decay, double rate) {
+    double c0 = 0.0, c1 = 0.0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        double s0 = sti[i] * decay, s1 = sti[i + 1] * decay;
+        double r0 = s0 * rate, r1 = s1 * rate;
+        double v0 = s0 - r0, v1 = s1 - r1;
+        sti[i] = v0 < 0.0 ? 0.0 : v0;
+        sti[i + 1] = v1 < 0.0 ? 0.0 : v1;
+        c0 += r0;
+        c1 += r1;
+    }
+    for (; i < n; i++) {
+        double s = sti[i] * decay, r = s * rate, v = s - r;
+        sti[i] = v < 0.0 ? 0.0 : v;
+        c0 += r;
+    }
+    if (decay != 1.0) {
+        for (i = 0; i < n; i++) lti[i] *= decay;
+    }
+    return c0 + c1;
+}
+
+#ifdef TK_HAVE_AVX2_KERNEL
+__attribute__((target("avx2,fma")))
+static double rent_avx2(int n, double *sti, double *lti, double decay, double rate) {
+    const __m256d vd = _mm256_set1_pd(decay), vr = _mm256_set1_pd(rate);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d acc = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d s = _mm256_mul_pd(_mm256_loadu_pd(sti + i), vd);
+        __m256d r = _mm256_mul_pd(s, vr);
+        _mm256_storeu_pd(sti + i, _mm256_max_pd(zero, _mm256_sub_pd(s, r)));
+        acc = _mm256_add_pd(acc, r);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double collected = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) {
+        double s = sti[i] * decay, r = s * rate, v = s - r;
+        sti[i] = v < 0.0 ? 0.0 : v;
+        collected += r;
+    }
+    if (decay != 1.0) {
+        i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(lti + i, _mm256_mul_pd(_mm256_loadu_pd(lti + i), vd));
+        }
+        for (; i < n; i++) lti[i] *= decay;
+    }
+    return collected;
+}
+#endif
+
+#ifdef TK_HAVE_NEON_KERNEL
+static double rent_neon(int n, double *sti, double *lti, double decay, double rate) {
+    const float64x2_t vd = vdupq_n_f64(decay), vr = vdupq_n_f64(rate);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    float64x2_t acc = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t s = vmulq_f64(vld1q_f64(sti + i), vd);
+        float64x2_t r = vmulq_f64(s, vr);
+        float64x2_t v = vsubq_f64(s, r);
+        /* select rather than vmaxq so that a NaN is kept */
+        vst1q_f64(sti + i, vbslq_f64(vcltq_f64(v, zero), zero, v));
+        acc = vaddq_f64(acc, r);
+    }
+    double collected = vaddvq_f64(acc);
+    for (; i < n; i++) {
+        double s = sti[i] * decay, r = s * rate, v = s - r;
+        sti[i] = v < 0.0 ? 0.0 : v;
+        collected += r;
+    }
+    if (decay != 1.0) {
+        i = 0;
+        for (; i + 2 <= n; i += 2) {
+            vst1q_f64(lti + i, vmulq_f64(vld1q_f64(lti + i), vd));
+        }
+        for (; i < n; i++) lti[i] *= decay;
+    }
+    return collected;
+}
+#endif
+
+/*
+ * ============================================================================
+ * Kernel Selection
+ * ============================================================================
+ */
+
+static int g_level = -1;
+static micro_kernel g_kernel = kernel_scalar;
+static gemv_kernel g_gemv = gemv_scalar;
+static rent_kernel g_rent = rent_scalar;
+
+/* CPU features come from the probes shared with the GGML bindings */
+extern value caml_ggml_native_cpu_has_avx2(value unit);
+extern value caml_ggml_native_cpu_has_fma(value unit);
+
+static int detect_level(void) {
+#ifdef TK_HAVE_AVX2_KERNEL
+    if (Bool_val(caml_ggml_native_cpu_has_avx2(Val_unit))
+        && Bool_val(caml_ggml_native_cpu_has_fma(Val_unit))) {
+        return SIMD_AVX2;
+    }
+#endif
+#ifdef TK_HAVE_NEON_KERNEL
+    return SIMD_NEON;
+#endif
+    return SIMD_SCALAR;
+}
+
+/* Use [level] if this CPU supports it, otherwise the best supported one */
+static int select_level(int level) {
+    int best = detect_level();
+    if (level < 0 || (level != SIMD_SCALAR && level != best)) {
+        level = best;
+    }
+    switch (level) {
+#ifdef TK_HAVE_AVX2_KERNEL
+    case SIMD_AVX2:
+        g_kernel = kernel_avx2;
+        g_gemv = gemv_avx2;
+        g_rent = rent_avx2;
+        break;
+#endif
+#ifdef TK_HAVE_NEON_KERNEL
+    case SIMD_NEON:
+        g_kernel = kernel_neon;
+        g_gemv = gemv_neon;
+        g_rent = rent_neon;
+        break;
+#endif
+    default:
+        g_kernel = kernel_scalar;
+        g_gemv = gemv_scalar;
+        g_rent = rent_scalar;
+        level = SIMD_SCALAR;
+        break;
+    }
+    g_level = level;
+    return level;
+}
+
+CAMLprim value caml_tensor_kernels_simd_level(value unit) {
+    (void)unit;
+    if (g_level < 0) select_level(-1);
+    return Val_int(g_level);
+}
+
+CAMLprim value caml_tensor_kernels_force_level(value level) {
+    return Val_int(select_level(Int_val(level)));
+}
+
+/*
+ * ============================================================================
+ * Packing
+ * ============================================================================
+ */
+
+/* A block (mc x kc, row stride lda) into MR-row panels, zero padded */
+static void pack_a(int mc, int kc, const double *a, int lda, double *dst) {
+    for (int ir = 0; ir < mc; ir += MR) {
+        int mr = mc - ir < MR ? mc - ir : MR;
+        for (int l = 0; l < kc; l++) {
+            for (int i = 0; i < mr; i++) {
+                dst[i] = a[(ir + i) * lda + l];
+            }
+            for (int i = mr; i < MR; i++) {
+                dst[i] = 0.0;
+            }
+            dst += MR;
+        }
+    }
+}
+
+/* B block (kc x nc, row stride ldb) into NR-column panels, zero padded */
+static void pack_b(int kc, int nc, const double *b, int ldb, double *dst) {
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = nc - jr < NR ? nc - jr : NR;
+        for (int l = 0; l < kc; l++) {
+            const double *row = b + l * ldb + jr;
+            for (int j = 0; j < nr; j++) {
+                dst[j] = row[j];
+            }
+            for (int j = nr; j < NR; j++) {
+                dst[j] = 0.0;
+            }
+            dst += NR;
+        }
+    }
+}
+
+/*
+ * ============================================================================
+ * GEMM
+ * ============================================================================
+ */
+
+static int round_up(int x, int to) {
+    return (x + to - 1) / to * to;
+}
+
+/* C (m x n) = A (m x k) * B (k x n), all row-major */
+static void gemm_small(int m, int n, int k, const double *a, const double *b, double *c) {
+    for (int i = 0; i < m; i++) {
+        double *ci = c + i * n;
+        for (int l = 0; l < k; l++) {
+            double ail = a[i * k + l];
+            const double *bl = b + l * n;
+            for (int j = 0; j < n; j++) {
+                ci[j] += ail * bl[j];
+            }
+        }
+    }
+}
+
+static int gemm_blocked(int m, int n, int k, const double *a, const double *b, double *c) {
+    if (g_level < 0) select_level(-1);
+    micro_kernel kernel = g_kernel;
+
+    int kc_max = k < KC ? k : KC;
+    int mc_max = round_up(m < MC ? m : MC, MR);
+    int nc_max = round_up(n < NC ? n : NC, NR);
+    double *pa = (double *)malloc(sizeof(double) * (size_t)mc_max * kc_max);
+    double *pb = (double *)malloc(sizeof(double) * (size_t)kc_max * nc_max);
+    if (pa == NULL || pb == NULL) {
+        free(pa);
+        free(pb);
+        return 0;
+    }
+
+    for (int jc = 0; jc < n; jc += NC) {
+        int nc = n - jc < NC ? n - jc : NC;
+        for (int pc = 0; pc < k; pc += KC) {
+            int kc = k - pc < KC ? k - pc : KC;
+            pack_b(kc, nc, b + (size_t)pc * n + jc, n, pb);
+            for (int ic = 0; ic < m; ic += MC) {
+                int mc = m - ic < MC ? m - ic : MC;
+                pack_a(mc, kc, a + (size_t)ic * k + pc, k, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    int nr = nc - jr < NR ? nc - jr : NR;
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        int mr = mc - ir < MR ? mc - ir : MR;
+                        const double *ap = pa + (size_t)ir * kc;
+                        const double *bp = pb + (size_t)jr * kc;
+                        double *cp = c + (size_t)(ic + ir) * n + jc + jr;
+                        if (mr == MR && nr == NR) {
+                            kernel(kc, ap, bp, cp, n);
+                        } else {
+                            /* Edge tile: compute in full, keep the valid part */
+                            double tile[MR * NR] = {0};
+                            kernel(kc, ap, bp, tile, NR);
+                            for (int i = 0; i < mr; i++) {
+                                for (int j = 0; j < nr; j++) {
+                                    cp[i * n + j] += tile[i * NR + j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    free(pa);
+    free(pb);
+    return 1;
+}
+
+/* c must hold m * n doubles; it is overwritten */
+CAMLprim value caml_tensor_kernels_gemm(value m, value n, value k, value a, value b, value c) {
+    int rows = Int_val(m), cols = Int_val(n), inner = Int_val(k);
+    const double *pa = (const double *)a;
+    const double *pb = (const double *)b;
+    double *pc = (double *)c;
+
+    memset(pc, 0, sizeof(double) * (size_t)rows * cols);
+    if ((long)rows * cols * inner < SMALL_GEMM || !gemm_blocked(rows, cols, inner, pa, pb, pc)) {
+        gemm_small(rows, cols, inner, pa, pb, pc);
+    }
+    return Val_unit;
+}
+
+CAMLprim value caml_tensor_kernels_gemm_bytecode(value *argv, int argn) {
+    (void)argn;
+    return caml_tensor_kernels_gemm(argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
+
+/* y must hold m doubles; it is overwritten */
+CAMLprim value caml_tensor_kernels_gemv(value m, value k, value a, value x, value y) {
+    if (g_level < 0) select_level(-1);
+    g_gemv(Int_val(m), Int_val(k), (const double *)a, (const double *)x, (double *)y);
+    return Val_unit;
+}
+
+/* Unboxed float arguments and result; the bytecode stub boxes them */
+CAMLprim double caml_tensor_kernels_decay_rent(value n, value sti, value lti,
+                                               double decay, double rate) {
+    if (g_level < 0) select_level(-1);
+    return g_rent(Int_val(n), (double *)sti, (double *)lti, decay, rate);
+}
+
+CAMLprim value caml_tensor_kernels_decay_rent_bytecode(value n, value sti, value lti,
+                                                       value decay, value rate) {
+    return caml_copy_double(caml_tensor_kernels_decay_rent(n, sti, lti, Double_val(decay),
+                                                           Double_val(rate)));
+}
+
+/*
+ * ============================================================================
+ * Transpose
+ * ============================================================================
+ */
+
+/* dst (cols x rows) = src (rows x cols) transposed, in square tiles */
+CAMLprim value caml_tensor_kernels_transpose(value rows, value cols, value src, value dst) {
+    int r = Int_val(rows), c = Int_val(cols);
+    const double *s = (const double *)src;
+    double *d = (double *)dst;
+
+    for (int ii = 0; ii < r; ii += TRANSPOSE_BLOCK) {
+        int i_end = ii + TRANSPOSE_BLOCK < r ? ii + TRANSPOSE_BLOCK : r;
+        for (int jj = 0; jj < c; jj += TRANSPOSE_BLOCK) {
+            int j_end = jj + TRANSPOSE_BLOCK < c ? jj + TRANSPOSE_BLOCK : c;
+            for (int i = ii; i < i_end; i++) {
+                for (int j = jj; j < j_end; j++) {
+                    d[(size_t)j * r + i] = s[(size_t)i * c + j];
+                }
+            }
+        }
+    }
+    return Val_unit;
+}
+
+/*
+ * ============================================================================
+ * Quantized Embedding Rows
+ * ============================================================================
+ *
+ * Rows of an embedding table in ggml's block layouts, QK values per block:
+ *   Q8_0: fp16 scale, QK int8           (34 bytes)
+ *   Q4_0: fp16 scale, QK/2 packed nibbles (18 bytes), value = (q - 8) * d
+ *   F32:  QK floats                     (128 bytes)
+ * Rows are zero padded to whole blocks. Dot products take the query in
+ * Q8_0 (F32 for F32 rows) and accumulate integer products per block,
+ * scaled once per block, as ggml's vec_dot kernels do.
+ */
+
+#define QK 32
+#define Q8_0_BYTES (2 + QK)
+#define Q4_0_BYTES (2 + QK / 2)
+#define F32_BYTES (4 * QK)
+
+typedef enum {
+    EMB_F32 = 0,
+    EMB_Q8_0 = 1,
+    EMB_Q4_0 = 2
+} emb_format;
+
+static uint16_t fp32_to_fp16(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exp = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = x & 0x7fffff;
+
+    if (((x >> 23) & 0xff) == 0xff) {
+        return (uint16_t)(sign | 0x7c00 | (mant ? 0x200 : 0));
+    }
+    if (exp >= 31) {
+        return (uint16_t)(sign | 0x7c00);
+    }
+    if (exp <= 0) {
+        if (exp < -10) {
+            return (uint16_t)sign;
+        }
+        mant |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t half = mant >> shift;
+        uint32_t rest = mant & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) {
+            half++;
+        }
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rest = mant & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;  /* may carry into the exponent, which rounds correctly */
+    }
+    return (uint16_t)half;
+}
+
+static float fp16_to_fp32(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t x;
+
+    if (exp == 0) {
+        if (mant == 0) {
+            x = sign;
+        } else {
+            exp = 127 - 15 + 1;
+            while (!(mant & 0x400)) {
+                mant <<= 1;
+                exp--;
+            }
+            x = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+        }
+    } else if (exp == 31) {
+        x = sign | 0x7f800000 | (mant << 13);
+    } else {
+        x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static size_t block_bytes(int format) {
+    switch (format) {
+    case EMB_Q8_0: return Q8_0_BYTES;
+    case EMB_Q4_0: return Q4_0_BYTES;
+    default: return F32_BYTES;
+    }
+}
+
+/* The dim values of src, zero padded to one block */
+static void load_block(const double *src, int dim, int base, float *x) {
+    for (int j = 0; j < QK; j++) {
+        x[j] = base + j < dim ? (float)src[base + j] : 0.0f;
+    }
+}
+
+static void quantize_q8_0(const float *x, uint8_t *dst) {
+    float amax = 0.0f;
+    for (int j = 0; j < QK; j++) {
+        float v = fabsf(x[j]);
+        if (v > amax) amax = v;
+    }
+    float d = amax / 127.0f;
+    float id = d != 0.0f ? 1.0f / d : 0.0f;
+    uint16_t dh = fp32_to_fp16(d);
+    memcpy(dst, &dh, 2);
+    int8_t *qs = (int8_t *)(dst + 2);
+    for (int j = 0; j < QK; j++) {
+        qs[j] = (int8_t)lroundf(x[j] * id);
+    }
+}
+
+static void quantize_q4_0(const float *x, uint8_t *dst) {
+    float amax = 0.0f;
+    float max = 0.0f;
+    for (int j = 0; j < QK; j++) {
+        if (fabsf(x[j]) > amax) {
+            amax = fabsf(x[j]);
+            max = x[j];
+        }
+    }
+    float d = max / -8.0f;
+    float id = d != 0.0f ? 1.0f / d : 0.0f;
+    uint16_t dh = fp32_to_fp16(d);
+    memcpy(dst, &dh, 2);
+    uint8_t *qs = dst + 2;
+    for (int j = 0; j < QK / 2; j++) {
+        int lo = (int)(x[j] * id + 8.5f);
+        int hi = (int)(x[j + QK / 2] * id + 8.5f);
+        lo = lo < 0 ? 0 : (lo > 15 ? 15 : lo);
+        hi = hi < 0 ? 0 : (hi > 15 ? 15 : hi);
+        qs[j] = (uint8_t)(lo | (hi << 4));
+    }
+}
+
+static void dequantize_block(int format, const uint8_t *src, float *x) {
+    uint16_t dh;
+    switch (format) {
+    case EMB_Q8_0: {
+        memcpy(&dh, src, 2);
+        float d = fp16_to_fp32(dh);
+        const int8_t *qs = (const int8_t *)(src + 2);
+        for (int j = 0; j < QK; j++) x[j] = qs[j] * d;
+        break;
+    }
+    case EMB_Q4_0: {
+        memcpy(&dh, src, 2);
+        float d = fp16_to_fp32(dh);
+        const uint8_t *qs = src + 2;
+        for (int j = 0; j < QK / 2; j++) {
+            x[j] = ((qs[j] & 0x0f) - 8) * d;
+            x[j + QK / 2] = ((qs[j] >> 4) - 8) * d;
+        }
+        break;
+    }
+    default:
+        memcpy(x, src, F32_BYTES);
+        break;
+    }
+}
+
+/* Encode a row: [format] for stored rows, or the query format */
+static void encode_row(int format, const double *src, int dim, uint8_t *dst) {
+    int blocks = (dim + QK - 1) / QK;
+    size_t bytes = block_bytes(format);
+    float x[QK];
+    for (int b = 0; b < blocks; b++) {
+        load_block(src, dim, b * QK, x);
+        switch (format) {
+        case EMB_Q8_0: quantize_q8_0(x, dst + b * bytes); break;
+        case EMB_Q4_0: quantize_q4_0(x, dst + b * bytes); break;
+        default: memcpy(dst + b * bytes, x, F32_BYTES); break;
+        }
+    }
+}
+
+/* Row in [format] against a query in Q8_0, or in F32 for F32 rows */
+static double dot_row(int format, const uint8_t *row, const uint8_t *query, int blocks) {
+    double sum = 0.0;
+    uint16_t dh;
+    for (int b = 0; b < blocks; b++) {
+        switch (format) {
+        case EMB_Q8_0: {
+            const uint8_t *r = row + b * Q8_0_BYTES;
+            const uint8_t *q = query + b * Q8_0_BYTES;
+            const int8_t *rq = (const int8_t *)(r + 2);
+            const int8_t *qq = (const int8_t *)(q + 2);
+            int32_t acc = 0;
+            for (int j = 0; j < QK; j++) acc += rq[j] * qq[j];
+            memcpy(&dh, r, 2);
+            float dr = fp16_to_fp32(dh);
+            memcpy(&dh, q, 2);
+            sum += (double)dr * fp16_to_fp32(dh) * acc;
+            break;
+        }
+        case EMB_Q4_0: {
+            const uint8_t *r = row + b * Q4_0_BYTES;
+            const uint8_t *q = query + b * Q8_0_BYTES;
+            const uint8_t *rq = r + 2;
+            const int8_t *qq = (const int8_t *)(q + 2);
+            int32_t acc = 0;
+            for (int j = 0; j < QK / 2; j++) {
+                acc += ((rq[j] & 0x0f) - 8) * qq[j] + ((rq[j] >> 4) - 8) * qq[j + QK / 2];
+            }
+            memcpy(&dh, r, 2);
+            float dr = fp16_to_fp32(dh);
+            memcpy(&dh, q, 2);
+            sum += (double)dr * fp16_to_fp32(dh) * acc;
+            break;
+        }
+        default: {
+            float r[QK], q[QK];
+            memcpy(r, row + b * F32_BYTES, F32_BYTES);
+            memcpy(q, query + b * F32_BYTES, F32_BYTES);
+            float acc = 0.0f;
+            for (int j = 0; j < QK; j++) acc += r[j] * q[j];
+            sum += acc;
+            break;
+        }
+        }
+    }
+    return sum;
+}
+
+#define Emb_bytes(v, off) ((uint8_t *)Caml_ba_data_val(v) + Long_val(off))
+
+/* Encode Float.Array.t src (dim values) into buf at byte offset off */
+CAMLprim value caml_embedding_encode(value format, value src, value buf, value off) {
+    encode_row(Int_val(format), (const double *)src, (int)(Wosize_val(src) / Double_wosize),
+               Emb_bytes(buf, off));
+    return Val_unit;
+}
+
+/* Decode the row at off into Float.Array.t dst (its length is the dim) */
+CAMLprim value caml_embedding_decode(value format, value buf, value off, value dst) {
+    int fmt = Int_val(format);
+    int dim = (int)(Wosize_val(dst) / Double_wosize);
+    const uint8_t *row = Emb_bytes(buf, off);
+    double *out = (double *)dst;
+    size_t bytes = block_bytes(fmt);
+    float x[QK];
+    for (int base = 0; base < dim; base += QK) {
+        dequantize_block(fmt, row + (base / QK) * bytes, x);
+        for (int j = 0; j < QK && base + j < dim; j++) {
+            out[base + j] = x[j];
+        }
+    }
+    return Val_unit;
+}
+
+CAMLprim value caml_embedding_dot(value format, value table, value row_off, value query,
+                                  value query_off, value blocks) {
+    return caml_copy_double(dot_row(Int_val(format), Emb_bytes(table, row_off),
+                                    Emb_bytes(query, query_off), Int_val(blocks)));
+}
+
+CAMLprim value caml_embedding_dot_bytecode(value *argv, int argn) {
+    (void)argn;
+    return caml_embedding_dot(argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
@@ -0,0 +1,89 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Dense Kernels for the OCaml Tensor Backend *)
+
+type simd =
+  | Scalar
+  | AVX2
+  | NEON
+
+(* Order matches simd_level in tensor_kernels.c *)
+let simd_of_int = function
+  | 1 -> AVX2
+  | 2 -> NEON
+  | _ -> Scalar
+
+let int_of_simd = function
+  | Scalar -> 0
+  | AVX2 -> 1
+  | NEON -> 2
+
+let simd_to_string = function
+  | Scalar -> "scalar"
+  | AVX2 -> "avx2"
+  | NEON -> "neon"
+
+external simd_level_stub : unit -> int = "caml_tensor_kernels_simd_level"
+external force_level_stub : int -> int = "caml_tensor_kernels_force_level"
+
+(* No kernel allocates or raises, so all are [@@noalloc];
+   bounds are checked here before the call *)
+external gemm_stub : int -> int -> int -> Float.Array.t -> Float.Array.t -> Float.Array.t -> unit
+  = "caml_tensor_kernels_gemm_bytecode" "caml_tensor_kernels_gemm" [@@noalloc]
+external gemv_stub : int -> int -> Float.Array.t -> Float.Array.t -> Float.Array.t -> unit
+  = "caml_tensor_kernels_gemv" [@@noalloc]
+external transpose_stub : int -> int -> Float.Array.t -> Float.Array.t -> unit
+  = "caml_tensor_kernels_transpose" [@@noalloc]
+external decay_rent_stub :
+  int -> Float.Array.t -> Float.Array.t -> (float [@unboxed]) -> (float [@unboxed]) ->
+  (float [@unboxed])
+  = "caml_tensor_kernels_decay_rent_bytecode" "caml_tensor_kernels_decay_rent" [@@noalloc]
+
+let simd_level () = simd_of_int (simd_level_stub ())
+
+let force_level level = simd_of_int (force_level_stub (int_of_simd level))
+
+let matmul m k n a b =
+  if m < 0 || k < 0 || n < 0 || Float.Array.length a <> m * k || Float.Array.length b <> k * n then
+    failwith "Invalid shapes for matrix multiplication";
+  let c = Float.Array.make (m * n) 0.0 in
+  if m > 0 && n > 0 && k > 0 then gemm_stub m n k a b c;
+  c
+
+let gemv m k a x =
+  if m < 0 || k < 0 || Float.Array.length a <> m * k || Float.Array.length x <> k then
+    failwith "Invalid shapes for matrix-vector product";
+  let y = Float.Array.make m 0.0 in
+  if m > 0 && k > 0 then gemv_stub m k a x y;
+  y
+
+let transpose rows cols data =
+  if rows < 0 || cols < 0 || Float.Array.length data <> rows * cols then
+    failwith "Transpose size does not match shape";
+  let result = Float.Array.make (rows * cols) 0.0 in
+  if rows > 0 && cols > 0 then transpose_stub rows cols data result;
+  result
+
+let decay_rent n sti lti decay rate =
+  if n < 0 || n > Float.Array.length sti || n > Float.Array.length lti then
+    failwith "Attention pass exceeds the columns";
+  if n = 0 then 0.0 else decay_rent_stub n sti lti decay rate
+
+let naive_matmul m k n a b =
+  let result = Float.Array.make (m * n) 0.0 in
+  for i = 0 to m - 1 do
+    for j = 0 to n - 1 do
+      let sum = ref 0.0 in
+      for l = 0 to k - 1 do
+        sum := !sum +. Float.Array.get a (i * k + l) *. Float.Array.get b (l * n + j)
+      done;
+      Float.Array.set result (i * n + j) !sum
+    done
+  done;
+  result
@@ -0,0 +1,54 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Dense Kernels for the OCaml Tensor Backend
+
+    Row-major kernels over flat float arrays ([Float.Array.t], unboxed
+    whatever the float array layout), implemented in C: a cache-blocked
+    GEMM with packed panels and a register-tiled micro-kernel, a
+    matrix-vector product, a tiled transpose, and the fused ECAN
+    decay/rent pass over attention columns. *)
+
+(** {1 SIMD Dispatch} *)
+
+(** Micro-kernel instruction set *)
+type simd =
+  | Scalar
+  | AVX2    (** x86-64 with AVX2 and FMA *)
+  | NEON    (** AArch64 *)
+
+(** Kernel in use; the best one this CPU supports unless forced *)
+val simd_level : unit -> simd
+
+(** Use the given kernel if supported (the best supported one
+    otherwise); returns the kernel now in use. Intended for tests and
+    benchmarks. *)
+val force_level : simd -> simd
+
+val simd_to_string : simd -> string
+
+(** {1 Kernels} *)
+
+(** [matmul m k n a b] is the [m x n] product of [a] ([m x k]) and
+    [b] ([k x n]) *)
+val matmul : int -> int -> int -> Float.Array.t -> Float.Array.t -> Float.Array.t
+
+(** [gemv m k a x] is the product of [a] ([m x k]) and the vector [x] *)
+val gemv : int -> int -> Float.Array.t -> Float.Array.t -> Float.Array.t
+
+(** [transpose rows cols data] is the [cols x rows] transpose *)
+val transpose : int -> int -> Float.Array.t -> Float.Array.t
+
+(** [decay_rent n sti lti decay rate] scales the first [n] entries of
+    both columns by [decay], then charges [rate] of each STI as rent,
+    clamping at zero; returns the total rent. LTI is left untouched when
+    [decay] is 1.0. *)
+val decay_rent : int -> Float.Array.t -> Float.Array.t -> float -> float -> float
+
+(** Reference triple loop, kept for benchmarks and tests *)
+val naive_matmul : int -> int -> int -> Float.Array.t -> Float.Array.t -> Float.Array.t
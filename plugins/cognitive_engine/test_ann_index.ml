@@ -0,0 +1,170 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Test Suite for the Approximate Nearest-Neighbour Index *)
+
+(** Test utilities *)
+let test_count = ref 0
+let pass_count = ref 0
+let fail_count = ref 0
+
+let assert_true condition name =
+  incr test_count;
+  if condition then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s\n" name
+  end
+
+let section name =
+  Printf.printf "\n=== %s ===\n" name
+
+let random_vector dim = Array.init dim (fun _ -> Random.float 2.0 -. 1.0)
+
+let cosine a b =
+  let dot = ref 0.0 and na = ref 0.0 and nb = ref 0.0 in
+  Array.iteri (fun i x ->
+    dot := !dot +. x *. b.(i);
+    na := !na +. x *. x;
+    nb := !nb +. b.(i) *. b.(i)) a;
+  !dot /. sqrt (!na *. !nb)
+
+let rec take n = function
+  | x :: rest when n > 0 -> x :: take (n - 1) rest
+  | _ -> []
+
+(* Exact top-k keys, indexed by position *)
+let brute_force vectors q k =
+  Array.to_list (Array.mapi (fun key v -> (key, cosine q v)) vectors)
+  |> List.sort (fun (_, a) (_, b) -> compare b a)
+  |> take k
+
+let recall expected actual =
+  let hits = List.length (List.filter (fun (key, _) -> List.mem_assoc key actual) expected) in
+  float_of_int hits /. float_of_int (max 1 (List.length expected))
+
+let time f =
+  let start = Unix.gettimeofday () in
+  let r = f () in
+  (r, Unix.gettimeofday () -. start)
+
+(** Test cases *)
+
+let test_basics () =
+  section "Index Basics";
+  let index = Ann_index.create 4 in
+  assert_true (Ann_index.search index [| 1.0; 0.0; 0.0; 0.0 |] 3 = []) "Empty index finds nothing";
+  Ann_index.add index 10 [| 1.0; 0.0; 0.0; 0.0 |];
+  Ann_index.add index 11 [| 0.9; 0.1; 0.0; 0.0 |];
+  Ann_index.add index 12 [| 0.0; 0.0; 1.0; 0.0 |];
+  Ann_index.add index 13 [| 0.0; 0.0; 0.0; 0.0 |];
+  assert_true (Ann_index.length index = 3 && not (Ann_index.mem index 13)) "Zero vectors are not indexed";
+  (match Ann_index.search index [| 2.0; 0.0; 0.0; 0.0 |] 2 with
+   | [(10, s); (11, _)] -> assert_true (abs_float (s -. 1.0) < 1e-9) "Search ranks by cosine"
+   | _ -> assert_true false "Search ranks by cosine");
+  assert_true (List.map fst (Ann_index.neighbours index 10 5) = [11; 12]) "Neighbours exclude the key";
+  assert_true (List.map fst (Ann_index.search_radius index [| 1.0; 0.0; 0.0; 0.0 |] 0.9) = [10; 11])
+    "Radius query keeps keys above the threshold";
+  Ann_index.add index 10 [| 0.0; 0.0; 1.0; 0.1 |];
+  assert_true (List.map fst (Ann_index.neighbours index 10 1) = [12]) "Replacing a key moves it";
+  Ann_index.remove index 12;
+  assert_true (not (List.mem_assoc 12 (Ann_index.search index [| 0.0; 0.0; 1.0; 0.0 |] 3)))
+    "Removed keys are not returned";
+  assert_true (try Ann_index.add index 1 [| 1.0 |]; false with Failure _ -> true)
+    "Dimension mismatch is rejected"
+
+let test_recall () =
+  section "Recall Against Brute Force";
+  Random.init 7;
+  let dim = 32 and n = 2000 and queries = 100 and k = 10 in
+  let vectors = Array.init n (fun _ -> random_vector dim) in
+  let probes = Array.init queries (fun _ -> random_vector dim) in
+  let index = Ann_index.create dim in
+  let ((), t_build) = time (fun () -> Array.iteri (Ann_index.add index) vectors) in
+  let (expected, t_exact) = time (fun () -> Array.map (fun q -> brute_force vectors q k) probes) in
+  let (actual, t_index) = time (fun () -> Array.map (fun q -> Ann_index.search index q k) probes) in
+  let total = ref 0.0 in
+  Array.iteri (fun i e -> total := !total +. recall e actual.(i)) expected;
+  let mean_recall = !total /. float_of_int queries in
+  Printf.printf "  ℹ️  %d x %d-d: build %.3fs, %d queries brute force %.3fs, HNSW %.3fs, recall@%d %.3f\n"
+    n dim t_build queries t_exact t_index k mean_recall;
+  assert_true (mean_recall >= 0.9) "Top-10 recall is at least 0.9";
+  assert_true (Array.for_all (fun r -> List.length r = k) actual) "Every query returns k keys";
+
+  (* Radius queries against the exact neighbourhood *)
+  let threshold = 0.5 in
+  let radius_total = ref 0.0 and radius_ok = ref true in
+  Array.iter (fun q ->
+    let exact = List.filter (fun (_, s) -> s >= threshold) (brute_force vectors q n) in
+    let found = Ann_index.search_radius index q threshold in
+    if List.exists (fun (_, s) -> s < threshold) found then radius_ok := false;
+    radius_total := !radius_total +. (if exact = [] then 1.0 else recall exact found)
+  ) (Array.sub probes 0 20);
+  assert_true !radius_ok "Radius results respect the threshold";
+  assert_true (!radius_total /. 20.0 >= 0.9) "Radius recall is at least 0.9";
+
+  (* Removing most keys rebuilds the graph without losing the rest *)
+  for key = 0 to n - 1 do
+    if key mod 4 <> 0 then Ann_index.remove index key
+  done;
+  let kept = Array.init (n / 4) (fun i -> vectors.(4 * i)) in
+  let total = ref 0.0 and leaked = ref false in
+  Array.iter (fun q ->
+    let expected = List.map (fun (i, s) -> (4 * i, s)) (brute_force kept q k) in
+    let found = Ann_index.search index q k in
+    if List.exists (fun (key, _) -> key mod 4 <> 0) found then leaked := true;
+    total := !total +. recall expected found
+  ) probes;
+  assert_true (Ann_index.length index = n / 4) "Removed keys leave the index";
+  assert_true (not !leaked) "Removed keys are never returned";
+  assert_true (!total /. float_of_int queries >= 0.9) "Recall holds after mass removal"
+
+let test_knn_graph () =
+  section "k-NN Graph";
+  Random.init 11;
+  let dim = 16 in
+  (* Two well separated clusters *)
+  let centre sign = Array.init dim (fun i -> if i mod 2 = 0 then sign else 0.0) in
+  let index = Ann_index.create ~m:8 dim in
+  for key = 0 to 199 do
+    let c = centre (if key < 100 then 1.0 else -1.0) in
+    Ann_index.add index key (Array.map (fun x -> x +. 0.1 *. (Random.float 2.0 -. 1.0)) c)
+  done;
+  let graph = Ann_index.knn_graph index 5 in
+  assert_true (List.length graph = 200) "Graph has a row per key";
+  assert_true (List.for_all (fun (key, row) ->
+    List.length row = 5 && not (List.mem_assoc key row)) graph) "Rows hold k other keys";
+  assert_true (List.for_all (fun (key, row) ->
+    List.for_all (fun (other, _) -> (key < 100) = (other < 100)) row) graph)
+    "Neighbours stay within their cluster"
+
+let () =
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║     ANN Index - Test Suite                               ║\n";
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  test_basics ();
+  test_recall ();
+  test_knn_graph ();
+
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║                    Test Summary                          ║\n";
+  Printf.printf "╠══════════════════════════════════════════════════════════╣\n";
+  Printf.printf "║  Total:  %3d                                             ║\n" !test_count;
+  Printf.printf "║  Passed: %3d                                             ║\n" !pass_count;
+  Printf.printf "║  Failed: %3d                                             ║\n" !fail_count;
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  if !fail_count = 0 then
+    Printf.printf "\n🔎 All ANN index tests passed! 🔎\n\n"
+  else
+    Printf.printf "\n⚠️  Some tests failed. Please review. ⚠️\n\n"
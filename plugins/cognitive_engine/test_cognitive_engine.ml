@@ -87,6 +87,24 @@ let test_attention_system () =
   Printf.printf "  Attention stats: STI=%.1f, LTI=%.1f, nodes=%d, focused=%d ✓\n" 
                 sti lti nodes focused;
   
+  (* Forgetting a focused node takes it out of the focus *)
+  let atomspace = Hypergraph.create_atomspace () in
+  let ecan = Attention_system.create_ecan_system atomspace config in
+  let faint = Hypergraph.add_node atomspace Hypergraph.Concept "faint" in
+  let other = Hypergraph.add_node atomspace Hypergraph.Concept "other" in
+  ignore (Hypergraph.add_link atomspace Hypergraph.Inheritance [faint; other]);
+  (* Ranked first, yet below the forgetting threshold *)
+  Hypergraph.update_node_attention atomspace faint { Hypergraph.sti = 0.5; lti = 0.0; vlti = 0.0 };
+  Attention_system.update_attentional_focus ecan;
+  if Attention_system.is_in_focus ecan faint then begin
+    Attention_system.forget_low_attention_atoms ecan;
+    if not (Attention_system.is_in_focus ecan faint)
+       && not (List.exists (fun (n, _) -> n = faint) (Attention_system.get_focused_atoms ecan))
+    then Printf.printf "  Forgotten node left the attentional focus ✓\n"
+    else Printf.printf "  Forgotten node is still in focus ✗\n"
+  end else
+    Printf.printf "  Low-attention node did not enter the focus ✗\n";
+  
   Printf.printf "Attention System tests completed.\n\n"
 
 let test_reasoning_engine () =
@@ -118,6 +136,145 @@ let test_reasoning_engine () =
    | Some result -> Printf.printf "  Applied deduction rule successfully ✓\n"
    | None -> Printf.printf "  Deduction rule application failed ✗\n");
   
+  (* The result carries the truth value computed for the conclusion *)
+  let atomspace = Hypergraph.create_atomspace () in
+  let engine = Reasoning_engine.create_reasoning_engine atomspace in
+  let x = Hypergraph.add_node atomspace Hypergraph.Concept "X" in
+  let y = Hypergraph.add_node atomspace Hypergraph.Concept "Y" in
+  let z = Hypergraph.add_node atomspace Hypergraph.Concept "Z" in
+  let xy = Hypergraph.add_link atomspace Hypergraph.Implication [x; y] in
+  let yz = Hypergraph.add_link atomspace Hypergraph.Implication [y; z] in
+  Hypergraph.update_link_truth atomspace xy (0.9, 0.8);
+  Hypergraph.update_link_truth atomspace yz (0.6, 0.5);
+  (match Reasoning_engine.apply_pln_rule engine Reasoning_engine.Deduction_rule
+           { context with Reasoning_engine.premises = [xy; yz] } with
+   | Some result ->
+       (match Hypergraph.get_link atomspace result.Reasoning_engine.conclusion_link with
+        | Some link when link.Hypergraph.truth_value = result.Reasoning_engine.truth_value ->
+            Printf.printf "  Deduction result reports the computed truth value ✓\n"
+        | _ -> Printf.printf "  Deduction result truth value differs from its link ✗\n")
+   | None -> Printf.printf "  Two-premise deduction failed ✗\n");
+  
+  (* Test parallel semi-naive forward chaining on a fresh chain A -> B -> C -> D *)
+  let atomspace = Hypergraph.create_atomspace () in
+  let engine = Reasoning_engine.create_reasoning_engine atomspace in
+  let nodes = List.map (Hypergraph.add_node atomspace Hypergraph.Concept) ["A"; "B"; "C"; "D"] in
+  let rec chain = function
+    | a :: (b :: _ as rest) ->
+        ignore (Hypergraph.add_link atomspace Hypergraph.Implication [a; b]);
+        chain rest
+    | _ -> ()
+  in
+  chain nodes;
+  let results = Reasoning_engine.parallel_forward_chaining ~workers:2 engine 5 in
+  let implications = Hypergraph.find_links_by_type atomspace Hypergraph.Implication in
+  if List.length implications = 6 then
+    Printf.printf "  Parallel forward chaining closed the chain (%d results) ✓\n" (List.length results)
+  else
+    Printf.printf "  Parallel forward chaining left %d implications ✗\n" (List.length implications);
+  let all_implications atomspace =
+    Hashtbl.fold (fun _ (link : Hypergraph.link) ok ->
+      ok && link.Hypergraph.link_type = Hypergraph.Implication
+    ) atomspace.Hypergraph.links true
+  in
+  if all_implications atomspace then
+    Printf.printf "  Parallel forward chaining added only implications ✓\n"
+  else
+    Printf.printf "  Parallel forward chaining added placeholder links ✗\n";
+  let again = Reasoning_engine.parallel_forward_chaining ~workers:2 engine 5 in
+  if List.for_all (fun r -> r.Reasoning_engine.applied_rule <> Reasoning_engine.Deduction_rule) again then
+    Printf.printf "  Re-running derives no duplicate deductions ✓\n"
+  else
+    Printf.printf "  Re-running derived duplicate deductions ✗\n";
+  
+  (* Test the delta-driven agenda on the same kind of chain *)
+  let atomspace = Hypergraph.create_atomspace () in
+  let engine = Reasoning_engine.create_reasoning_engine atomspace in
+  let nodes = List.map (Hypergraph.add_node atomspace Hypergraph.Concept) ["A"; "B"; "C"; "D"; "E"] in
+  let a = List.nth nodes 0 and b = List.nth nodes 1 and d = List.nth nodes 3 and e = List.nth nodes 4 in
+  let c = List.nth nodes 2 in
+  List.iter (fun (x, y) -> ignore (Hypergraph.add_link atomspace Hypergraph.Implication [x; y]))
+    [(a, b); (b, c); (c, d)];
+  let agenda = Reasoning_engine.create_inference_agenda engine in
+  let _ = Reasoning_engine.run_agenda agenda 10 in
+  if Reasoning_engine.agenda_pending_count agenda = 0 then
+    Printf.printf "  Agenda reached a fixpoint ✓\n"
+  else
+    Printf.printf "  Agenda still has pending changes ✗\n";
+  let _ = Hypergraph.add_link atomspace Hypergraph.Implication [d; e] in
+  if Reasoning_engine.agenda_pending_count agenda = 1 then
+    Printf.printf "  Adding a link queues exactly one change ✓\n"
+  else
+    Printf.printf "  Adding a link queued %d changes ✗\n" (Reasoning_engine.agenda_pending_count agenda);
+  let new_results = Reasoning_engine.run_agenda agenda 10 in
+  if all_implications atomspace then
+    Printf.printf "  Agenda added only implications ✓\n"
+  else
+    Printf.printf "  Agenda added placeholder links ✗\n";
+  let conclusions results =
+    List.sort_uniq compare (List.filter_map (fun r ->
+      match Hypergraph.get_link atomspace r.Reasoning_engine.conclusion_link with
+      | Some link -> Some link.Hypergraph.outgoing
+      | None -> None) results)
+  in
+  let derived = conclusions new_results in
+  if derived = List.sort compare [[a; e]; [b; e]; [c; e]] then
+    Printf.printf "  Agenda derived A -> E, B -> E and C -> E from the new link ✓\n"
+  else
+    Printf.printf "  Agenda derived %d conclusions from the new link, expected 3 ✗\n" (List.length derived);
+  (match Hypergraph.find_links_by_type atomspace Hypergraph.Implication
+         |> List.filter (fun id ->
+              match Hypergraph.get_link atomspace id with
+              | Some link -> link.Hypergraph.outgoing = [a; b]
+              | None -> false) with
+   | [ab] ->
+       Hypergraph.update_link_truth atomspace ab (0.5, 0.9);
+       let updated = conclusions (Reasoning_engine.run_agenda agenda 10) in
+       if List.mem [a; c] updated && List.mem [a; d] updated
+          && List.for_all (fun outgoing -> List.hd outgoing = a) updated then
+         Printf.printf "  Truth update propagated to A -> C and A -> D ✓\n"
+       else
+         Printf.printf "  Truth update reached %d derived links, not A -> C and A -> D ✗\n"
+           (List.length updated)
+   | _ -> Printf.printf "  A -> B not found ✗\n");
+  
+  (* Two premise sets for X -> Z: the conclusion holds their revision *)
+  let atomspace = Hypergraph.create_atomspace () in
+  let engine = Reasoning_engine.create_reasoning_engine atomspace in
+  let x = Hypergraph.add_node atomspace Hypergraph.Concept "X" in
+  let y1 = Hypergraph.add_node atomspace Hypergraph.Concept "Y1" in
+  let y2 = Hypergraph.add_node atomspace Hypergraph.Concept "Y2" in
+  let z = Hypergraph.add_node atomspace Hypergraph.Concept "Z" in
+  let implication src dst (s, c) =
+    let id = Hypergraph.add_link atomspace Hypergraph.Implication [src; dst] in
+    Hypergraph.update_link_truth atomspace id (s, c);
+    Pln_formulas.make_tv s c
+  in
+  let xy1 = implication x y1 (0.9, 0.8) and y1z = implication y1 z (0.8, 0.7) in
+  let xy2 = implication x y2 (0.3, 0.6) and y2z = implication y2 z (0.4, 0.5) in
+  let expected = Pln_formulas.revision
+      (Pln_formulas.deduction_simple xy1 y1z) (Pln_formulas.deduction_simple xy2 y2z) in
+  let agenda = Reasoning_engine.create_inference_agenda engine in
+  let _ = Reasoning_engine.run_agenda agenda 10 in
+  (match List.filter_map (fun id -> Hypergraph.get_link atomspace id)
+           (Hypergraph.find_links_by_type atomspace Hypergraph.Implication)
+         |> List.filter (fun link -> link.Hypergraph.outgoing = [x; z]) with
+   | [xz] ->
+       let (s, c) = xz.Hypergraph.truth_value in
+       if abs_float (s -. expected.Pln_formulas.strength) < 1e-6
+          && abs_float (c -. expected.Pln_formulas.confidence) < 1e-6 then
+         Printf.printf "  Agenda revised X -> Z over both premise sets ✓\n"
+       else
+         Printf.printf "  Agenda kept X -> Z at (%.3f, %.3f) instead of (%.3f, %.3f) ✗\n"
+           s c expected.Pln_formulas.strength expected.Pln_formulas.confidence
+   | links -> Printf.printf "  Agenda derived %d X -> Z links ✗\n" (List.length links));
+  Reasoning_engine.release_inference_agenda agenda;
+  let _ = Hypergraph.add_link atomspace Hypergraph.Implication [z; x] in
+  if Reasoning_engine.agenda_pending_count agenda = 0 then
+    Printf.printf "  Released agenda ignores new links ✓\n"
+  else
+    Printf.printf "  Released agenda still queues new links ✗\n";
+  
   Printf.printf "Reasoning Engine tests completed.\n\n"
 
 let test_metacognition () =
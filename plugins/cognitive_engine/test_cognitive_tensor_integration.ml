@@ -66,7 +66,7 @@ let test_cognitive_tensor_integration () =
     match Hypergraph.get_tensor engine.atomspace result_id with
     | Some tensor ->
         Printf.printf "    - Attention tensor %d: %s\n" (i+1) 
-          (Tensor_backend.tensor_to_string tensor.shape tensor.data)
+          (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of tensor) (Hypergraph.tensor_values tensor))
     | None -> Printf.printf "    - Failed to retrieve attention tensor %d\n" (i+1)
   ) attention_results;
   
@@ -98,7 +98,7 @@ let test_cognitive_tensor_integration () =
   (match Hypergraph.get_tensor engine.atomspace matmul_id with
    | Some tensor ->
        Printf.printf "  ✓ Matrix multiplication result: %s\n" 
-         (Tensor_backend.tensor_to_string tensor.shape tensor.data)
+         (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of tensor) (Hypergraph.tensor_values tensor))
    | None -> Printf.printf "  ✗ Matrix multiplication failed\n");
   
   (* Neural activation *)
@@ -106,7 +106,7 @@ let test_cognitive_tensor_integration () =
   (match Hypergraph.get_tensor engine.atomspace relu_id with
    | Some tensor ->
        Printf.printf "  ✓ ReLU activation result: %s\n" 
-         (Tensor_backend.tensor_to_string tensor.shape tensor.data)
+         (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of tensor) (Hypergraph.tensor_values tensor))
    | None -> Printf.printf "  ✗ ReLU activation failed\n");
   
   (* Test 8: Knowledge retrieval with neural representations *)
@@ -117,7 +117,7 @@ let test_cognitive_tensor_integration () =
   
   List.iter (fun tensor ->
     Printf.printf "    - Tensor ID %d: %s\n" tensor.id 
-      (Tensor_backend.tensor_to_string tensor.shape tensor.data)
+      (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of tensor) (Hypergraph.tensor_values tensor))
   ) neural_reps;
   
   Printf.printf "\n🎉 Cognitive-Tensor Integration Test Completed! 🎉\n";
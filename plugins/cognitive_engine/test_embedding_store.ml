@@ -0,0 +1,163 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Test Suite for the Quantized Embedding Store *)
+
+open Embedding_store
+
+(** Test utilities *)
+let test_count = ref 0
+let pass_count = ref 0
+let fail_count = ref 0
+
+let assert_true condition name =
+  incr test_count;
+  if condition then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s\n" name
+  end
+
+let section name =
+  Printf.printf "\n=== %s ===\n" name
+
+let random_vector dim = Array.init dim (fun _ -> Random.float 2.0 -. 1.0)
+
+let exact_dot a b =
+  let sum = ref 0.0 in
+  Array.iteri (fun i x -> sum := !sum +. x *. b.(i)) a;
+  !sum
+
+let exact_cosine a b = exact_dot a b /. sqrt (exact_dot a a *. exact_dot b b)
+
+let max_error a b =
+  let worst = ref 0.0 in
+  Array.iteri (fun i x -> worst := max !worst (abs_float (x -. b.(i)))) a;
+  !worst
+
+(** Test cases *)
+
+let test_layout () =
+  section "Block Layout";
+  assert_true (row_bytes F32 128 = 512) "F32 row is 4 bytes per value";
+  assert_true (row_bytes Q8_0 128 = 4 * 34) "Q8_0 row is 34 bytes per block";
+  assert_true (row_bytes Q4_0 128 = 4 * 18) "Q4_0 row is 18 bytes per block";
+  assert_true (row_bytes Q8_0 100 = row_bytes Q8_0 128) "Rows are padded to whole blocks"
+
+let test_round_trip () =
+  section "Encode and Decode";
+  let data = Array.init 100 (fun i -> float_of_int (i - 50) /. 8.0) in
+  List.iter (fun (format, eps) ->
+    let store = create ~format 100 in
+    set store 7 data;
+    let name = format_to_string format in
+    match get store 7 with
+    | Some decoded ->
+      assert_true (Array.length decoded = 100) (name ^ " keeps the dimension");
+      assert_true (max_error data decoded <= eps)
+        (Printf.sprintf "%s round trip within %g" name eps)
+    | None -> assert_true false (name ^ " stores the row")
+  ) [(F32, 1e-6); (Q8_0, 0.05); (Q4_0, 0.5)];
+  let store = create ~format:Q8_0 32 in
+  set store 1 (Array.make 32 0.0);
+  assert_true (norm store 1 = 0.0) "Zero row has zero norm";
+  assert_true (cosine store 1 1 = 0.0) "Cosine with a zero row is 0"
+
+let test_table_updates () =
+  section "Table Updates";
+  let store = create ~format:Q8_0 ~capacity:2 64 in
+  let vectors = Array.init 10 (fun _ -> random_vector 64) in
+  Array.iteri (fun key v -> set store key v) vectors;
+  assert_true (length store = 10) "Table grows past its capacity";
+  assert_true (memory_bytes store = 10 * (row_bytes Q8_0 64 + 8)) "Memory counts rows and norms";
+  let before = get store 9 in
+  remove store 2;
+  assert_true (length store = 9 && not (mem store 2)) "Remove drops the key";
+  assert_true (get store 9 = before) "Moved row keeps its embedding";
+  assert_true (List.length (keys store) = 9 && not (List.mem 2 (keys store))) "Keys follow removal";
+  set store 3 vectors.(0);
+  assert_true (length store = 9) "Replacing a key reuses its row";
+  assert_true (abs_float (cosine store 3 0 -. 1.0) < 1e-6) "Replaced row matches its new value";
+  assert_true (abs_float (cosine store 5 5 -. 1.0) < 1e-6) "Stored row has cosine 1 with itself";
+  assert_true (cosine store 5 42 = 0.0) "Cosine with a missing key is 0";
+  assert_true (try ignore (set store 1 (Array.make 3 0.0)); false with Failure _ -> true)
+    "Dimension mismatch is rejected"
+
+(* Cosine error and top-k agreement against exact float64 similarity *)
+let test_accuracy () =
+  section "Accuracy Against F32";
+  Random.init 42;
+  let dim = 128 and rows = 1000 and queries = 50 in
+  let table = Array.init rows (fun _ -> random_vector dim) in
+  let probes = Array.init queries (fun _ -> random_vector dim) in
+  let argmax scores =
+    let best = ref 0 in
+    Array.iteri (fun i s -> if s > scores.(!best) then best := i) scores;
+    !best in
+  let exact = Array.map (fun q -> Array.map (exact_cosine q) table) probes in
+  let f32_bytes = rows * (row_bytes F32 dim + 8) in
+  List.iter (fun (format, mean_bound, max_bound, top1_bound) ->
+    let store = create ~format ~capacity:rows dim in
+    Array.iteri (fun key v -> set store key v) table;
+    let total_error = ref 0.0 and worst = ref 0.0 in
+    let top1 = ref 0 and top5 = ref 0 in
+    Array.iteri (fun qi q ->
+      let query = encode_query store q in
+      let scores = Array.init rows (query_cosine store query) in
+      Array.iteri (fun i s ->
+        let err = abs_float (s -. exact.(qi).(i)) in
+        total_error := !total_error +. err;
+        worst := max !worst err
+      ) scores;
+      let expected = argmax exact.(qi) in
+      if argmax scores = expected then incr top1;
+      let rank = Array.fold_left (fun r s -> if s > scores.(expected) then r + 1 else r) 0 scores in
+      if rank < 5 then incr top5
+    ) probes;
+    let name = format_to_string format in
+    let mean_error = !total_error /. float_of_int (rows * queries) in
+    let bytes = memory_bytes store in
+    Printf.printf "  ℹ️  %-4s: %7d bytes (%.2fx F32, %.2fx float array), cosine error mean %.5f max %.5f, top-1 %d/%d, top-5 %d/%d\n"
+      name bytes (float_of_int bytes /. float_of_int f32_bytes)
+      (float_of_int bytes /. float_of_int (rows * dim * 8))
+      mean_error !worst !top1 queries !top5 queries;
+    assert_true (mean_error < mean_bound) (Printf.sprintf "%s mean cosine error below %g" name mean_bound);
+    assert_true (!worst < max_bound) (Printf.sprintf "%s max cosine error below %g" name max_bound);
+    assert_true (float_of_int !top1 >= top1_bound *. float_of_int queries)
+      (Printf.sprintf "%s top-1 agrees on %.0f%% of queries" name (100.0 *. top1_bound));
+    assert_true (!top5 = queries) (name ^ " exact top-1 is in the top 5")
+  ) [(F32, 1e-6, 1e-5, 1.0); (Q8_0, 0.002, 0.01, 0.9); (Q4_0, 0.02, 0.08, 0.7)];
+  assert_true (row_bytes Q8_0 dim * 3 < row_bytes F32 dim) "Q8_0 rows are under a third of F32";
+  assert_true (row_bytes Q4_0 dim * 7 < row_bytes F32 dim) "Q4_0 rows are under a seventh of F32"
+
+let () =
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║     Embedding Store - Test Suite                         ║\n";
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  test_layout ();
+  test_round_trip ();
+  test_table_updates ();
+  test_accuracy ();
+
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║                    Test Summary                          ║\n";
+  Printf.printf "╠══════════════════════════════════════════════════════════╣\n";
+  Printf.printf "║  Total:  %3d                                             ║\n" !test_count;
+  Printf.printf "║  Passed: %3d                                             ║\n" !pass_count;
+  Printf.printf "║  Failed: %3d                                             ║\n" !fail_count;
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  if !fail_count = 0 then
+    Printf.printf "\n🧮 All embedding store tests passed! 🧮\n\n"
+  else
+    Printf.printf "\n⚠️  Some tests failed. Please review. ⚠️\n\n"
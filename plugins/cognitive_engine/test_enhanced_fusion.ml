@@ -4,6 +4,7 @@
 #directory "/home/runner/work/opencoq/opencoq/plugins/cognitive_engine";;
 #load "tensor_backend.cmo";;
 #load "hypergraph.cmo";;
+#load "embedding_store.cmo";;
 #load "neural_symbolic_fusion.cmo";;
 
 let test_enhanced_neural_symbolic_architecture () =
@@ -119,6 +120,46 @@ let test_enhanced_neural_symbolic_architecture () =
   Printf.printf "  ✓ Fusion context serialized to Scheme (length: %d chars)\n" 
     (String.length scheme_repr);
   
+  (* Test 13: Quantized embeddings *)
+  Printf.printf "\nTest 13: Quantized store as the only copy of bound embeddings\n";
+  let tensor_count () = Hashtbl.length atomspace.Hypergraph.tensors in
+  let before = tensor_count () in
+  let exact = Neural_symbolic_fusion.enhanced_concept_similarity fusion_ctx ml_concept_id dl_concept_id in
+  Neural_symbolic_fusion.use_quantized_embeddings fusion_ctx Embedding_store.Q8_0;
+  let released = Hashtbl.length fusion_ctx.Neural_symbolic_fusion.released in
+  if released > 0 && tensor_count () = before - released
+     && Hypergraph.tensor_count atomspace = before then
+    Printf.printf "  ✓ Released %d float tensors to the store, their ids kept\n" released
+  else
+    Printf.printf "  ❌ Float tensors kept beside the store (%d released, %d -> %d)\n"
+      released before (tensor_count ());
+  let quantized = Neural_symbolic_fusion.enhanced_concept_similarity fusion_ctx ml_concept_id dl_concept_id in
+  if abs_float (quantized -. exact) < 0.02 then
+    Printf.printf "  ✓ Quantized similarity %.4f matches %.4f\n" quantized exact
+  else
+    Printf.printf "  ❌ Quantized similarity %.4f drifted from %.4f\n" quantized exact;
+  (match dl_neural_opt with
+   | Some dl_neural ->
+       let gradients = Neural_symbolic_fusion.compute_symbolic_gradients fusion_ctx ml_concept_id dl_neural in
+       Neural_symbolic_fusion.update_symbolic_knowledge fusion_ctx ml_concept_id gradients;
+       let stored = match fusion_ctx.Neural_symbolic_fusion.embedding_store with
+         | Some store -> Embedding_store.get store ml_concept_id
+         | None -> None in
+       (match stored, Neural_symbolic_fusion.symbol_to_neural fusion_ctx ml_concept_id
+                         Neural_symbolic_fusion.Embedding_Based with
+        | Some values, Some neural_id
+          when Hashtbl.mem fusion_ctx.Neural_symbolic_fusion.released neural_id
+               && Array.length gradients = Array.length values ->
+            Printf.printf "  ✓ Learning updates the stored embedding in place of a float copy\n"
+        | _ -> Printf.printf "  ❌ Learning left the store stale\n")
+   | None -> Printf.printf "  ⚠ Skipped quantized learning (neural representations unavailable)\n");
+  Neural_symbolic_fusion.use_float_embeddings fusion_ctx;
+  if fusion_ctx.Neural_symbolic_fusion.embedding_store = None
+     && Hashtbl.length fusion_ctx.Neural_symbolic_fusion.released = 0 then
+    Printf.printf "  ✓ Float tensors restored\n"
+  else
+    Printf.printf "  ❌ Store still holds embeddings\n";
+  
   Printf.printf "\n✅ Enhanced Neural-Symbolic Fusion Architecture Test Complete!\n";
   Printf.printf "\n🎯 Summary: All major fusion capabilities tested and working!\n"
 
@@ -0,0 +1,620 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Test Suite for the Hypergraph AtomSpace *)
+
+open Hypergraph
+
+(** Test utilities *)
+let test_count = ref 0
+let pass_count = ref 0
+let fail_count = ref 0
+
+let assert_true condition name =
+  incr test_count;
+  if condition then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s\n" name
+  end
+
+let assert_eq expected actual name =
+  incr test_count;
+  if expected = actual then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s: expected %d, got %d\n" name expected actual
+  end
+
+let assert_float_eq ?(eps=0.001) expected actual name =
+  incr test_count;
+  if abs_float (expected -. actual) < eps then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s: %.4f ≈ %.4f\n" name expected actual
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s: expected %.4f, got %.4f\n" name expected actual
+  end
+
+let section name =
+  Printf.printf "\n=== %s ===\n" name
+
+let sorted ids = List.sort compare ids
+
+let rec take n = function
+  | x :: rest when n > 0 -> x :: take (n - 1) rest
+  | _ -> []
+
+(** Test cases *)
+
+let test_incoming_outgoing_index () =
+  section "Incoming/Outgoing Index";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  let b = add_node atomspace Concept "b" in
+  let c = add_node atomspace Concept "c" in
+  let l1 = add_link atomspace Inheritance [a; b] in
+  let l2 = add_link atomspace Implication [b; c] in
+  let l3 = add_link atomspace Similarity [a; c; a] in
+
+  assert_true (sorted (get_incoming_links atomspace a) = sorted [l1; l3])
+    "incoming of a = {l1, l3}";
+  assert_true (sorted (get_incoming_links atomspace b) = sorted [l1; l2])
+    "incoming of b = {l1, l2}";
+  assert_true (sorted (get_outgoing_links atomspace a) = sorted [l1; l3])
+    "outgoing of a = {l1, l3}";
+  assert_true (get_outgoing_links atomspace c = [])
+    "c heads no link";
+  assert_eq 1 (List.length (List.filter (fun l -> l = l3) (get_incoming_links atomspace a)))
+    "repeated member indexed once";
+
+  remove_link atomspace l1;
+  assert_true (get_incoming_links atomspace b = [l2]) "remove_link updates incoming";
+  assert_true (get_outgoing_links atomspace a = [l3]) "remove_link updates outgoing";
+
+  remove_link atomspace l1;
+  assert_true (get_link atomspace l1 = None) "removing twice is harmless";
+
+  (* Every link of a hub node can be deleted without rescanning its set *)
+  let hub = add_node atomspace Concept "hub" in
+  let spokes = List.init 20_000 (fun i ->
+    add_link atomspace Inheritance [add_node atomspace Concept ("spoke" ^ string_of_int i); hub]) in
+  assert_eq 20_000 (List.length (get_incoming_links atomspace hub)) "hub incoming set";
+  List.iter (remove_link atomspace) spokes;
+  assert_true (get_incoming_links atomspace hub = []) "hub incoming set emptied"
+
+let test_type_index () =
+  section "Type Index";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  let p = add_node atomspace Predicate "p" in
+  let b = add_node atomspace Concept "b" in
+  let l1 = add_link atomspace Implication [a; b] in
+  let l2 = add_link atomspace (Custom "member") [a; p] in
+  let l3 = add_link atomspace Inheritance [b; a] in
+
+  assert_true (sorted (find_nodes_by_type atomspace Concept) = sorted [a; b])
+    "concept nodes";
+  assert_true (find_nodes_by_type atomspace Predicate = [p]) "predicate nodes";
+  assert_true (find_nodes_by_type atomspace Schema = []) "no schema nodes";
+  assert_true (find_links_by_type atomspace Implication = [l1]) "implication links";
+  assert_true (find_links_by_type atomspace (Custom "member") = [l2]) "custom links";
+
+  remove_node atomspace a;
+  assert_true (find_nodes_by_type atomspace Concept = [b]) "remove_node updates type index";
+  assert_true (find_nodes_by_name atomspace "a" = []) "remove_node updates name index";
+  assert_true (sorted (get_incoming_links atomspace a) = sorted [l1; l2; l3])
+    "links to a removed node stay indexed";
+
+  remove_link atomspace l1;
+  assert_true (find_links_by_type atomspace Implication = []) "remove_link updates type index"
+
+let test_link_subscriptions () =
+  section "Link Event Subscriptions";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  let b = add_node atomspace Concept "b" in
+  let first = ref 0 and second = ref 0 in
+  let s1 = subscribe_link_events atomspace (fun _ -> incr first) in
+  let _s2 = subscribe_link_events atomspace (fun _ -> incr second) in
+  let l1 = add_link atomspace Inheritance [a; b] in
+  assert_eq 1 !first "first observer sees Link_added";
+  assert_eq 1 !second "second observer sees Link_added";
+
+  unsubscribe_link_events atomspace s1;
+  update_link_truth atomspace l1 (0.5, 0.5);
+  remove_link atomspace l1;
+  assert_eq 1 !first "unsubscribed observer sees nothing more";
+  assert_eq 3 !second "remaining observer keeps receiving events";
+  assert_eq 1 (List.length atomspace.link_observers) "one observer left";
+
+  unsubscribe_link_events atomspace s1;
+  assert_eq 1 (List.length atomspace.link_observers) "unsubscribing twice is harmless"
+
+let test_columnar_values () =
+  section "Columnar Attention/Truth Values";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  let b = add_node atomspace Concept "b" in
+  let l = add_link atomspace Inheritance [a; b] in
+
+  update_node_attention atomspace a { sti = 50.0; lti = 10.0; vlti = 1.0 };
+  update_node_truth atomspace a (0.7, 0.4);
+  update_link_attention atomspace l { sti = 20.0; lti = 0.0; vlti = 0.0 };
+
+  (match get_node atomspace a with
+   | Some node ->
+       assert_float_eq 50.0 node.attention.sti "node view reads STI";
+       assert_float_eq 0.7 (fst node.truth_value) "node view reads strength"
+   | None -> assert_true false "node view exists");
+  (match get_link_attention atomspace l with
+   | Some av -> assert_float_eq 20.0 av.sti "link attention read"
+   | None -> assert_true false "link attention exists");
+
+  decay_attention atomspace 0.5;
+  (match get_node_attention atomspace a with
+   | Some av ->
+       assert_float_eq 25.0 av.sti "decay halves STI";
+       assert_float_eq 5.0 av.lti "decay halves LTI";
+       assert_float_eq 1.0 av.vlti "decay keeps VLTI"
+   | None -> assert_true false "node attention exists");
+
+  let rent = collect_attention_rent atomspace 0.1 in
+  assert_float_eq 3.5 rent "rent collected from nodes and links";
+
+  remove_node atomspace a;
+  assert_true (get_node_attention atomspace a = None) "removed node has no attention";
+  assert_eq 1 (fold_nodes (fun _ n -> n + 1) atomspace 0) "fold_nodes sees live nodes";
+
+  (* Ids beyond the initial column capacity grow the columns *)
+  let last = ref b in
+  for i = 1 to 5000 do
+    last := add_node atomspace Concept (string_of_int i)
+  done;
+  update_node_attention atomspace !last { sti = 3.0; lti = 0.0; vlti = 0.0 };
+  (match get_node atomspace !last with
+   | Some node -> assert_float_eq 3.0 node.attention.sti "grown column holds value"
+   | None -> assert_true false "grown node exists")
+
+let test_restore () =
+  section "Restoring Stored Atoms";
+
+  let atomspace = create_atomspace ~capacity:10 () in
+  restore_node atomspace { id = 7; node_type = Concept; name = "x";
+                           attention = { sti = 4.0; lti = 1.0; vlti = 0.0 };
+                           truth_value = (0.5, 0.25) };
+  restore_node atomspace { id = 2; node_type = Predicate; name = "y";
+                           attention = { sti = 0.0; lti = 0.0; vlti = 0.0 };
+                           truth_value = (1.0, 1.0) };
+  restore_link atomspace { id = 3; link_type = Custom "member"; outgoing = [7; 2];
+                           attention = { sti = 1.0; lti = 0.0; vlti = 0.0 };
+                           truth_value = (0.9, 0.8) };
+
+  (match get_node atomspace 7 with
+   | Some node -> assert_float_eq 4.0 node.attention.sti "restored node keeps its values"
+   | None -> assert_true false "restored node exists");
+  assert_true (find_nodes_by_name atomspace "x" = [7]) "restored node indexed by name";
+  assert_true (get_incoming_links atomspace 2 = [3]) "restored link indexed";
+  assert_eq 8 (add_node atomspace Concept "z") "new node ids follow restored ones";
+  assert_eq 4 (add_link atomspace Inheritance [7; 8]) "new link ids follow restored ones";
+
+  restore_node atomspace { id = 7; node_type = Concept; name = "x2";
+                           attention = { sti = 0.0; lti = 0.0; vlti = 0.0 };
+                           truth_value = (1.0, 1.0) };
+  assert_true (find_nodes_by_name atomspace "x" = []) "restoring an id replaces the atom";
+
+  assert_true (node_type_of_string (node_type_to_string Link_type) = Link_type)
+    "node type name roundtrip";
+  assert_true (link_type_of_string "member" = Custom "member") "unknown link types are custom"
+
+(** Queries must cost proportionally to their result, not to the AtomSpace *)
+let test_dense_tensors () =
+  section "Dense Tensors";
+
+  let atomspace = create_atomspace () in
+  let m = add_tensor atomspace [2; 3] [| 1.0; -2.0; 3.0; -4.0; 5.0; -6.0 |] None in
+  let t = match get_tensor atomspace m with Some t -> t | None -> failwith "missing tensor" in
+  assert_true (tensor_shape_of t = [2; 3]) "shape from dims";
+  assert_true (Bigarray.Array1.dim t.data.Tensor_backend.Dense.buffer = 6) "one float32 buffer";
+
+  (* Views share the buffer *)
+  let tr = tensor_transpose_op atomspace m in
+  let row = tensor_slice_view atomspace m ~axis:0 1 1 in
+  let flat = tensor_reshape_view atomspace m [6] in
+  let values id = match get_tensor atomspace id with
+    | Some t -> tensor_values t
+    | None -> [||] in
+  assert_true (values tr = [| 1.0; -4.0; -2.0; 5.0; 3.0; -6.0 |]) "transposed view";
+  assert_true (values row = [| -4.0; 5.0; -6.0 |]) "row slice";
+
+  tensor_relu_inplace atomspace m;
+  assert_true (values flat = [| 1.0; 0.0; 3.0; 0.0; 5.0; 0.0 |]) "in-place relu seen through reshape view";
+  tensor_scale_inplace atomspace row 2.0;
+  assert_true (values m = [| 1.0; 0.0; 3.0; 0.0; 10.0; 0.0 |]) "in-place scale of a slice";
+  tensor_add_inplace atomspace tr tr;
+  assert_true (values m = [| 2.0; 0.0; 6.0; 0.0; 20.0; 0.0 |]) "in-place add through a transposed view";
+
+  (* New results do not alias their inputs *)
+  let doubled = tensor_add_op atomspace m m in
+  tensor_scale_inplace atomspace doubled 0.0;
+  assert_true (values m = [| 2.0; 0.0; 6.0; 0.0; 20.0; 0.0 |]) "op results own their buffer";
+  let product = tensor_matmul_op atomspace m tr in
+  assert_true (values product = [| 40.0; 0.0; 0.0; 400.0 |]) "matmul with a strided operand";
+  assert_float_eq 1.0 (Array.fold_left (+.) 0.0 (values (tensor_softmax_op atomspace m)))
+    "softmax sums to one";
+  assert_float_eq (sqrt 440.0) (tensor_norm_op atomspace m) "norm";
+
+  update_tensor_data atomspace row [| 0.1; 0.2; 0.3 |];
+  assert_float_eq 0.1 (values m).(3) "update writes into the shared buffer";
+  assert_true ((values m).(3) <> 0.1) "stored as float32";
+  assert_true (try update_tensor_data atomspace row [| 1.0 |]; false with Failure _ -> true)
+    "update must match the tensor size"
+
+let test_batched_similarity () =
+  section "Batched Similarity";
+
+  Random.init 5;
+  let atomspace = create_atomspace () in
+  let random_tensor () = add_tensor atomspace [16] (Array.init 16 (fun _ -> Random.float 2.0 -. 1.0)) None in
+  let query = random_tensor () in
+  let candidates = List.init 200 (fun _ -> random_tensor ()) in
+  let odd = add_tensor atomspace [4; 4] (Array.make 16 1.0) None in
+  let zero = add_tensor atomspace [16] (Array.make 16 0.0) None in
+  let ids = candidates @ [odd; zero; -1] in
+
+  let batched = tensor_cosine_similarities atomspace query ids in
+  let pairwise = List.map (tensor_cosine_similarity_op atomspace query) ids in
+  assert_true (List.for_all2 (fun a b -> abs_float (a -. b) < 1e-9) (Array.to_list batched) pairwise)
+    "batched scores match the pairwise op";
+  assert_true (batched.(200) = 0.0 && batched.(201) = 0.0 && batched.(202) = 0.0)
+    "mismatched, zero and missing candidates score 0";
+
+  let expected = List.combine ids pairwise
+    |> List.sort (fun (_, a) (_, b) -> compare b a)
+    |> List.map fst in
+  let top = List.map fst (tensor_cosine_top_k atomspace query ids 10) in
+  assert_true (top = take 10 expected) "top-k matches a full sort";
+  assert_true (tensor_cosine_top_k atomspace query ids 0 = []) "top-0 is empty";
+  assert_eq 203 (List.length (tensor_cosine_top_k atomspace query ids 500)) "top-k caps at the candidate count";
+
+  (* Pairs from the Gram matrix against the pairwise op *)
+  let sample = Array.of_list (take 40 candidates @ [odd; odd]) in
+  let brute = ref [] in
+  Array.iteri (fun i a ->
+    Array.iteri (fun j b ->
+      let s = tensor_cosine_similarity_op atomspace a b in
+      if i < j && s > 0.3 then brute := (i, j) :: !brute) sample) sample;
+  let pairs = tensor_cosine_pairs atomspace (Array.to_list sample) 0.3 in
+  assert_true (List.map (fun (i, j, _) -> (i, j)) pairs = List.sort compare !brute)
+    "Gram-matrix pairs match the pairwise op";
+  assert_true (List.mem (40, 41) (List.map (fun (i, j, _) -> (i, j)) pairs))
+    "tensors pair within their own shape";
+
+  (* Cached norms follow in-place writes *)
+  let t = match get_tensor atomspace query with Some t -> t | None -> failwith "missing tensor" in
+  let before = tensor_norm t in
+  tensor_scale_inplace atomspace query 2.0;
+  assert_float_eq (2.0 *. before) (tensor_norm t) "norm cache invalidated by in-place ops";
+  update_tensor_data atomspace query (Array.make 16 1.0);
+  assert_float_eq 4.0 (tensor_norm t) "norm cache invalidated by updates";
+  let other = match get_tensor atomspace (List.hd ids) with Some t -> t | None -> failwith "missing tensor" in
+  ignore (tensor_norm other);
+  let cached = other.norm_version in
+  tensor_scale_inplace atomspace query 3.0;
+  ignore (tensor_norm other);
+  assert_true (other.norm_version = cached) "writes to one tensor keep other norms cached";
+  let view = tensor_reshape_view atomspace query [4; 4] in
+  tensor_scale_inplace atomspace view 0.5;
+  assert_float_eq 6.0 (tensor_norm t) "writes through a view invalidate the source norm";
+  Tensor_backend.Dense.scale_inplace 2.0 t.data;
+  touch_tensor atomspace query;
+  assert_float_eq 12.0 (tensor_norm t) "touched tensor recomputes its norm"
+
+let test_attention_passes () =
+  section "ECAN Column Passes";
+
+  let build () =
+    let atomspace = create_atomspace ~capacity:16 () in
+    for i = 0 to 199 do
+      let id = add_node atomspace Concept (string_of_int i) in
+      update_node_attention atomspace id
+        { sti = float_of_int ((i * 37) mod 101); lti = float_of_int (i mod 7); vlti = 0.0 }
+    done;
+    for i = 1 to 50 do
+      let id = add_link atomspace Inheritance [i; i + 1] in
+      update_link_attention atomspace id { sti = float_of_int i; lti = 1.0; vlti = 0.0 }
+    done;
+    atomspace
+  in
+  let separate = build () and fused = build () in
+  decay_attention separate 0.9;
+  let rent = collect_attention_rent separate 0.05 in
+  let fused_rent = decay_and_collect_rent fused 0.9 0.05 in
+  assert_float_eq rent fused_rent "fused pass collects the same rent";
+  let same = ref true in
+  for id = 1 to 200 do
+    match get_node_attention separate id, get_node_attention fused id with
+    | Some a, Some b ->
+        if abs_float (a.sti -. b.sti) > 1e-9 || abs_float (a.lti -. b.lti) > 1e-9 then
+          same := false
+    | _ -> same := false
+  done;
+  assert_true !same "fused pass leaves the same STI and LTI";
+
+  (* Rent clamps at zero *)
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  update_node_attention atomspace a { sti = -4.0; lti = 0.0; vlti = 0.0 };
+  ignore (collect_attention_rent atomspace 0.5);
+  (match get_node_attention atomspace a with
+   | Some av -> assert_float_eq 0.0 av.sti "negative STI clamped by rent"
+   | None -> assert_true false "node attention exists");
+  add_node_sti atomspace a 3.0;
+  add_node_sti atomspace 999 3.0;
+  (match get_node_attention atomspace a with
+   | Some av -> assert_float_eq 3.0 av.sti "add_node_sti updates in place"
+   | None -> assert_true false "node attention exists");
+
+  (* Heap selection agrees with a full sort and skips removed atoms *)
+  let atomspace = build () in
+  remove_node atomspace 101;
+  let by_sort =
+    fold_nodes (fun node acc -> (node.attention.sti, node.id) :: acc) atomspace []
+    |> List.sort (fun (a, _) (b, _) -> compare b a)
+    |> List.map fst
+  in
+  let top = top_nodes_by_sti atomspace 10 in
+  let top_sti = List.map (fun id ->
+    match get_node_attention atomspace id with Some av -> av.sti | None -> nan) top in
+  assert_eq 10 (List.length top) "top-10 size";
+  assert_true (top_sti = take 10 by_sort) "top-10 matches a full sort";
+  assert_true (not (List.mem 101 top)) "removed node never selected";
+  assert_true (top_k_indices [| 3.0; 9.0; 1.0; 7.0 |] 2 = [1; 3]) "top_k_indices best first";
+
+  let focus = get_high_attention_atoms atomspace 200 in
+  assert_eq 50 (List.length focus) "focus pairs up to the shorter ranking";
+  assert_true (List.length (get_high_attention_atoms (create_atomspace ()) 10) = 0)
+    "empty atomspace has empty focus"
+
+let test_sti_ranking () =
+  section "STI Ranking";
+
+  Random.init 11;
+  let atomspace = create_atomspace ~capacity:16 () in
+  let ids = Array.init 500 (fun i -> add_node atomspace Concept (string_of_int i)) in
+  let ranked_sti count =
+    List.map (fun id ->
+      match get_node_attention atomspace id with Some av -> av.sti | None -> nan)
+      (top_nodes_by_sti atomspace count)
+  in
+  let sorted_sti count =
+    fold_nodes (fun node acc -> node.attention.sti :: acc) atomspace []
+    |> List.sort (fun a b -> compare b a)
+    |> take count
+  in
+  let consistent = ref true in
+  let check () = if ranked_sti 25 <> sorted_sti 25 then consistent := false in
+  for round = 1 to 40 do
+    for _ = 1 to 50 do
+      let id = ids.(Random.int 500) in
+      match Random.int 3 with
+      | 0 -> update_node_attention atomspace id
+               { sti = Random.float 100.0; lti = 0.0; vlti = 0.0 }
+      | 1 -> add_node_sti atomspace id (Random.float 20.0 -. 10.0)
+      | _ -> ignore (get_node atomspace id)
+    done;
+    check ();
+    if round mod 5 = 0 then begin
+      ignore (decay_and_collect_rent atomspace 0.9 0.05);
+      check ()
+    end;
+    if round mod 10 = 0 then begin
+      remove_node atomspace ids.(round);
+      check ()
+    end
+  done;
+  assert_true !consistent "ranking matches a full sort through updates, passes and removals";
+
+  (* Order-reversing passes rebuild the ranking *)
+  decay_attention atomspace (-1.0);
+  assert_true (ranked_sti 25 = sorted_sti 25) "negative decay reranks";
+  (match get_node atomspace ids.(42) with
+   | Some node ->
+       restore_node atomspace { node with attention = { sti = 1e6; lti = 0.0; vlti = 0.0 } };
+       assert_true (top_nodes_by_sti atomspace 1 = [ids.(42)]) "restored node is ranked"
+   | None -> assert_true false "node exists");
+  remove_node atomspace ids.(42);
+  assert_true (not (List.mem ids.(42) (top_nodes_by_sti atomspace 500)))
+    "removed node leaves the ranking";
+  assert_eq 495 (List.length (top_nodes_by_sti atomspace 1000)) "ranking holds every live node"
+
+let test_scheme_export () =
+  section "Scheme Export and Loading";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "say \"hi\"" in
+  let b = add_node atomspace Predicate "back\\slash" in
+  let gone = add_node atomspace Concept "gone" in
+  let l = add_link atomspace (Custom "member-of") [a; b; a] in
+  let odd = add_link atomspace (Custom "part of (\"x\")") [b; a] in
+  update_node_attention atomspace a { sti = 12.5; lti = 3.0; vlti = 1.0 };
+  update_link_truth atomspace l (0.25, 0.75);
+  remove_node atomspace gone;
+  let t = add_tensor atomspace [2; 2] [| 1.0; -0.5; 0.25; 2.0 |] (Some a) in
+
+  let text = atomspace_to_scheme atomspace in
+  let buf = Buffer.create 64 in
+  add_atomspace_scheme buf atomspace;
+  assert_true (Buffer.contents buf = text) "string export wraps the Buffer writer";
+  let path = Filename.temp_file "atomspace" ".scm" in
+  let oc = open_out path in
+  output_atomspace_scheme oc atomspace;
+  close_out oc;
+  let ic = open_in path in
+  let streamed = really_input_string ic (in_channel_length ic) in
+  close_in ic;
+  assert_true (streamed = text) "channel export matches";
+  assert_true (node_to_scheme (Option.get (get_node atomspace b)) =
+               "(node (id 2) (type Predicate) (name \"back\\\\slash\") (attention (sti 0.000) (lti 0.000) (vlti 0.000)) (truth 1.000 1.000))")
+    "names are escaped";
+
+  let ic = open_in path in
+  let loaded = input_atomspace_scheme ic in
+  close_in ic;
+  Sys.remove path;
+  assert_true (find_nodes_by_name loaded "say \"hi\"" = [a]) "escaped name read back";
+  assert_true (get_node loaded gone = None) "removed node stays removed";
+  (match get_node_attention loaded a with
+   | Some av -> assert_float_eq 12.5 av.sti "node attention read back"
+   | None -> assert_true false "node read back");
+  (match get_link loaded l with
+   | Some link ->
+       assert_true (link.link_type = Custom "member-of" && link.outgoing = [a; b; a]) "link read back";
+       assert_float_eq 0.75 (snd link.truth_value) "link truth read back"
+   | None -> assert_true false "link read back");
+  (match get_link loaded odd with
+   | Some link -> assert_true (link.link_type = Custom "part of (\"x\")") "quoted custom type read back"
+   | None -> assert_true false "custom-typed link read back");
+  (match get_tensor loaded t with
+   | Some tensor ->
+       assert_true (tensor_values tensor = [| 1.0; -0.5; 0.25; 2.0 |]) "tensor data read back";
+       assert_true (tensor.associated_node = Some a) "tensor node read back"
+   | None -> assert_true false "tensor read back");
+  assert_true (atomspace_to_scheme (atomspace_of_scheme text) = text) "export of a reload is identical";
+  assert_true (atomspace_to_scheme (atomspace_of_scheme (atomspace_to_scheme (create_atomspace ()))) =
+               atomspace_to_scheme (create_atomspace ())) "empty AtomSpace round-trips";
+
+  (* A large export goes out in chunks *)
+  let big = create_atomspace ~capacity:100_000 () in
+  for i = 1 to 100_000 do
+    let id = add_node big Concept (string_of_int i) in
+    if i > 1 then ignore (add_link big Similarity [id - 1; id])
+  done;
+  let path = Filename.temp_file "atomspace" ".scm" in
+  let oc = open_out path in
+  let t0 = Sys.time () in
+  output_atomspace_scheme oc big;
+  close_out oc;
+  let export_time = Sys.time () -. t0 in
+  let ic = open_in path in
+  let size = in_channel_length ic in
+  let t0 = Sys.time () in
+  let reloaded = input_atomspace_scheme ic in
+  let load_time = Sys.time () -. t0 in
+  close_in ic;
+  Printf.printf "  199999 atoms: export %.3fs, load %.3fs, %d bytes\n" export_time load_time size;
+  Sys.remove path;
+  assert_eq 99_999 (fold_links (fun _ n -> n + 1) reloaded 0) "streamed export reloads"
+
+let test_index_benchmark () =
+  section "Index Benchmark (10^6 atoms)";
+
+  let atomspace = create_atomspace () in
+  let num_nodes = 500_000 in
+  let num_links = 500_000 in
+
+  let t0 = Sys.time () in
+  let nodes = Array.init num_nodes (fun i ->
+    add_node atomspace (if i mod 10 = 0 then Predicate else Concept) (string_of_int i)) in
+  for i = 0 to num_links - 1 do
+    let src = nodes.(i mod num_nodes) in
+    let dst = nodes.((i * 7 + 1) mod num_nodes) in
+    ignore (add_link atomspace (if i mod 100 = 0 then Implication else Inheritance) [src; dst])
+  done;
+  let build_time = Sys.time () -. t0 in
+  Printf.printf "  Built %d nodes + %d links in %.2fs\n" num_nodes num_links build_time;
+
+  let queries = 100_000 in
+  let t0 = Sys.time () in
+  let total = ref 0 in
+  for i = 0 to queries - 1 do
+    let id = nodes.((i * 13) mod num_nodes) in
+    total := !total + List.length (get_incoming_links atomspace id)
+                    + List.length (get_outgoing_links atomspace id)
+  done;
+  let adjacency_time = Sys.time () -. t0 in
+  Printf.printf "  %d adjacency queries in %.3fs (%.2f µs/query)\n"
+    queries adjacency_time (adjacency_time *. 1e6 /. float_of_int queries);
+  assert_true (!total > 0) "adjacency queries return results";
+
+  let t0 = Sys.time () in
+  let implications = find_links_by_type atomspace Implication in
+  let predicates = find_nodes_by_type atomspace Predicate in
+  let type_time = Sys.time () -. t0 in
+  Printf.printf "  Type queries in %.3fs\n" type_time;
+  assert_eq (num_links / 100) (List.length implications) "implication count";
+  assert_eq (num_nodes / 10) (List.length predicates) "predicate count";
+
+  Array.iteri (fun i id -> add_node_sti atomspace id (float_of_int (i mod 1000))) nodes;
+  let cycles = 10 in
+  let t0 = Sys.time () in
+  for _ = 1 to cycles do
+    decay_attention atomspace 0.99;
+    ignore (collect_attention_rent atomspace 0.01)
+  done;
+  let ecan_time = Sys.time () -. t0 in
+  Printf.printf "  %d decay+rent passes in %.3fs (%.2f ms/pass)\n"
+    cycles ecan_time (ecan_time *. 1000.0 /. float_of_int cycles);
+
+  let t0 = Sys.time () in
+  for _ = 1 to cycles do
+    ignore (decay_and_collect_rent atomspace 0.99 0.01)
+  done;
+  let fused_time = Sys.time () -. t0 in
+  Printf.printf "  %d fused decay/rent passes in %.3fs (%.2f ms/pass)\n"
+    cycles fused_time (fused_time *. 1000.0 /. float_of_int cycles);
+
+  let t0 = Sys.time () in
+  let focus = ref [] in
+  for _ = 1 to cycles do
+    focus := get_high_attention_atoms atomspace 100
+  done;
+  let focus_time = Sys.time () -. t0 in
+  Printf.printf "  %d attentional focus selections in %.3fs (%.2f ms each)\n"
+    cycles focus_time (focus_time *. 1000.0 /. float_of_int cycles);
+  assert_eq 50 (List.length !focus) "focus selected from 10^6 atoms"
+
+let () =
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║     Hypergraph AtomSpace - Test Suite                    ║\n";
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  test_incoming_outgoing_index ();
+  test_type_index ();
+  test_link_subscriptions ();
+  test_columnar_values ();
+  test_restore ();
+  test_dense_tensors ();
+  test_batched_similarity ();
+  test_attention_passes ();
+  test_sti_ranking ();
+  test_scheme_export ();
+  test_index_benchmark ();
+
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║                    Test Summary                          ║\n";
+  Printf.printf "╠══════════════════════════════════════════════════════════╣\n";
+  Printf.printf "║  Total:  %3d                                             ║\n" !test_count;
+  Printf.printf "║  Passed: %3d                                             ║\n" !pass_count;
+  Printf.printf "║  Failed: %3d                                             ║\n" !fail_count;
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  if !fail_count = 0 then
+    Printf.printf "\n🕸️  All hypergraph tests passed! 🕸️\n\n"
+  else
+    Printf.printf "\n⚠️  Some tests failed. Please review. ⚠️\n\n"
@@ -218,6 +218,76 @@ let test_fitness_evaluation () =
   Printf.printf "  ℹ️  Double program fitness: %.4f\n" fitness_double;
   assert_true (fitness_double > 0.99) "perfect regression fitness"
 
+(* Interpreted evaluation as fitness functions did it before compilation *)
+let interpret p inputs =
+  eval (List.combine p.variables (List.map (fun x -> Prim (PFloat x)) inputs)) p.expr
+
+let test_compiled_evaluation () =
+  section "Compiled Evaluation";
+  
+  let same p inputs =
+    let expected = try Some (interpret p inputs) with _ -> None in
+    let actual = try Some (eval_compiled (compile p) (Array.of_list inputs)) with _ -> None in
+    compare expected actual = 0  (* nan results compare equal *)
+  in
+  let handwritten = [
+    "(if (< $x0 0) (neg $x0) $x0)";
+    "(+ $x0 1)";                      (* float and int: stays symbolic *)
+    "(= (+ $x0 1) (+ $x0 1))";         (* symbolic values compare equal *)
+    "(xor (> $x0 1.0) #t)";
+    "(/ $x1 (- $x0 $x0))";
+    "(if (+ 1 2) $x0 $x1)";
+    "((+ 1 2) $x0 foo)";               (* application, left to the interpreter *)
+    "(abs (neg (* $x0 $x1)))";
+    "(and (>= $x0 $x1) (<= $x1 $x0))";
+  ] in
+  List.iter (fun src ->
+    let p = create_program src in
+    let inputs = List.init p.arity (fun i -> float_of_int (i * 3) -. 2.0) in
+    assert_true (same p inputs) ("compiled matches eval: " ^ src)
+  ) handwritten;
+  
+  Random.init 3;
+  let agree = ref true in
+  for _ = 1 to 500 do
+    let p = create_program_from_expr (random_expr 5) in
+    for _ = 1 to 4 do
+      let inputs = List.init p.arity (fun _ -> Random.float 4.0 -. 2.0) in
+      if not (same p inputs) then agree := false
+    done
+  done;
+  assert_true !agree "compiled matches eval on 500 random programs";
+  
+  let p = create_program "(+ (* $x0 2.0) $x1)" in
+  let cases = Array.init 5 (fun i -> [| float_of_int i; 1.0 |]) in
+  assert_true (eval_batch (compile p) cases
+               = Array.map (fun c -> eval_program p (Array.to_list c)) cases) "batch matches per-case";
+  assert_true (try ignore (eval_compiled (compile p) [| 1.0 |]); false with Failure _ -> true)
+    "arity mismatch rejected";
+  
+  (* Fitness over a population, interpreted versus compiled *)
+  let test_cases = List.init 256 (fun i ->
+    let x = float_of_int i /. 32.0 in ([x; 1.0 -. x], 2.0 *. x +. 1.0)) in
+  let interpreted p =
+    let mse = List.fold_left (fun acc (inputs, expected) ->
+      try match interpret p inputs with
+        | Prim (PFloat r) -> acc +. (r -. expected) ** 2.0
+        | Prim (PInt r) -> acc +. (float_of_int r -. expected) ** 2.0
+        | _ -> acc +. 1000.0
+      with _ -> acc +. 1000.0) 0.0 test_cases in
+    1.0 /. (1.0 +. mse /. float_of_int (List.length test_cases))
+  in
+  let programs = Array.init 300 (fun _ -> create_program_from_expr (random_expr 6)) in
+  let fitness = regression_fitness test_cases in
+  let t0 = Sys.time () in
+  let slow = Array.map interpreted programs in
+  let t1 = Sys.time () in
+  let fast = Array.map fitness programs in
+  let t2 = Sys.time () in
+  Printf.printf "  ℹ️  300 programs x 256 cases: interpreted %.3fs, compiled %.3fs\n"
+    (t1 -. t0) (t2 -. t1);
+  assert_true (compare slow fast = 0) "compiled fitness equals interpreted fitness"
+
 let test_population () =
   section "Population Management";
   
@@ -277,6 +347,80 @@ let test_evolution () =
   assert_true (!pop.generation = 5) "evolution ran 5 generations";
   assert_true (!pop.best_fitness > 0.0) "some fitness achieved"
 
+(* Timing assertions only hold on an idle multi-core machine; [make bench]
+   passes --bench to enable them *)
+let bench = Array.mem "--bench" Sys.argv
+
+let test_parallel_evaluation () =
+  section "Parallel Evaluation";
+  
+  let weights = [| 9; 1; 1; 1; 5; 4; 1; 3 |] in
+  let chunks = Parallel_pool.balance 3 (fun i -> weights.(i)) (Array.init 8 (fun i -> i)) in
+  let loads = Array.map (Array.fold_left (fun acc i -> acc + weights.(i)) 0) chunks in
+  assert_true (Array.length chunks = 3) "one chunk per worker";
+  assert_true (List.sort compare (Array.to_list (Array.concat (Array.to_list chunks)))
+               = List.init 8 (fun i -> i)) "every item lands in one chunk";
+  assert_true (Array.fold_left max 0 loads - Array.fold_left min max_int loads <= 2)
+    "chunk weights are near-equal";
+  let raised =
+    try
+      ignore (Parallel_pool.map ~workers:4 (fun i -> if i = 0 then failwith "boom" else i)
+                (Array.init 8 (fun i -> i)));
+      false
+    with Failure _ -> true
+  in
+  assert_true raised "a failing worker raises in the parent";
+  if Parallel_pool.can_fork then
+    assert_true (try ignore (Unix.waitpid [Unix.WNOHANG] (-1)); false
+                 with Unix.Unix_error (Unix.ECHILD, _, _) -> true)
+      "every worker is reaped after a failure";
+  
+  let population () = Random.init 11; create_population 200 6 in
+  let test_cases = List.init 512 (fun i ->
+    let x = float_of_int i /. 64.0 in ([x; x *. x], x *. x -. x)) in
+  let fitness = regression_fitness test_cases in
+  let scores pop = Array.map (fun p -> p.fitness) pop.programs in
+  let sequential = evaluate_population ~workers:1 fitness (population ()) in
+  let parallel = evaluate_population ~workers:4 fitness (population ()) in
+  assert_true (compare (scores sequential) (scores parallel) = 0) "parallel scores match sequential";
+  assert_true (sequential.best_fitness = parallel.best_fitness) "summary matches";
+  
+  (* Fitness functions that sample see the same numbers on any worker *)
+  let sampled p = float_of_int p.complexity +. Random.float 1.0 in
+  let a = evaluate_population ~workers:1 ~seed:5 sampled (population ()) in
+  let b = evaluate_population ~workers:3 ~seed:5 sampled (population ()) in
+  assert_true (compare (scores a) (scores b) = 0) "per-program seeding is deterministic";
+  let c = evaluate_population ~workers:1 ~seed:6 sampled (population ()) in
+  assert_true (compare (scores a) (scores c) <> 0) "seed changes the samples";
+  let pop = population () in
+  let state = Random.get_state () in
+  ignore (evaluate_population ~seed:5 sampled pop);
+  let continued = Random.bits () in
+  Random.set_state state;
+  assert_true (continued = Random.bits ()) "global RNG stream is left untouched";
+  let failing p = if p.complexity > 3 then failwith "fitness" else Random.float 1.0 in
+  let state = Random.get_state () in
+  (try ignore (evaluate_population ~seed:5 failing (population ())) with Failure _ -> ());
+  let continued = Random.bits () in
+  Random.set_state state;
+  assert_true (continued = Random.bits ()) "global RNG stream restored when fitness raises";
+  
+  (* Generations per second with heavier fitness *)
+  let generations workers =
+    let pop = ref (evaluate_population ~workers fitness (population ())) in
+    let start = Unix.gettimeofday () in
+    for _ = 1 to 5 do
+      pop := evolve_population ~workers fitness !pop
+    done;
+    5.0 /. (Unix.gettimeofday () -. start)
+  in
+  let one = generations 1 in
+  let four = generations 4 in
+  Printf.printf "  ℹ️  generations/sec: 1 worker %.2f, 4 workers %.2f\n" one four;
+  assert_true (one > 0.0 && four > 0.0) "evolution runs with any worker count";
+  if bench && Parallel_pool.can_fork then
+    assert_true (four > 1.2 *. one) "4 workers speed evolution up"
+
 let test_scheme_serialization () =
   section "Scheme Serialization";
   
@@ -301,6 +445,8 @@ let () =
   test_simplification ();
   test_genetic_operators ();
   test_fitness_evaluation ();
+  test_compiled_evaluation ();
+  test_parallel_evaluation ();
   test_population ();
   test_evolution ();
   test_scheme_serialization ();
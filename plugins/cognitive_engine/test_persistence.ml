@@ -98,7 +98,7 @@ let test_json_serialization () =
     sn_confidence = 0.9;
     sn_sti = 100.0;
     sn_lti = 50.0;
-    sn_vlti = false;
+    sn_vlti = 0.0;
   } in
   let json = JSON.node_to_json node in
   Printf.printf "  ℹ️  Node JSON: %s\n" json;
@@ -135,23 +135,23 @@ let test_wal_operations () =
     sn_confidence = 0.9;
     sn_sti = 100.0;
     sn_lti = 50.0;
-    sn_vlti = false;
+    sn_vlti = 0.0;
   } in
   
   WAL.append wal (WAL.AddNode node);
-  assert_eq 1 wal.sequence "WAL sequence incremented";
+  assert_eq 1 (WAL.sequence wal) "WAL sequence incremented";
   
   WAL.append wal (WAL.UpdateNode node);
-  assert_eq 2 wal.sequence "WAL sequence incremented again";
+  assert_eq 2 (WAL.sequence wal) "WAL sequence incremented again";
   
   WAL.checkpoint wal;
-  assert_true (List.length wal.operations = 1) "checkpoint clears old ops"
+  assert_true (List.length (WAL.operations wal) = 1) "checkpoint clears old ops"
 
 let test_snapshot_creation () =
   section "Snapshot Creation";
   
   let store = create_store InMemory in
-  let atomspace = Hypergraph.create () in
+  let atomspace = Hypergraph.create_atomspace () in
   
   (* Add some data *)
   let _ = Hypergraph.add_node atomspace Hypergraph.Concept "TestNode" in
@@ -190,7 +190,7 @@ let test_stats_serialization () =
 let test_atomspace_serialization () =
   section "AtomSpace Serialization";
   
-  let atomspace = Hypergraph.create () in
+  let atomspace = Hypergraph.create_atomspace () in
   
   (* Add nodes *)
   let n1 = Hypergraph.add_node atomspace Hypergraph.Concept "Node1" in
@@ -212,7 +212,7 @@ let test_atomspace_serialization () =
 let test_json_file_operations () =
   section "JSON File Operations";
   
-  let atomspace = Hypergraph.create () in
+  let atomspace = Hypergraph.create_atomspace () in
   let _ = Hypergraph.add_node atomspace Hypergraph.Concept "TestNode" in
   
   let path = "/tmp/test_atomspace.json" in
@@ -240,21 +240,458 @@ let test_incremental_operations () =
     id = 1;
     node_type = Hypergraph.Concept;
     name = "TestNode";
-    strength = 0.8;
-    confidence = 0.9;
-    attention = { sti = 100.0; lti = 50.0; vlti = false };
-    incoming = [];
-    outgoing = [];
+    attention = { sti = 100.0; lti = 50.0; vlti = 0.0 };
+    truth_value = (0.8, 0.9);
   } in
   
   record_add_node store node;
-  assert_eq 1 store.wal.sequence "add node recorded";
+  assert_eq 1 (wal_sequence store) "add node recorded";
   
   record_update_node store node;
-  assert_eq 2 store.wal.sequence "update node recorded";
+  assert_eq 2 (wal_sequence store) "update node recorded";
   
   record_delete_node store 1;
-  assert_eq 3 store.wal.sequence "delete node recorded"
+  assert_eq 3 (wal_sequence store) "delete node recorded"
+
+let sample_node id name = {
+  sn_id = id;
+  sn_node_type = "Concept";
+  sn_name = name;
+  sn_strength = 0.8;
+  sn_confidence = 0.9;
+  sn_sti = 10.0;
+  sn_lti = 5.0;
+  sn_vlti = 1.0;
+}
+
+let sample_link id link_type outgoing = {
+  sl_id = id;
+  sl_link_type = link_type;
+  sl_outgoing = outgoing;
+  sl_strength = 0.7;
+  sl_confidence = 0.6;
+  sl_sti = 3.0;
+  sl_lti = 0.0;
+  sl_vlti = 0.0;
+}
+
+let test_rocks_encoding () =
+  section "RocksDB Key/Value Encoding";
+  
+  let open RocksStore in
+  assert_true (id_key 255 < id_key 256) "id keys sort numerically";
+  assert_true (id_key 70000 < id_key 1_000_000_000) "wide id keys sort numerically";
+  assert_eq 123456789 (id_of_key (id_key 123456789) 0) "id key roundtrip";
+  assert_eq 9 (String.length (atom_key 'n' 42)) "atom key is kind + 8 bytes";
+  assert_true (atom_key 'n' 7 <> atom_key 'l' 7) "node and link keys differ";
+  assert_eq 42 (id_of_key (incoming_key 42 7) 0) "incoming key starts with node id";
+  
+  let value = encode_node (sample_node 1 "cat") in
+  assert_eq 4 (String.length value) "built-in node type takes one byte";
+  assert_true (decode_node value = ("Concept", "cat")) "node value roundtrip";
+  
+  let value = encode_link (sample_link 2 "Implication" [1; 300; 70000]) in
+  assert_true (decode_link value = ("Implication", [1; 300; 70000])) "link value roundtrip";
+  let value = encode_link (sample_link 3 "member-of" [5; 5]) in
+  assert_true (decode_link value = ("member-of", [5; 5])) "custom link type roundtrip";
+  
+  let floats = encode_floats [| 1.5; -2.25; 1e10 |] in
+  assert_eq 24 (String.length floats) "three float64 values";
+  assert_true (decode_float floats 1 = -2.25) "float value roundtrip"
+
+let test_rocksdb_store () =
+  section "Incremental RocksDB Store";
+  
+  if not (Rocksdb_native.is_native_available ()) then
+    Printf.printf "  ℹ️  Native RocksDB not available, skipping\n"
+  else begin
+    let path = "/tmp/opencoq_persistence_rocksdb" in
+    ignore (Sys.command (Printf.sprintf "rm -rf %s %s.wal" path path));
+    let store = create_store (RocksDB path) in
+    let atomspace = Hypergraph.create_atomspace () in
+    let a = Hypergraph.add_node atomspace Hypergraph.Concept "a" in
+    let b = Hypergraph.add_node atomspace Hypergraph.Concept "b" in
+    let l = Hypergraph.add_link atomspace Hypergraph.Inheritance [a; b] in
+    let e = Hypergraph.add_node atomspace Hypergraph.Concept "e" in
+    save store atomspace;
+    
+    (* Changes the WAL never saw reach the database too *)
+    Hypergraph.update_node_attention atomspace a { Hypergraph.sti = 7.0; lti = 0.0; vlti = 0.0 };
+    let d = Hypergraph.add_node atomspace Hypergraph.Concept "d" in
+    Hypergraph.remove_node atomspace e;
+    let c = Hypergraph.add_node atomspace Hypergraph.Concept "c" in
+    (match Hypergraph.get_node atomspace c with
+     | Some node -> record_add_node store node
+     | None -> ());
+    Hypergraph.update_link_truth atomspace l (0.25, 0.5);
+    (match Hypergraph.get_link atomspace l with
+     | Some link -> record_update_link store link
+     | None -> ());
+    save store atomspace;
+    close_store store;
+    
+    let db = Rocksdb_native.open_db path in
+    let get cf key = Rocksdb_native.get ~cf db key in
+    assert_true (get Rocksdb_native.Nodes (RocksStore.id_key c) <> None) "flushed node stored";
+    assert_true (get Rocksdb_native.Incoming (RocksStore.incoming_key b l) <> None)
+      "incoming membership stored";
+    (match get Rocksdb_native.TruthValues (RocksStore.atom_key 'l' l) with
+     | Some v -> assert_true (RocksStore.decode_float v 0 = 0.25) "flushed truth update"
+     | None -> assert_true false "link truth stored");
+    assert_true (get Rocksdb_native.Nodes (RocksStore.id_key d) <> None) "unlogged node stored";
+    assert_true (get Rocksdb_native.Nodes (RocksStore.id_key e) = None) "unlogged removal stored";
+    (match get Rocksdb_native.Attention (RocksStore.atom_key 'n' a) with
+     | Some v -> assert_true (RocksStore.decode_float v 0 = 7.0) "unlogged attention update stored"
+     | None -> assert_true false "node attention stored");
+    let changes = Hypergraph.track_changes atomspace in
+    assert_eq 0 (RocksStore.write_changes db atomspace changes) "unchanged atoms are not rewritten";
+    Hypergraph.update_node_truth atomspace b (0.5, 0.5);
+    assert_eq 2 (RocksStore.write_changes db atomspace changes) "a value update writes its values only";
+    Hypergraph.decay_attention atomspace 0.5;
+    assert_eq 10 (RocksStore.write_changes db atomspace changes) "a column pass rewrites every atom's values";
+    Rocksdb_native.close db;
+    ignore (Sys.command (Printf.sprintf "rm -rf %s %s.wal" path path))
+  end
+
+let build_sample_atomspace () =
+  let atomspace = Hypergraph.create_atomspace () in
+  let a = Hypergraph.add_node atomspace Hypergraph.Concept "a" in
+  let p = Hypergraph.add_node atomspace Hypergraph.Predicate "p" in
+  let l = Hypergraph.add_link atomspace Hypergraph.Inheritance [a; p] in
+  let m = Hypergraph.add_link atomspace (Hypergraph.Custom "member") [p; a; a] in
+  Hypergraph.update_node_attention atomspace p { Hypergraph.sti = 12.5; lti = 2.0; vlti = 1.0 };
+  Hypergraph.update_link_truth atomspace l (0.25, 0.5);
+  Hypergraph.remove_node atomspace a;
+  let b = Hypergraph.add_node atomspace Hypergraph.Concept "b" in
+  (atomspace, (a, p, b, l, m))
+
+(** Checks shared by the binary and RocksDB load round trips *)
+let check_loaded prefix loaded (a, p, b, l, m) =
+  let name s = prefix ^ ": " ^ s in
+  assert_eq 2 (Hypergraph.fold_nodes (fun _ n -> n + 1) loaded 0) (name "node count");
+  assert_eq 2 (Hypergraph.fold_links (fun _ n -> n + 1) loaded 0) (name "link count");
+  (match Hypergraph.get_node loaded p with
+   | Some node ->
+     assert_true (node.Hypergraph.node_type = Hypergraph.Predicate) (name "node type");
+     assert_true (node.Hypergraph.attention.Hypergraph.sti = 12.5) (name "node attention")
+   | None -> assert_true false (name "node restored"));
+  (match Hypergraph.get_link loaded l with
+   | Some link -> assert_true (link.Hypergraph.truth_value = (0.25, 0.5)) (name "link truth")
+   | None -> assert_true false (name "link restored"));
+  (match Hypergraph.get_link loaded m with
+   | Some link ->
+     assert_true (link.Hypergraph.link_type = Hypergraph.Custom "member") (name "custom link type");
+     assert_true (link.Hypergraph.outgoing = [p; a; a]) (name "outgoing set")
+   | None -> assert_true false (name "custom link restored"));
+  assert_true (Hypergraph.find_nodes_by_name loaded "b" = [b]) (name "name index rebuilt");
+  assert_true (List.mem m (Hypergraph.get_incoming_links loaded p)) (name "incoming index rebuilt");
+  assert_eq (b + 1) (Hypergraph.add_node loaded Hypergraph.Concept "new") (name "ids continue")
+
+let test_binary_load () =
+  section "Binary Load Roundtrip";
+  
+  let (atomspace, ids) = build_sample_atomspace () in
+  let path = "/tmp/test_atomspace.bin" in
+  save_binary path atomspace;
+  check_loaded "binary" (load_binary path) ids;
+  
+  (* Files in the record format still load *)
+  let oc = open_out_bin path in
+  output_string oc (Binary.atomspace_to_binary (serialize_atomspace atomspace));
+  close_out oc;
+  check_loaded "record format" (load_binary path) ids;
+  Sys.remove path
+
+let test_columnar_snapshot () =
+  section "Columnar Snapshot";
+  
+  let (atomspace, (_, p, b, _, _)) = build_sample_atomspace () in
+  let t = Hypergraph.add_tensor atomspace [2; 3] [| 1.; 2.; 3.; 4.; 5.; 6. |] (Some p) in
+  let v = Hypergraph.tensor_transpose_op atomspace t in
+  ignore (Hypergraph.add_tensor atomspace [4] [| 0.5; 0.25; 0.; -1. |] None);
+  Hypergraph.update_node_attention atomspace b { Hypergraph.sti = 40.0; lti = 0.0; vlti = 0.0 };
+  let path = "/tmp/test_atomspace_columnar.bin" in
+  save_binary path atomspace;
+  assert_true (not (Sys.file_exists (path ^ ".tmp"))) "temporary file renamed into place";
+  let loaded = load_binary path in
+  (match Hypergraph.get_tensor loaded t with
+   | Some tensor ->
+     assert_true (Hypergraph.tensor_values tensor = [| 1.; 2.; 3.; 4.; 5.; 6. |]) "tensor data";
+     assert_true (tensor.Hypergraph.associated_node = Some p) "tensor node"
+   | None -> assert_true false "tensor restored");
+  (match Hypergraph.get_tensor loaded v with
+   | Some view ->
+     assert_true (Hypergraph.tensor_shape_of view = [3; 2]) "view saved with its own shape";
+     assert_true (Hypergraph.tensor_values view = [| 1.; 4.; 2.; 5.; 3.; 6. |]) "view data"
+   | None -> assert_true false "view restored");
+  Hypergraph.tensor_scale_inplace loaded t 2.0;
+  assert_true (Hypergraph.tensor_values (Option.get (Hypergraph.get_tensor (load_binary path) t))
+               = [| 1.; 2.; 3.; 4.; 5.; 6. |]) "writes to a loaded tensor leave the file alone";
+  assert_true (Hypergraph.top_nodes_by_sti loaded 2 = [b; p]) "STI ranking built";
+  assert_eq (v + 1) (Hypergraph.add_tensor loaded [1] [| 0. |] None) "tensor ids continue";
+  
+  (* Damaged files are refused *)
+  let ic = open_in_bin path in
+  let pristine = really_input_string ic (in_channel_length ic) in
+  close_in ic;
+  let corrupt section index patch name =
+    let data = Bytes.of_string pristine in
+    let offset = Binary.read_int64 pristine (24 + 24 * section + 8) in
+    Bytes.blit_string patch 0 data (offset + index * String.length patch) (String.length patch);
+    let oc = open_out_bin path in
+    output_bytes oc data;
+    close_out oc;
+    assert_true (try ignore (load_binary path); false with Failure _ -> true) name
+  in
+  corrupt 0 1 "\000\000\000\000\000\000\001\000" "string offset past the string bytes rejected";
+  corrupt 4 0 "\255\255\255\127" "name index past the string table rejected";
+  corrupt 8 1 "\255\255\255\255\255\255\255\255" "decreasing link offsets rejected";
+  Unix.truncate path 100;
+  assert_true (try ignore (load_binary path); false with Failure _ -> true)
+    "truncated file rejected";
+  Sys.remove path;
+  
+  (* Checkpoint and restore at scale *)
+  let n = 1_000_000 in
+  let big = Hypergraph.create_atomspace ~capacity:n () in
+  for i = 1 to n do
+    let id = Hypergraph.add_node big Hypergraph.Concept (string_of_int (i mod 1000)) in
+    Hypergraph.add_node_sti big id (float_of_int (i mod 97));
+    if i > 1 then ignore (Hypergraph.add_link big Hypergraph.Similarity [id - 1; id])
+  done;
+  let t0 = Unix.gettimeofday () in
+  save_binary path big;
+  let t1 = Unix.gettimeofday () in
+  let loaded = load_binary path in
+  let t2 = Unix.gettimeofday () in
+  Printf.printf "  ℹ️  %d atoms: save %.3fs, load %.3fs, %d bytes\n"
+    (2 * n - 1) (t1 -. t0) (t2 -. t1) (Unix.stat path).Unix.st_size;
+  assert_eq (n - 1) (Hypergraph.fold_links (fun _ k -> k + 1) loaded 0) "all links loaded";
+  assert_eq 1000 (List.length (Hypergraph.find_nodes_by_name loaded "7")) "names interned and indexed";
+  Sys.remove path
+
+let test_quantized_embeddings () =
+  section "Quantized Embeddings";
+  
+  let module F = Neural_symbolic_fusion in
+  let atomspace = Hypergraph.create_atomspace () in
+  let ctx = F.create_fusion_context atomspace 64 in
+  let bound = List.init 8 (fun i ->
+    let id = Hypergraph.add_node atomspace Hypergraph.Concept ("embedded" ^ string_of_int i) in
+    (id, Option.get (F.symbol_to_neural ctx id F.Embedding_Based))) in
+  let values t = Hypergraph.tensor_values (Option.get (Hypergraph.get_tensor atomspace t)) in
+  let exact = List.map (fun (_, t) -> values t) bound in
+  F.use_quantized_embeddings ctx Embedding_store.Q8_0;
+  assert_true (List.for_all (fun (_, t) -> Hypergraph.is_external_tensor atomspace t) bound)
+    "embeddings held only by the store";
+  let close_to a b =
+    Array.length a = Array.length b
+    && Array.for_all2 (fun x y -> abs_float (x -. y) < 0.02) a b in
+  assert_true (List.for_all2 (fun (_, t) e -> close_to (values t) e) bound exact)
+    "lookups dequantize from the store";
+  
+  let path = "/tmp/test_atomspace_quantized.bin" in
+  save_binary path atomspace;
+  let loaded = load_binary path in
+  Sys.remove path;
+  assert_true (List.for_all2 (fun (id, t) e ->
+    match Hypergraph.get_tensor loaded t with
+    | Some tensor ->
+      tensor.Hypergraph.associated_node = Some id && close_to (Hypergraph.tensor_values tensor) e
+    | None -> false) bound exact) "quantized embeddings saved and loaded";
+  
+  let (premise, t) = List.hd bound in
+  let (conclusion, _) = List.nth bound 1 in
+  (match F.neural_guided_inference ctx premise [conclusion] with
+   | [(c, similarity)] ->
+     assert_true (c = conclusion && similarity >= -1.0 && similarity <= 1.0) "inference scores a released premise"
+   | _ -> assert_true false "inference scores a released premise");
+  Hypergraph.tensor_scale_inplace atomspace t 2.0;
+  assert_true (not (Hypergraph.is_external_tensor atomspace t) && not (Hashtbl.mem ctx.F.released t))
+    "a write brings the float tensor back";
+  assert_true (close_to (values t) (Array.map (fun x -> 2.0 *. x) (List.hd exact)))
+    "the write applies to the stored values"
+
+let test_rocksdb_load () =
+  section "Parallel RocksDB Load";
+  
+  assert_true (RocksStore.id_ranges (-1) 4 = []) "empty column family has no ranges";
+  assert_true (RocksStore.id_ranges 9 4 = [(0, 2); (2, 5); (5, 7); (7, 10)])
+    "ranges cover all ids";
+  assert_true (RocksStore.id_ranges 1 4 = [(0, 1); (1, 2)]) "no empty ranges";
+  
+  if not (Rocksdb_native.is_native_available ()) then
+    Printf.printf "  ℹ️  Native RocksDB not available, skipping\n"
+  else begin
+    let path = "/tmp/opencoq_persistence_load" in
+    ignore (Sys.command (Printf.sprintf "rm -rf %s %s.wal" path path));
+    let (atomspace, ids) = build_sample_atomspace () in
+    let store = create_store (RocksDB path) in
+    save store atomspace;
+    List.iter (fun threads ->
+      let loaded = load_rocksdb ~threads store path in
+      check_loaded (Printf.sprintf "%d threads" threads) loaded ids
+    ) [1; 3];
+    
+    (* A larger AtomSpace spreads over several ranges per column family *)
+    let big = Hypergraph.create_atomspace () in
+    for i = 0 to 9999 do
+      let n = Hypergraph.add_node big Hypergraph.Concept (string_of_int i) in
+      if i > 0 then ignore (Hypergraph.add_link big Hypergraph.Similarity [n - 1; n])
+    done;
+    let big_store = create_store (RocksDB (path ^ "_big")) in
+    ignore (Sys.command (Printf.sprintf "rm -rf %s_big" path));
+    save big_store big;
+    let t0 = Unix.gettimeofday () in
+    let loaded = load_rocksdb ~threads:4 big_store (path ^ "_big") in
+    Printf.printf "  ℹ️  Loaded 19999 atoms in %.3fs\n" (Unix.gettimeofday () -. t0);
+    assert_eq 10000 (Hypergraph.fold_nodes (fun _ n -> n + 1) loaded 0) "all nodes loaded";
+    assert_eq 9999 (Hypergraph.fold_links (fun _ n -> n + 1) loaded 0) "all links loaded";
+    close_store store;
+    close_store big_store;
+    ignore (Sys.command (Printf.sprintf "rm -rf %s %s.wal %s_big %s_big.wal" path path path path))
+  end
+
+let file_size path = (Unix.stat path).Unix.st_size
+
+let test_wal_log () =
+  section "Binary Write-Ahead Log";
+  
+  assert_eq 0xCBF43926 (Binary.crc32 "123456789" 0 9) "CRC-32 check value";
+  let path = "/tmp/test_opencoq.wal" in
+  (try Sys.remove path with _ -> ());
+  
+  (* Records round-trip with their full payloads *)
+  let ops = [
+    WAL.AddNode (sample_node 1 "cat");
+    WAL.AddNode (sample_node 70000 "tab\tand \"quote\"");
+    WAL.AddLink (sample_link 2 "member-of" [1; 70000]);
+    WAL.UpdateNode (sample_node 1 "cat");
+    WAL.DeleteLink 2;
+    WAL.DeleteNode 70000;
+  ] in
+  let wal = WAL.create ~path ~group_size:4 ~sync:(WAL.Sync_interval 60.0) () in
+  List.iter (WAL.append wal) ops;
+  assert_eq 2 (WAL.pending_records wal) "records buffered until the group fills";
+  assert_eq 4 (List.length (WAL.read_file path)) "first group written";
+  WAL.flush wal;
+  assert_true (WAL.read_file path = ops) "records round-trip in order";
+  
+  (* A torn or corrupt tail is dropped *)
+  let size = file_size path in
+  let oc = open_out_gen [Open_wronly; Open_append; Open_binary] 0o644 path in
+  output_string oc "\x40\x00\x00\x00\x01\x02";
+  close_out oc;
+  assert_true (WAL.read_file path = ops) "torn record ignored";
+  Unix.truncate path (size - 3);
+  assert_eq 5 (List.length (WAL.read_file path)) "short last record ignored";
+  let fd = Unix.openfile path [Unix.O_WRONLY] 0o644 in
+  ignore (Unix.lseek fd (size - 40) Unix.SEEK_SET);
+  ignore (Unix.write_substring fd "X" 0 1);
+  Unix.close fd;
+  assert_eq 4 (List.length (WAL.read_file path)) "checksum mismatch stops the scan";
+  
+  (* Checkpoints truncate *)
+  WAL.checkpoint wal;
+  assert_eq 0 (file_size path) "checkpoint truncates the log";
+  WAL.append wal (WAL.DeleteNode 1);
+  WAL.close wal;
+  assert_true (WAL.read_file path = [WAL.DeleteNode 1]) "close flushes the last group";
+  Sys.remove path;
+  
+  (* Only the interval policy buffers, and not past its interval *)
+  let wal = WAL.create ~path ~group_size:4 ~sync:WAL.Sync_always () in
+  WAL.append wal (WAL.DeleteNode 1);
+  assert_eq 0 (WAL.pending_records wal) "Sync_always writes every append";
+  assert_eq 1 (List.length (WAL.read_file path)) "appended record on disk";
+  WAL.close wal;
+  Sys.remove path;
+  let wal = WAL.create ~path ~group_size:4 ~sync:(WAL.Sync_interval 0.0) () in
+  WAL.append wal (WAL.DeleteNode 1);
+  assert_eq 1 (List.length (WAL.read_file path)) "elapsed interval commits the append";
+  WAL.close wal;
+  Sys.remove path
+
+let test_wal_replay () =
+  section "WAL Replay";
+  
+  let path = "/tmp/test_opencoq_replay.bin" in
+  List.iter (fun p -> try Sys.remove p with _ -> ()) [path; path ^ ".wal"];
+  let store = create_store (FileBinary path) in
+  let atomspace = Hypergraph.create_atomspace () in
+  let a = Hypergraph.add_node atomspace Hypergraph.Concept "a" in
+  save store atomspace;
+  
+  (* Changes after the save reach the log only *)
+  let b = Hypergraph.add_node atomspace Hypergraph.Concept "b" in
+  record_add_node store (Option.get (Hypergraph.get_node atomspace b));
+  Hypergraph.add_node_sti atomspace a 42.0;
+  record_update_node store (Option.get (Hypergraph.get_node atomspace a));
+  let l = Hypergraph.add_link atomspace Hypergraph.Inheritance [a; b] in
+  record_add_link store (Option.get (Hypergraph.get_link atomspace l));
+  close_store store;
+  
+  (* A load that fails keeps the log for the next attempt *)
+  let bad = path ^ ".bad" in
+  let copy src dst =
+    let ic = open_in_bin src in
+    let data = really_input_string ic (in_channel_length ic) in
+    close_in ic;
+    let oc = open_out_bin dst in
+    output_string oc data;
+    close_out oc
+  in
+  let oc = open_out_bin bad in
+  output_string oc "not a snapshot";
+  close_out oc;
+  copy (path ^ ".wal") (bad ^ ".wal");
+  let failing = create_store (FileBinary bad) in
+  assert_true (try ignore (load failing); false with Failure _ -> true) "corrupt base fails to load";
+  assert_eq 3 (List.length (WAL.read_file (bad ^ ".wal"))) "failed load leaves the log intact";
+  close_store failing;
+  List.iter Sys.remove [bad; bad ^ ".wal"];
+  
+  (* Replay rewrites the log whole, dropping a torn tail *)
+  let oc = open_out_gen [Open_wronly; Open_append; Open_binary] 0o644 (path ^ ".wal") in
+  output_string oc "\x40\x00\x00";
+  close_out oc;
+  let reopened = create_store (FileBinary path) in
+  let loaded = load reopened in
+  assert_true (Hypergraph.get_node loaded b <> None) "logged node replayed";
+  assert_true (Hypergraph.get_link loaded l <> None) "logged link replayed";
+  assert_true (match Hypergraph.get_node_attention loaded a with
+      | Some av -> av.sti = 42.0 | None -> false) "logged update replayed";
+  assert_eq 3 (List.length (WAL.read_file (path ^ ".wal"))) "replayed records stay logged";
+  assert_true (not (Sys.file_exists (path ^ ".wal.tmp"))) "log replaced through a rename";
+  record_delete_node reopened b;
+  flush_wal reopened;
+  assert_eq 4 (List.length (WAL.read_file (path ^ ".wal"))) "appends after replay stay readable";
+  save reopened loaded;
+  assert_eq 0 (file_size (path ^ ".wal")) "save checkpoints the log";
+  close_store reopened;
+  List.iter Sys.remove [path; path ^ ".wal"]
+
+let test_wal_throughput () =
+  section "WAL Throughput";
+  
+  let path = "/tmp/test_opencoq_bench.wal" in
+  let n = 100_000 in
+  let run group_size sync =
+    (try Sys.remove path with _ -> ());
+    let wal = WAL.create ~path ~group_size ~sync () in
+    let t0 = Unix.gettimeofday () in
+    for i = 1 to n do
+      WAL.append wal (WAL.UpdateNode (sample_node i "bench"))
+    done;
+    WAL.close wal;
+    let elapsed = Unix.gettimeofday () -. t0 in
+    elapsed
+  in
+  let grouped = run 256 (WAL.Sync_interval 1.0) in
+  let single = run 1 WAL.Sync_never in
+  Printf.printf "  ℹ️  %d records: groups of 256 %.3fs, one write each %.3fs\n" n grouped single;
+  assert_eq n (List.length (WAL.read_file path)) "every record readable";
+  Sys.remove path
 
 let () =
   Printf.printf "\n";
@@ -273,6 +710,15 @@ let () =
   test_atomspace_serialization ();
   test_json_file_operations ();
   test_incremental_operations ();
+  test_rocks_encoding ();
+  test_rocksdb_store ();
+  test_binary_load ();
+  test_columnar_snapshot ();
+  test_quantized_embeddings ();
+  test_rocksdb_load ();
+  test_wal_log ();
+  test_wal_replay ();
+  test_wal_throughput ();
   
   Printf.printf "\n";
   Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
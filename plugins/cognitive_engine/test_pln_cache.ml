@@ -241,6 +241,121 @@ let test_reset_stats () =
   assert_eq 0 stats2.hits "hits reset to 0";
   assert_eq 0 stats2.misses "misses reset to 0"
 
+let test_lru_eviction () =
+  section "LRU Eviction";
+  
+  let cache = create ~max_size:3 () in
+  let _ = cached_deduction cache mock_atomspace 1 2 mock_deduction in
+  let _ = cached_deduction cache mock_atomspace 3 4 mock_deduction in
+  let _ = cached_deduction cache mock_atomspace 5 6 mock_deduction in
+  
+  (* Touch (1,2) so that (3,4) becomes least recently used *)
+  let _ = cached_deduction cache mock_atomspace 1 2 mock_deduction in
+  let _ = cached_deduction cache mock_atomspace 7 8 mock_deduction in
+  
+  assert_eq 3 (size cache) "size bounded by max_size";
+  assert_eq 1 (get_stats cache).evictions "one eviction";
+  
+  let hits_before = (get_stats cache).hits in
+  let _ = cached_deduction cache mock_atomspace 1 2 mock_deduction in
+  assert_eq (hits_before + 1) (get_stats cache).hits "recently used entry kept";
+  
+  let misses_before = (get_stats cache).misses in
+  let _ = cached_deduction cache mock_atomspace 3 4 mock_deduction in
+  assert_eq (misses_before + 1) (get_stats cache).misses "least recently used entry evicted"
+
+let test_dependency_index () =
+  section "Dependency Index";
+  
+  let cache = create ~max_size:2 () in
+  let _ = cached_deduction cache mock_atomspace 1 2 mock_deduction in
+  let _ = cached_deduction cache mock_atomspace 1 3 mock_deduction in
+  let _ = cached_deduction cache mock_atomspace 4 5 mock_deduction in
+  
+  (* (1,2) was evicted, so only (1,3) depends on atom 1 *)
+  invalidate cache 1;
+  assert_eq 1 (get_stats cache).invalidations "evicted entries are not invalidated";
+  assert_eq 1 (size cache) "one entry left";
+  
+  let _ = cached_chain cache mock_atomspace [7; 8; 9] (fun _ _ -> []) in
+  invalidate cache 8;
+  assert_eq 2 (get_stats cache).invalidations "chain invalidated through inner link";
+  invalidate cache 8;
+  assert_eq 2 (get_stats cache).invalidations "repeated invalidation is a no-op"
+
+let test_sharded_cache () =
+  section "Sharded Concurrent Cache";
+  
+  let cache = Sharded.create ~shards:8 ~max_size:100_000 () in
+  assert_eq 8 (Sharded.num_shards cache) "8 shards";
+  
+  let workers = 4 in
+  let queries_per_worker = 20_000 in
+  let worker w =
+    for i = 0 to queries_per_worker - 1 do
+      (* Workers overlap on half of their keys *)
+      let a = (i + w * queries_per_worker / 2) mod 5_000 in
+      ignore (Sharded.cached_deduction cache mock_atomspace a (a + 1) mock_deduction);
+      ignore (Sharded.cached_conjunction cache mock_atomspace a (a + 1) mock_conjunction)
+    done
+  in
+  let threads = List.init workers (fun w -> Thread.create worker w) in
+  List.iter Thread.join threads;
+  
+  let stats = Sharded.get_stats cache in
+  assert_eq (2 * workers * queries_per_worker) stats.total_queries "all queries counted";
+  assert_eq stats.total_queries (stats.hits + stats.misses) "hits + misses = queries";
+  assert_eq 10_000 (Sharded.size cache) "one entry per distinct key";
+  assert_true (Sharded.hit_rate cache > 0.9) "concurrent workers share entries";
+  
+  Sharded.invalidate cache 1;
+  assert_eq 9_996 (Sharded.size cache) "invalidation reaches every shard";
+  
+  Sharded.invalidate_all cache;
+  assert_eq 0 (Sharded.size cache) "invalidate_all empties all shards"
+
+(** Lookup, insert, evict and invalidate must stay O(1) at 10^6 entries *)
+let test_cache_benchmark () =
+  section "Cache Benchmark (10^6 entries)";
+  
+  let n = 1_000_000 in
+  let cache = create ~max_size:n ~ttl:3600.0 () in
+  
+  let t0 = Unix.gettimeofday () in
+  for i = 1 to n do
+    ignore (cached_deduction cache mock_atomspace i (i + 1) mock_deduction)
+  done;
+  let insert_time = Unix.gettimeofday () -. t0 in
+  Printf.printf "  ℹ️  %d inserts: %.3fs (%.0f ops/s)\n" n insert_time
+    (float_of_int n /. insert_time);
+  assert_eq n (size cache) "cache holds 10^6 entries";
+  
+  let t0 = Unix.gettimeofday () in
+  for i = 1 to n do
+    ignore (cached_deduction cache mock_atomspace i (i + 1) mock_deduction)
+  done;
+  let lookup_time = Unix.gettimeofday () -. t0 in
+  Printf.printf "  ℹ️  %d hits: %.3fs (%.0f ops/s)\n" n lookup_time
+    (float_of_int n /. lookup_time);
+  assert_eq n (get_stats cache).hits "all lookups hit";
+  
+  let t0 = Unix.gettimeofday () in
+  for i = n + 1 to 2 * n do
+    ignore (cached_deduction cache mock_atomspace i (i + 1) mock_deduction)
+  done;
+  let evict_time = Unix.gettimeofday () -. t0 in
+  Printf.printf "  ℹ️  %d inserts with eviction: %.3fs (%.0f ops/s)\n" n evict_time
+    (float_of_int n /. evict_time);
+  assert_eq n (get_stats cache).evictions "each insert evicts one entry";
+  
+  let t0 = Unix.gettimeofday () in
+  for i = n + 1 to n + 100_000 do
+    invalidate cache i
+  done;
+  let invalidate_time = Unix.gettimeofday () -. t0 in
+  Printf.printf "  ℹ️  100000 invalidations: %.3fs\n" invalidate_time;
+  assert_true ((get_stats cache).invalidations >= 100_000) "invalidations use the index"
+
 let () =
   Printf.printf "\n";
   Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
@@ -257,6 +372,10 @@ let () =
   test_stats_serialization ();
   test_memory_estimate ();
   test_reset_stats ();
+  test_lru_eviction ();
+  test_dependency_index ();
+  test_sharded_cache ();
+  test_cache_benchmark ();
   
   Printf.printf "\n";
   Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
@@ -110,7 +110,13 @@ let test_revision () =
   (* Revised strength should be between the two *)
   assert_float_eq true (tv_revised.strength >= 0.6 && tv_revised.strength <= 0.8) 1.0 "revision strength in range";
   Printf.printf "  ℹ️  TV1=%s, TV2=%s => Revised=%s\n"
-    (tv_to_string tv1) (tv_to_string tv2) (tv_to_string tv_revised)
+    (tv_to_string tv1) (tv_to_string tv2) (tv_to_string tv_revised);
+  (* Confidence 1 means an infinite count; revision must stay finite *)
+  let certain = revision (make_tv 1.0 1.0) (make_tv 0.5 1.0) in
+  assert_tv_valid certain "revision of certain values";
+  assert_float_eq 0.75 certain.strength "certain values average";
+  let dominant = revision (make_tv 0.9 1.0) tv2 in
+  assert_float_eq 0.9 dominant.strength "certain value outweighs finite evidence"
 
 let test_logical_connectives () =
   section "Logical Connectives";
@@ -305,6 +305,121 @@ let () =
       close db
     );
     
+    let buffer_of_string str =
+      let buf = create_buffer (String.length str) in
+      String.iteri (fun i c -> Bigarray.Array1.set buf i c) str;
+      buf
+    in
+    let string_of_buffer buf len =
+      String.init len (fun i -> Bigarray.Array1.get buf i)
+    in
+    
+    test "put_bigarray and get_into" (fun () ->
+      let db = open_db test_db_path in
+      put_bigarray ~cf:Attention db "ba_key" (buffer_of_string "zero-copy");
+      let buf = create_buffer 64 in
+      let len = get_into ~cf:Attention db "ba_key" buf in
+      assert_eq "length" "9" (string_of_int len);
+      assert_eq "value" "zero-copy" (string_of_buffer buf len);
+      assert_eq "string get" "zero-copy" (get_exn ~cf:Attention db "ba_key");
+      close db
+    );
+    
+    test "get_into reports full length when truncated" (fun () ->
+      let db = open_db test_db_path in
+      put db "long_key" "0123456789";
+      let buf = create_buffer 4 in
+      let len = get_into db "long_key" buf in
+      assert_eq "length" "10" (string_of_int len);
+      assert_eq "prefix" "0123" (string_of_buffer buf 4);
+      assert_eq "missing" "-1" (string_of_int (get_into db "no_such_key" buf));
+      close db
+    );
+    
+    test "batch_put_bigarray and iter_value_into" (fun () ->
+      let db = open_db test_db_path in
+      with_batch db (fun batch ->
+        batch_put_bigarray db batch TruthValues "tv1" (buffer_of_string "aa");
+        batch_put_bigarray db batch TruthValues "tv2" (buffer_of_string "bbb")
+      );
+      let iter = iter_create ~cf:TruthValues db in
+      iter_seek iter "tv1";
+      let key_buf = create_buffer 16 in
+      let value_buf = create_buffer 16 in
+      let key_len = iter_key_into iter key_buf in
+      let value_len = iter_value_into iter value_buf in
+      iter_destroy iter;
+      assert_eq "key" "tv1" (string_of_buffer key_buf key_len);
+      assert_eq "value" "aa" (string_of_buffer value_buf value_len);
+      close db
+    );
+    
+    test "multi_get_into" (fun () ->
+      let db = open_db test_db_path in
+      put ~cf:Nodes db "mg1" "one";
+      put ~cf:Nodes db "mg3" "three";
+      let buf = create_buffer 32 in
+      let lens = multi_get_into ~cf:Nodes db [| "mg1"; "mg2"; "mg3" |] buf in
+      assert_eq "lengths" "3,-1,5"
+        (String.concat "," (Array.to_list (Array.map string_of_int lens)));
+      assert_eq "packed" "onethree" (string_of_buffer buf 8);
+      let small = create_buffer 4 in
+      assert_true "overflow rejected"
+        (try ignore (multi_get_into ~cf:Nodes db [| "mg1"; "mg3" |] small); false
+         with Invalid_argument _ -> true);
+      close db
+    );
+    
+    test "iterator outlives close" (fun () ->
+      let db = open_db test_db_path in
+      put ~cf:Metadata db "oc1" "one";
+      put ~cf:Metadata db "oc2" "two";
+      let iter = iter_create_range ~cf:Metadata ~lower:"oc1" ~upper:"oc3" db in
+      let reader = Thread.create (fun () ->
+        iter_seek_to_first iter;
+        iter_read_batch iter (create_buffer 64)) () in
+      close db;
+      Thread.join reader;
+      assert_true "closed" (not (is_open db));
+      iter_seek_to_first iter;
+      assert_eq "still readable" "oc1" (iter_key iter);
+      iter_destroy iter;
+      let db = open_db test_db_path in
+      assert_eq "reopened" "two" (Option.value ~default:"" (get ~cf:Metadata db "oc2"));
+      close db
+    );
+    
+    test "concurrent threads share the database" (fun () ->
+      let db = open_db test_db_path in
+      let n = 2000 in
+      let key i = Printf.sprintf "t:%06d" i in
+      let old_value i = "old:" ^ string_of_int i in
+      let new_value i = "new:" ^ string_of_int i in
+      for i = 1 to n do put ~cf:Attention db (key i) (old_value i) done;
+      (* Two writers overwrite the odd and even keys while this thread reads *)
+      let writer parity = Thread.create (fun () ->
+        for i = 1 to n do
+          if i mod 2 = parity then put ~cf:Attention db (key i) (new_value i)
+        done) () in
+      let writers = [writer 0; writer 1] in
+      let torn = ref 0 in
+      for _ = 1 to 3 do
+        for i = 1 to n do
+          match get ~cf:Attention db (key i) with
+          | Some v when v = old_value i || v = new_value i -> ()
+          | _ -> incr torn
+        done
+      done;
+      List.iter Thread.join writers;
+      assert_eq "reads see old or new values" "0" (string_of_int !torn);
+      let final = ref 0 in
+      for i = 1 to n do
+        if get ~cf:Attention db (key i) = Some (new_value i) then incr final
+      done;
+      assert_eq "final values are the writers'" (string_of_int n) (string_of_int !final);
+      close db
+    );
+    
     cleanup ()
   end;
   
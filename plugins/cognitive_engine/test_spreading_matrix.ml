@@ -0,0 +1,195 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Test Suite for the Sparse Spreading-Activation Matrix *)
+
+open Hypergraph
+
+(** Test utilities *)
+let test_count = ref 0
+let pass_count = ref 0
+let fail_count = ref 0
+
+let assert_true condition name =
+  incr test_count;
+  if condition then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s\n" name
+  end
+
+let section name =
+  Printf.printf "\n=== %s ===\n" name
+
+let close a b = abs_float (a -. b) < 1e-9
+
+let time f =
+  let start = Unix.gettimeofday () in
+  let r = f () in
+  (r, Unix.gettimeofday () -. start)
+
+(* A random graph with STI on every node, built the same way each time *)
+let build_graph num_nodes num_links =
+  Random.init 7;
+  let atomspace = create_atomspace ~capacity:num_nodes () in
+  let nodes = Array.init num_nodes (fun i -> add_node atomspace Concept (string_of_int i)) in
+  Array.iter (fun id -> add_node_sti atomspace id (Random.float 100.0)) nodes;
+  for _ = 1 to num_links do
+    let arity = 2 + Random.int 2 in
+    let outgoing = List.init arity (fun _ -> nodes.(Random.int num_nodes)) in
+    ignore (add_link atomspace Inheritance outgoing)
+  done;
+  (atomspace, nodes)
+
+(* Spreading as it was done per source before the matrix *)
+let reference_spread atomspace sources threshold fraction =
+  List.iter (fun id ->
+    match get_node_attention atomspace id with
+    | Some av when av.sti > threshold ->
+        let adjacent = get_incoming_links atomspace id @ get_outgoing_links atomspace id in
+        if adjacent <> [] then begin
+          spread_activation atomspace id (av.sti *. fraction);
+          add_node_sti atomspace id (-. av.sti *. fraction)
+        end
+    | _ -> ()
+  ) sources
+
+let same_attention a b =
+  let same = ref true in
+  for id = 1 to a.next_link_id - 1 do
+    match get_link_attention a id, get_link_attention b id with
+    | Some x, Some y -> if not (close x.sti y.sti) then same := false
+    | None, None -> ()
+    | _ -> same := false
+  done;
+  for id = 1 to a.next_node_id - 1 do
+    match get_node_attention a id, get_node_attention b id with
+    | Some x, Some y -> if not (close x.sti y.sti) then same := false
+    | None, None -> ()
+    | _ -> same := false
+  done;
+  !same
+
+(** Test cases *)
+
+let test_rows () =
+  section "Rows";
+
+  let atomspace = create_atomspace () in
+  let a = add_node atomspace Concept "a" in
+  let b = add_node atomspace Concept "b" in
+  let c = add_node atomspace Concept "c" in
+  let l1 = add_link atomspace Inheritance [a; b] in
+  let matrix = Spreading_matrix.create atomspace in
+  assert_true (Spreading_matrix.nonzeros matrix = 2) "one entry per node of the link";
+  assert_true (Spreading_matrix.row matrix a = [(l1, 1.0)])
+    "incoming and outgoing shares of one link merge";
+  assert_true (Spreading_matrix.row matrix c = []) "isolated node has an empty row";
+
+  (* Incremental refresh through link events *)
+  let l2 = add_link atomspace Similarity [c; a] in
+  assert_true (Spreading_matrix.pending_rows matrix = 2) "added link marks its nodes";
+  (match Spreading_matrix.row matrix a with
+   | [(x, s1); (y, s2)] ->
+       assert_true (x = l1 && y = l2) "row lists both links";
+       assert_true (close s1 (2.0 /. 3.0) && close s2 (1.0 /. 3.0)) "shares follow adjacency counts"
+   | _ -> assert_true false "row has two entries");
+  remove_link atomspace l1;
+  assert_true (Spreading_matrix.row matrix b = []) "removed link leaves the row";
+  Spreading_matrix.compact matrix;
+  assert_true (Spreading_matrix.pending_rows matrix = 0) "compaction folds changed rows in";
+  assert_true (Spreading_matrix.row matrix a = [(l2, 1.0)]) "compacted row matches";
+  let d = add_node atomspace Concept "d" in
+  ignore (add_link atomspace Inheritance [d; c]);
+  assert_true (List.length (Spreading_matrix.row matrix d) = 1)
+    "node added after the build gets a row";
+  Spreading_matrix.compact matrix;
+  let observers = List.length atomspace.link_observers in
+  Spreading_matrix.release matrix;
+  assert_true (List.length atomspace.link_observers = observers - 1)
+    "release unsubscribes the matrix";
+  ignore (add_link atomspace Inheritance [b; d]);
+  assert_true (Spreading_matrix.pending_rows matrix = 0)
+    "released matrix ignores link events"
+
+let test_spread () =
+  section "Spreading";
+
+  let (expected, nodes) = build_graph 2000 5000 in
+  let (actual, _) = build_graph 2000 5000 in
+  let matrix = Spreading_matrix.create ~workers:1 actual in
+  let sources = Array.to_list (Array.sub nodes 0 500) in
+  reference_spread expected sources 50.0 0.1;
+  let spread = Spreading_matrix.spread matrix sources 50.0 0.1 in
+  assert_true (same_attention expected actual) "one pass matches per-source spreading";
+  assert_true (List.for_all (fun (_, amount) -> amount > 5.0) spread)
+    "only sources above the threshold spread";
+  assert_true (List.length (Spreading_matrix.spread matrix [] 0.0 0.1) = 0) "no sources, no spread";
+
+  (* Links added after the build spread like the rest *)
+  for i = 0 to 99 do
+    ignore (add_link expected Inheritance [nodes.(i); nodes.(i + 1)]);
+    ignore (add_link actual Inheritance [nodes.(i); nodes.(i + 1)])
+  done;
+  remove_link expected 3;
+  remove_link actual 3;
+  reference_spread expected sources 10.0 0.1;
+  ignore (Spreading_matrix.spread matrix sources 10.0 0.1);
+  assert_true (same_attention expected actual) "refreshed rows match after link changes";
+
+  (* Worker processes give the same sums *)
+  let (parallel, _) = build_graph 2000 5000 in
+  let (sequential, _) = build_graph 2000 5000 in
+  let pm = Spreading_matrix.create ~workers:4 ~parallel_threshold:0 parallel in
+  let sm = Spreading_matrix.create ~workers:1 sequential in
+  let all = Array.to_list nodes in
+  ignore (Spreading_matrix.spread pm all 0.0 0.1);
+  ignore (Spreading_matrix.spread sm all 0.0 0.1);
+  assert_true (same_attention parallel sequential) "parallel blocks match a single pass"
+
+let test_benchmark () =
+  section "Benchmark";
+
+  let num_nodes = 200_000 and num_links = 400_000 in
+  let (per_source, nodes) = build_graph num_nodes num_links in
+  let (batched, _) = build_graph num_nodes num_links in
+  let (matrix, build_time) = time (fun () -> Spreading_matrix.create ~workers:1 batched) in
+  Printf.printf "  CSR over %d nodes: %d entries in %.3fs\n"
+    num_nodes (Spreading_matrix.nonzeros matrix) build_time;
+  let sources = Array.to_list (Array.sub nodes 0 20_000) in
+  let ((), reference_time) = time (fun () -> reference_spread per_source sources 0.0 0.1) in
+  let (_, matrix_time) = time (fun () -> Spreading_matrix.spread matrix sources 0.0 0.1) in
+  Printf.printf "  %d sources: per-source %.3fs, one pass %.3fs\n"
+    (List.length sources) reference_time matrix_time;
+  assert_true (same_attention per_source batched) "benchmark results agree"
+
+let () =
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║     Spreading Matrix - Test Suite                        ║\n";
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  test_rows ();
+  test_spread ();
+  test_benchmark ();
+
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║                    Test Summary                          ║\n";
+  Printf.printf "╠══════════════════════════════════════════════════════════╣\n";
+  Printf.printf "║  Total:  %3d                                             ║\n" !test_count;
+  Printf.printf "║  Passed: %3d                                             ║\n" !pass_count;
+  Printf.printf "║  Failed: %3d                                             ║\n" !fail_count;
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  if !fail_count = 0 then
+    Printf.printf "\n⚡ All spreading matrix tests passed! ⚡\n\n"
+  else
+    Printf.printf "\n⚠️  Some tests failed. Please review. ⚠️\n\n"
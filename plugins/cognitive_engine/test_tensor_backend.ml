@@ -0,0 +1,303 @@
+(************************************************************************)
+(*  v      *   The Coq Proof Assistant  /  The Coq Development Team     *)
+(* <O___,, *   INRIA - CNRS - LIX - LRI - PPS - Copyright 1999-2016     *)
+(*   \VV/  **************************************************************)
+(*    //   *      This file is distributed under the terms of the       *)
+(*         *       GNU Lesser General Public License Version 2.1        *)
+(************************************************************************)
+
+(** Test Suite for the Tensor Backend and batched GGML execution *)
+
+open Tensor_backend
+
+(** Test utilities *)
+let test_count = ref 0
+let pass_count = ref 0
+let fail_count = ref 0
+
+let assert_true condition name =
+  incr test_count;
+  if condition then begin
+    incr pass_count;
+    Printf.printf "  ✅ %s\n" name
+  end else begin
+    incr fail_count;
+    Printf.printf "  ❌ %s\n" name
+  end
+
+(* GGML computes in float32 *)
+let close ?(eps=1e-4) a b =
+  Array.length a = Array.length b
+  && (let ok = ref true in
+      Array.iteri (fun i y ->
+        if abs_float (a.(i) -. y) > eps *. (1.0 +. abs_float y) then ok := false) b;
+      !ok)
+
+let assert_close ?eps expected actual name =
+  assert_true (close ?eps expected actual) name
+
+let section name =
+  Printf.printf "\n=== %s ===\n" name
+
+let ocaml = create_context OCaml_native
+let ggml = create_context GGML
+
+let matrix rows cols f = Array.init (rows * cols) (fun i -> f (i / cols) (i mod cols))
+
+(* Tensor_kernels takes and returns flat float arrays *)
+let floats = Float.Array.map_from_array Fun.id
+let of_floats = Float.Array.map_to_array Fun.id
+
+(** Test cases *)
+
+let test_backend_equivalence () =
+  section "GGML Backend Matches OCaml Backend";
+  Printf.printf "  ℹ️  Native GGML: %b\n" (Ggml_native.is_native_available ());
+
+  let a = matrix 3 4 (fun i j -> float_of_int (i * 4 + j) /. 7.0 -. 0.5) in
+  let b = matrix 4 2 (fun i j -> float_of_int (i - j) *. 0.25) in
+  let c = matrix 3 4 (fun i j -> float_of_int (i + j) -. 2.0) in
+
+  assert_close (tensor_add ocaml [3; 4] a c) (tensor_add ggml [3; 4] a c) "add";
+  assert_close (tensor_multiply ocaml [3; 4] a c) (tensor_multiply ggml [3; 4] a c) "multiply";
+  assert_close (tensor_scale ocaml [3; 4] 1.5 a) (tensor_scale ggml [3; 4] 1.5 a) "scale";
+  assert_close (tensor_matmul ocaml [3; 4] [4; 2] a b) (tensor_matmul ggml [3; 4] [4; 2] a b)
+    "non-square matmul";
+  let (t_ocaml, s_ocaml) = tensor_transpose ocaml [3; 4] a in
+  let (t_ggml, s_ggml) = tensor_transpose ggml [3; 4] a in
+  assert_true (s_ocaml = s_ggml) "transpose shape";
+  assert_close t_ocaml t_ggml "transpose data";
+  assert_close (tensor_relu ocaml [3; 4] c) (tensor_relu ggml [3; 4] c) "relu";
+  assert_close (tensor_sigmoid ocaml [3; 4] c) (tensor_sigmoid ggml [3; 4] c) "sigmoid";
+  assert_close (tensor_softmax ocaml [3; 4] a) (tensor_softmax ggml [3; 4] a) "softmax over all elements";
+  assert_close [| tensor_dot_product ocaml a c |] [| tensor_dot_product ggml a c |] "dot product";
+  assert_close [| tensor_norm ocaml a |] [| tensor_norm ggml a |] "norm"
+
+  (* Single operations size their context from their operands, past the
+     default batch memory *)
+  if Ggml_native.is_native_available () then begin
+    let n = 6_000_000 in
+    let x = Array.make n 1.0 in
+    let sum = tensor_add ggml [n] x x in
+    assert_true (sum.(n - 1) = 2.0) "single operation larger than the default batch memory"
+  end
+
+let test_fused_batch () =
+  section "Fused Batch";
+
+  let x = matrix 2 3 (fun i j -> float_of_int (i + 2 * j) -. 1.0) in
+  let w = matrix 3 3 (fun i j -> if i = j then 2.0 else 0.5) in
+  let bias = matrix 2 3 (fun _ j -> float_of_int j) in
+
+  (* softmax(relu(x w + bias)) by hand *)
+  let hidden =
+    tensor_relu ocaml [2; 3] (tensor_add ocaml [2; 3] (tensor_matmul ocaml [2; 3] [3; 3] x w) bias) in
+  let expected_out = Array.concat [
+    tensor_softmax ocaml [3] (Array.sub hidden 0 3);
+    tensor_softmax ocaml [3] (Array.sub hidden 3 3) ] in
+
+  List.iter (fun (name, ctx) ->
+    match with_batch ctx (fun b ->
+      let h = batch_relu (batch_add (batch_matmul (batch_input b [2; 3] x) (batch_input b [3; 3] w))
+                            (batch_input b [2; 3] bias)) in
+      let out = batch_softmax h in
+      assert_true (batch_shape out = [2; 3]) (name ^ ": output shape");
+      batch_compute b [h; out]) with
+    | [h; out] ->
+      assert_close hidden h (name ^ ": intermediate output");
+      assert_close expected_out out (name ^ ": row-wise softmax")
+    | _ -> assert_true false (name ^ ": two outputs")
+  ) [("ocaml", ocaml); ("ggml", ggml)];
+
+  (* Batches run back to back reuse the pooled context *)
+  let ok = ref true in
+  for i = 1 to 50 do
+    match with_batch ggml (fun b ->
+      batch_compute b [batch_scale (float_of_int i) (batch_input b [2; 3] x)]) with
+    | [r] -> if not (close (Array.map (fun v -> v *. float_of_int i) x) r) then ok := false
+    | _ -> ok := false
+  done;
+  assert_true !ok "repeated batches on the pooled context"
+
+let test_batch_misuse () =
+  section "Batch Lifetime";
+
+  let escaped = with_batch ggml (fun b -> batch_input b [2] [| 1.0; 2.0 |]) in
+  assert_true (try ignore (batch_relu escaped); false with Failure _ -> true)
+    "tensors cannot outlive their batch";
+  assert_true (try ignore (with_batch ggml (fun b -> batch_input b [3] [| 1.0 |])); false
+               with Failure _ -> true)
+    "input size must match shape";
+  let nested = with_batch ggml (fun outer ->
+    let a = batch_input outer [2] [| 1.0; -1.0 |] in
+    let inner = tensor_relu ggml [2] [| -3.0; 3.0 |] in
+    (inner, batch_compute outer [batch_relu a])) in
+  assert_true (nested = ([| 0.0; 3.0 |], [[| 1.0; 0.0 |]])) "batches can nest";
+  let oversized () =
+    with_batch ~mem_size:1024 ggml (fun b ->
+      batch_compute b [batch_input b [4_000_000] (Array.make 4_000_000 0.0)]) in
+  if Ggml_native.is_native_available () then
+    assert_true (try ignore (oversized ()); false with Failure _ -> true)
+      "oversized batch fails instead of overrunning its context"
+  else
+    assert_true (List.length (oversized ()) = 1) "host batches are not bounded"
+
+let test_dense_batches () =
+  section "Dense Tensors in Batches";
+
+  let x = Dense.of_array [| 2; 3 |] (matrix 2 3 (fun i j -> float_of_int (i * 3 + j) -. 2.0)) in
+  let w = Dense.of_array [| 3; 2 |] (matrix 3 2 (fun i j -> if i = j then 1.0 else 0.5)) in
+  let expected = tensor_relu ocaml [2; 2]
+      (tensor_matmul ocaml [2; 3] [3; 2] (Dense.to_array x) (Dense.to_array w)) in
+  List.iter (fun (name, ctx) ->
+    match with_batch ctx (fun b ->
+      batch_compute_dense b [batch_relu (batch_matmul (batch_input_dense b x) (batch_input_dense b w))]) with
+    | [r] ->
+      assert_true (Dense.dims r = [| 2; 2 |]) (name ^ ": result dims");
+      assert_close expected (Dense.to_array r) (name ^ ": matmul and relu")
+    | _ -> assert_true false (name ^ ": one output")
+  ) [("ocaml", ocaml); ("ggml", ggml)];
+
+  (* Non-contiguous views are packed before upload *)
+  let xt = Dense.transpose x in
+  assert_true (not (Dense.is_contiguous xt)) "transpose is a strided view";
+  (match with_batch ggml (fun b -> batch_compute_dense b [batch_input_dense b xt]) with
+   | [r] -> assert_close (fst (tensor_transpose ocaml [2; 3] (Dense.to_array x))) (Dense.to_array r)
+              "strided view round trip"
+   | _ -> assert_true false "strided view round trip");
+  assert_true (try ignore (Dense.flat xt); false with Failure _ -> true)
+    "flat needs a contiguous tensor";
+  assert_true (Bigarray.Array1.size_in_bytes (Dense.flat x) = 4 * Dense.size x)
+    "four bytes per element"
+
+let test_handle_lifetime () =
+  section "GGML Handle Lifetime";
+  let module G = Ggml_native in
+  if not (G.is_native_available ()) then
+    assert_true ((G.handle_stats ()).G.live_contexts = 0) "no handles without native GGML"
+  else begin
+    ggml_optimize_memory ggml ();
+    Gc.full_major ();
+    let base = G.handle_stats () in
+
+    (* More contexts at once than the old 64-entry registry held *)
+    let use_many () =
+      let contexts = List.init 100 (fun i ->
+        let ctx = G.create_context ~mem_size:(1024 * 1024) ~n_threads:1 () in
+        let t = G.new_tensor_1d ctx 4 in
+        G.set_data_from_array t (Array.make 4 (float_of_int i));
+        (ctx, t)) in
+      assert_true (List.for_all (fun (_, t) -> Array.length (G.get_data_as_array t) = 4) contexts)
+        "100 live contexts are all usable";
+      assert_true ((G.handle_stats ()).G.live_contexts = base.G.live_contexts + 100)
+        "live contexts counted" in
+    use_many ();
+
+    (* Dropping them lets the GC finalize every handle *)
+    Gc.full_major ();
+    let after = G.handle_stats () in
+    assert_true (after.G.live_contexts = base.G.live_contexts) "contexts finalized";
+    assert_true (after.G.live_tensors = base.G.live_tensors) "tensor wrappers finalized";
+    assert_true (after.G.pooled_arenas > 0 && after.G.pooled_arenas <= 4) "arenas pooled, not leaked";
+
+    (* Stale handles fail instead of reading reused memory *)
+    let ctx = G.create_context ~mem_size:(1024 * 1024) ~n_threads:1 () in
+    assert_true ((G.handle_stats ()).G.pooled_arenas = after.G.pooled_arenas - 1)
+      "new context reuses a pooled arena";
+    let t = G.new_tensor_1d ctx 2 in
+    G.reset ctx;
+    assert_true (try ignore (G.get_data_as_array t); false with Failure _ -> true)
+      "tensor from before a reset is rejected";
+    let t = G.new_tensor_1d ctx 2 in
+    G.set_data_from_array t [| 1.0; 2.0 |];
+    assert_true (G.get_data_as_array t = [| 1.0; 2.0 |]) "context usable after reset";
+    G.free ctx;
+    assert_true (try ignore (G.get_data_as_array t); false with Failure _ -> true)
+      "tensor of a freed context is rejected";
+
+    (* Long-running use does not grow the handle count *)
+    for _ = 1 to 1000 do
+      ignore (tensor_relu ggml [4] [| -1.0; 1.0; -2.0; 2.0 |])
+    done;
+    Gc.full_major ();
+    assert_true ((G.handle_stats ()).G.live_tensors <= base.G.live_tensors + 1)
+      "repeated batches leave no tensor wrappers behind";
+    ggml_optimize_memory ggml ();
+    assert_true ((G.handle_stats ()).G.pooled_arenas = 0) "trim frees pooled arenas"
+  end
+
+let test_blocked_gemm () =
+  section "Blocked GEMM";
+  let best = Tensor_kernels.simd_level () in
+  Printf.printf "  ℹ️  Micro-kernel: %s\n" (Tensor_kernels.simd_to_string best);
+
+  (* Odd sizes exercise the zero-padded edge tiles and partial K blocks *)
+  let sizes = [(1, 1, 1); (3, 5, 7); (37, 53, 61); (129, 67, 300); (64, 64, 64)] in
+  let check level =
+    let name = Tensor_kernels.simd_to_string (Tensor_kernels.force_level level) in
+    List.iter (fun (m, k, n) ->
+      let a = floats (matrix m k (fun i j -> sin (float_of_int (i * k + j)))) in
+      let b = floats (matrix k n (fun i j -> cos (float_of_int (i * n + j)))) in
+      assert_close ~eps:1e-12 (of_floats (Tensor_kernels.naive_matmul m k n a b))
+        (of_floats (Tensor_kernels.matmul m k n a b))
+        (Printf.sprintf "%s %dx%d * %dx%d" name m k k n)) sizes in
+  check Tensor_kernels.Scalar;
+  if best <> Tensor_kernels.Scalar then check best;
+  assert_true (Tensor_kernels.force_level best = best) "restores the detected kernel";
+
+  assert_true (Float.Array.length (Tensor_kernels.matmul 0 3 2 (floats [||]) (Float.Array.make 6 1.0)) = 0)
+    "empty product";
+  assert_true (try ignore (Tensor_kernels.matmul 2 2 2 (floats [| 1.0 |]) (floats [| 1.0 |])); false
+               with Failure _ -> true)
+    "size mismatch is rejected";
+  let t = matrix 45 70 (fun i j -> float_of_int (i * 70 + j)) in
+  let (tt, _) = tensor_transpose ocaml [45; 70] t in
+  assert_true (tt.(69 * 45 + 44) = t.(44 * 70 + 69) && tt.(45) = t.(1)) "tiled transpose";
+  assert_true (fst (tensor_transpose ocaml [70; 45] tt) = t) "transpose round trip"
+
+let benchmark_gemm () =
+  section "GEMM Benchmark";
+  let time f =
+    let start = Unix.gettimeofday () in
+    let r = f () in
+    (r, Unix.gettimeofday () -. start) in
+  List.iter (fun n ->
+    let a = matrix n n (fun i j -> float_of_int ((i + j) mod 7) -. 3.0) in
+    let b = matrix n n (fun i j -> float_of_int ((i * j) mod 5) -. 2.0) in
+    let gflops t = 2.0 *. float_of_int n ** 3.0 /. t /. 1e9 in
+    let (expected, t_naive) =
+      time (fun () -> of_floats (Tensor_kernels.naive_matmul n n n (floats a) (floats b))) in
+    let (actual, t_blocked) = time (fun () -> tensor_matmul ocaml [n; n] [n; n] a b) in
+    Printf.printf "  ℹ️  %4d: naive %6.2f GFLOP/s, blocked %6.2f GFLOP/s (%.1fx)\n"
+      n (gflops t_naive) (gflops t_blocked) (t_naive /. t_blocked);
+    assert_true (actual = expected) (Printf.sprintf "%dx%d blocked result is exact" n n)
+  ) [128; 256; 512]
+
+let () =
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║     Tensor Backend - Test Suite                          ║\n";
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  test_backend_equivalence ();
+  test_fused_batch ();
+  test_batch_misuse ();
+  test_dense_batches ();
+  test_handle_lifetime ();
+  test_blocked_gemm ();
+  benchmark_gemm ();
+  ggml_optimize_memory ggml ();
+
+  Printf.printf "\n";
+  Printf.printf "╔══════════════════════════════════════════════════════════╗\n";
+  Printf.printf "║                    Test Summary                          ║\n";
+  Printf.printf "╠══════════════════════════════════════════════════════════╣\n";
+  Printf.printf "║  Total:  %3d                                             ║\n" !test_count;
+  Printf.printf "║  Passed: %3d                                             ║\n" !pass_count;
+  Printf.printf "║  Failed: %3d                                             ║\n" !fail_count;
+  Printf.printf "╚══════════════════════════════════════════════════════════╝\n";
+
+  if !fail_count = 0 then
+    Printf.printf "\n🧮 All tensor backend tests passed! 🧮\n\n"
+  else
+    Printf.printf "\n⚠️  Some tests failed. Please review. ⚠️\n\n"
@@ -39,35 +39,35 @@ let test_tensor_operations () =
   let add_result_id = Hypergraph.tensor_add_op atomspace t1_id t2_id in
   (match Hypergraph.get_tensor atomspace add_result_id with
    | Some t -> Printf.printf "  ✓ Addition result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Addition failed\n");
   
   (* Test tensor multiplication *)
   let mul_result_id = Hypergraph.tensor_multiply_op atomspace t1_id t2_id in
   (match Hypergraph.get_tensor atomspace mul_result_id with
    | Some t -> Printf.printf "  ✓ Element-wise multiplication result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Multiplication failed\n");
   
   (* Test matrix multiplication *)
   let matmul_result_id = Hypergraph.tensor_matmul_op atomspace t1_id t2_id in
   (match Hypergraph.get_tensor atomspace matmul_result_id with
    | Some t -> Printf.printf "  ✓ Matrix multiplication result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Matrix multiplication failed\n");
   
   (* Test scaling *)
   let scale_result_id = Hypergraph.tensor_scale_op atomspace t1_id 2.0 in
   (match Hypergraph.get_tensor atomspace scale_result_id with
    | Some t -> Printf.printf "  ✓ Scaling by 2.0 result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Scaling failed\n");
   
   (* Test transpose *)
   let transpose_result_id = Hypergraph.tensor_transpose_op atomspace t1_id in
   (match Hypergraph.get_tensor atomspace transpose_result_id with
    | Some t -> Printf.printf "  ✓ Transpose result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Transpose failed\n");
   
   (* Test dot product *)
@@ -89,21 +89,21 @@ let test_tensor_operations () =
   let relu_result_id = Hypergraph.tensor_relu_op atomspace nn_id in
   (match Hypergraph.get_tensor atomspace relu_result_id with
    | Some t -> Printf.printf "  ✓ ReLU result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ ReLU failed\n");
   
   (* Test Sigmoid *)
   let sigmoid_result_id = Hypergraph.tensor_sigmoid_op atomspace nn_id in
   (match Hypergraph.get_tensor atomspace sigmoid_result_id with
    | Some t -> Printf.printf "  ✓ Sigmoid result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Sigmoid failed\n");
   
   (* Test Softmax *)
   let softmax_result_id = Hypergraph.tensor_softmax_op atomspace nn_id in
   (match Hypergraph.get_tensor atomspace softmax_result_id with
    | Some t -> Printf.printf "  ✓ Softmax result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ Softmax failed\n");
   
   (* Test 4: Switch to GGML backend (currently uses fallback) *)
@@ -116,7 +116,7 @@ let test_tensor_operations () =
   let ggml_add_result_id = Hypergraph.tensor_add_op atomspace t1_id t2_id in
   (match Hypergraph.get_tensor atomspace ggml_add_result_id with
    | Some t -> Printf.printf "  ✓ GGML addition result: %s\n" 
-                 (Tensor_backend.tensor_to_string t.shape t.data)
+                 (Tensor_backend.tensor_to_string (Hypergraph.tensor_shape_of t) (Hypergraph.tensor_values t))
    | None -> Printf.printf "  ✗ GGML addition failed\n");
   
   Printf.printf "\n🎉 All tensor operations completed successfully! 🎉\n";